@@ -0,0 +1,151 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Unittests for the generated event decoders.
+#include "sawbuck/log_lib/descriptors/image.h"
+#include "sawbuck/log_lib/descriptors/process.h"
+#include "sawbuck/log_lib/descriptors/thread.h"
+
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+// Accumulates event data in a byte buffer.
+class EventBuilder {
+ public:
+  template <class ValueType>
+  EventBuilder& Append(const ValueType& value) {
+    const uint8* data = reinterpret_cast<const uint8*>(&value);
+    buffer_.insert(buffer_.end(), data, data + sizeof(value));
+    return *this;
+  }
+
+  EventBuilder& AppendString(const wchar_t* str) {
+    const uint8* data = reinterpret_cast<const uint8*>(str);
+    buffer_.insert(buffer_.end(), data,
+                   data + (wcslen(str) + 1) * sizeof(*str));
+    return *this;
+  }
+
+  EventBuilder& AppendString(const char* str) {
+    buffer_.insert(buffer_.end(), str, str + strlen(str) + 1);
+    return *this;
+  }
+
+  const uint8* data() const { return &buffer_[0]; }
+  size_t size() const { return buffer_.size(); }
+
+ private:
+  std::vector<uint8> buffer_;
+};
+
+TEST(DescriptorsTest, ImageLoad32) {
+  EventBuilder builder;
+  builder.Append<ULONG>(0x01000000)  // ImageBase
+      .Append<ULONG>(0x10000)  // ImageSize
+      .Append<ULONG>(42)  // ProcessId
+      .Append<ULONG>(0xCAFEBABE)  // ImageChecksum
+      .Append<ULONG>(0x12345678)  // TimeDateStamp
+      .Append<ULONG>(0)  // Reserved0
+      .Append<ULONG>(0x01000000)  // DefaultBase
+      .Append<ULONG>(0).Append<ULONG>(0).Append<ULONG>(0).Append<ULONG>(0)
+      .AppendString(L"C:\\foo.dll");
+
+  BinaryBufferReader reader(builder.data(), builder.size());
+  descriptors::image::Load<2, false> load;
+  ASSERT_TRUE(load.Parse(&reader));
+
+  EXPECT_EQ(0x01000000, load.ImageBase);
+  EXPECT_EQ(0x10000, load.ImageSize);
+  EXPECT_EQ(42, load.ProcessId);
+  EXPECT_EQ(0xCAFEBABE, load.ImageChecksum);
+  EXPECT_EQ(0x12345678, load.TimeDateStamp);
+  EXPECT_EQ(L"C:\\foo.dll", load.FileName);
+  EXPECT_EQ(0, reader.RemainingBytes());
+}
+
+TEST(DescriptorsTest, ImageLoad64) {
+  EventBuilder builder;
+  builder.Append<ULONGLONG>(0x100000000ULL)  // ImageBase
+      .Append<ULONGLONG>(0x10000)  // ImageSize
+      .Append<ULONG>(42)  // ProcessId
+      .Append<ULONG>(0).Append<ULONG>(0).Append<ULONG>(0)
+      .Append<ULONGLONG>(0)  // DefaultBase
+      .Append<ULONG>(0).Append<ULONG>(0).Append<ULONG>(0).Append<ULONG>(0)
+      .AppendString(L"C:\\bar.dll");
+
+  BinaryBufferReader reader(builder.data(), builder.size());
+  descriptors::image::Load<2, true> load;
+  ASSERT_TRUE(load.Parse(&reader));
+
+  EXPECT_EQ(0x100000000ULL, load.ImageBase);
+  EXPECT_EQ(42, load.ProcessId);
+  EXPECT_EQ(L"C:\\bar.dll", load.FileName);
+}
+
+TEST(DescriptorsTest, TruncatedEventFails) {
+  EventBuilder builder;
+  builder.Append<ULONG>(1).Append<ULONG>(2);
+
+  BinaryBufferReader reader(builder.data(), builder.size());
+  descriptors::thread::CSwitch<2, false> cswitch;
+  EXPECT_FALSE(cswitch.Parse(&reader));
+}
+
+TEST(DescriptorsTest, ProcessWithSid) {
+  BYTE sid_buffer[SECURITY_MAX_SID_SIZE] = {};
+  DWORD sid_len = sizeof(sid_buffer);
+  ASSERT_TRUE(::CreateWellKnownSid(WinWorldSid, NULL, sid_buffer, &sid_len));
+
+  EventBuilder builder;
+  builder.Append<ULONG>(0)  // UniqueProcessKey
+      .Append<ULONG>(100)  // ProcessId
+      .Append<ULONG>(4)  // ParentId
+      .Append<ULONG>(1)  // SessionId
+      .Append<LONG>(0)  // ExitStatus
+      .Append<ULONG>(0)  // DirectoryTableBase
+      .Append<ULONG>(1).Append<ULONG>(0);  // The pointers preceding the SID.
+  for (DWORD i = 0; i < sid_len; ++i)
+    builder.Append(sid_buffer[i]);
+  builder.AppendString("foo.exe").AppendString(L"foo.exe --bar");
+
+  BinaryBufferReader reader(builder.data(), builder.size());
+  descriptors::process::TypeGroup1<3, false> process;
+  ASSERT_TRUE(process.Parse(&reader));
+
+  EXPECT_EQ(100, process.ProcessId);
+  EXPECT_EQ(4, process.ParentId);
+  ASSERT_EQ(sid_len, process.UserSID.size());
+  EXPECT_TRUE(::EqualSid(sid_buffer, &process.UserSID[0]));
+  EXPECT_EQ("foo.exe", process.ImageFileName);
+  EXPECT_EQ(L"foo.exe --bar", process.CommandLine);
+}
+
+TEST(DescriptorsTest, ProcessWithoutSid) {
+  EventBuilder builder;
+  builder.Append<ULONG>(0).Append<ULONG>(100).Append<ULONG>(4)
+      .Append<ULONG>(1).Append<LONG>(0).Append<ULONG>(0)
+      .Append<ULONG>(0)  // A NULL pointer means there's no SID.
+      .AppendString("foo.exe").AppendString(L"");
+
+  BinaryBufferReader reader(builder.data(), builder.size());
+  descriptors::process::TypeGroup1<3, false> process;
+  ASSERT_TRUE(process.Parse(&reader));
+
+  EXPECT_TRUE(process.UserSID.empty());
+  EXPECT_EQ("foo.exe", process.ImageFileName);
+}
+
+}  // namespace
@@ -0,0 +1,110 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Field readers used by the generated event decoders in this directory.
+// These are the C++ counterparts of the field types in
+// sawbuck/py/etw/etw/descriptors/field.py.
+#ifndef SAWBUCK_LOG_LIB_DESCRIPTORS_FIELD_H_
+#define SAWBUCK_LOG_LIB_DESCRIPTORS_FIELD_H_
+
+#include <windows.h>
+#include <string>
+#include <vector>
+
+#include "sawbuck/common/buffer_parser.h"
+
+namespace descriptors {
+namespace field {
+
+// The type of a pointer-sized field in a log of the given bitness.
+template <bool kIs64Bit> struct Pointer;
+template <> struct Pointer<false> {
+  typedef ULONG Type;
+};
+template <> struct Pointer<true> {
+  typedef ULONGLONG Type;
+};
+
+// A SID field holds a copy of the SID, or is empty if the event has no SID.
+typedef std::vector<uint8> Sid;
+
+// Reads an integral field.
+template <class ValueType>
+bool Read(BinaryBufferReader* reader, ValueType* value) {
+  const ValueType* data = NULL;
+  if (!reader->Read(&data))
+    return false;
+
+  *value = *data;
+  return true;
+}
+
+// Reads a boolean field, which is stored as a single byte.
+inline bool Read(BinaryBufferReader* reader, bool* value) {
+  const UCHAR* data = NULL;
+  if (!reader->Read(&data))
+    return false;
+
+  *value = *data != 0;
+  return true;
+}
+
+// Reads a zero-terminated string field.
+template <class CharType>
+bool Read(BinaryBufferReader* reader, std::basic_string<CharType>* value) {
+  const CharType* str = NULL;
+  size_t str_len = 0;
+  if (!reader->ReadString(&str, &str_len))
+    return false;
+
+  value->assign(str, str_len);
+  return true;
+}
+
+// Reads a SID field. SIDs are preceded by two pointers, and are only
+// present if the first of those is non-NULL.
+template <bool kIs64Bit>
+bool ReadSid(BinaryBufferReader* reader, Sid* value) {
+  typedef typename Pointer<kIs64Bit>::Type PointerType;
+  value->clear();
+
+  const PointerType* has_sid = NULL;
+  if (!reader->Read(&has_sid))
+    return false;
+  if (*has_sid == 0)
+    return true;
+
+  // Skip the second pointer.
+  if (!reader->Consume(sizeof(PointerType)))
+    return false;
+
+  // Probe the front of the SID structure.
+  const SID* sid = NULL;
+  if (!reader->Peek(FIELD_OFFSET(SID, SubAuthority), &sid) ||
+      !::IsValidSid(const_cast<SID*>(sid)))
+    return false;
+
+  DWORD sid_len = ::GetLengthSid(const_cast<SID*>(sid));
+  const uint8* data = NULL;
+  if (!reader->Read(sid_len, &data))
+    return false;
+
+  value->assign(data, data + sid_len);
+  return true;
+}
+
+}  // namespace field
+}  // namespace descriptors
+
+#endif  // SAWBUCK_LOG_LIB_DESCRIPTORS_FIELD_H_
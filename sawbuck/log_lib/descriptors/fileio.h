@@ -0,0 +1,243 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Generated event decoders for MOF GUID {90cbdc39-4a3e-11d1-84f4-0000f80464e3}.
+//
+// DO NOT EDIT. This file was generated by
+// sawbuck/py/etw/generate_cpp_descriptor.py from:
+//   etw.descriptors.fileio
+#ifndef SAWBUCK_LOG_LIB_DESCRIPTORS_FILEIO_H_
+#define SAWBUCK_LOG_LIB_DESCRIPTORS_FILEIO_H_
+
+#include "sawbuck/log_lib/descriptors/field.h"
+
+namespace descriptors {
+namespace fileio {
+
+// {90cbdc39-4a3e-11d1-84f4-0000f80464e3}
+const GUID kGuid = { 0x90cbdc39, 0x4a3e, 0x11d1,
+    { 0x84, 0xf4, 0x00, 0x00, 0xf8, 0x04, 0x64, 0xe3 } };
+
+enum EventType {
+  kName = 0,
+  kFileCreate = 32,
+  kFileDelete = 35,
+  kFileRundown = 36,
+  kCreate = 64,
+  kCleanup = 65,
+  kClose = 66,
+  kRead = 67,
+  kWrite = 68,
+  kSetInfo = 69,
+  kDelete = 70,
+  kRename = 71,
+  kDirEnum = 72,
+  kFlush = 73,
+  kQueryInfo = 74,
+  kFSControl = 75,
+  kOperationEnd = 76,
+  kDirNotify = 77,
+};
+
+template <int kVersion, bool kIs64Bit> struct Create;
+
+// Layout of the Create events, version 2.
+template <bool kIs64Bit>
+struct Create<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type IrpPtr;
+  typename field::Pointer<kIs64Bit>::Type TTID;
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  ULONG CreateOptions;
+  ULONG FileAttributes;
+  ULONG ShareAccess;
+  std::wstring OpenPath;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &IrpPtr) &&
+        field::Read(reader, &TTID) &&
+        field::Read(reader, &FileObject) &&
+        field::Read(reader, &CreateOptions) &&
+        field::Read(reader, &FileAttributes) &&
+        field::Read(reader, &ShareAccess) &&
+        field::Read(reader, &OpenPath);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct DirEnum;
+
+// Layout of the DirEnum, DirNotify events, version 2.
+template <bool kIs64Bit>
+struct DirEnum<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type IrpPtr;
+  typename field::Pointer<kIs64Bit>::Type TTID;
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  typename field::Pointer<kIs64Bit>::Type FileKey;
+  ULONG Length;
+  ULONG InfoClass;
+  ULONG FileIndex;
+  std::wstring FileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &IrpPtr) &&
+        field::Read(reader, &TTID) &&
+        field::Read(reader, &FileObject) &&
+        field::Read(reader, &FileKey) &&
+        field::Read(reader, &Length) &&
+        field::Read(reader, &InfoClass) &&
+        field::Read(reader, &FileIndex) &&
+        field::Read(reader, &FileName);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct Info;
+
+// Layout of the Delete, FSControl, QueryInfo, Rename, SetInfo events, version
+// 2.
+template <bool kIs64Bit>
+struct Info<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type IrpPtr;
+  typename field::Pointer<kIs64Bit>::Type TTID;
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  typename field::Pointer<kIs64Bit>::Type FileKey;
+  typename field::Pointer<kIs64Bit>::Type ExtraInfo;
+  ULONG InfoClass;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &IrpPtr) &&
+        field::Read(reader, &TTID) &&
+        field::Read(reader, &FileObject) &&
+        field::Read(reader, &FileKey) &&
+        field::Read(reader, &ExtraInfo) &&
+        field::Read(reader, &InfoClass);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct Name;
+
+// Layout of the Name events, version 0.
+template <bool kIs64Bit>
+struct Name<0, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  std::wstring FileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &FileObject) &&
+        field::Read(reader, &FileName);
+  }
+};
+
+// Layout of the FileCreate, Name events, version 1.
+template <bool kIs64Bit>
+struct Name<1, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  std::wstring FileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &FileObject) &&
+        field::Read(reader, &FileName);
+  }
+};
+
+// Layout of the FileCreate, FileDelete, FileRundown, Name events, version 2.
+template <bool kIs64Bit>
+struct Name<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  std::wstring FileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &FileObject) &&
+        field::Read(reader, &FileName);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct OpEnd;
+
+// Layout of the OperationEnd events, version 2.
+template <bool kIs64Bit>
+struct OpEnd<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type IrpPtr;
+  typename field::Pointer<kIs64Bit>::Type ExtraInfo;
+  ULONG NtStatus;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &IrpPtr) &&
+        field::Read(reader, &ExtraInfo) &&
+        field::Read(reader, &NtStatus);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct ReadWrite;
+
+// Layout of the Read, Write events, version 2.
+template <bool kIs64Bit>
+struct ReadWrite<2, kIs64Bit> {
+  ULONGLONG Offset;
+  typename field::Pointer<kIs64Bit>::Type IrpPtr;
+  typename field::Pointer<kIs64Bit>::Type TTID;
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  typename field::Pointer<kIs64Bit>::Type FileKey;
+  ULONG IoSize;
+  ULONG IoFlags;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &Offset) &&
+        field::Read(reader, &IrpPtr) &&
+        field::Read(reader, &TTID) &&
+        field::Read(reader, &FileObject) &&
+        field::Read(reader, &FileKey) &&
+        field::Read(reader, &IoSize) &&
+        field::Read(reader, &IoFlags);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct SimpleOp;
+
+// Layout of the Cleanup, Close, Flush events, version 2.
+template <bool kIs64Bit>
+struct SimpleOp<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type IrpPtr;
+  typename field::Pointer<kIs64Bit>::Type TTID;
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  typename field::Pointer<kIs64Bit>::Type FileKey;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &IrpPtr) &&
+        field::Read(reader, &TTID) &&
+        field::Read(reader, &FileObject) &&
+        field::Read(reader, &FileKey);
+  }
+};
+
+}  // namespace fileio
+}  // namespace descriptors
+
+#endif  // SAWBUCK_LOG_LIB_DESCRIPTORS_FILEIO_H_
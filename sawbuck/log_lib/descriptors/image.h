@@ -0,0 +1,127 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Generated event decoders for MOF GUID {2cb15d1d-5fc1-11d2-abe1-00a0c911f518}.
+//
+// DO NOT EDIT. This file was generated by
+// sawbuck/py/etw/generate_cpp_descriptor.py from:
+//   etw.descriptors.image
+#ifndef SAWBUCK_LOG_LIB_DESCRIPTORS_IMAGE_H_
+#define SAWBUCK_LOG_LIB_DESCRIPTORS_IMAGE_H_
+
+#include "sawbuck/log_lib/descriptors/field.h"
+
+namespace descriptors {
+namespace image {
+
+// {2cb15d1d-5fc1-11d2-abe1-00a0c911f518}
+const GUID kGuid = { 0x2cb15d1d, 0x5fc1, 0x11d2,
+    { 0xab, 0xe1, 0x00, 0xa0, 0xc9, 0x11, 0xf5, 0x18 } };
+
+enum EventType {
+  kUnLoad = 2,
+  kDCStart = 3,
+  kDCEnd = 4,
+  kLoad = 10,
+  kKernelBase = 33,
+};
+
+template <int kVersion, bool kIs64Bit> struct KernelImageBase;
+
+// Layout of the KernelBase events, version 2.
+template <bool kIs64Bit>
+struct KernelImageBase<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type ImageBase;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ImageBase);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct Load;
+
+// Layout of the Load events, version 0.
+template <bool kIs64Bit>
+struct Load<0, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type BaseAddress;
+  ULONG ModuleSize;
+  std::wstring ImageFileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &BaseAddress) &&
+        field::Read(reader, &ModuleSize) &&
+        field::Read(reader, &ImageFileName);
+  }
+};
+
+// Layout of the Load events, version 1.
+template <bool kIs64Bit>
+struct Load<1, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type ImageBase;
+  typename field::Pointer<kIs64Bit>::Type ImageSize;
+  ULONG ProcessId;
+  std::wstring FileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ImageBase) &&
+        field::Read(reader, &ImageSize) &&
+        field::Read(reader, &ProcessId) &&
+        field::Read(reader, &FileName);
+  }
+};
+
+// Layout of the DCEnd, DCStart, Load, UnLoad events, version 2.
+template <bool kIs64Bit>
+struct Load<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type ImageBase;
+  typename field::Pointer<kIs64Bit>::Type ImageSize;
+  ULONG ProcessId;
+  ULONG ImageChecksum;
+  ULONG TimeDateStamp;
+  ULONG Reserved0;
+  typename field::Pointer<kIs64Bit>::Type DefaultBase;
+  ULONG Reserved1;
+  ULONG Reserved2;
+  ULONG Reserved3;
+  ULONG Reserved4;
+  std::wstring FileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ImageBase) &&
+        field::Read(reader, &ImageSize) &&
+        field::Read(reader, &ProcessId) &&
+        field::Read(reader, &ImageChecksum) &&
+        field::Read(reader, &TimeDateStamp) &&
+        field::Read(reader, &Reserved0) &&
+        field::Read(reader, &DefaultBase) &&
+        field::Read(reader, &Reserved1) &&
+        field::Read(reader, &Reserved2) &&
+        field::Read(reader, &Reserved3) &&
+        field::Read(reader, &Reserved4) &&
+        field::Read(reader, &FileName);
+  }
+};
+
+}  // namespace image
+}  // namespace descriptors
+
+#endif  // SAWBUCK_LOG_LIB_DESCRIPTORS_IMAGE_H_
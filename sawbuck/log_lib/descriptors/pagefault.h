@@ -0,0 +1,262 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Generated event decoders for MOF GUID {3d6fa8d3-fe05-11d0-9dda-00c04fd7ba7c}.
+//
+// DO NOT EDIT. This file was generated by
+// sawbuck/py/etw/generate_cpp_descriptor.py from:
+//   etw.descriptors.pagefault
+//   etw.descriptors.pagefault_xp
+#ifndef SAWBUCK_LOG_LIB_DESCRIPTORS_PAGEFAULT_H_
+#define SAWBUCK_LOG_LIB_DESCRIPTORS_PAGEFAULT_H_
+
+#include "sawbuck/log_lib/descriptors/field.h"
+
+namespace descriptors {
+namespace pagefault {
+
+// {3d6fa8d3-fe05-11d0-9dda-00c04fd7ba7c}
+const GUID kGuid = { 0x3d6fa8d3, 0xfe05, 0x11d0,
+    { 0x9d, 0xda, 0x00, 0xc0, 0x4f, 0xd7, 0xba, 0x7c } };
+
+enum EventType {
+  kTransitionFault = 10,
+  kDemandZeroFault = 11,
+  kCopyOnWrite = 12,
+  kGuardPageFault = 13,
+  kHardPageFault = 14,
+  kAccessViolation = 15,
+  kHardFault = 32,
+  kVirtualAlloc = 98,
+  kVirtualFree = 99,
+  kHRRundown = 100,
+  kHRCreate = 101,
+  kHRReserve = 102,
+  kHRRelease = 103,
+  kHRDestroy = 104,
+  kImageLoadBacked = 105,
+};
+
+template <int kVersion, bool kIs64Bit> struct HardFault;
+
+// Layout of the HardFault events, version 1.
+template <bool kIs64Bit>
+struct HardFault<1, kIs64Bit> {
+  ULONGLONG InitialTime;
+  ULONGLONG ReadOffset;
+  typename field::Pointer<kIs64Bit>::Type VirtualAddress;
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  ULONG TThreadId;
+  ULONG ByteCount;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &InitialTime) &&
+        field::Read(reader, &ReadOffset) &&
+        field::Read(reader, &VirtualAddress) &&
+        field::Read(reader, &FileObject) &&
+        field::Read(reader, &TThreadId) &&
+        field::Read(reader, &ByteCount);
+  }
+};
+
+// Layout of the HardFault events, version 2.
+template <bool kIs64Bit>
+struct HardFault<2, kIs64Bit> {
+  ULONGLONG InitialTime;
+  ULONGLONG ReadOffset;
+  typename field::Pointer<kIs64Bit>::Type VirtualAddress;
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  ULONG TThreadId;
+  ULONG ByteCount;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &InitialTime) &&
+        field::Read(reader, &ReadOffset) &&
+        field::Read(reader, &VirtualAddress) &&
+        field::Read(reader, &FileObject) &&
+        field::Read(reader, &TThreadId) &&
+        field::Read(reader, &ByteCount);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct HeapRangeCreate;
+
+// Layout of the HRCreate events, version 2.
+template <bool kIs64Bit>
+struct HeapRangeCreate<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type HeapHandle;
+  LONG FirstRangeSize;
+  ULONG HRCreateFlags;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &HeapHandle) &&
+        field::Read(reader, &FirstRangeSize) &&
+        field::Read(reader, &HRCreateFlags);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct HeapRangeDestroy;
+
+// Layout of the HRDestroy events, version 2.
+template <bool kIs64Bit>
+struct HeapRangeDestroy<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type HeapHandle;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &HeapHandle);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct HeapRangeRundown;
+
+// Layout of the HRRundown events, version 2.
+template <bool kIs64Bit>
+struct HeapRangeRundown<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type HeapHandle;
+  ULONG HRFlags;
+  ULONG HRPid;
+  ULONG HRRangeCount;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &HeapHandle) &&
+        field::Read(reader, &HRFlags) &&
+        field::Read(reader, &HRPid) &&
+        field::Read(reader, &HRRangeCount);
+  }
+};
+
+// Layout of the HRRundown events, version 3.
+template <bool kIs64Bit>
+struct HeapRangeRundown<3, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type HeapHandle;
+  ULONG HRFlags;
+  ULONG HRPid;
+  ULONG HRRangeCount;
+  ULONG Reserved;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &HeapHandle) &&
+        field::Read(reader, &HRFlags) &&
+        field::Read(reader, &HRPid) &&
+        field::Read(reader, &HRRangeCount) &&
+        field::Read(reader, &Reserved);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct HeapRangeTypeGroup;
+
+// Layout of the HRRelease, HRReserve events, version 2.
+template <bool kIs64Bit>
+struct HeapRangeTypeGroup<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type HeapHandle;
+  typename field::Pointer<kIs64Bit>::Type HRAddress;
+  LONG HRSize;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &HeapHandle) &&
+        field::Read(reader, &HRAddress) &&
+        field::Read(reader, &HRSize);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct ImageLoadBacked;
+
+// Layout of the ImageLoadBacked events, version 2.
+template <bool kIs64Bit>
+struct ImageLoadBacked<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type FileObject;
+  ULONG DeviceChar;
+  USHORT FileChar;
+  USHORT LoadFlags;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &FileObject) &&
+        field::Read(reader, &DeviceChar) &&
+        field::Read(reader, &FileChar) &&
+        field::Read(reader, &LoadFlags);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct TypeGroup1;
+
+// Layout of the AccessViolation, CopyOnWrite, DemandZeroFault, GuardPageFault,
+// HardPageFault, TransitionFault events, version 1.
+template <bool kIs64Bit>
+struct TypeGroup1<1, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type VirtualAddress;
+  typename field::Pointer<kIs64Bit>::Type ProgramCounter;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &VirtualAddress) &&
+        field::Read(reader, &ProgramCounter);
+  }
+};
+
+// Layout of the AccessViolation, CopyOnWrite, DemandZeroFault, GuardPageFault,
+// HardPageFault, TransitionFault events, version 2.
+template <bool kIs64Bit>
+struct TypeGroup1<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type VirtualAddress;
+  typename field::Pointer<kIs64Bit>::Type ProgramCounter;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &VirtualAddress) &&
+        field::Read(reader, &ProgramCounter);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct VirtualAlloc;
+
+// Layout of the VirtualAlloc, VirtualFree events, version 2.
+template <bool kIs64Bit>
+struct VirtualAlloc<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type BaseAddress;
+  LONG RegionSize;
+  ULONG ProcessId;
+  ULONG Flags;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &BaseAddress) &&
+        field::Read(reader, &RegionSize) &&
+        field::Read(reader, &ProcessId) &&
+        field::Read(reader, &Flags);
+  }
+};
+
+}  // namespace pagefault
+}  // namespace descriptors
+
+#endif  // SAWBUCK_LOG_LIB_DESCRIPTORS_PAGEFAULT_H_
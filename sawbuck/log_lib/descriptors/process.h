@@ -0,0 +1,202 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Generated event decoders for MOF GUID {3d6fa8d0-fe05-11d0-9dda-00c04fd7ba7c}.
+//
+// DO NOT EDIT. This file was generated by
+// sawbuck/py/etw/generate_cpp_descriptor.py from:
+//   etw.descriptors.process
+#ifndef SAWBUCK_LOG_LIB_DESCRIPTORS_PROCESS_H_
+#define SAWBUCK_LOG_LIB_DESCRIPTORS_PROCESS_H_
+
+#include "sawbuck/log_lib/descriptors/field.h"
+
+namespace descriptors {
+namespace process {
+
+// {3d6fa8d0-fe05-11d0-9dda-00c04fd7ba7c}
+const GUID kGuid = { 0x3d6fa8d0, 0xfe05, 0x11d0,
+    { 0x9d, 0xda, 0x00, 0xc0, 0x4f, 0xd7, 0xba, 0x7c } };
+
+enum EventType {
+  kStart = 1,
+  kEnd = 2,
+  kDCStart = 3,
+  kDCEnd = 4,
+  kPerfCtr = 32,
+  kPerfCtrRundown = 33,
+  kInSwap = 35,
+  kDefunct = 39,
+};
+
+template <int kVersion, bool kIs64Bit> struct TypeGroup1;
+
+// Layout of the DCEnd, DCStart, End, Start events, version 0.
+template <bool kIs64Bit>
+struct TypeGroup1<0, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type ProcessId;
+  typename field::Pointer<kIs64Bit>::Type ParentId;
+  field::Sid UserSID;
+  std::string ImageFileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ProcessId) &&
+        field::Read(reader, &ParentId) &&
+        field::ReadSid<kIs64Bit>(reader, &UserSID) &&
+        field::Read(reader, &ImageFileName);
+  }
+};
+
+// Layout of the DCEnd, DCStart, End, Start events, version 1.
+template <bool kIs64Bit>
+struct TypeGroup1<1, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type PageDirectoryBase;
+  ULONG ProcessId;
+  ULONG ParentId;
+  ULONG SessionId;
+  LONG ExitStatus;
+  field::Sid UserSID;
+  std::string ImageFileName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &PageDirectoryBase) &&
+        field::Read(reader, &ProcessId) &&
+        field::Read(reader, &ParentId) &&
+        field::Read(reader, &SessionId) &&
+        field::Read(reader, &ExitStatus) &&
+        field::ReadSid<kIs64Bit>(reader, &UserSID) &&
+        field::Read(reader, &ImageFileName);
+  }
+};
+
+// Layout of the DCEnd, DCStart, Defunct, End, Start events, version 2.
+template <bool kIs64Bit>
+struct TypeGroup1<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type UniqueProcessKey;
+  ULONG ProcessId;
+  ULONG ParentId;
+  ULONG SessionId;
+  LONG ExitStatus;
+  field::Sid UserSID;
+  std::string ImageFileName;
+  std::wstring CommandLine;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &UniqueProcessKey) &&
+        field::Read(reader, &ProcessId) &&
+        field::Read(reader, &ParentId) &&
+        field::Read(reader, &SessionId) &&
+        field::Read(reader, &ExitStatus) &&
+        field::ReadSid<kIs64Bit>(reader, &UserSID) &&
+        field::Read(reader, &ImageFileName) &&
+        field::Read(reader, &CommandLine);
+  }
+};
+
+// Layout of the DCEnd, DCStart, Defunct, End, Start events, version 3.
+template <bool kIs64Bit>
+struct TypeGroup1<3, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type UniqueProcessKey;
+  ULONG ProcessId;
+  ULONG ParentId;
+  ULONG SessionId;
+  LONG ExitStatus;
+  typename field::Pointer<kIs64Bit>::Type DirectoryTableBase;
+  field::Sid UserSID;
+  std::string ImageFileName;
+  std::wstring CommandLine;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &UniqueProcessKey) &&
+        field::Read(reader, &ProcessId) &&
+        field::Read(reader, &ParentId) &&
+        field::Read(reader, &SessionId) &&
+        field::Read(reader, &ExitStatus) &&
+        field::Read(reader, &DirectoryTableBase) &&
+        field::ReadSid<kIs64Bit>(reader, &UserSID) &&
+        field::Read(reader, &ImageFileName) &&
+        field::Read(reader, &CommandLine);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct TypeGroup2;
+
+// Layout of the PerfCtr, PerfCtrRundown events, version 2.
+template <bool kIs64Bit>
+struct TypeGroup2<2, kIs64Bit> {
+  ULONG ProcessId;
+  ULONG PageFaultCount;
+  ULONG HandleCount;
+  ULONG Reserved;
+  LONG PeakVirtualSize;
+  LONG PeakWorkingSetSize;
+  LONG PeakPagefileUsage;
+  LONG QuotaPeakPagedPoolUsage;
+  LONG QuotaPeakNonPagedPoolUsage;
+  LONG VirtualSize;
+  LONG WorkingSetSize;
+  LONG PagefileUsage;
+  LONG QuotaPagedPoolUsage;
+  LONG QuotaNonPagedPoolUsage;
+  LONG PrivatePageCount;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ProcessId) &&
+        field::Read(reader, &PageFaultCount) &&
+        field::Read(reader, &HandleCount) &&
+        field::Read(reader, &Reserved) &&
+        field::Read(reader, &PeakVirtualSize) &&
+        field::Read(reader, &PeakWorkingSetSize) &&
+        field::Read(reader, &PeakPagefileUsage) &&
+        field::Read(reader, &QuotaPeakPagedPoolUsage) &&
+        field::Read(reader, &QuotaPeakNonPagedPoolUsage) &&
+        field::Read(reader, &VirtualSize) &&
+        field::Read(reader, &WorkingSetSize) &&
+        field::Read(reader, &PagefileUsage) &&
+        field::Read(reader, &QuotaPagedPoolUsage) &&
+        field::Read(reader, &QuotaNonPagedPoolUsage) &&
+        field::Read(reader, &PrivatePageCount);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct TypeGroup3;
+
+// Layout of the InSwap events, version 2.
+template <bool kIs64Bit>
+struct TypeGroup3<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type DirectoryTableBase;
+  ULONG ProcessId;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &DirectoryTableBase) &&
+        field::Read(reader, &ProcessId);
+  }
+};
+
+}  // namespace process
+}  // namespace descriptors
+
+#endif  // SAWBUCK_LOG_LIB_DESCRIPTORS_PROCESS_H_
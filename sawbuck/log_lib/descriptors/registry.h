@@ -0,0 +1,201 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Generated event decoders for MOF GUID {ae53722e-c863-11d2-8659-00c04fa321a1}.
+//
+// DO NOT EDIT. This file was generated by
+// sawbuck/py/etw/generate_cpp_descriptor.py from:
+//   etw.descriptors.registry
+#ifndef SAWBUCK_LOG_LIB_DESCRIPTORS_REGISTRY_H_
+#define SAWBUCK_LOG_LIB_DESCRIPTORS_REGISTRY_H_
+
+#include "sawbuck/log_lib/descriptors/field.h"
+
+namespace descriptors {
+namespace registry {
+
+// {ae53722e-c863-11d2-8659-00c04fa321a1}
+const GUID kGuid = { 0xae53722e, 0xc863, 0x11d2,
+    { 0x86, 0x59, 0x00, 0xc0, 0x4f, 0xa3, 0x21, 0xa1 } };
+
+enum EventType {
+  kCreate = 10,
+  kOpen = 11,
+  kDelete = 12,
+  kQuery = 13,
+  kSetValue = 14,
+  kDeleteValue = 15,
+  kQueryValue = 16,
+  kEnumerateKey = 17,
+  kEnumerateValueKey = 18,
+  kQueryMultipleValue = 19,
+  kSetInformation = 20,
+  kFlush = 21,
+  kKCBCreate = 22,
+  kRunDown = 22,
+  kKCBDelete = 23,
+  kKCBRundownBegin = 24,
+  kKCBRundownEnd = 25,
+  kVirtualize = 26,
+  kClose = 27,
+  kSetSecurity = 28,
+  kQuerySecurity = 29,
+  kTxRCommit = 30,
+  kTxRPrepare = 31,
+  kTxRRollback = 32,
+  kCounters = 34,
+  kConfig = 35,
+};
+
+template <int kVersion, bool kIs64Bit> struct Config;
+
+// Layout of the Config events, version 2.
+template <bool kIs64Bit>
+struct Config<2, kIs64Bit> {
+  ULONG CurrentControlSet;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &CurrentControlSet);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct Counters;
+
+// Layout of the Counters events, version 2.
+template <bool kIs64Bit>
+struct Counters<2, kIs64Bit> {
+  ULONGLONG Counter1;
+  ULONGLONG Counter2;
+  ULONGLONG Counter3;
+  ULONGLONG Counter4;
+  ULONGLONG Counter5;
+  ULONGLONG Counter6;
+  ULONGLONG Counter7;
+  ULONGLONG Counter8;
+  ULONGLONG Counter9;
+  ULONGLONG Counter10;
+  ULONGLONG Counter11;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &Counter1) &&
+        field::Read(reader, &Counter2) &&
+        field::Read(reader, &Counter3) &&
+        field::Read(reader, &Counter4) &&
+        field::Read(reader, &Counter5) &&
+        field::Read(reader, &Counter6) &&
+        field::Read(reader, &Counter7) &&
+        field::Read(reader, &Counter8) &&
+        field::Read(reader, &Counter9) &&
+        field::Read(reader, &Counter10) &&
+        field::Read(reader, &Counter11);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct TxR;
+
+// Layout of the TxRCommit, TxRPrepare, TxRRollback events, version 2.
+template <bool kIs64Bit>
+struct TxR<2, kIs64Bit> {
+  UCHAR TxrGUID;
+  ULONG Status;
+  ULONG UowCount;
+  ULONGLONG OperationTime;
+  std::wstring Hive;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &TxrGUID) &&
+        field::Read(reader, &Status) &&
+        field::Read(reader, &UowCount) &&
+        field::Read(reader, &OperationTime) &&
+        field::Read(reader, &Hive);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct TypeGroup1;
+
+// Layout of the Create, Delete, DeleteValue, EnumerateKey, EnumerateValueKey,
+// Flush, Open, Query, QueryMultipleValue, QueryValue, SetInformation, SetValue
+// events, version 0.
+template <bool kIs64Bit>
+struct TypeGroup1<0, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type Status;
+  typename field::Pointer<kIs64Bit>::Type KeyHandle;
+  LONGLONG ElapsedTime;
+  std::wstring KeyName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &Status) &&
+        field::Read(reader, &KeyHandle) &&
+        field::Read(reader, &ElapsedTime) &&
+        field::Read(reader, &KeyName);
+  }
+};
+
+// Layout of the Create, Delete, DeleteValue, EnumerateKey, EnumerateValueKey,
+// Flush, KCBCreate, Open, Query, QueryMultipleValue, QueryValue,
+// SetInformation, SetValue events, version 1.
+template <bool kIs64Bit>
+struct TypeGroup1<1, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type Status;
+  typename field::Pointer<kIs64Bit>::Type KeyHandle;
+  LONGLONG ElapsedTime;
+  ULONG Index;
+  std::wstring KeyName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &Status) &&
+        field::Read(reader, &KeyHandle) &&
+        field::Read(reader, &ElapsedTime) &&
+        field::Read(reader, &Index) &&
+        field::Read(reader, &KeyName);
+  }
+};
+
+// Layout of the Close, Create, Delete, DeleteValue, EnumerateKey,
+// EnumerateValueKey, Flush, KCBCreate, KCBDelete, KCBRundownBegin,
+// KCBRundownEnd, Open, Query, QueryMultipleValue, QuerySecurity, QueryValue,
+// SetInformation, SetSecurity, SetValue, Virtualize events, version 2.
+template <bool kIs64Bit>
+struct TypeGroup1<2, kIs64Bit> {
+  LONGLONG InitialTime;
+  ULONG Status;
+  ULONG Index;
+  typename field::Pointer<kIs64Bit>::Type KeyHandle;
+  std::wstring KeyName;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &InitialTime) &&
+        field::Read(reader, &Status) &&
+        field::Read(reader, &Index) &&
+        field::Read(reader, &KeyHandle) &&
+        field::Read(reader, &KeyName);
+  }
+};
+
+}  // namespace registry
+}  // namespace descriptors
+
+#endif  // SAWBUCK_LOG_LIB_DESCRIPTORS_REGISTRY_H_
@@ -0,0 +1,356 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Generated event decoders for MOF GUID {3d6fa8d1-fe05-11d0-9dda-00c04fd7ba7c}.
+//
+// DO NOT EDIT. This file was generated by
+// sawbuck/py/etw/generate_cpp_descriptor.py from:
+//   etw.descriptors.thread
+#ifndef SAWBUCK_LOG_LIB_DESCRIPTORS_THREAD_H_
+#define SAWBUCK_LOG_LIB_DESCRIPTORS_THREAD_H_
+
+#include "sawbuck/log_lib/descriptors/field.h"
+
+namespace descriptors {
+namespace thread {
+
+// {3d6fa8d1-fe05-11d0-9dda-00c04fd7ba7c}
+const GUID kGuid = { 0x3d6fa8d1, 0xfe05, 0x11d0,
+    { 0x9d, 0xda, 0x00, 0xc0, 0x4f, 0xd7, 0xba, 0x7c } };
+
+enum EventType {
+  kStart = 1,
+  kEnd = 2,
+  kDCStart = 3,
+  kDCEnd = 4,
+  kCSwitch = 36,
+  kCompCS = 37,
+  kSetPriority = 48,
+  kSetBasePriority = 49,
+  kReadyThread = 50,
+  kSetPagePriority = 51,
+  kSetIoPriority = 52,
+  kThreadAffinity = 53,
+  kWorkerThread = 57,
+};
+
+template <int kVersion, bool kIs64Bit> struct CSwitch;
+
+// Layout of the CSwitch events, version 1.
+template <bool kIs64Bit>
+struct CSwitch<1, kIs64Bit> {
+  ULONG NewThreadId;
+  ULONG OldThreadId;
+  CHAR NewThreadPriority;
+  CHAR OldThreadPriority;
+  CHAR NewThreadQuantum;
+  CHAR OldThreadQuantum;
+  CHAR OldThreadWaitReason;
+  CHAR OldThreadWaitMode;
+  CHAR OldThreadState;
+  CHAR OldThreadWaitIdealProcessor;
+  ULONG NewThreadWaitTime;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &NewThreadId) &&
+        field::Read(reader, &OldThreadId) &&
+        field::Read(reader, &NewThreadPriority) &&
+        field::Read(reader, &OldThreadPriority) &&
+        field::Read(reader, &NewThreadQuantum) &&
+        field::Read(reader, &OldThreadQuantum) &&
+        field::Read(reader, &OldThreadWaitReason) &&
+        field::Read(reader, &OldThreadWaitMode) &&
+        field::Read(reader, &OldThreadState) &&
+        field::Read(reader, &OldThreadWaitIdealProcessor) &&
+        field::Read(reader, &NewThreadWaitTime);
+  }
+};
+
+// Layout of the CSwitch events, version 2.
+template <bool kIs64Bit>
+struct CSwitch<2, kIs64Bit> {
+  ULONG NewThreadId;
+  ULONG OldThreadId;
+  CHAR NewThreadPriority;
+  CHAR OldThreadPriority;
+  UCHAR PreviousCState;
+  CHAR SpareByte;
+  CHAR OldThreadWaitReason;
+  CHAR OldThreadWaitMode;
+  CHAR OldThreadState;
+  CHAR OldThreadWaitIdealProcessor;
+  ULONG NewThreadWaitTime;
+  ULONG Reserved;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &NewThreadId) &&
+        field::Read(reader, &OldThreadId) &&
+        field::Read(reader, &NewThreadPriority) &&
+        field::Read(reader, &OldThreadPriority) &&
+        field::Read(reader, &PreviousCState) &&
+        field::Read(reader, &SpareByte) &&
+        field::Read(reader, &OldThreadWaitReason) &&
+        field::Read(reader, &OldThreadWaitMode) &&
+        field::Read(reader, &OldThreadState) &&
+        field::Read(reader, &OldThreadWaitIdealProcessor) &&
+        field::Read(reader, &NewThreadWaitTime) &&
+        field::Read(reader, &Reserved);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct CompCS;
+
+// Layout of the CompCS events, version 2.
+template <bool kIs64Bit>
+struct CompCS<2, kIs64Bit> {
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return true;
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct ReadyThread;
+
+// Layout of the ReadyThread events, version 2.
+template <bool kIs64Bit>
+struct ReadyThread<2, kIs64Bit> {
+  ULONG TThreadId;
+  CHAR AdjustReason;
+  CHAR AdjustIncrement;
+  CHAR Flag;
+  CHAR Reserved;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &TThreadId) &&
+        field::Read(reader, &AdjustReason) &&
+        field::Read(reader, &AdjustIncrement) &&
+        field::Read(reader, &Flag) &&
+        field::Read(reader, &Reserved);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct ThreadAffinity;
+
+// Layout of the ThreadAffinity events, version 2.
+template <bool kIs64Bit>
+struct ThreadAffinity<2, kIs64Bit> {
+  typename field::Pointer<kIs64Bit>::Type Affinity;
+  ULONG ThreadId;
+  USHORT Group;
+  USHORT Reserved;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &Affinity) &&
+        field::Read(reader, &ThreadId) &&
+        field::Read(reader, &Group) &&
+        field::Read(reader, &Reserved);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct ThreadPriority;
+
+// Layout of the SetBasePriority, SetIoPriority, SetPagePriority, SetPriority
+// events, version 3.
+template <bool kIs64Bit>
+struct ThreadPriority<3, kIs64Bit> {
+  ULONG ThreadId;
+  UCHAR OldPriority;
+  UCHAR NewPriority;
+  USHORT Reserved;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ThreadId) &&
+        field::Read(reader, &OldPriority) &&
+        field::Read(reader, &NewPriority) &&
+        field::Read(reader, &Reserved);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct TypeGroup1;
+
+// Layout of the DCEnd, DCStart, End, Start events, version 0.
+template <bool kIs64Bit>
+struct TypeGroup1<0, kIs64Bit> {
+  ULONG TThreadId;
+  ULONG ProcessId;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &TThreadId) &&
+        field::Read(reader, &ProcessId);
+  }
+};
+
+// Layout of the DCStart, Start events, version 1.
+template <bool kIs64Bit>
+struct TypeGroup1<1, kIs64Bit> {
+  ULONG ProcessId;
+  ULONG TThreadId;
+  typename field::Pointer<kIs64Bit>::Type StackBase;
+  typename field::Pointer<kIs64Bit>::Type StackLimit;
+  typename field::Pointer<kIs64Bit>::Type UserStackBase;
+  typename field::Pointer<kIs64Bit>::Type UserStackLimit;
+  typename field::Pointer<kIs64Bit>::Type StartAddr;
+  typename field::Pointer<kIs64Bit>::Type Win32StartAddr;
+  CHAR WaitMode;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ProcessId) &&
+        field::Read(reader, &TThreadId) &&
+        field::Read(reader, &StackBase) &&
+        field::Read(reader, &StackLimit) &&
+        field::Read(reader, &UserStackBase) &&
+        field::Read(reader, &UserStackLimit) &&
+        field::Read(reader, &StartAddr) &&
+        field::Read(reader, &Win32StartAddr) &&
+        field::Read(reader, &WaitMode);
+  }
+};
+
+// Layout of the DCEnd, DCStart, End, Start events, version 2.
+template <bool kIs64Bit>
+struct TypeGroup1<2, kIs64Bit> {
+  ULONG ProcessId;
+  ULONG TThreadId;
+  typename field::Pointer<kIs64Bit>::Type StackBase;
+  typename field::Pointer<kIs64Bit>::Type StackLimit;
+  typename field::Pointer<kIs64Bit>::Type UserStackBase;
+  typename field::Pointer<kIs64Bit>::Type UserStackLimit;
+  typename field::Pointer<kIs64Bit>::Type StartAddr;
+  typename field::Pointer<kIs64Bit>::Type Win32StartAddr;
+  typename field::Pointer<kIs64Bit>::Type TebBase;
+  ULONG SubProcessTag;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ProcessId) &&
+        field::Read(reader, &TThreadId) &&
+        field::Read(reader, &StackBase) &&
+        field::Read(reader, &StackLimit) &&
+        field::Read(reader, &UserStackBase) &&
+        field::Read(reader, &UserStackLimit) &&
+        field::Read(reader, &StartAddr) &&
+        field::Read(reader, &Win32StartAddr) &&
+        field::Read(reader, &TebBase) &&
+        field::Read(reader, &SubProcessTag);
+  }
+};
+
+// Layout of the DCEnd, DCStart, End, Start events, version 3.
+template <bool kIs64Bit>
+struct TypeGroup1<3, kIs64Bit> {
+  ULONG ProcessId;
+  ULONG TThreadId;
+  typename field::Pointer<kIs64Bit>::Type StackBase;
+  typename field::Pointer<kIs64Bit>::Type StackLimit;
+  typename field::Pointer<kIs64Bit>::Type UserStackBase;
+  typename field::Pointer<kIs64Bit>::Type UserStackLimit;
+  typename field::Pointer<kIs64Bit>::Type Affinity;
+  typename field::Pointer<kIs64Bit>::Type Win32StartAddr;
+  typename field::Pointer<kIs64Bit>::Type TebBase;
+  ULONG SubProcessTag;
+  UCHAR BasePriority;
+  UCHAR PagePriority;
+  UCHAR IoPriority;
+  UCHAR ThreadFlags;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ProcessId) &&
+        field::Read(reader, &TThreadId) &&
+        field::Read(reader, &StackBase) &&
+        field::Read(reader, &StackLimit) &&
+        field::Read(reader, &UserStackBase) &&
+        field::Read(reader, &UserStackLimit) &&
+        field::Read(reader, &Affinity) &&
+        field::Read(reader, &Win32StartAddr) &&
+        field::Read(reader, &TebBase) &&
+        field::Read(reader, &SubProcessTag) &&
+        field::Read(reader, &BasePriority) &&
+        field::Read(reader, &PagePriority) &&
+        field::Read(reader, &IoPriority) &&
+        field::Read(reader, &ThreadFlags);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct TypeGroup2;
+
+// Layout of the DCEnd, End events, version 1.
+template <bool kIs64Bit>
+struct TypeGroup2<1, kIs64Bit> {
+  ULONG ProcessId;
+  ULONG TThreadId;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &ProcessId) &&
+        field::Read(reader, &TThreadId);
+  }
+};
+
+template <int kVersion, bool kIs64Bit> struct WorkerThread;
+
+// Layout of the WorkerThread events, version 1.
+template <bool kIs64Bit>
+struct WorkerThread<1, kIs64Bit> {
+  ULONG TThreadId;
+  ULONGLONG StartTime;
+  typename field::Pointer<kIs64Bit>::Type ThreadRoutine;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &TThreadId) &&
+        field::Read(reader, &StartTime) &&
+        field::Read(reader, &ThreadRoutine);
+  }
+};
+
+// Layout of the WorkerThread events, version 2.
+template <bool kIs64Bit>
+struct WorkerThread<2, kIs64Bit> {
+  ULONG TThreadId;
+  ULONGLONG StartTime;
+  typename field::Pointer<kIs64Bit>::Type ThreadRoutine;
+
+  // Parses the event from @p reader.
+  // @returns true on success, false if the event data is malformed.
+  bool Parse(BinaryBufferReader* reader) {
+    return field::Read(reader, &TThreadId) &&
+        field::Read(reader, &StartTime) &&
+        field::Read(reader, &ThreadRoutine);
+  }
+};
+
+}  // namespace thread
+}  // namespace descriptors
+
+#endif  // SAWBUCK_LOG_LIB_DESCRIPTORS_THREAD_H_
@@ -16,12 +16,18 @@
 #include "base/at_exit.h"
 #include "base/command_line.h"
 #include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/win/event_trace_consumer.h"
 #include "sawbuck/log_lib/kernel_log_consumer.h"
 #include "sawbuck/log_lib/log_consumer.h"
+#include "sawbuck/log_lib/log_query.h"
+#include "sawbuck/log_lib/log_statistics.h"
+#include "sawbuck/log_lib/template_miner.h"
 
 
 // The log consumer class we use to parse the logs on our behalf.
@@ -34,6 +40,11 @@ class DumpLogConsumer
   DumpLogConsumer();
   ~DumpLogConsumer();
 
+  // Consumes the events logged from @p start_time through @p end_time.
+  HRESULT Consume(const base::Time& start_time, const base::Time& end_time) {
+    return ConsumeTimeWindow(trace_handles_, start_time, end_time);
+  }
+
   static void ProcessEvent(EVENT_TRACE* event);
 
  private:
@@ -73,6 +84,9 @@ class LogDumpHandler
     : public KernelModuleEvents,
       public KernelPageFaultEvents,
       public KernelProcessEvents,
+      public KernelThreadEvents,
+      public KernelFileIoEvents,
+      public KernelRegistryEvents,
       public LogEvents {
  protected:
   // KernelModuleEvents implementation.
@@ -134,6 +148,44 @@ class LogDumpHandler
                               const ProcessInfo& process_info,
                               ULONG exit_status);
 
+  // KernelThreadEvents implementation.
+  virtual void OnThreadIsRunning(const base::Time& time,
+                                 const ThreadInfo& thread_info);
+  virtual void OnThreadStarted(const base::Time& time,
+                               const ThreadInfo& thread_info);
+  virtual void OnThreadEnded(const base::Time& time,
+                             const ThreadInfo& thread_info);
+  virtual void OnContextSwitch(const base::Time& time,
+                               UCHAR processor,
+                               const ContextSwitchInfo& switch_info);
+
+  // KernelFileIoEvents implementation.
+  virtual void OnFileName(const base::Time& time,
+                          const FileNameInfo& name_info);
+  virtual void OnFileNameDeleted(const base::Time& time,
+                                 const FileNameInfo& name_info);
+  virtual void OnFileCreate(const base::Time& time,
+                            const FileCreateInfo& create_info);
+  virtual void OnFileRead(const base::Time& time,
+                          const FileIoInfo& io_info);
+  virtual void OnFileWrite(const base::Time& time,
+                           const FileIoInfo& io_info);
+  virtual void OnFileCleanup(const base::Time& time,
+                             const IoRequest& request);
+  virtual void OnFileClose(const base::Time& time,
+                           const IoRequest& request);
+  virtual void OnFileFlush(const base::Time& time,
+                           const IoRequest& request);
+  virtual void OnFileOperationEnd(const base::Time& time,
+                                  const OperationEndInfo& end_info);
+
+  // KernelRegistryEvents implementation.
+  virtual void OnRegistryOperation(DWORD process_id,
+                                   DWORD thread_id,
+                                   const base::Time& time,
+                                   UCHAR operation,
+                                   const RegistryInfo& registry_info);
+
   // LogEvents implementation.
   virtual void OnLogMessage(const LogEvents::LogMessage& msg);
 
@@ -276,6 +328,117 @@ void LogDumpHandler::OnProcessEnded(const base::Time& time,
   std::wcout << L"Ended:\n" << process_info;
 }
 
+std::wostream& operator<< (std::wostream& str,
+    const KernelThreadEvents::ThreadInfo& thread) {
+  str << base::StringPrintf(L"pid: %d, tid: %d, start: 0x%llX\n",
+                            thread.process_id,
+                            thread.thread_id,
+                            thread.start_address);
+  return str;
+}
+
+// KernelThreadEvents implementation.
+void LogDumpHandler::OnThreadIsRunning(const base::Time& time,
+                                       const ThreadInfo& thread_info) {
+  std::wcout << L"Thread running: " << thread_info;
+}
+
+void LogDumpHandler::OnThreadStarted(const base::Time& time,
+                                     const ThreadInfo& thread_info) {
+  std::wcout << L"Thread started: " << thread_info;
+}
+
+void LogDumpHandler::OnThreadEnded(const base::Time& time,
+                                   const ThreadInfo& thread_info) {
+  std::wcout << L"Thread ended: " << thread_info;
+}
+
+void LogDumpHandler::OnContextSwitch(const base::Time& time,
+                                     UCHAR processor,
+                                     const ContextSwitchInfo& switch_info) {
+  // Context switches are too numerous to be of use in a dump.
+}
+
+std::wostream& operator<< (std::wostream& str,
+    const KernelFileIoEvents::IoRequest& request) {
+  str << base::StringPrintf(L"tid: %d, irp: 0x%llX, file: 0x%llX\n",
+                            request.thread_id,
+                            request.irp,
+                            request.file_object);
+  return str;
+}
+
+// KernelFileIoEvents implementation.
+void LogDumpHandler::OnFileName(const base::Time& time,
+                                const FileNameInfo& name_info) {
+  std::wcout << base::StringPrintf(L"File name: 0x%llX \"%ls\"\n",
+                                   name_info.file_object,
+                                   name_info.file_name.c_str());
+}
+
+void LogDumpHandler::OnFileNameDeleted(const base::Time& time,
+                                       const FileNameInfo& name_info) {
+  std::wcout << base::StringPrintf(L"File name deleted: 0x%llX \"%ls\"\n",
+                                   name_info.file_object,
+                                   name_info.file_name.c_str());
+}
+
+void LogDumpHandler::OnFileCreate(const base::Time& time,
+                                  const FileCreateInfo& create_info) {
+  std::wcout << L"File create: \"" << create_info.open_path << L"\", "
+      << create_info.request;
+}
+
+void LogDumpHandler::OnFileRead(const base::Time& time,
+                                const FileIoInfo& io_info) {
+  std::wcout << L"File read: " << io_info.io_size << L" bytes at "
+      << io_info.offset << L", " << io_info.request;
+}
+
+void LogDumpHandler::OnFileWrite(const base::Time& time,
+                                 const FileIoInfo& io_info) {
+  std::wcout << L"File write: " << io_info.io_size << L" bytes at "
+      << io_info.offset << L", " << io_info.request;
+}
+
+void LogDumpHandler::OnFileCleanup(const base::Time& time,
+                                   const IoRequest& request) {
+  std::wcout << L"File cleanup: " << request;
+}
+
+void LogDumpHandler::OnFileClose(const base::Time& time,
+                                 const IoRequest& request) {
+  std::wcout << L"File close: " << request;
+}
+
+void LogDumpHandler::OnFileFlush(const base::Time& time,
+                                 const IoRequest& request) {
+  std::wcout << L"File flush: " << request;
+}
+
+void LogDumpHandler::OnFileOperationEnd(const base::Time& time,
+                                        const OperationEndInfo& end_info) {
+  std::wcout << base::StringPrintf(L"File operation end: irp: 0x%llX, "
+                                       L"status: 0x%08X\n",
+                                   end_info.irp,
+                                   end_info.nt_status);
+}
+
+// KernelRegistryEvents implementation.
+void LogDumpHandler::OnRegistryOperation(DWORD process_id,
+                                         DWORD thread_id,
+                                         const base::Time& time,
+                                         UCHAR operation,
+                                         const RegistryInfo& registry_info) {
+  std::wcout << base::StringPrintf(
+      L"Registry operation %d: pid: %d, tid: %d, status: 0x%08X, \"%ls\"\n",
+      operation,
+      process_id,
+      thread_id,
+      registry_info.status,
+      registry_info.key_name.c_str());
+}
+
 // LogEvents implementation.
 void LogDumpHandler::OnLogMessage(const LogEvents::LogMessage& log_msg) {
   // TODO(siggi): implement me..
@@ -296,6 +459,150 @@ void LogDumpHandler::OnTraceEventInstant(
   // TODO(siggi): implement me..
 }
 
+// Counts the log messages for the --stats switch.
+class LogStatisticsHandler : public LogEvents {
+ public:
+  // @param miner mines the message templates when grouping by template,
+  //     may be NULL otherwise.
+  LogStatisticsHandler(LogStatistics* statistics, TemplateMiner* miner)
+      : statistics_(statistics), miner_(miner) {
+  }
+
+  virtual void OnLogMessage(const LogEvents::LogMessage& msg) {
+    int template_id = 0;
+    if (miner_ != NULL) {
+      template_id = miner_->GetClusterId(miner_->AddMessage(
+          base::StringPiece(msg.message, msg.message_len), &parameters_));
+    }
+
+    statistics_->AddMessage(msg.process_id,
+                            msg.thread_id,
+                            msg.level,
+                            msg.time,
+                            base::StringPiece(msg.file, msg.file_len),
+                            msg.line,
+                            template_id);
+  }
+
+ private:
+  LogStatistics* statistics_;
+  TemplateMiner* miner_;
+  std::string parameters_;
+};
+
+// Evaluates the query of the --query switch over the log messages, a batch
+// at a time, copying only the columns the query reads.
+class LogQueryHandler : public LogEvents {
+ public:
+  // The number of messages we evaluate at a time.
+  static const size_t kBatchRows = 64 * 1024;
+
+  LogQueryHandler(const LogQuery* query, LogQueryResult* result)
+      : query_(query), result_(result), num_rows_(0) {
+  }
+
+  virtual void OnLogMessage(const LogEvents::LogMessage& msg) {
+    batch_.rows.push_back(num_rows_++);
+    if (query_->ReadsColumn(LogQuery::TIME))
+      batch_.times.push_back(msg.time.ToInternalValue());
+    if (query_->ReadsColumn(LogQuery::PROCESS_ID))
+      batch_.process_ids.push_back(msg.process_id);
+    if (query_->ReadsColumn(LogQuery::THREAD_ID))
+      batch_.thread_ids.push_back(msg.thread_id);
+    if (query_->ReadsColumn(LogQuery::SEVERITY))
+      batch_.severities.push_back(msg.level);
+    if (query_->ReadsColumn(LogQuery::FILE))
+      batch_.files.push_back(std::string(msg.file, msg.file_len));
+    if (query_->ReadsColumn(LogQuery::LINE))
+      batch_.lines.push_back(msg.line);
+    if (query_->ReadsColumn(LogQuery::MESSAGE))
+      batch_.messages.push_back(std::string(msg.message, msg.message_len));
+    if (query_->ReadsColumn(LogQuery::STACK))
+      batch_.stacks.push_back(
+          LogQuery::GetStackId(msg.traces, msg.trace_depth));
+
+    if (batch_.size() == kBatchRows)
+      Flush();
+  }
+
+  // Evaluates the messages of the current batch.
+  void Flush() {
+    query_->Execute(batch_, result_);
+    batch_.Clear();
+  }
+
+ private:
+  const LogQuery* query_;
+  LogQueryResult* result_;
+  LogRowBatch batch_;
+  int64 num_rows_;
+};
+
+// Parses a comma separated list of the keys pid, tid, severity, file and
+// template to a mask of LogStatistics::GroupBy values.
+bool ParseGroupBy(const std::string& keys, int* group_by) {
+  std::vector<std::string> key_list;
+  base::SplitString(keys, ',', &key_list);
+
+  *group_by = 0;
+  for (size_t i = 0; i < key_list.size(); ++i) {
+    if (key_list[i] == "pid") {
+      *group_by |= LogStatistics::GROUP_BY_PROCESS;
+    } else if (key_list[i] == "tid") {
+      *group_by |= LogStatistics::GROUP_BY_THREAD;
+    } else if (key_list[i] == "severity") {
+      *group_by |= LogStatistics::GROUP_BY_SEVERITY;
+    } else if (key_list[i] == "file") {
+      *group_by |= LogStatistics::GROUP_BY_FILE_LINE;
+    } else if (key_list[i] == "template") {
+      *group_by |= LogStatistics::GROUP_BY_TEMPLATE;
+    } else if (!key_list[i].empty()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// @param miner the miner of the templates when grouping by template.
+void PrintStatistics(const LogStatistics& statistics,
+                     const TemplateMiner* miner,
+                     size_t max_groups) {
+  std::vector<LogStatistics::Group> groups;
+  statistics.GetTopGroups(max_groups, &groups);
+
+  std::wcout << statistics.num_messages() << L" messages in "
+      << statistics.num_groups() << L" groups.\n";
+  for (size_t i = 0; i < groups.size(); ++i) {
+    const LogStatistics::Key& key = groups[i].key;
+    std::wcout << base::StringPrintf(L"%8Iu", groups[i].count);
+    if (!key.bucket.is_null()) {
+      base::Time::Exploded exploded = {};
+      key.bucket.LocalExplode(&exploded);
+      std::wcout << base::StringPrintf(L"  %02d:%02d:%02d.%03d",
+                                       exploded.hour,
+                                       exploded.minute,
+                                       exploded.second,
+                                       exploded.millisecond);
+    }
+    if (statistics.group_by() & LogStatistics::GROUP_BY_PROCESS)
+      std::wcout << base::StringPrintf(L"  pid: %5d", key.process_id);
+    if (statistics.group_by() & LogStatistics::GROUP_BY_THREAD)
+      std::wcout << base::StringPrintf(L"  tid: %5d", key.thread_id);
+    if (statistics.group_by() & LogStatistics::GROUP_BY_SEVERITY)
+      std::wcout << base::StringPrintf(L"  severity: %d", key.severity);
+    if (statistics.group_by() & LogStatistics::GROUP_BY_FILE_LINE) {
+      std::wcout << L"  " << base::UTF8ToWide(key.file)
+          << L"(" << key.line << L")";
+    }
+    if (statistics.group_by() & LogStatistics::GROUP_BY_TEMPLATE) {
+      std::wcout << L"  " << base::UTF8ToWide(miner->GetTemplateText(
+          miner->GetClusterTemplateId(key.template_id)));
+    }
+    std::wcout << L"\n";
+  }
+}
+
 int Error(const std::wstring& error) {
   std::wcout << error << std::endl;
 
@@ -322,11 +629,116 @@ int wmain(int argc, const wchar_t** argv) {
   consumer.set_module_event_sink(&handler);
   consumer.set_page_fault_event_sink(&handler);
   consumer.set_process_event_sink(&handler);
+  consumer.set_thread_event_sink(&handler);
+  consumer.set_file_io_event_sink(&handler);
+  consumer.set_registry_event_sink(&handler);
   consumer.set_event_sink(&handler);
 
-  HRESULT hr = consumer.Consume();
-  if (FAILED(hr))
-    return Error(base::StringPrintf(L"Error 0x%08X consuming log files", hr));
+  // The --stats switch counts the log messages, grouped by a comma separated
+  // list of the keys pid, tid, severity, file and template, and optionally
+  // by time with --stats-bucket=<milliseconds>. The --stats-top=<n> groups
+  // with the most messages are printed after consuming the logs.
+  // The log messages themselves are not dumped with --stats, as the
+  // statistics handler replaces the dump handler as the event sink. The
+  // kernel events are still dumped.
+  scoped_ptr<LogStatistics> statistics;
+  scoped_ptr<TemplateMiner> miner;
+  scoped_ptr<LogStatisticsHandler> statistics_handler;
+  size_t max_groups = 20;
+  if (cmd_line->HasSwitch("stats")) {
+    int group_by = 0;
+    std::string keys = cmd_line->GetSwitchValueASCII("stats");
+    if (!ParseGroupBy(keys, &group_by))
+      return Error(L"Invalid statistics keys " + base::UTF8ToWide(keys));
+
+    int bucket_ms = 0;
+    std::string value = cmd_line->GetSwitchValueASCII("stats-bucket");
+    if (!value.empty() && (!base::StringToInt(value, &bucket_ms) ||
+                           bucket_ms < 0)) {
+      return Error(L"Invalid statistics bucket " + base::UTF8ToWide(value));
+    }
+
+    int top = 0;
+    value = cmd_line->GetSwitchValueASCII("stats-top");
+    if (!value.empty()) {
+      if (!base::StringToInt(value, &top) || top <= 0)
+        return Error(L"Invalid statistics top " + base::UTF8ToWide(value));
+      max_groups = top;
+    }
+
+    statistics.reset(new LogStatistics(
+        group_by, base::TimeDelta::FromMilliseconds(bucket_ms)));
+    if (group_by & LogStatistics::GROUP_BY_TEMPLATE)
+      miner.reset(new TemplateMiner());
+    statistics_handler.reset(
+        new LogStatisticsHandler(statistics.get(), miner.get()));
+    consumer.set_event_sink(statistics_handler.get());
+  }
+
+  // The --query switch prints the result of a query over the log messages,
+  // e.g. --query="SELECT file, line, COUNT(*) WHERE severity >= WARNING
+  // GROUP BY file, line ORDER BY 3 DESC LIMIT 10".
+  LogQuery query;
+  LogQueryResult query_result;
+  scoped_ptr<LogQueryHandler> query_handler;
+  if (cmd_line->HasSwitch("query")) {
+    if (statistics.get() != NULL)
+      return Error(L"Only one of --stats and --query may be given");
+
+    std::string error;
+    if (!query.Parse(cmd_line->GetSwitchValueASCII("query"), &error))
+      return Error(L"Invalid query: " + base::UTF8ToWide(error));
+
+    query_handler.reset(new LogQueryHandler(&query, &query_result));
+    consumer.set_event_sink(query_handler.get());
+  }
+
+  // The optional --start-time and --end-time switches restrict the dump
+  // to a window of time.
+  base::Time start_time;
+  std::string time_string = cmd_line->GetSwitchValueASCII("start-time");
+  if (!time_string.empty() &&
+      !base::Time::FromString(time_string.c_str(), &start_time)) {
+    return Error(L"Invalid start time " + base::UTF8ToWide(time_string));
+  }
+  base::Time end_time;
+  time_string = cmd_line->GetSwitchValueASCII("end-time");
+  if (!time_string.empty() &&
+      !base::Time::FromString(time_string.c_str(), &end_time)) {
+    return Error(L"Invalid end time " + base::UTF8ToWide(time_string));
+  }
+  if (!start_time.is_null() && !end_time.is_null() && start_time >= end_time)
+    return Error(L"The start time must precede the end time");
+
+  // Don't consume the events outside the span of time a query selects.
+  // When no row can match, there's nothing to consume at all.
+  bool consume = true;
+  if (query_handler.get() != NULL) {
+    base::Time earliest;
+    base::Time end;
+    consume = query.GetTimeSpan(&earliest, &end);
+    if (!earliest.is_null() && (start_time.is_null() || earliest > start_time))
+      start_time = earliest;
+    if (!end.is_null() && (end_time.is_null() || end < end_time))
+      end_time = end;
+    if (!start_time.is_null() && !end_time.is_null() && start_time >= end_time)
+      consume = false;
+  }
+
+  if (consume) {
+    HRESULT hr = consumer.Consume(start_time, end_time);
+    if (FAILED(hr))
+      return Error(base::StringPrintf(L"Error 0x%08X consuming log files", hr));
+  }
+
+  if (statistics.get() != NULL)
+    PrintStatistics(*statistics, miner.get(), max_groups);
+
+  if (query_handler.get() != NULL) {
+    query_handler->Flush();
+    std::wcout << base::UTF8ToWide(query.Format(query_result));
+    std::wcout << query_result.num_matches() << L" matching messages.\n";
+  }
 
   return 0;
 }
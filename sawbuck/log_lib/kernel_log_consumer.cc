@@ -17,6 +17,9 @@
 
 #include "base/logging.h"
 #include "sawbuck/common/buffer_parser.h"
+#include "sawbuck/log_lib/descriptors/fileio.h"
+#include "sawbuck/log_lib/descriptors/registry.h"
+#include "sawbuck/log_lib/descriptors/thread.h"
 #include <initguid.h>  // NOLINT - must precede kernel_log_types.
 #include "sawbuck/log_lib/kernel_log_types.h"  // NOLINT - must be last
 
@@ -211,6 +214,135 @@ bool ParseProcessEvent(const void* data, size_t data_len,
   return true;
 }
 
+namespace thread = descriptors::thread;
+namespace fileio = descriptors::fileio;
+namespace registry = descriptors::registry;
+
+// The ConvertEventData overloads below convert a parsed event of a
+// particular layout to the form it's issued to the event sinks in.
+template <bool kIs64Bit>
+void ConvertEventData(const thread::TypeGroup1<0, kIs64Bit>& data,
+                      KernelThreadEvents::ThreadInfo* info) {
+  info->process_id = data.ProcessId;
+  info->thread_id = data.TThreadId;
+}
+
+template <int kVersion, bool kIs64Bit>
+void ConvertEventData(const thread::TypeGroup1<kVersion, kIs64Bit>& data,
+                      KernelThreadEvents::ThreadInfo* info) {
+  info->process_id = data.ProcessId;
+  info->thread_id = data.TThreadId;
+  info->user_stack_base = data.UserStackBase;
+  info->user_stack_limit = data.UserStackLimit;
+  info->start_address = data.Win32StartAddr;
+}
+
+template <bool kIs64Bit>
+void ConvertEventData(const thread::TypeGroup2<1, kIs64Bit>& data,
+                      KernelThreadEvents::ThreadInfo* info) {
+  info->process_id = data.ProcessId;
+  info->thread_id = data.TThreadId;
+}
+
+template <int kVersion, bool kIs64Bit>
+void ConvertEventData(const thread::CSwitch<kVersion, kIs64Bit>& data,
+                      KernelThreadEvents::ContextSwitchInfo* info) {
+  info->new_thread_id = data.NewThreadId;
+  info->old_thread_id = data.OldThreadId;
+  info->new_thread_priority = data.NewThreadPriority;
+  info->old_thread_priority = data.OldThreadPriority;
+  info->old_thread_wait_reason = data.OldThreadWaitReason;
+  info->old_thread_state = data.OldThreadState;
+  info->new_thread_wait_time = data.NewThreadWaitTime;
+}
+
+template <int kVersion, bool kIs64Bit>
+void ConvertEventData(const fileio::Name<kVersion, kIs64Bit>& data,
+                      KernelFileIoEvents::FileNameInfo* info) {
+  info->file_object = data.FileObject;
+  info->file_name = data.FileName;
+}
+
+template <bool kIs64Bit>
+void ConvertEventData(const fileio::Create<2, kIs64Bit>& data,
+                      KernelFileIoEvents::FileCreateInfo* info) {
+  // The TTID field is pointer sized, but holds a thread id.
+  info->request.thread_id = static_cast<DWORD>(data.TTID);
+  info->request.irp = data.IrpPtr;
+  info->request.file_object = data.FileObject;
+  info->create_options = data.CreateOptions;
+  info->file_attributes = data.FileAttributes;
+  info->share_access = data.ShareAccess;
+  info->open_path = data.OpenPath;
+}
+
+template <bool kIs64Bit>
+void ConvertEventData(const fileio::SimpleOp<2, kIs64Bit>& data,
+                      KernelFileIoEvents::IoRequest* request) {
+  request->thread_id = static_cast<DWORD>(data.TTID);
+  request->irp = data.IrpPtr;
+  request->file_object = data.FileObject;
+  request->file_key = data.FileKey;
+}
+
+template <bool kIs64Bit>
+void ConvertEventData(const fileio::ReadWrite<2, kIs64Bit>& data,
+                      KernelFileIoEvents::FileIoInfo* info) {
+  info->request.thread_id = static_cast<DWORD>(data.TTID);
+  info->request.irp = data.IrpPtr;
+  info->request.file_object = data.FileObject;
+  info->request.file_key = data.FileKey;
+  info->offset = data.Offset;
+  info->io_size = data.IoSize;
+  info->io_flags = data.IoFlags;
+}
+
+template <bool kIs64Bit>
+void ConvertEventData(const fileio::OpEnd<2, kIs64Bit>& data,
+                      KernelFileIoEvents::OperationEndInfo* info) {
+  info->irp = data.IrpPtr;
+  info->extra_info = data.ExtraInfo;
+  info->nt_status = data.NtStatus;
+}
+
+template <bool kIs64Bit>
+void ConvertEventData(const registry::TypeGroup1<0, kIs64Bit>& data,
+                      KernelRegistryEvents::RegistryInfo* info) {
+  info->status = static_cast<ULONG>(data.Status);
+  info->key_handle = data.KeyHandle;
+  info->key_name = data.KeyName;
+}
+
+template <int kVersion, bool kIs64Bit>
+void ConvertEventData(const registry::TypeGroup1<kVersion, kIs64Bit>& data,
+                      KernelRegistryEvents::RegistryInfo* info) {
+  info->status = static_cast<ULONG>(data.Status);
+  info->index = data.Index;
+  info->key_handle = data.KeyHandle;
+  info->key_name = data.KeyName;
+}
+
+template <class LayoutType, class InfoType>
+bool ParseLayout(const EVENT_TRACE* event, InfoType* info) {
+  LayoutType data;
+  BinaryBufferReader reader(event->MofData, event->MofLength);
+  if (!data.Parse(&reader))
+    return false;
+
+  ConvertEventData(data, info);
+  return true;
+}
+
+// Parses the data of @p event with the 32 or 64 bit variant of version
+// @p kVersion of @p LayoutType, and converts it to @p info.
+template <template <int, bool> class LayoutType, int kVersion, class InfoType>
+bool ParseEvent(const EVENT_TRACE* event, bool is_64_bit_log, InfoType* info) {
+  if (is_64_bit_log)
+    return ParseLayout<LayoutType<kVersion, true> >(event, info);
+  else
+    return ParseLayout<LayoutType<kVersion, false> >(event, info);
+}
+
 }  // namespace
 
 bool KernelProcessEvents::ProcessInfo::operator == (
@@ -224,8 +356,75 @@ bool KernelProcessEvents::ProcessInfo::operator == (
       command_line == other.command_line;
 }
 
+bool KernelThreadEvents::ThreadInfo::operator == (
+    const ThreadInfo& other) const {
+  return process_id == other.process_id &&
+      thread_id == other.thread_id &&
+      user_stack_base == other.user_stack_base &&
+      user_stack_limit == other.user_stack_limit &&
+      start_address == other.start_address;
+}
+
+bool KernelThreadEvents::ContextSwitchInfo::operator == (
+    const ContextSwitchInfo& other) const {
+  return new_thread_id == other.new_thread_id &&
+      old_thread_id == other.old_thread_id &&
+      new_thread_priority == other.new_thread_priority &&
+      old_thread_priority == other.old_thread_priority &&
+      old_thread_wait_reason == other.old_thread_wait_reason &&
+      old_thread_state == other.old_thread_state &&
+      new_thread_wait_time == other.new_thread_wait_time;
+}
+
+bool KernelFileIoEvents::FileNameInfo::operator == (
+    const FileNameInfo& other) const {
+  return file_object == other.file_object && file_name == other.file_name;
+}
+
+bool KernelFileIoEvents::IoRequest::operator == (
+    const IoRequest& other) const {
+  return thread_id == other.thread_id &&
+      irp == other.irp &&
+      file_object == other.file_object &&
+      file_key == other.file_key;
+}
+
+bool KernelFileIoEvents::FileCreateInfo::operator == (
+    const FileCreateInfo& other) const {
+  return request == other.request &&
+      create_options == other.create_options &&
+      file_attributes == other.file_attributes &&
+      share_access == other.share_access &&
+      open_path == other.open_path;
+}
+
+bool KernelFileIoEvents::FileIoInfo::operator == (
+    const FileIoInfo& other) const {
+  return request == other.request &&
+      offset == other.offset &&
+      io_size == other.io_size &&
+      io_flags == other.io_flags;
+}
+
+bool KernelFileIoEvents::OperationEndInfo::operator == (
+    const OperationEndInfo& other) const {
+  return irp == other.irp &&
+      extra_info == other.extra_info &&
+      nt_status == other.nt_status;
+}
+
+bool KernelRegistryEvents::RegistryInfo::operator == (
+    const RegistryInfo& other) const {
+  return status == other.status &&
+      index == other.index &&
+      key_handle == other.key_handle &&
+      key_name == other.key_name;
+}
+
 KernelLogParser::KernelLogParser() : module_event_sink_(NULL),
     page_fault_event_sink_(NULL), process_event_sink_(NULL),
+    thread_event_sink_(NULL), file_io_event_sink_(NULL),
+    registry_event_sink_(NULL),
     infer_bitness_from_log_(true),
     is_64_bit_log_(false) {
 }
@@ -551,6 +750,259 @@ bool KernelLogParser::ProcessProcessEvent(EVENT_TRACE* event) {
   return false;
 }
 
+bool KernelLogParser::ProcessThreadEvent(EVENT_TRACE* event) {
+  DCHECK(event && event->Header.Guid == thread::kGuid);
+
+  if (thread_event_sink_ == NULL)
+    return false;
+
+  base::Time time(base::Time::FromFileTime(
+      reinterpret_cast<FILETIME&>(event->Header.TimeStamp)));
+  UCHAR type = event->Header.Class.Type;
+  UCHAR version = event->Header.Class.Version;
+
+  if (type == thread::kCSwitch) {
+    KernelThreadEvents::ContextSwitchInfo info = {};
+    bool has_info = false;
+    switch (version) {
+      case 1:
+        has_info = ParseEvent<thread::CSwitch, 1>(event, is_64_bit_log_, &info);
+        break;
+      case 2:
+        has_info = ParseEvent<thread::CSwitch, 2>(event, is_64_bit_log_, &info);
+        break;
+
+      default:
+        LOG(ERROR) << "Unexpected context switch version "
+            << static_cast<int>(version);
+        break;
+    }
+
+    if (!has_info)
+      return false;
+
+    thread_event_sink_->OnContextSwitch(
+        time, event->BufferContext.ProcessorNumber, info);
+    return true;
+  }
+
+  switch (type) {
+    case thread::kStart:
+    case thread::kEnd:
+    case thread::kDCStart:
+      break;
+
+    default:
+      // Unknown or uninteresting event type.
+      return false;
+  }
+
+  KernelThreadEvents::ThreadInfo info = {};
+  bool has_info = false;
+  switch (version) {
+    case 0:
+      has_info =
+          ParseEvent<thread::TypeGroup1, 0>(event, is_64_bit_log_, &info);
+      break;
+    case 1:
+      // Version 1 thread end events have their own, shorter layout.
+      if (type == thread::kEnd) {
+        has_info =
+            ParseEvent<thread::TypeGroup2, 1>(event, is_64_bit_log_, &info);
+      } else {
+        has_info =
+            ParseEvent<thread::TypeGroup1, 1>(event, is_64_bit_log_, &info);
+      }
+      break;
+    case 2:
+      has_info =
+          ParseEvent<thread::TypeGroup1, 2>(event, is_64_bit_log_, &info);
+      break;
+    case 3:
+      has_info =
+          ParseEvent<thread::TypeGroup1, 3>(event, is_64_bit_log_, &info);
+      break;
+
+    default:
+      LOG(ERROR) << "Unexpected thread info version "
+          << static_cast<int>(version);
+      break;
+  }
+
+  if (!has_info)
+    return false;
+
+  switch (type) {
+    case thread::kDCStart:
+      thread_event_sink_->OnThreadIsRunning(time, info);
+      break;
+
+    case thread::kStart:
+      thread_event_sink_->OnThreadStarted(time, info);
+      break;
+
+    case thread::kEnd:
+      thread_event_sink_->OnThreadEnded(time, info);
+      break;
+  }
+
+  return true;
+}
+
+bool KernelLogParser::ProcessFileIoEvent(EVENT_TRACE* event) {
+  DCHECK(event && event->Header.Guid == fileio::kGuid);
+
+  if (file_io_event_sink_ == NULL)
+    return false;
+
+  base::Time time(base::Time::FromFileTime(
+      reinterpret_cast<FILETIME&>(event->Header.TimeStamp)));
+  UCHAR type = event->Header.Class.Type;
+  UCHAR version = event->Header.Class.Version;
+
+  switch (type) {
+    case fileio::kName:
+    case fileio::kFileCreate:
+    case fileio::kFileDelete:
+    case fileio::kFileRundown: {
+        KernelFileIoEvents::FileNameInfo info = {};
+        bool has_info = false;
+        switch (version) {
+          case 0:
+            has_info =
+                ParseEvent<fileio::Name, 0>(event, is_64_bit_log_, &info);
+            break;
+          case 1:
+            has_info =
+                ParseEvent<fileio::Name, 1>(event, is_64_bit_log_, &info);
+            break;
+          case 2:
+            has_info =
+                ParseEvent<fileio::Name, 2>(event, is_64_bit_log_, &info);
+            break;
+
+          default:
+            LOG(ERROR) << "Unexpected file name version "
+                << static_cast<int>(version);
+            break;
+        }
+
+        if (!has_info)
+          return false;
+
+        if (type == fileio::kFileDelete)
+          file_io_event_sink_->OnFileNameDeleted(time, info);
+        else
+          file_io_event_sink_->OnFileName(time, info);
+        return true;
+      }
+  }
+
+  // The I/O request events are only logged from version 2 on.
+  if (version != 2)
+    return false;
+
+  switch (type) {
+    case fileio::kCreate: {
+        KernelFileIoEvents::FileCreateInfo info = {};
+        if (!ParseEvent<fileio::Create, 2>(event, is_64_bit_log_, &info))
+          return false;
+
+        file_io_event_sink_->OnFileCreate(time, info);
+        return true;
+      }
+
+    case fileio::kRead:
+    case fileio::kWrite: {
+        KernelFileIoEvents::FileIoInfo info = {};
+        if (!ParseEvent<fileio::ReadWrite, 2>(event, is_64_bit_log_, &info))
+          return false;
+
+        if (type == fileio::kRead)
+          file_io_event_sink_->OnFileRead(time, info);
+        else
+          file_io_event_sink_->OnFileWrite(time, info);
+        return true;
+      }
+
+    case fileio::kCleanup:
+    case fileio::kClose:
+    case fileio::kFlush: {
+        KernelFileIoEvents::IoRequest request = {};
+        if (!ParseEvent<fileio::SimpleOp, 2>(event, is_64_bit_log_, &request))
+          return false;
+
+        if (type == fileio::kCleanup)
+          file_io_event_sink_->OnFileCleanup(time, request);
+        else if (type == fileio::kClose)
+          file_io_event_sink_->OnFileClose(time, request);
+        else
+          file_io_event_sink_->OnFileFlush(time, request);
+        return true;
+      }
+
+    case fileio::kOperationEnd: {
+        KernelFileIoEvents::OperationEndInfo info = {};
+        if (!ParseEvent<fileio::OpEnd, 2>(event, is_64_bit_log_, &info))
+          return false;
+
+        file_io_event_sink_->OnFileOperationEnd(time, info);
+        return true;
+      }
+  }
+
+  // The directory enumeration, directory notification and file information
+  // events are not handled, and are left to the other parsers.
+  return false;
+}
+
+bool KernelLogParser::ProcessRegistryEvent(EVENT_TRACE* event) {
+  DCHECK(event && event->Header.Guid == registry::kGuid);
+
+  if (registry_event_sink_ == NULL)
+    return false;
+
+  // All key and value operations share a layout, the transaction, counter
+  // and configuration events are not handled.
+  UCHAR type = event->Header.Class.Type;
+  if (type < registry::kCreate || type > registry::kQuerySecurity)
+    return false;
+
+  base::Time time(base::Time::FromFileTime(
+      reinterpret_cast<FILETIME&>(event->Header.TimeStamp)));
+  KernelRegistryEvents::RegistryInfo info = {};
+  bool has_info = false;
+  switch (event->Header.Class.Version) {
+    case 0:
+      has_info =
+          ParseEvent<registry::TypeGroup1, 0>(event, is_64_bit_log_, &info);
+      break;
+    case 1:
+      has_info =
+          ParseEvent<registry::TypeGroup1, 1>(event, is_64_bit_log_, &info);
+      break;
+    case 2:
+      has_info =
+          ParseEvent<registry::TypeGroup1, 2>(event, is_64_bit_log_, &info);
+      break;
+
+    default:
+      LOG(ERROR) << "Unexpected registry event version "
+          << static_cast<int>(event->Header.Class.Version);
+      break;
+  }
+
+  if (!has_info)
+    return false;
+
+  registry_event_sink_->OnRegistryOperation(event->Header.ProcessId,
+                                            event->Header.ThreadId,
+                                            time,
+                                            type,
+                                            info);
+  return true;
+}
+
 bool KernelLogParser::ProcessOneEvent(EVENT_TRACE* event) {
   if (event->Header.Guid == kImageLoadEventClass) {
     return ProcessImageLoadEvent(event);
@@ -558,6 +1010,12 @@ bool KernelLogParser::ProcessOneEvent(EVENT_TRACE* event) {
     return ProcessPageFaultEvent(event);
   } else if (event->Header.Guid == kProcessEventClass) {
     return ProcessProcessEvent(event);
+  } else if (event->Header.Guid == thread::kGuid) {
+    return ProcessThreadEvent(event);
+  } else if (event->Header.Guid == fileio::kGuid) {
+    return ProcessFileIoEvent(event);
+  } else if (event->Header.Guid == registry::kGuid) {
+    return ProcessRegistryEvent(event);
   } else if (event->Header.Guid == kEventTraceEventClass) {
     if (event->Header.Class.Type == kLogFileHeaderEvent) {
       LogFileHeader32* data =
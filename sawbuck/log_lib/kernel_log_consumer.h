@@ -115,6 +115,148 @@ class KernelProcessEvents {
   // TODO(siggi): Data collection end event?
 };
 
+// Implemented by clients of EventTraceConsumer to get thread lifetime and
+// context switch event notifications.
+class KernelThreadEvents {
+ public:
+  struct ThreadInfo {
+    DWORD process_id;
+    DWORD thread_id;
+    // The user mode stack and start address of the thread. These are zero
+    // for version 0 events, and for thread end events before version 2.
+    sym_util::Address user_stack_base;
+    sym_util::Address user_stack_limit;
+    sym_util::Address start_address;
+
+    bool operator == (const ThreadInfo& other) const;
+  };
+
+  struct ContextSwitchInfo {
+    DWORD new_thread_id;
+    DWORD old_thread_id;
+    CHAR new_thread_priority;
+    CHAR old_thread_priority;
+    CHAR old_thread_wait_reason;
+    CHAR old_thread_state;
+    ULONG new_thread_wait_time;
+
+    bool operator == (const ContextSwitchInfo& other) const;
+  };
+
+  // Issued for threads running before the trace session started.
+  virtual void OnThreadIsRunning(const base::Time& time,
+                                 const ThreadInfo& thread_info) = 0;
+  // Issued for threads starting after the trace session started.
+  virtual void OnThreadStarted(const base::Time& time,
+                               const ThreadInfo& thread_info) = 0;
+  // Issued for threads ending.
+  virtual void OnThreadEnded(const base::Time& time,
+                             const ThreadInfo& thread_info) = 0;
+  // Issued for context switches on @p processor.
+  virtual void OnContextSwitch(const base::Time& time,
+                               UCHAR processor,
+                               const ContextSwitchInfo& switch_info) = 0;
+};
+
+// Implemented by clients of EventTraceConsumer to get file I/O event
+// notifications. Files are identified by their kernel file object address,
+// which is associated with a name through OnFileName.
+class KernelFileIoEvents {
+ public:
+  struct FileNameInfo {
+    sym_util::Address file_object;
+    std::wstring file_name;
+
+    bool operator == (const FileNameInfo& other) const;
+  };
+
+  // The identity of an I/O request.
+  struct IoRequest {
+    // The thread issuing the request.
+    DWORD thread_id;
+    sym_util::Address irp;
+    sym_util::Address file_object;
+    sym_util::Address file_key;
+
+    bool operator == (const IoRequest& other) const;
+  };
+
+  struct FileCreateInfo {
+    IoRequest request;
+    ULONG create_options;
+    ULONG file_attributes;
+    ULONG share_access;
+    std::wstring open_path;
+
+    bool operator == (const FileCreateInfo& other) const;
+  };
+
+  struct FileIoInfo {
+    IoRequest request;
+    ULONGLONG offset;
+    ULONG io_size;
+    ULONG io_flags;
+
+    bool operator == (const FileIoInfo& other) const;
+  };
+
+  struct OperationEndInfo {
+    sym_util::Address irp;
+    sym_util::Address extra_info;
+    ULONG nt_status;
+
+    bool operator == (const OperationEndInfo& other) const;
+  };
+
+  // Issued for files opened before, or created after the trace session
+  // started, as well as for explicit name events.
+  virtual void OnFileName(const base::Time& time,
+                          const FileNameInfo& name_info) = 0;
+  // Issued when a file object is deleted.
+  virtual void OnFileNameDeleted(const base::Time& time,
+                                 const FileNameInfo& name_info) = 0;
+  // Issued for file opens and creations.
+  virtual void OnFileCreate(const base::Time& time,
+                            const FileCreateInfo& create_info) = 0;
+  virtual void OnFileRead(const base::Time& time,
+                          const FileIoInfo& io_info) = 0;
+  virtual void OnFileWrite(const base::Time& time,
+                           const FileIoInfo& io_info) = 0;
+  virtual void OnFileCleanup(const base::Time& time,
+                             const IoRequest& request) = 0;
+  virtual void OnFileClose(const base::Time& time,
+                           const IoRequest& request) = 0;
+  virtual void OnFileFlush(const base::Time& time,
+                           const IoRequest& request) = 0;
+  // Issued on completion of the request identified by end_info.irp.
+  virtual void OnFileOperationEnd(const base::Time& time,
+                                  const OperationEndInfo& end_info) = 0;
+};
+
+// Implemented by clients of EventTraceConsumer to get registry event
+// notifications.
+class KernelRegistryEvents {
+ public:
+  struct RegistryInfo {
+    ULONG status;
+    // The subkey or value index for enumerations, zero for version 0 events.
+    ULONG index;
+    // The key control block of the key operated on.
+    sym_util::Address key_handle;
+    std::wstring key_name;
+
+    bool operator == (const RegistryInfo& other) const;
+  };
+
+  // Issued for registry operations, @p operation is one of the
+  // descriptors::registry::EventType values.
+  virtual void OnRegistryOperation(DWORD process_id,
+                                   DWORD thread_id,
+                                   const base::Time& time,
+                                   UCHAR operation,
+                                   const RegistryInfo& registry_info) = 0;
+};
+
 class KernelLogParser {
  public:
   KernelLogParser();
@@ -139,6 +281,15 @@ class KernelLogParser {
   void set_process_event_sink(KernelProcessEvents* process_event_sink) {
     process_event_sink_ = process_event_sink;
   }
+  void set_thread_event_sink(KernelThreadEvents* thread_event_sink) {
+    thread_event_sink_ = thread_event_sink;
+  }
+  void set_file_io_event_sink(KernelFileIoEvents* file_io_event_sink) {
+    file_io_event_sink_ = file_io_event_sink;
+  }
+  void set_registry_event_sink(KernelRegistryEvents* registry_event_sink) {
+    registry_event_sink_ = registry_event_sink;
+  }
 
   // Process an event, issue callbacks to event sinks as appropriate.
   // @param event the event to process.
@@ -149,6 +300,9 @@ class KernelLogParser {
   bool ProcessImageLoadEvent(EVENT_TRACE* event);
   bool ProcessPageFaultEvent(EVENT_TRACE* event);
   bool ProcessProcessEvent(EVENT_TRACE* event);
+  bool ProcessThreadEvent(EVENT_TRACE* event);
+  bool ProcessFileIoEvent(EVENT_TRACE* event);
+  bool ProcessRegistryEvent(EVENT_TRACE* event);
 
   // Our module event sink.
   KernelModuleEvents* module_event_sink_;
@@ -156,6 +310,12 @@ class KernelLogParser {
   KernelPageFaultEvents* page_fault_event_sink_;
   // Our process event sink.
   KernelProcessEvents* process_event_sink_;
+  // Our thread event sink.
+  KernelThreadEvents* thread_event_sink_;
+  // Our file I/O event sink.
+  KernelFileIoEvents* file_io_event_sink_;
+  // Our registry event sink.
+  KernelRegistryEvents* registry_event_sink_;
 
   // If true, we should infer the log bitness from the event stream,
   // e.g. from the pointer size field of the log file header event.
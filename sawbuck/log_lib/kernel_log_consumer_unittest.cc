@@ -19,6 +19,9 @@
 #include "base/files/file_path.h"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
+#include "sawbuck/log_lib/descriptors/fileio.h"
+#include "sawbuck/log_lib/descriptors/registry.h"
+#include "sawbuck/log_lib/descriptors/thread.h"
 #include "sawbuck/log_lib/kernel_log_unittest_data.h"
 
 namespace {
@@ -53,6 +56,50 @@ class MockKernelProcessEvents: public KernelProcessEvents{
                                      ULONG exit_status));
 };
 
+class MockKernelThreadEvents: public KernelThreadEvents {
+ public:
+  MOCK_METHOD2(OnThreadIsRunning, void(const base::Time& time,
+                                       const ThreadInfo& thread_info));
+  MOCK_METHOD2(OnThreadStarted, void(const base::Time& time,
+                                     const ThreadInfo& thread_info));
+  MOCK_METHOD2(OnThreadEnded, void(const base::Time& time,
+                                   const ThreadInfo& thread_info));
+  MOCK_METHOD3(OnContextSwitch, void(const base::Time& time,
+                                     UCHAR processor,
+                                     const ContextSwitchInfo& switch_info));
+};
+
+class MockKernelFileIoEvents: public KernelFileIoEvents {
+ public:
+  MOCK_METHOD2(OnFileName, void(const base::Time& time,
+                                const FileNameInfo& name_info));
+  MOCK_METHOD2(OnFileNameDeleted, void(const base::Time& time,
+                                       const FileNameInfo& name_info));
+  MOCK_METHOD2(OnFileCreate, void(const base::Time& time,
+                                  const FileCreateInfo& create_info));
+  MOCK_METHOD2(OnFileRead, void(const base::Time& time,
+                                const FileIoInfo& io_info));
+  MOCK_METHOD2(OnFileWrite, void(const base::Time& time,
+                                 const FileIoInfo& io_info));
+  MOCK_METHOD2(OnFileCleanup, void(const base::Time& time,
+                                   const IoRequest& request));
+  MOCK_METHOD2(OnFileClose, void(const base::Time& time,
+                                 const IoRequest& request));
+  MOCK_METHOD2(OnFileFlush, void(const base::Time& time,
+                                 const IoRequest& request));
+  MOCK_METHOD2(OnFileOperationEnd, void(const base::Time& time,
+                                        const OperationEndInfo& end_info));
+};
+
+class MockKernelRegistryEvents: public KernelRegistryEvents {
+ public:
+  MOCK_METHOD5(OnRegistryOperation, void(DWORD process_id,
+                                         DWORD thread_id,
+                                         const base::Time& time,
+                                         UCHAR operation,
+                                         const RegistryInfo& registry_info));
+};
+
 class KernelLogConsumerTest: public testing::Test {
  public:
   KernelLogConsumerTest() {
@@ -220,4 +267,280 @@ TEST_F(KernelLogConsumerTest, ProcessEventsLog64Version3) {
   Consume(L"process_data_64_v3.etl");
 }
 
+// Builds the data of a single event in memory.
+class TestEvent {
+ public:
+  TestEvent(const GUID& guid, UCHAR type, UCHAR version) {
+    memset(&event_, 0, sizeof(event_));
+    event_.Header.Guid = guid;
+    event_.Header.Class.Type = type;
+    event_.Header.Class.Version = version;
+    event_.Header.ProcessId = kProcessId;
+    event_.Header.ThreadId = kThreadId;
+  }
+
+  template <class ValueType>
+  TestEvent& Append(const ValueType& value) {
+    const uint8* data = reinterpret_cast<const uint8*>(&value);
+    data_.insert(data_.end(), data, data + sizeof(value));
+    return *this;
+  }
+
+  // Appends a pointer sized value.
+  TestEvent& AppendPointer(bool is_64_bit, ULONGLONG value) {
+    if (is_64_bit)
+      return Append(value);
+    return Append(static_cast<ULONG>(value));
+  }
+
+  TestEvent& AppendString(const wchar_t* str) {
+    const uint8* data = reinterpret_cast<const uint8*>(str);
+    data_.insert(data_.end(), data, data + (wcslen(str) + 1) * sizeof(*str));
+    return *this;
+  }
+
+  EVENT_TRACE* Get() {
+    event_.MofData = data_.empty() ? NULL : &data_[0];
+    event_.MofLength = static_cast<ULONG>(data_.size());
+    return &event_;
+  }
+
+  static const DWORD kProcessId = 0x1234;
+  static const DWORD kThreadId = 0x5678;
+
+ private:
+  EVENT_TRACE event_;
+  std::vector<uint8> data_;
+};
+
+class KernelLogParserTest: public testing::TestWithParam<bool> {
+ public:
+  virtual void SetUp() {
+    parser_.set_infer_bitness_from_log(false);
+    parser_.set_is_64_bit_log(is_64_bit());
+    parser_.set_thread_event_sink(&thread_events_);
+    parser_.set_file_io_event_sink(&file_io_events_);
+    parser_.set_registry_event_sink(&registry_events_);
+  }
+
+  bool is_64_bit() const { return GetParam(); }
+
+  // Appends the data of a version 2 or 3 thread event.
+  void AppendThreadInfo(const KernelThreadEvents::ThreadInfo& info,
+                        int version, TestEvent* event) {
+    event->Append<ULONG>(info.process_id)
+        .Append<ULONG>(info.thread_id)
+        .AppendPointer(is_64_bit(), 0x1000)  // StackBase.
+        .AppendPointer(is_64_bit(), 0x2000)  // StackLimit.
+        .AppendPointer(is_64_bit(), info.user_stack_base)
+        .AppendPointer(is_64_bit(), info.user_stack_limit)
+        .AppendPointer(is_64_bit(), 0x3000)  // StartAddr or Affinity.
+        .AppendPointer(is_64_bit(), info.start_address)
+        .AppendPointer(is_64_bit(), 0x7FFD0000)  // TebBase.
+        .Append<ULONG>(0);  // SubProcessTag.
+    if (version == 3)
+      event->Append<ULONG>(0x00050208);  // Priorities and flags.
+  }
+
+ protected:
+  StrictMock<MockKernelThreadEvents> thread_events_;
+  StrictMock<MockKernelFileIoEvents> file_io_events_;
+  StrictMock<MockKernelRegistryEvents> registry_events_;
+  KernelLogParser parser_;
+};
+
+const KernelThreadEvents::ThreadInfo kThreadInfo = {
+  0x1234, 0x5678, 0x00130000, 0x0012C000, 0x77001234
+};
+
+TEST_P(KernelLogParserTest, ThreadEventsVersion2) {
+  TestEvent running(descriptors::thread::kGuid,
+                    descriptors::thread::kDCStart, 2);
+  AppendThreadInfo(kThreadInfo, 2, &running);
+  TestEvent started(descriptors::thread::kGuid,
+                    descriptors::thread::kStart, 2);
+  AppendThreadInfo(kThreadInfo, 2, &started);
+  TestEvent ended(descriptors::thread::kGuid, descriptors::thread::kEnd, 2);
+  AppendThreadInfo(kThreadInfo, 2, &ended);
+
+  InSequence in;
+  EXPECT_CALL(thread_events_, OnThreadIsRunning(_, kThreadInfo));
+  EXPECT_CALL(thread_events_, OnThreadStarted(_, kThreadInfo));
+  EXPECT_CALL(thread_events_, OnThreadEnded(_, kThreadInfo));
+
+  EXPECT_TRUE(parser_.ProcessOneEvent(running.Get()));
+  EXPECT_TRUE(parser_.ProcessOneEvent(started.Get()));
+  EXPECT_TRUE(parser_.ProcessOneEvent(ended.Get()));
+}
+
+TEST_P(KernelLogParserTest, ThreadEventsVersion3) {
+  TestEvent started(descriptors::thread::kGuid,
+                    descriptors::thread::kStart, 3);
+  AppendThreadInfo(kThreadInfo, 3, &started);
+
+  EXPECT_CALL(thread_events_, OnThreadStarted(_, kThreadInfo));
+  EXPECT_TRUE(parser_.ProcessOneEvent(started.Get()));
+}
+
+TEST_P(KernelLogParserTest, ThreadEndEventVersion1) {
+  // Version 1 end events carry only the process and thread ids.
+  TestEvent ended(descriptors::thread::kGuid, descriptors::thread::kEnd, 1);
+  ended.Append<ULONG>(kThreadInfo.process_id)
+      .Append<ULONG>(kThreadInfo.thread_id);
+
+  KernelThreadEvents::ThreadInfo expected = {
+    kThreadInfo.process_id, kThreadInfo.thread_id
+  };
+  EXPECT_CALL(thread_events_, OnThreadEnded(_, expected));
+  EXPECT_TRUE(parser_.ProcessOneEvent(ended.Get()));
+}
+
+TEST_P(KernelLogParserTest, ShortThreadEvent) {
+  TestEvent started(descriptors::thread::kGuid,
+                    descriptors::thread::kStart, 2);
+  started.Append<ULONG>(kThreadInfo.process_id)
+      .Append<ULONG>(kThreadInfo.thread_id);
+
+  // The strict mock fails the test on any callback.
+  EXPECT_FALSE(parser_.ProcessOneEvent(started.Get()));
+}
+
+TEST_P(KernelLogParserTest, ContextSwitchEvent) {
+  TestEvent cswitch(descriptors::thread::kGuid,
+                    descriptors::thread::kCSwitch, 2);
+  cswitch.Append<ULONG>(0x100)  // NewThreadId.
+      .Append<ULONG>(0x200)  // OldThreadId.
+      .Append<CHAR>(9)  // NewThreadPriority.
+      .Append<CHAR>(8)  // OldThreadPriority.
+      .Append<UCHAR>(0)  // PreviousCState.
+      .Append<CHAR>(0)  // SpareByte.
+      .Append<CHAR>(6)  // OldThreadWaitReason.
+      .Append<CHAR>(1)  // OldThreadWaitMode.
+      .Append<CHAR>(5)  // OldThreadState.
+      .Append<CHAR>(0)  // OldThreadWaitIdealProcessor.
+      .Append<ULONG>(42)  // NewThreadWaitTime.
+      .Append<ULONG>(0);  // Reserved.
+  EVENT_TRACE* event = cswitch.Get();
+  event->BufferContext.ProcessorNumber = 3;
+
+  KernelThreadEvents::ContextSwitchInfo expected = {
+    0x100, 0x200, 9, 8, 6, 5, 42
+  };
+  EXPECT_CALL(thread_events_, OnContextSwitch(_, 3, expected));
+  EXPECT_TRUE(parser_.ProcessOneEvent(event));
+}
+
+TEST_P(KernelLogParserTest, FileNameEvents) {
+  TestEvent name(descriptors::fileio::kGuid,
+                 descriptors::fileio::kFileRundown, 2);
+  name.AppendPointer(is_64_bit(), 0x8A001000).AppendString(L"C:\\foo.txt");
+  TestEvent deleted(descriptors::fileio::kGuid,
+                    descriptors::fileio::kFileDelete, 2);
+  deleted.AppendPointer(is_64_bit(), 0x8A001000)
+      .AppendString(L"C:\\foo.txt");
+
+  KernelFileIoEvents::FileNameInfo expected;
+  expected.file_object = 0x8A001000;
+  expected.file_name = L"C:\\foo.txt";
+
+  InSequence in;
+  EXPECT_CALL(file_io_events_, OnFileName(_, expected));
+  EXPECT_CALL(file_io_events_, OnFileNameDeleted(_, expected));
+
+  EXPECT_TRUE(parser_.ProcessOneEvent(name.Get()));
+  EXPECT_TRUE(parser_.ProcessOneEvent(deleted.Get()));
+}
+
+TEST_P(KernelLogParserTest, FileIoEvents) {
+  // FILE_NON_DIRECTORY_FILE.
+  const ULONG kCreateOptions = 0x00000040;
+  KernelFileIoEvents::IoRequest request = {
+    kThreadInfo.thread_id, 0x8B000100, 0x8A001000, 0x8C002000
+  };
+
+  TestEvent create(descriptors::fileio::kGuid, descriptors::fileio::kCreate, 2);
+  create.AppendPointer(is_64_bit(), request.irp)
+      .AppendPointer(is_64_bit(), request.thread_id)
+      .AppendPointer(is_64_bit(), request.file_object)
+      .Append<ULONG>(kCreateOptions)
+      .Append<ULONG>(FILE_ATTRIBUTE_NORMAL)
+      .Append<ULONG>(FILE_SHARE_READ)
+      .AppendString(L"\\Device\\HarddiskVolume1\\foo.txt");
+
+  TestEvent read(descriptors::fileio::kGuid, descriptors::fileio::kRead, 2);
+  read.Append<ULONGLONG>(0x10000)
+      .AppendPointer(is_64_bit(), request.irp)
+      .AppendPointer(is_64_bit(), request.thread_id)
+      .AppendPointer(is_64_bit(), request.file_object)
+      .AppendPointer(is_64_bit(), request.file_key)
+      .Append<ULONG>(4096)
+      .Append<ULONG>(0);
+
+  TestEvent end(descriptors::fileio::kGuid,
+                descriptors::fileio::kOperationEnd, 2);
+  end.AppendPointer(is_64_bit(), request.irp)
+      .AppendPointer(is_64_bit(), 4096)
+      .Append<ULONG>(0);
+
+  TestEvent close(descriptors::fileio::kGuid, descriptors::fileio::kClose, 2);
+  close.AppendPointer(is_64_bit(), request.irp)
+      .AppendPointer(is_64_bit(), request.thread_id)
+      .AppendPointer(is_64_bit(), request.file_object)
+      .AppendPointer(is_64_bit(), request.file_key);
+
+  KernelFileIoEvents::FileCreateInfo create_info;
+  create_info.request = request;
+  create_info.request.file_key = 0;
+  create_info.create_options = kCreateOptions;
+  create_info.file_attributes = FILE_ATTRIBUTE_NORMAL;
+  create_info.share_access = FILE_SHARE_READ;
+  create_info.open_path = L"\\Device\\HarddiskVolume1\\foo.txt";
+  KernelFileIoEvents::FileIoInfo io_info = { request, 0x10000, 4096, 0 };
+  KernelFileIoEvents::OperationEndInfo end_info = { request.irp, 4096, 0 };
+
+  InSequence in;
+  EXPECT_CALL(file_io_events_, OnFileCreate(_, create_info));
+  EXPECT_CALL(file_io_events_, OnFileRead(_, io_info));
+  EXPECT_CALL(file_io_events_, OnFileOperationEnd(_, end_info));
+  EXPECT_CALL(file_io_events_, OnFileClose(_, request));
+
+  EXPECT_TRUE(parser_.ProcessOneEvent(create.Get()));
+  EXPECT_TRUE(parser_.ProcessOneEvent(read.Get()));
+  EXPECT_TRUE(parser_.ProcessOneEvent(end.Get()));
+  EXPECT_TRUE(parser_.ProcessOneEvent(close.Get()));
+}
+
+TEST_P(KernelLogParserTest, RegistryEvent) {
+  TestEvent open(descriptors::registry::kGuid,
+                 descriptors::registry::kOpen, 2);
+  open.Append<LONGLONG>(0)  // InitialTime.
+      .Append<ULONG>(ERROR_SUCCESS)
+      .Append<ULONG>(0)
+      .AppendPointer(is_64_bit(), 0xE1000200)
+      .AppendString(L"\\REGISTRY\\MACHINE\\SOFTWARE");
+
+  KernelRegistryEvents::RegistryInfo expected;
+  expected.status = ERROR_SUCCESS;
+  expected.index = 0;
+  expected.key_handle = 0xE1000200;
+  expected.key_name = L"\\REGISTRY\\MACHINE\\SOFTWARE";
+
+  EXPECT_CALL(registry_events_,
+              OnRegistryOperation(TestEvent::kProcessId,
+                                  TestEvent::kThreadId,
+                                  _,
+                                  descriptors::registry::kOpen,
+                                  expected));
+  EXPECT_TRUE(parser_.ProcessOneEvent(open.Get()));
+}
+
+TEST_P(KernelLogParserTest, UnhandledRegistryEvent) {
+  TestEvent counters(descriptors::registry::kGuid,
+                     descriptors::registry::kCounters, 2);
+  counters.Append<ULONGLONG>(0);
+  EXPECT_FALSE(parser_.ProcessOneEvent(counters.Get()));
+}
+
+INSTANTIATE_TEST_CASE_P(Bitness, KernelLogParserTest, testing::Bool());
+
 }  // namespace
@@ -175,6 +175,32 @@ bool LogParser::ParseTraceEvent(EVENT_TRACE* event) {
   return false;
 }
 
+HRESULT ConsumeTimeWindow(const std::vector<TRACEHANDLE>& trace_handles,
+                          const base::Time& start_time,
+                          const base::Time& end_time) {
+  DCHECK(!trace_handles.empty());
+  DCHECK(start_time.is_null() || end_time.is_null() || start_time < end_time);
+
+  FILETIME start = {};
+  FILETIME* start_ptr = NULL;
+  if (!start_time.is_null()) {
+    start = start_time.ToFileTime();
+    start_ptr = &start;
+  }
+
+  FILETIME end = {};
+  FILETIME* end_ptr = NULL;
+  if (!end_time.is_null()) {
+    end = end_time.ToFileTime();
+    end_ptr = &end;
+  }
+
+  // ProcessTrace doesn't modify the handles, it's just not const correct.
+  std::vector<TRACEHANDLE> handles(trace_handles);
+  ULONG err = ::ProcessTrace(&handles[0], handles.size(), start_ptr, end_ptr);
+  return HRESULT_FROM_WIN32(err);
+}
+
 LogConsumer* LogConsumer::current_ = NULL;
 
 LogConsumer::LogConsumer() {
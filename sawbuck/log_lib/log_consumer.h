@@ -16,6 +16,7 @@
 #ifndef SAWBUCK_LOG_LIB_LOG_CONSUMER_H_
 #define SAWBUCK_LOG_LIB_LOG_CONSUMER_H_
 
+#include <vector>
 #include "base/time/time.h"
 #include "base/win/event_trace_consumer.h"
 
@@ -103,6 +104,16 @@ class LogParser {
   TraceEvents* trace_event_sink_;
 };
 
+// Consumes the trace sessions in @p trace_handles as
+// EtwTraceConsumerBase::Consume does, but only delivers the events logged
+// from @p start_time through @p end_time. ProcessTrace skips the buffers
+// before the window by their time stamps, and stops consuming past the end
+// of the window. A null time leaves that end of the window open.
+// @note @p end_time must be null when consuming real-time sessions.
+HRESULT ConsumeTimeWindow(const std::vector<TRACEHANDLE>& trace_handles,
+                          const base::Time& start_time,
+                          const base::Time& end_time);
+
 class LogConsumer
     : public base::win::EtwTraceConsumerBase<LogConsumer>,
       public LogParser {
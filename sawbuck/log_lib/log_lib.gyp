@@ -27,14 +27,31 @@
       'target_name': 'log_lib',
       'type': 'static_library',
       'sources': [
+        'descriptors/field.h',
+        'descriptors/fileio.h',
+        'descriptors/image.h',
+        'descriptors/pagefault.h',
+        'descriptors/process.h',
+        'descriptors/registry.h',
+        'descriptors/thread.h',
         'kernel_log_consumer.cc',
         'kernel_log_consumer.h',
         'log_consumer.cc',
         'log_consumer.h',
+        'log_query.cc',
+        'log_query.h',
+        'log_statistics.cc',
+        'log_statistics.h',
         'process_info_service.cc',
         'process_info_service.h',
         'symbol_lookup_service.cc',
         'symbol_lookup_service.h',
+        'task_scheduler.cc',
+        'task_scheduler.h',
+        'template_miner.cc',
+        'template_miner.h',
+        'thread_info_service.cc',
+        'thread_info_service.h',
       ],
       'dependencies': [
         '<(DEPTH)/base/base.gyp:base',
@@ -66,11 +83,17 @@
       'target_name': 'log_lib_unittests',
       'type': 'executable',
       'sources': [
+        'descriptors/descriptors_unittest.cc',
         'kernel_log_consumer_unittest.cc',
         'log_consumer_unittest.cc',
         'log_lib_unittest_main.cc',
+        'log_query_unittest.cc',
+        'log_statistics_unittest.cc',
         'process_info_service_unittest.cc',
         'symbol_lookup_service_unittest.cc',
+        'task_scheduler_unittest.cc',
+        'template_miner_unittest.cc',
+        'thread_info_service_unittest.cc',
       ],
       'dependencies': [
         'log_lib',
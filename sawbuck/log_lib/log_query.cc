@@ -0,0 +1,1002 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log query implementation.
+#include "sawbuck/log_lib/log_query.h"
+
+#include <windows.h>
+#include <wmistr.h>
+#include <evntrace.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+
+namespace {
+
+// The names of the columns, as queries refer to them.
+const char* const kColumnNames[] = {
+  "time",
+  "pid",
+  "tid",
+  "severity",
+  "file",
+  "line",
+  "message",
+  "stack",
+  "count",
+};
+
+struct SeverityName {
+  const char* name;
+  int level;
+};
+
+const SeverityName kSeverityNames[] = {
+  { "fatal", TRACE_LEVEL_FATAL },
+  { "error", TRACE_LEVEL_ERROR },
+  { "warning", TRACE_LEVEL_WARNING },
+  { "info", TRACE_LEVEL_INFORMATION },
+  { "information", TRACE_LEVEL_INFORMATION },
+  { "verbose", TRACE_LEVEL_VERBOSE },
+};
+
+// Plain queries with a limit keep this many rows past their limit before
+// trimming them, to trim once in a while rather than for every batch.
+const size_t kTrimSlack = 1024;
+
+// Keeps the @p rows whose @p numbers compare to @p value as per
+// @p predicate. Each comparison gets a loop of its own, to keep it tight.
+template <typename Predicate>
+void KeepNumbers(const std::vector<int64>& numbers,
+                 int64 value,
+                 Predicate predicate,
+                 std::vector<size_t>* rows) {
+  size_t kept = 0;
+  for (size_t i = 0; i < rows->size(); ++i) {
+    size_t row = (*rows)[i];
+    if (predicate(numbers[row], value))
+      (*rows)[kept++] = row;
+  }
+  rows->resize(kept);
+}
+
+}  // namespace
+
+void LogRowBatch::Clear() {
+  rows.clear();
+  times.clear();
+  process_ids.clear();
+  thread_ids.clear();
+  severities.clear();
+  files.clear();
+  lines.clear();
+  messages.clear();
+  stacks.clear();
+}
+
+LogQueryResult::LogQueryResult() : num_matches_(0) {
+}
+
+LogQueryResult::~LogQueryResult() {
+}
+
+bool LogQueryResult::Value::operator < (const Value& other) const {
+  if (number != other.number)
+    return number < other.number;
+
+  return text < other.text;
+}
+
+bool LogQueryResult::Value::operator == (const Value& other) const {
+  return number == other.number && text == other.text;
+}
+
+// Parses the text of a query, a token at a time.
+class LogQuery::Parser {
+ public:
+  Parser(LogQuery* query, std::string* error)
+      : query_(query), error_(error), next_(0) {
+  }
+
+  bool Parse(const base::StringPiece& text);
+
+ private:
+  struct Token {
+    enum Type {
+      // Keywords, column names and severities, in lower case.
+      WORD,
+      NUMBER,
+      // Quoted strings, without their quotes.
+      STRING,
+      SYMBOL,
+      END,
+    };
+
+    Type type;
+    std::string text;
+  };
+
+  bool Tokenize(const base::StringPiece& text);
+
+  // @returns true iff the next token is the word or symbol @p text, which
+  //     is then consumed.
+  bool Accept(const char* text);
+  // Consumes the word or symbol @p text, or fails.
+  bool Expect(const char* text);
+
+  bool ParseItem(Column* column);
+  bool ParseColumn(Column* column);
+  bool ParseOrderItem();
+
+  // Parse the conditions, by increasing precedence of their operators, and
+  // store the index of the condition parsed to @p condition.
+  bool ParseOr(int* condition);
+  bool ParseAnd(int* condition);
+  bool ParseNot(int* condition);
+  bool ParseComparison(int* condition);
+
+  // Parses a literal of @p column to @p value.
+  bool ParseValue(Column column, Value* value);
+
+  // @returns the index of a new condition combining @p left and @p right.
+  int AddOperator(Condition::Type type, int left, int right);
+  // @returns the index of a new condition comparing @p column to @p value.
+  int AddComparison(Condition::Type type, Column column, const Value& value);
+
+  // Describes the next token for errors.
+  std::string DescribeNext() const;
+  bool Fail(const std::string& expected);
+
+  LogQuery* query_;
+  std::string* error_;
+
+  std::vector<Token> tokens_;
+  // The index of the next token.
+  size_t next_;
+};
+
+bool LogQuery::Parser::Parse(const base::StringPiece& text) {
+  if (!Tokenize(text) || !Expect("select"))
+    return false;
+
+  do {
+    Column column = NUM_COLUMNS;
+    if (!ParseItem(&column))
+      return false;
+    query_->items_.push_back(column);
+  } while (Accept(","));
+
+  if (Accept("where") && !ParseOr(&query_->where_))
+    return false;
+
+  if (Accept("group")) {
+    if (!Expect("by"))
+      return false;
+
+    do {
+      Column column = NUM_COLUMNS;
+      if (!ParseColumn(&column))
+        return false;
+      query_->group_by_.push_back(column);
+    } while (Accept(","));
+  }
+
+  if (Accept("order")) {
+    if (!Expect("by"))
+      return false;
+
+    do {
+      if (!ParseOrderItem())
+        return false;
+    } while (Accept(","));
+  }
+
+  if (Accept("limit")) {
+    const Token& token = tokens_[next_];
+    if (token.type != Token::NUMBER ||
+        !base::StringToInt64(token.text, &query_->limit_)) {
+      return Fail("a limit");
+    }
+    ++next_;
+  }
+
+  if (tokens_[next_].type != Token::END)
+    return Fail("the end of the query");
+
+  // Aggregating queries can only select the columns they group by.
+  if (query_->IsAggregate()) {
+    for (size_t i = 0; i < query_->items_.size(); ++i) {
+      Column column = query_->items_[i];
+      if (column != COUNT &&
+          std::find(query_->group_by_.begin(), query_->group_by_.end(),
+                    column) == query_->group_by_.end()) {
+        *error_ = base::StringPrintf("Column %s must be grouped by.",
+                                     kColumnNames[column]);
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool LogQuery::Parser::Tokenize(const base::StringPiece& text) {
+  size_t i = 0;
+  while (i < text.size()) {
+    char c = text[i];
+    if (IsAsciiWhitespace(c)) {
+      ++i;
+      continue;
+    }
+
+    Token token;
+    size_t start = i;
+    if (IsAsciiAlpha(c) || c == '_') {
+      while (i < text.size() && (IsAsciiAlpha(text[i]) ||
+                                 IsAsciiDigit(text[i]) || text[i] == '_')) {
+        ++i;
+      }
+      token.type = Token::WORD;
+      token.text = StringToLowerASCII(text.substr(start, i - start)
+                                          .as_string());
+    } else if (IsAsciiDigit(c)) {
+      while (i < text.size() && IsAsciiDigit(text[i]))
+        ++i;
+      token.type = Token::NUMBER;
+      token.text = text.substr(start, i - start).as_string();
+    } else if (c == '\'') {
+      // Quotes within strings are doubled.
+      token.type = Token::STRING;
+      ++i;
+      while (true) {
+        if (i == text.size()) {
+          *error_ = "Unterminated string.";
+          return false;
+        }
+        if (text[i] == '\'') {
+          if (i + 1 == text.size() || text[i + 1] != '\'')
+            break;
+          ++i;
+        }
+        token.text.push_back(text[i]);
+        ++i;
+      }
+      ++i;
+    } else {
+      static const char* const kSymbols[] = {
+        "<=", ">=", "!=", "<>", "=", "<", ">", ",", "(", ")", "*",
+      };
+      token.type = Token::SYMBOL;
+      for (size_t j = 0; j < arraysize(kSymbols); ++j) {
+        base::StringPiece symbol(kSymbols[j]);
+        if (text.substr(i, symbol.size()) == symbol) {
+          token.text = symbol.as_string();
+          i += symbol.size();
+          break;
+        }
+      }
+      if (token.text.empty()) {
+        *error_ = base::StringPrintf("Unexpected character '%c'.", c);
+        return false;
+      }
+    }
+
+    tokens_.push_back(token);
+  }
+
+  Token end;
+  end.type = Token::END;
+  tokens_.push_back(end);
+  return true;
+}
+
+bool LogQuery::Parser::Accept(const char* text) {
+  const Token& token = tokens_[next_];
+  if ((token.type != Token::WORD && token.type != Token::SYMBOL) ||
+      token.text != text) {
+    return false;
+  }
+
+  ++next_;
+  return true;
+}
+
+bool LogQuery::Parser::Expect(const char* text) {
+  if (Accept(text))
+    return true;
+
+  return Fail(base::StringPrintf("'%s'", text));
+}
+
+bool LogQuery::Parser::ParseItem(Column* column) {
+  if (!Accept("count"))
+    return ParseColumn(column);
+
+  if (!Expect("(") || !Expect("*") || !Expect(")"))
+    return false;
+
+  *column = COUNT;
+  return true;
+}
+
+bool LogQuery::Parser::ParseColumn(Column* column) {
+  const Token& token = tokens_[next_];
+  if (token.type == Token::WORD) {
+    for (int i = 0; i < COUNT; ++i) {
+      if (token.text == kColumnNames[i]) {
+        *column = static_cast<Column>(i);
+        ++next_;
+        return true;
+      }
+    }
+  }
+
+  return Fail("a column");
+}
+
+bool LogQuery::Parser::ParseOrderItem() {
+  OrderItem order = { 0, true };
+
+  // Items are referred to by their position, or as they're selected.
+  const Token& token = tokens_[next_];
+  if (token.type == Token::NUMBER) {
+    int position = 0;
+    if (!base::StringToInt(token.text, &position) || position < 1 ||
+        static_cast<size_t>(position) > query_->items_.size()) {
+      return Fail("the position of a selected item");
+    }
+    ++next_;
+    order.item = position - 1;
+  } else {
+    Column column = NUM_COLUMNS;
+    if (!ParseItem(&column))
+      return false;
+
+    std::vector<Column>::const_iterator it =
+        std::find(query_->items_.begin(), query_->items_.end(), column);
+    if (it == query_->items_.end()) {
+      *error_ = base::StringPrintf("Can only order by selected items, not %s.",
+                                   kColumnNames[column]);
+      return false;
+    }
+    order.item = it - query_->items_.begin();
+  }
+
+  if (Accept("desc"))
+    order.ascending = false;
+  else
+    Accept("asc");
+
+  query_->order_by_.push_back(order);
+  return true;
+}
+
+bool LogQuery::Parser::ParseOr(int* condition) {
+  if (!ParseAnd(condition))
+    return false;
+
+  while (Accept("or")) {
+    int right = -1;
+    if (!ParseAnd(&right))
+      return false;
+    *condition = AddOperator(Condition::OR, *condition, right);
+  }
+
+  return true;
+}
+
+bool LogQuery::Parser::ParseAnd(int* condition) {
+  if (!ParseNot(condition))
+    return false;
+
+  while (Accept("and")) {
+    int right = -1;
+    if (!ParseNot(&right))
+      return false;
+    *condition = AddOperator(Condition::AND, *condition, right);
+  }
+
+  return true;
+}
+
+bool LogQuery::Parser::ParseNot(int* condition) {
+  if (Accept("not")) {
+    int operand = -1;
+    if (!ParseNot(&operand))
+      return false;
+    *condition = AddOperator(Condition::NOT, operand, -1);
+    return true;
+  }
+
+  if (Accept("("))
+    return ParseOr(condition) && Expect(")");
+
+  return ParseComparison(condition);
+}
+
+bool LogQuery::Parser::ParseComparison(int* condition) {
+  Column column = NUM_COLUMNS;
+  if (!ParseColumn(&column))
+    return false;
+
+  Value value;
+  if (Accept("between")) {
+    Value last;
+    if (!ParseValue(column, &value) || !Expect("and") ||
+        !ParseValue(column, &last)) {
+      return false;
+    }
+
+    *condition = AddOperator(
+        Condition::AND,
+        AddComparison(Condition::GREATER_EQUAL, column, value),
+        AddComparison(Condition::LESS_EQUAL, column, last));
+    return true;
+  }
+
+  if (Accept("contains")) {
+    if (column != FILE && column != MESSAGE) {
+      *error_ = base::StringPrintf("Column %s is not text.",
+                                   kColumnNames[column]);
+      return false;
+    }
+    if (!ParseValue(column, &value))
+      return false;
+
+    *condition = AddComparison(Condition::CONTAINS, column, value);
+    return true;
+  }
+
+  static const struct {
+    const char* symbol;
+    Condition::Type type;
+  } kComparisons[] = {
+    { "=", Condition::EQUAL },
+    { "!=", Condition::NOT_EQUAL },
+    { "<>", Condition::NOT_EQUAL },
+    { "<", Condition::LESS },
+    { "<=", Condition::LESS_EQUAL },
+    { ">", Condition::GREATER },
+    { ">=", Condition::GREATER_EQUAL },
+  };
+  for (size_t i = 0; i < arraysize(kComparisons); ++i) {
+    if (Accept(kComparisons[i].symbol)) {
+      if (!ParseValue(column, &value))
+        return false;
+
+      *condition = AddComparison(kComparisons[i].type, column, value);
+      return true;
+    }
+  }
+
+  return Fail("a comparison");
+}
+
+bool LogQuery::Parser::ParseValue(Column column, Value* value) {
+  const Token& token = tokens_[next_];
+
+  // Severities are named, or given as trace levels.
+  if (column == SEVERITY && token.type == Token::WORD) {
+    for (size_t i = 0; i < arraysize(kSeverityNames); ++i) {
+      if (token.text == kSeverityNames[i].name) {
+        value->number = kSeverityNames[i].level;
+        ++next_;
+        return true;
+      }
+    }
+    return Fail("a severity");
+  }
+
+  switch (column) {
+    case TIME: {
+      base::Time time;
+      if (token.type != Token::STRING ||
+          !base::Time::FromString(token.text.c_str(), &time)) {
+        return Fail("a quoted time");
+      }
+      value->number = time.ToInternalValue();
+      break;
+    }
+
+    case FILE:
+    case MESSAGE:
+      if (token.type != Token::STRING)
+        return Fail("a quoted string");
+      value->text = token.text;
+      break;
+
+    default:
+      if (token.type != Token::NUMBER ||
+          !base::StringToInt64(token.text, &value->number)) {
+        return Fail("a number");
+      }
+      break;
+  }
+
+  ++next_;
+  return true;
+}
+
+int LogQuery::Parser::AddOperator(Condition::Type type, int left, int right) {
+  Condition condition;
+  condition.type = type;
+  condition.left = left;
+  condition.right = right;
+  condition.column = NUM_COLUMNS;
+
+  query_->conditions_.push_back(condition);
+  return query_->conditions_.size() - 1;
+}
+
+int LogQuery::Parser::AddComparison(Condition::Type type,
+                                    Column column,
+                                    const Value& value) {
+  // The more important severities have the lower trace levels, so flip
+  // the comparisons of severities, to compare trace levels.
+  if (column == SEVERITY) {
+    switch (type) {
+      case Condition::LESS: type = Condition::GREATER; break;
+      case Condition::LESS_EQUAL: type = Condition::GREATER_EQUAL; break;
+      case Condition::GREATER: type = Condition::LESS; break;
+      case Condition::GREATER_EQUAL: type = Condition::LESS_EQUAL; break;
+      default: break;
+    }
+  }
+
+  Condition condition;
+  condition.type = type;
+  condition.left = -1;
+  condition.right = -1;
+  condition.column = column;
+  condition.value = value;
+
+  query_->conditions_.push_back(condition);
+  return query_->conditions_.size() - 1;
+}
+
+std::string LogQuery::Parser::DescribeNext() const {
+  const Token& token = tokens_[next_];
+  switch (token.type) {
+    case Token::END:
+      return "the end of the query";
+    case Token::STRING:
+      return "'" + token.text + "'";
+    default:
+      return token.text;
+  }
+}
+
+bool LogQuery::Parser::Fail(const std::string& expected) {
+  *error_ = "Expected " + expected + " but found " + DescribeNext() + ".";
+  return false;
+}
+
+// Orders the rows of results as per the ORDER BY clause, and then by row.
+class LogQuery::RowLess {
+ public:
+  explicit RowLess(const std::vector<OrderItem>& order_by)
+      : order_by_(order_by) {
+  }
+
+  bool operator()(const LogQueryResult::Row& a,
+                  const LogQueryResult::Row& b) const {
+    for (size_t i = 0; i < order_by_.size(); ++i) {
+      const Value& value_a = a.second[order_by_[i].item];
+      const Value& value_b = b.second[order_by_[i].item];
+      if (value_a == value_b)
+        continue;
+
+      return order_by_[i].ascending ? value_a < value_b : value_b < value_a;
+    }
+
+    return a.first < b.first;
+  }
+
+ private:
+  const std::vector<OrderItem>& order_by_;
+};
+
+LogQuery::LogQuery() : limit_(-1), where_(-1) {
+  std::fill(reads_column_, reads_column_ + NUM_COLUMNS, false);
+}
+
+LogQuery::~LogQuery() {
+}
+
+bool LogQuery::Parse(const base::StringPiece& text, std::string* error) {
+  DCHECK(error != NULL);
+
+  *this = LogQuery();
+  Parser parser(this, error);
+  if (!parser.Parse(text)) {
+    *this = LogQuery();
+    return false;
+  }
+
+  for (size_t i = 0; i < items_.size(); ++i)
+    reads_column_[items_[i]] = true;
+  for (size_t i = 0; i < group_by_.size(); ++i)
+    reads_column_[group_by_[i]] = true;
+  for (size_t i = 0; i < conditions_.size(); ++i) {
+    if (conditions_[i].column != NUM_COLUMNS)
+      reads_column_[conditions_[i].column] = true;
+  }
+  reads_column_[COUNT] = false;
+
+  return true;
+}
+
+bool LogQuery::ReadsColumn(Column column) const {
+  DCHECK_LT(column, NUM_COLUMNS);
+  return reads_column_[column];
+}
+
+int64 LogQuery::GetStackId(void* const* traces, size_t depth) {
+  if (depth == 0)
+    return 0;
+
+  // FNV-1a over the frame addresses, kept positive and non-zero.
+  uint64 hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < depth; ++i) {
+    uint64 frame = reinterpret_cast<uintptr_t>(traces[i]);
+    for (size_t byte = 0; byte < sizeof(frame); ++byte) {
+      hash ^= (frame >> (byte * 8)) & 0xFF;
+      hash *= 1099511628211ULL;
+    }
+  }
+
+  int64 id = static_cast<int64>(hash & kint64max);
+  return id != 0 ? id : 1;
+}
+
+bool LogQuery::GetTimeSpan(base::Time* earliest, base::Time* end) const {
+  DCHECK(earliest != NULL);
+  DCHECK(end != NULL);
+
+  *earliest = base::Time();
+  *end = base::Time();
+  if (where_ != -1)
+    AddTimeSpan(where_, earliest, end);
+
+  return earliest->is_null() || end->is_null() || *earliest < *end;
+}
+
+void LogQuery::AddTimeSpan(int index,
+                           base::Time* earliest,
+                           base::Time* end) const {
+  const Condition& condition = conditions_[index];
+  if (condition.type == Condition::AND) {
+    AddTimeSpan(condition.left, earliest, end);
+    AddTimeSpan(condition.right, earliest, end);
+    return;
+  }
+
+  // Only the conditions all rows must meet bound the span.
+  if (condition.column != TIME)
+    return;
+
+  int64 from = -1;
+  int64 to = -1;
+  int64 value = condition.value.number;
+  switch (condition.type) {
+    case Condition::EQUAL: from = value; to = value + 1; break;
+    case Condition::LESS: to = value; break;
+    case Condition::LESS_EQUAL: to = value + 1; break;
+    case Condition::GREATER: from = value + 1; break;
+    case Condition::GREATER_EQUAL: from = value; break;
+    default: break;
+  }
+
+  if (from != -1 && (earliest->is_null() ||
+                     from > earliest->ToInternalValue())) {
+    *earliest = base::Time::FromInternalValue(from);
+  }
+  if (to != -1 && (end->is_null() || to < end->ToInternalValue()))
+    *end = base::Time::FromInternalValue(to);
+}
+
+void LogQuery::Execute(const LogRowBatch& batch,
+                       LogQueryResult* result) const {
+  DCHECK(result != NULL);
+
+  std::vector<size_t> rows(batch.size());
+  for (size_t i = 0; i < rows.size(); ++i)
+    rows[i] = i;
+  if (where_ != -1)
+    Select(where_, batch, &rows);
+
+  result->num_matches_ += rows.size();
+
+  if (IsAggregate()) {
+    Values key(group_by_.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+      for (size_t j = 0; j < group_by_.size(); ++j)
+        GetValue(batch, group_by_[j], rows[i], &key[j]);
+      ++result->groups_[key];
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    result->rows_.push_back(
+        LogQueryResult::Row(batch.rows[rows[i]], Values(items_.size())));
+    Values& values = result->rows_.back().second;
+    for (size_t j = 0; j < items_.size(); ++j)
+      GetValue(batch, items_[j], rows[i], &values[j]);
+  }
+  TrimRows(result);
+}
+
+void LogQuery::Merge(const LogQueryResult& from, LogQueryResult* into) const {
+  DCHECK(into != NULL);
+
+  into->num_matches_ += from.num_matches_;
+
+  LogQueryResult::GroupMap::const_iterator it(from.groups_.begin());
+  for (; it != from.groups_.end(); ++it)
+    into->groups_[it->first] += it->second;
+
+  into->rows_.insert(into->rows_.end(), from.rows_.begin(), from.rows_.end());
+  TrimRows(into);
+}
+
+void LogQuery::GetTable(const LogQueryResult& result,
+                        std::vector<std::vector<std::string> >* table) const {
+  DCHECK(table != NULL);
+
+  std::vector<LogQueryResult::Row> rows;
+  GetRows(result, &rows);
+
+  table->clear();
+  table->resize(rows.size() + 1);
+  for (size_t i = 0; i < items_.size(); ++i)
+    (*table)[0].push_back(kColumnNames[items_[i]]);
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    for (size_t j = 0; j < items_.size(); ++j)
+      (*table)[i + 1].push_back(FormatValue(items_[j], rows[i].second[j]));
+  }
+}
+
+std::string LogQuery::Format(const LogQueryResult& result) const {
+  std::vector<std::vector<std::string> > table;
+  GetTable(result, &table);
+
+  std::vector<size_t> widths(items_.size());
+  for (size_t i = 0; i < table.size(); ++i) {
+    for (size_t j = 0; j < table[i].size(); ++j)
+      widths[j] = std::max(widths[j], table[i][j].size());
+  }
+
+  std::string text;
+  for (size_t i = 0; i < table.size(); ++i) {
+    for (size_t j = 0; j < table[i].size(); ++j) {
+      text += table[i][j];
+      // Pad all but the last column.
+      if (j + 1 < table[i].size())
+        text.append(widths[j] - table[i][j].size() + 2, ' ');
+    }
+    text += "\n";
+  }
+
+  return text;
+}
+
+bool LogQuery::IsAggregate() const {
+  return !group_by_.empty() ||
+      std::find(items_.begin(), items_.end(), COUNT) != items_.end();
+}
+
+void LogQuery::Select(int index,
+                      const LogRowBatch& batch,
+                      std::vector<size_t>* rows) const {
+  const Condition& condition = conditions_[index];
+  switch (condition.type) {
+    case Condition::AND:
+      Select(condition.left, batch, rows);
+      Select(condition.right, batch, rows);
+      return;
+
+    case Condition::OR: {
+      // Only the rows the left doesn't match need the right.
+      std::vector<size_t> left(*rows);
+      Select(condition.left, batch, &left);
+      std::vector<size_t> right;
+      std::set_difference(rows->begin(), rows->end(),
+                          left.begin(), left.end(),
+                          std::back_inserter(right));
+      Select(condition.right, batch, &right);
+
+      rows->clear();
+      std::merge(left.begin(), left.end(), right.begin(), right.end(),
+                 std::back_inserter(*rows));
+      return;
+    }
+
+    case Condition::NOT: {
+      std::vector<size_t> matches(*rows);
+      Select(condition.left, batch, &matches);
+      std::vector<size_t> rest;
+      std::set_difference(rows->begin(), rows->end(),
+                          matches.begin(), matches.end(),
+                          std::back_inserter(rest));
+      rows->swap(rest);
+      return;
+    }
+
+    default:
+      break;
+  }
+
+  const std::vector<int64>* numbers = GetNumbers(batch, condition.column);
+  if (numbers != NULL) {
+    int64 value = condition.value.number;
+    switch (condition.type) {
+      case Condition::EQUAL:
+        KeepNumbers(*numbers, value, std::equal_to<int64>(), rows);
+        break;
+      case Condition::NOT_EQUAL:
+        KeepNumbers(*numbers, value, std::not_equal_to<int64>(), rows);
+        break;
+      case Condition::LESS:
+        KeepNumbers(*numbers, value, std::less<int64>(), rows);
+        break;
+      case Condition::LESS_EQUAL:
+        KeepNumbers(*numbers, value, std::less_equal<int64>(), rows);
+        break;
+      case Condition::GREATER:
+        KeepNumbers(*numbers, value, std::greater<int64>(), rows);
+        break;
+      case Condition::GREATER_EQUAL:
+        KeepNumbers(*numbers, value, std::greater_equal<int64>(), rows);
+        break;
+      default:
+        NOTREACHED() << "Invalid comparison of numbers.";
+        break;
+    }
+    return;
+  }
+
+  const std::vector<std::string>& texts =
+      condition.column == FILE ? batch.files : batch.messages;
+  const std::string& value = condition.value.text;
+  size_t kept = 0;
+  for (size_t i = 0; i < rows->size(); ++i) {
+    size_t row = (*rows)[i];
+    const std::string& text = texts[row];
+
+    bool matches = false;
+    if (condition.type == Condition::CONTAINS) {
+      matches = text.find(value) != std::string::npos;
+    } else {
+      int order = text.compare(value);
+      switch (condition.type) {
+        case Condition::EQUAL: matches = order == 0; break;
+        case Condition::NOT_EQUAL: matches = order != 0; break;
+        case Condition::LESS: matches = order < 0; break;
+        case Condition::LESS_EQUAL: matches = order <= 0; break;
+        case Condition::GREATER: matches = order > 0; break;
+        case Condition::GREATER_EQUAL: matches = order >= 0; break;
+        default: break;
+      }
+    }
+
+    if (matches)
+      (*rows)[kept++] = row;
+  }
+  rows->resize(kept);
+}
+
+void LogQuery::GetValue(const LogRowBatch& batch,
+                        Column column,
+                        size_t row,
+                        Value* value) {
+  if (column == FILE) {
+    value->text = batch.files[row];
+  } else if (column == MESSAGE) {
+    value->text = batch.messages[row];
+  } else {
+    value->number = (*GetNumbers(batch, column))[row];
+    // Order the severities by importance, like their comparisons.
+    if (column == SEVERITY)
+      value->number = -value->number;
+  }
+}
+
+const std::vector<int64>* LogQuery::GetNumbers(const LogRowBatch& batch,
+                                               Column column) {
+  switch (column) {
+    case TIME: return &batch.times;
+    case PROCESS_ID: return &batch.process_ids;
+    case THREAD_ID: return &batch.thread_ids;
+    case SEVERITY: return &batch.severities;
+    case LINE: return &batch.lines;
+    case STACK: return &batch.stacks;
+    default: return NULL;
+  }
+}
+
+void LogQuery::TrimRows(LogQueryResult* result) const {
+  if (limit_ < 0 ||
+      result->rows_.size() <= static_cast<size_t>(limit_) + kTrimSlack) {
+    return;
+  }
+
+  std::sort(result->rows_.begin(), result->rows_.end(), RowLess(order_by_));
+  result->rows_.resize(static_cast<size_t>(limit_));
+}
+
+void LogQuery::GetRows(const LogQueryResult& result,
+                       std::vector<LogQueryResult::Row>* rows) const {
+  if (IsAggregate()) {
+    // The groups are numbered in the order of their keys, to break ties.
+    int64 number = 0;
+    LogQueryResult::GroupMap::const_iterator it(result.groups_.begin());
+    for (; it != result.groups_.end(); ++it, ++number) {
+      rows->push_back(LogQueryResult::Row(number, Values(items_.size())));
+      Values& values = rows->back().second;
+      for (size_t i = 0; i < items_.size(); ++i) {
+        if (items_[i] == COUNT) {
+          values[i].number = it->second;
+        } else {
+          size_t key = std::find(group_by_.begin(), group_by_.end(),
+                                 items_[i]) - group_by_.begin();
+          values[i] = it->first[key];
+        }
+      }
+    }
+  } else {
+    *rows = result.rows_;
+  }
+
+  std::sort(rows->begin(), rows->end(), RowLess(order_by_));
+  if (limit_ >= 0 && rows->size() > static_cast<size_t>(limit_))
+    rows->resize(static_cast<size_t>(limit_));
+}
+
+std::string LogQuery::FormatValue(Column column, const Value& value) {
+  switch (column) {
+    case TIME: {
+      base::Time::Exploded exploded = {};
+      base::Time::FromInternalValue(value.number).LocalExplode(&exploded);
+      // As base::Time::FromString parses it back.
+      return base::StringPrintf("%04d-%02d-%02d %02d:%02d:%02d.%03d",
+                                exploded.year,
+                                exploded.month,
+                                exploded.day_of_month,
+                                exploded.hour,
+                                exploded.minute,
+                                exploded.second,
+                                exploded.millisecond);
+    }
+
+    case SEVERITY:
+      for (size_t i = 0; i < arraysize(kSeverityNames); ++i) {
+        if (kSeverityNames[i].level == -value.number)
+          return StringToUpperASCII(std::string(kSeverityNames[i].name));
+      }
+      return base::Int64ToString(-value.number);
+
+    case FILE:
+    case MESSAGE:
+      return value.text;
+
+    default:
+      return base::Int64ToString(value.number);
+  }
+}
@@ -0,0 +1,251 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log query declaration.
+#ifndef SAWBUCK_LOG_LIB_LOG_QUERY_H_
+#define SAWBUCK_LOG_LIB_LOG_QUERY_H_
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+
+// A batch of log rows, stored by column. Only the columns a query reads
+// need to be filled in, and all those have one value per row.
+struct LogRowBatch {
+  // Forgets all rows.
+  void Clear();
+
+  size_t size() const { return rows.size(); }
+
+  // The number of each row in its log, which orders the rows of plain
+  // queries that don't order them otherwise.
+  std::vector<int64> rows;
+
+  // The internal values of the times of the rows.
+  std::vector<int64> times;
+  std::vector<int64> process_ids;
+  std::vector<int64> thread_ids;
+  // The trace levels of the rows.
+  std::vector<int64> severities;
+  std::vector<std::string> files;
+  std::vector<int64> lines;
+  std::vector<std::string> messages;
+  // The ids of the stack traces of the rows, see LogQuery::GetStackId.
+  std::vector<int64> stacks;
+};
+
+class LogQuery;
+
+// The partial result of a query over some batches of rows. The partial
+// results of separate chunks of a log can be merged in any order.
+class LogQueryResult {
+ public:
+  LogQueryResult();
+  ~LogQueryResult();
+
+  // The number of rows that matched the query so far.
+  int64 num_matches() const { return num_matches_; }
+
+ private:
+  friend class LogQuery;
+
+  // A column value, numeric or text depending on its column.
+  struct Value {
+    Value() : number(0) {
+    }
+
+    int64 number;
+    std::string text;
+
+    bool operator < (const Value& other) const;
+    bool operator == (const Value& other) const;
+  };
+  typedef std::vector<Value> Values;
+
+  // The row counts of aggregating queries, keyed by the values of the
+  // columns grouped by.
+  typedef std::map<Values, int64> GroupMap;
+  GroupMap groups_;
+
+  // The selected values of plain queries, with their row numbers.
+  typedef std::pair<int64, Values> Row;
+  std::vector<Row> rows_;
+
+  int64 num_matches_;
+};
+
+// A query over the rows of a log, in a small subset of SQL:
+//
+//   SELECT <item>, ... [WHERE <condition>] [GROUP BY <column>, ...]
+//       [ORDER BY <item> [ASC|DESC], ...] [LIMIT <count>]
+//
+// The columns are time, pid, tid, severity, file, line, message and stack,
+// and an item is a column or COUNT(*). Conditions compare a column to a literal
+// with =, !=, <>, <, <=, > or >=, check a range with BETWEEN ... AND ...,
+// or look for a substring with CONTAINS, and combine with AND, OR, NOT and
+// parentheses. Times are quoted as base::Time::FromString accepts them,
+// severities are ERROR, WARNING and the like, and compare by importance,
+// so that "severity >= WARNING" matches warnings and errors.
+//
+// The rows are evaluated in batches, a column at a time, narrowing the
+// rows that remain for each condition, which keeps the inner loops tight.
+// Queries are immutable once parsed, so that the batches of a log can be
+// evaluated in parallel, each into its own partial result.
+class LogQuery {
+ public:
+  enum Column {
+    TIME,
+    PROCESS_ID,
+    THREAD_ID,
+    SEVERITY,
+    FILE,
+    LINE,
+    MESSAGE,
+    // The id of the stack trace of a row.
+    STACK,
+    // The number of rows of a group, only valid as a selected item.
+    COUNT,
+    NUM_COLUMNS
+  };
+
+  LogQuery();
+  ~LogQuery();
+
+  // Parses @p text into this query.
+  // @returns true on success, otherwise false with a description of the
+  //     problem in @p error.
+  bool Parse(const base::StringPiece& text, std::string* error);
+
+  // @returns true iff the query reads @p column from the rows.
+  bool ReadsColumn(Column column) const;
+
+  // @returns the id of the stack trace of @p depth frames at @p traces,
+  //     which is a hash of its frames, or zero for an empty trace.
+  static int64 GetStackId(void* const* traces, size_t depth);
+
+  // Retrieves the span of time the rows must be logged in to match, as
+  // implied by the conditions on the time all rows must meet. This lets
+  // callers skip the rows outside the span without reading them.
+  // @param earliest receives the earliest time, or null if unbounded.
+  // @param end receives the time before which the rows must be logged, or
+  //     null if unbounded.
+  // @returns false iff the span is empty, so that no row can match.
+  bool GetTimeSpan(base::Time* earliest, base::Time* end) const;
+
+  // Adds the rows of @p batch that match to @p result.
+  void Execute(const LogRowBatch& batch, LogQueryResult* result) const;
+
+  // Adds the partial result @p from to @p into.
+  void Merge(const LogQueryResult& from, LogQueryResult* into) const;
+
+  // Retrieves the ordered and limited rows of @p result, as text,
+  // headed by the names of the selected items.
+  void GetTable(const LogQueryResult& result,
+                std::vector<std::vector<std::string> >* table) const;
+
+  // @returns the rows of @p result as a table of text, with aligned
+  //     columns and a line per row.
+  std::string Format(const LogQueryResult& result) const;
+
+ private:
+  class Parser;
+  class RowLess;
+  typedef LogQueryResult::Value Value;
+  typedef LogQueryResult::Values Values;
+
+  // A node of the condition tree.
+  struct Condition {
+    enum Type {
+      AND,
+      OR,
+      NOT,
+      EQUAL,
+      NOT_EQUAL,
+      LESS,
+      LESS_EQUAL,
+      GREATER,
+      GREATER_EQUAL,
+      CONTAINS,
+    };
+
+    Type type;
+    // The operands of AND, OR and NOT, as indexes into conditions_.
+    int left;
+    int right;
+    // The column and the value the other types compare.
+    Column column;
+    Value value;
+  };
+
+  struct OrderItem {
+    // The index of the item in items_.
+    size_t item;
+    bool ascending;
+  };
+
+  // @returns true iff we count rows by groups.
+  bool IsAggregate() const;
+
+  // Keeps the @p rows of @p batch that meet @p condition.
+  // @param rows the indexes of the rows in the batch, in increasing order.
+  void Select(int condition,
+              const LogRowBatch& batch,
+              std::vector<size_t>* rows) const;
+
+  // Retrieves the value of @p column in @p row of @p batch.
+  static void GetValue(const LogRowBatch& batch,
+                       Column column,
+                       size_t row,
+                       Value* value);
+
+  // @returns the numbers of @p column of @p batch, or NULL if the column
+  //     is not numeric.
+  static const std::vector<int64>* GetNumbers(const LogRowBatch& batch,
+                                              Column column);
+
+  // Adds the span of time of @p condition, if it constrains the time.
+  void AddTimeSpan(int condition, base::Time* earliest, base::Time* end) const;
+
+  // Drops the rows of @p result past the limit, once they grow enough.
+  void TrimRows(LogQueryResult* result) const;
+
+  // Retrieves the values of the selected items of all result rows, ordered.
+  void GetRows(const LogQueryResult& result,
+               std::vector<LogQueryResult::Row>* rows) const;
+
+  // @returns @p value of @p column as text.
+  static std::string FormatValue(Column column, const Value& value);
+
+  // The selected items.
+  std::vector<Column> items_;
+  // The columns grouped by.
+  std::vector<Column> group_by_;
+  std::vector<OrderItem> order_by_;
+  // The maximum number of rows of the result, or -1 for all rows.
+  int64 limit_;
+
+  // The conditions of the query, and the index of the root of the WHERE
+  // clause, or -1 if there's none.
+  std::vector<Condition> conditions_;
+  int where_;
+
+  // The columns read by the query.
+  bool reads_column_[NUM_COLUMNS];
+};
+
+#endif  // SAWBUCK_LOG_LIB_LOG_QUERY_H_
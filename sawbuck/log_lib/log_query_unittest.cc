@@ -0,0 +1,311 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log query unittests.
+#include "sawbuck/log_lib/log_query.h"
+
+#include <windows.h>
+#include <wmistr.h>
+#include <evntrace.h>
+#include "base/strings/string_number_conversions.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+typedef std::vector<std::vector<std::string> > Table;
+
+class LogQueryTest: public testing::Test {
+ public:
+  LogQueryTest() : kT0(base::Time::FromTimeT(1300000000)) {
+  }
+
+ protected:
+  // Adds a row, numbered by its position, to batch_.
+  void AddRow(int64 ms, DWORD pid, int severity, const char* file, int line,
+              const char* message) {
+    batch_.rows.push_back(batch_.size());
+    batch_.times.push_back(
+        (kT0 + base::TimeDelta::FromMilliseconds(ms)).ToInternalValue());
+    batch_.process_ids.push_back(pid);
+    batch_.thread_ids.push_back(pid + 1);
+    batch_.severities.push_back(severity);
+    batch_.files.push_back(file);
+    batch_.lines.push_back(line);
+    batch_.messages.push_back(message);
+  }
+
+  void AddRows() {
+    AddRow(0, 10, TRACE_LEVEL_ERROR, "a.cc", 1, "open failed");
+    AddRow(1, 10, TRACE_LEVEL_INFORMATION, "a.cc", 2, "opened file");
+    AddRow(2, 20, TRACE_LEVEL_WARNING, "b.cc", 5, "slow read");
+    AddRow(3, 20, TRACE_LEVEL_VERBOSE, "b.cc", 6, "read 10 bytes");
+    AddRow(4, 10, TRACE_LEVEL_ERROR, "a.cc", 1, "open failed");
+    AddRow(5, 30, TRACE_LEVEL_FATAL, "c.cc", 9, "out of memory");
+  }
+
+  // Runs @p text over batch_ to @p table.
+  void Run(const char* text, Table* table) {
+    LogQuery query;
+    std::string error;
+    ASSERT_TRUE(query.Parse(text, &error)) << error;
+
+    LogQueryResult result;
+    query.Execute(batch_, &result);
+    query.GetTable(result, table);
+  }
+
+  const base::Time kT0;
+  LogRowBatch batch_;
+};
+
+TEST_F(LogQueryTest, ParseErrors) {
+  const char* const kInvalid[] = {
+    "",
+    "SELECT",
+    "select pid from",
+    "SELECT bogus",
+    "SELECT pid WHERE",
+    "SELECT pid WHERE pid = 'text'",
+    "SELECT pid WHERE message = 12",
+    "SELECT pid WHERE pid CONTAINS 'x'",
+    "SELECT pid WHERE message = 'unterminated",
+    "SELECT pid WHERE (pid = 1",
+    "SELECT pid, COUNT(*)",
+    "SELECT pid ORDER BY tid",
+    "SELECT pid ORDER BY 2",
+    "SELECT pid LIMIT many",
+    "SELECT pid; DROP",
+  };
+
+  for (size_t i = 0; i < arraysize(kInvalid); ++i) {
+    LogQuery query;
+    std::string error;
+    EXPECT_FALSE(query.Parse(kInvalid[i], &error)) << kInvalid[i];
+    EXPECT_FALSE(error.empty()) << kInvalid[i];
+  }
+}
+
+TEST_F(LogQueryTest, ReadsOnlyItsColumns) {
+  LogQuery query;
+  std::string error;
+  ASSERT_TRUE(query.Parse(
+      "select file, count(*) where pid = 10 group by file", &error));
+
+  EXPECT_TRUE(query.ReadsColumn(LogQuery::FILE));
+  EXPECT_TRUE(query.ReadsColumn(LogQuery::PROCESS_ID));
+  EXPECT_FALSE(query.ReadsColumn(LogQuery::TIME));
+  EXPECT_FALSE(query.ReadsColumn(LogQuery::MESSAGE));
+}
+
+TEST_F(LogQueryTest, SelectsRows) {
+  AddRows();
+
+  Table table;
+  Run("SELECT pid, line, message WHERE file = 'a.cc' AND line < 2", &table);
+  ASSERT_EQ(3U, table.size());
+  EXPECT_EQ("pid", table[0][0]);
+  EXPECT_EQ("message", table[0][2]);
+  EXPECT_EQ("10", table[1][0]);
+  EXPECT_EQ("open failed", table[1][2]);
+  EXPECT_EQ("open failed", table[2][2]);
+
+  Run("SELECT line WHERE message CONTAINS 'read' OR pid = 30", &table);
+  ASSERT_EQ(4U, table.size());
+  EXPECT_EQ("5", table[1][0]);
+  EXPECT_EQ("6", table[2][0]);
+  EXPECT_EQ("9", table[3][0]);
+
+  Run("SELECT line WHERE NOT (pid = 10 OR pid = 20)", &table);
+  ASSERT_EQ(2U, table.size());
+  EXPECT_EQ("9", table[1][0]);
+
+  Run("SELECT line WHERE line BETWEEN 2 AND 5 ORDER BY line DESC LIMIT 1",
+      &table);
+  ASSERT_EQ(2U, table.size());
+  EXPECT_EQ("5", table[1][0]);
+}
+
+TEST_F(LogQueryTest, ComparesSeveritiesByImportance) {
+  AddRows();
+
+  Table table;
+  Run("SELECT severity WHERE severity >= warning", &table);
+  ASSERT_EQ(5U, table.size());
+  EXPECT_EQ("ERROR", table[1][0]);
+  EXPECT_EQ("WARNING", table[2][0]);
+  EXPECT_EQ("ERROR", table[3][0]);
+  EXPECT_EQ("FATAL", table[4][0]);
+
+  Run("SELECT line WHERE severity < INFO", &table);
+  ASSERT_EQ(2U, table.size());
+  EXPECT_EQ("6", table[1][0]);
+
+  Run("SELECT severity, COUNT(*) GROUP BY severity ORDER BY 1 DESC", &table);
+  ASSERT_EQ(6U, table.size());
+  EXPECT_EQ("FATAL", table[1][0]);
+  EXPECT_EQ("ERROR", table[2][0]);
+  EXPECT_EQ("2", table[2][1]);
+  EXPECT_EQ("VERBOSE", table[5][0]);
+}
+
+TEST_F(LogQueryTest, CountsGroups) {
+  AddRows();
+
+  Table table;
+  Run("SELECT COUNT(*)", &table);
+  ASSERT_EQ(2U, table.size());
+  EXPECT_EQ("count", table[0][0]);
+  EXPECT_EQ("6", table[1][0]);
+
+  Run("SELECT file, line, COUNT(*) WHERE pid != 30 GROUP BY file, line "
+      "ORDER BY COUNT(*) DESC, file LIMIT 2", &table);
+  ASSERT_EQ(3U, table.size());
+  EXPECT_EQ("a.cc", table[1][0]);
+  EXPECT_EQ("1", table[1][1]);
+  EXPECT_EQ("2", table[1][2]);
+  EXPECT_EQ("a.cc", table[2][0]);
+  EXPECT_EQ("2", table[2][1]);
+  EXPECT_EQ("1", table[2][2]);
+}
+
+TEST_F(LogQueryTest, GroupsByStack) {
+  void* const kStackA[] = { reinterpret_cast<void*>(0x1000),
+                            reinterpret_cast<void*>(0x2000) };
+  void* const kStackB[] = { reinterpret_cast<void*>(0x2000),
+                            reinterpret_cast<void*>(0x1000) };
+  const int64 kIdA = LogQuery::GetStackId(kStackA, arraysize(kStackA));
+  const int64 kIdB = LogQuery::GetStackId(kStackB, arraysize(kStackB));
+  EXPECT_EQ(0, LogQuery::GetStackId(NULL, 0));
+  EXPECT_LT(0, kIdA);
+  EXPECT_LT(0, kIdB);
+  EXPECT_NE(kIdA, kIdB);
+  EXPECT_EQ(kIdA, LogQuery::GetStackId(kStackA, arraysize(kStackA)));
+
+  AddRows();
+  const int64 kStacks[] = { kIdA, 0, kIdB, 0, kIdA, kIdA };
+  batch_.stacks.assign(kStacks, kStacks + arraysize(kStacks));
+
+  Table table;
+  Run("SELECT stack, COUNT(*) WHERE stack != 0 GROUP BY stack "
+      "ORDER BY 2 DESC", &table);
+  ASSERT_EQ(3U, table.size());
+  EXPECT_EQ("stack", table[0][0]);
+  EXPECT_EQ(base::Int64ToString(kIdA), table[1][0]);
+  EXPECT_EQ("3", table[1][1]);
+  EXPECT_EQ(base::Int64ToString(kIdB), table[2][0]);
+  EXPECT_EQ("1", table[2][1]);
+}
+
+TEST_F(LogQueryTest, GetsTimeSpan) {
+  LogQuery query;
+  std::string error;
+  ASSERT_TRUE(query.Parse("SELECT pid WHERE pid = 1", &error));
+
+  base::Time earliest;
+  base::Time end;
+  EXPECT_TRUE(query.GetTimeSpan(&earliest, &end));
+  EXPECT_TRUE(earliest.is_null());
+  EXPECT_TRUE(end.is_null());
+
+  const char kFrom[] = "Tue, 15 Nov 1994 12:45:26 GMT";
+  const char kTo[] = "Tue, 15 Nov 1994 12:46:26 GMT";
+  base::Time from;
+  base::Time to;
+  ASSERT_TRUE(base::Time::FromString(kFrom, &from));
+  ASSERT_TRUE(base::Time::FromString(kTo, &to));
+
+  ASSERT_TRUE(query.Parse(std::string("SELECT pid WHERE pid = 1 AND time "
+                                      "BETWEEN '") + kFrom + "' AND '" +
+                          kTo + "'", &error)) << error;
+  EXPECT_TRUE(query.GetTimeSpan(&earliest, &end));
+  EXPECT_EQ(from, earliest);
+  EXPECT_EQ(to + base::TimeDelta::FromMicroseconds(1), end);
+
+  // Alternatives don't bound the span.
+  ASSERT_TRUE(query.Parse(std::string("SELECT pid WHERE pid = 1 OR time < '") +
+                          kTo + "'", &error)) << error;
+  EXPECT_TRUE(query.GetTimeSpan(&earliest, &end));
+  EXPECT_TRUE(earliest.is_null());
+  EXPECT_TRUE(end.is_null());
+}
+
+TEST_F(LogQueryTest, GetsEmptyTimeSpan) {
+  const char kFrom[] = "Tue, 15 Nov 1994 12:45:26 GMT";
+  const char kTo[] = "Tue, 15 Nov 1994 12:46:26 GMT";
+  LogQuery query;
+  std::string error;
+  base::Time earliest;
+  base::Time end;
+
+  ASSERT_TRUE(query.Parse(std::string("SELECT pid WHERE time > '") + kFrom +
+                          "' AND time < '" + kFrom + "'", &error)) << error;
+  EXPECT_FALSE(query.GetTimeSpan(&earliest, &end));
+  EXPECT_LE(end, earliest);
+
+  ASSERT_TRUE(query.Parse(std::string("SELECT pid WHERE time BETWEEN '") +
+                          kTo + "' AND '" + kFrom + "'", &error)) << error;
+  EXPECT_FALSE(query.GetTimeSpan(&earliest, &end));
+  EXPECT_LE(end, earliest);
+
+  // A single instant is not empty.
+  ASSERT_TRUE(query.Parse(std::string("SELECT pid WHERE time >= '") + kFrom +
+                          "' AND time <= '" + kFrom + "'", &error)) << error;
+  EXPECT_TRUE(query.GetTimeSpan(&earliest, &end));
+  EXPECT_EQ(earliest + base::TimeDelta::FromMicroseconds(1), end);
+}
+
+TEST_F(LogQueryTest, MergesLikeExecuting) {
+  const char* const kQueries[] = {
+    "SELECT pid, COUNT(*) GROUP BY pid",
+    "SELECT line, message WHERE severity <= info",
+    "SELECT line WHERE pid = 10 ORDER BY line DESC LIMIT 2",
+  };
+
+  AddRows();
+  LogRowBatch all(batch_);
+  LogRowBatch first;
+  LogRowBatch second;
+  for (size_t i = 0; i < all.size(); ++i) {
+    LogRowBatch& half = i < 2 ? first : second;
+    half.rows.push_back(all.rows[i]);
+    half.times.push_back(all.times[i]);
+    half.process_ids.push_back(all.process_ids[i]);
+    half.thread_ids.push_back(all.thread_ids[i]);
+    half.severities.push_back(all.severities[i]);
+    half.files.push_back(all.files[i]);
+    half.lines.push_back(all.lines[i]);
+    half.messages.push_back(all.messages[i]);
+  }
+
+  for (size_t i = 0; i < arraysize(kQueries); ++i) {
+    LogQuery query;
+    std::string error;
+    ASSERT_TRUE(query.Parse(kQueries[i], &error)) << error;
+
+    LogQueryResult whole;
+    query.Execute(all, &whole);
+
+    // Merge the halves in reverse.
+    LogQueryResult merged;
+    LogQueryResult part;
+    query.Execute(second, &merged);
+    query.Execute(first, &part);
+    query.Merge(part, &merged);
+
+    EXPECT_EQ(whole.num_matches(), merged.num_matches()) << kQueries[i];
+    EXPECT_EQ(query.Format(whole), query.Format(merged)) << kQueries[i];
+  }
+}
+
+}  // namespace
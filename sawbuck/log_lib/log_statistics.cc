@@ -0,0 +1,156 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log statistics implementation.
+#include "sawbuck/log_lib/log_statistics.h"
+
+#include <algorithm>
+#include "base/logging.h"
+
+namespace {
+
+bool ByDecreasingCount(const LogStatistics::Group& a,
+                       const LogStatistics::Group& b) {
+  if (a.count != b.count)
+    return a.count > b.count;
+
+  // Break ties on the key for a stable order.
+  return a.key < b.key;
+}
+
+}  // namespace
+
+LogStatistics::Key::Key()
+    : process_id(0), thread_id(0), severity(0), line(0), template_id(0) {
+}
+
+bool LogStatistics::Key::operator < (const Key& other) const {
+  if (bucket != other.bucket)
+    return bucket < other.bucket;
+  if (process_id != other.process_id)
+    return process_id < other.process_id;
+  if (thread_id != other.thread_id)
+    return thread_id < other.thread_id;
+  if (severity != other.severity)
+    return severity < other.severity;
+  if (line != other.line)
+    return line < other.line;
+  if (template_id != other.template_id)
+    return template_id < other.template_id;
+
+  return file < other.file;
+}
+
+bool LogStatistics::Key::operator == (const Key& other) const {
+  return bucket == other.bucket &&
+         process_id == other.process_id &&
+         thread_id == other.thread_id &&
+         severity == other.severity &&
+         line == other.line &&
+         template_id == other.template_id &&
+         file == other.file;
+}
+
+LogStatistics::LogStatistics(int group_by, base::TimeDelta bucket_size)
+    : group_by_(group_by), bucket_size_(bucket_size), num_messages_(0) {
+  DCHECK(bucket_size_ >= base::TimeDelta());
+}
+
+LogStatistics::~LogStatistics() {
+}
+
+void LogStatistics::AddMessage(DWORD process_id,
+                               DWORD thread_id,
+                               int severity,
+                               const base::Time& time,
+                               const base::StringPiece& file,
+                               int line,
+                               int template_id) {
+  Key key;
+  if (group_by_ & GROUP_BY_PROCESS)
+    key.process_id = process_id;
+  if (group_by_ & GROUP_BY_THREAD)
+    key.thread_id = thread_id;
+  if (group_by_ & GROUP_BY_SEVERITY)
+    key.severity = severity;
+  if (group_by_ & GROUP_BY_FILE_LINE) {
+    file.CopyToString(&key.file);
+    key.line = line;
+  }
+  if (group_by_ & GROUP_BY_TEMPLATE)
+    key.template_id = template_id;
+  if (bucket_size_ > base::TimeDelta()) {
+    // Round down to the start of the bucket.
+    int64 since_epoch = (time - base::Time()).InMicroseconds();
+    int64 offset = since_epoch % bucket_size_.InMicroseconds();
+    key.bucket = time - base::TimeDelta::FromMicroseconds(offset);
+  }
+
+  Counts counts = { 1, time, time };
+  AddCounts(key, counts);
+  ++num_messages_;
+}
+
+void LogStatistics::Merge(const LogStatistics& other) {
+  DCHECK_EQ(group_by_, other.group_by_);
+  DCHECK(bucket_size_ == other.bucket_size_);
+
+  GroupMap::const_iterator it(other.groups_.begin());
+  for (; it != other.groups_.end(); ++it)
+    AddCounts(it->first, it->second);
+
+  num_messages_ += other.num_messages_;
+}
+
+void LogStatistics::GetTopGroups(size_t max_groups,
+                                 std::vector<Group>* groups) const {
+  DCHECK(groups != NULL);
+  groups->clear();
+  groups->reserve(groups_.size());
+
+  GroupMap::const_iterator it(groups_.begin());
+  for (; it != groups_.end(); ++it) {
+    Group group = {
+        it->first,
+        it->second.count,
+        it->second.first_time,
+        it->second.last_time,
+      };
+    groups->push_back(group);
+  }
+
+  size_t num_groups = std::min(max_groups, groups->size());
+  std::partial_sort(groups->begin(),
+                    groups->begin() + num_groups,
+                    groups->end(),
+                    ByDecreasingCount);
+  groups->resize(num_groups);
+}
+
+void LogStatistics::Clear() {
+  groups_.clear();
+  num_messages_ = 0;
+}
+
+void LogStatistics::AddCounts(const Key& key, const Counts& counts) {
+  std::pair<GroupMap::iterator, bool> inserted(
+      groups_.insert(std::make_pair(key, counts)));
+  if (inserted.second)
+    return;
+
+  Counts& existing = inserted.first->second;
+  existing.count += counts.count;
+  existing.first_time = std::min(existing.first_time, counts.first_time);
+  existing.last_time = std::max(existing.last_time, counts.last_time);
+}
@@ -0,0 +1,120 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log statistics declaration.
+#ifndef SAWBUCK_LOG_LIB_LOG_STATISTICS_H_
+#define SAWBUCK_LOG_LIB_LOG_STATISTICS_H_
+
+#include <windows.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+
+// Counts log messages grouped by any combination of process, thread,
+// severity, file/line and message template, and optionally by buckets of
+// time. This answers
+// questions like "which file/line logs the most", "what is the log rate of
+// each process per second" or "how does the severity break down over time".
+// Messages are added incrementally, and the statistics of separate chunks
+// of a log can be merged.
+class LogStatistics {
+ public:
+  // The keys to group messages by, to be combined in a bit mask.
+  enum GroupBy {
+    GROUP_BY_PROCESS = 1 << 0,
+    GROUP_BY_THREAD = 1 << 1,
+    GROUP_BY_SEVERITY = 1 << 2,
+    GROUP_BY_FILE_LINE = 1 << 3,
+    GROUP_BY_TEMPLATE = 1 << 4,
+  };
+
+  // The key of a group. The fields not grouped by are zero.
+  struct Key {
+    Key();
+
+    DWORD process_id;
+    DWORD thread_id;
+    int severity;
+    std::string file;
+    int line;
+    // The id of a template cluster of a TemplateMiner.
+    int template_id;
+    // The start of the time bucket, null unless grouping by time.
+    base::Time bucket;
+
+    bool operator < (const Key& other) const;
+    bool operator == (const Key& other) const;
+  };
+
+  struct Group {
+    Key key;
+    size_t count;
+    base::Time first_time;
+    base::Time last_time;
+  };
+
+  // @param group_by a mask of GroupBy values.
+  // @param bucket_size the width of the time buckets, or zero to not group
+  //     by time.
+  LogStatistics(int group_by, base::TimeDelta bucket_size);
+  ~LogStatistics();
+
+  // Counts a message.
+  // @param template_id the template cluster of the message, only used when
+  //     grouping by template.
+  void AddMessage(DWORD process_id,
+                  DWORD thread_id,
+                  int severity,
+                  const base::Time& time,
+                  const base::StringPiece& file,
+                  int line,
+                  int template_id);
+
+  // Adds the counts of @p other, which must group alike, to ours.
+  // This allows counting chunks of a log independently, e.g. on separate
+  // threads, and then combining the results.
+  void Merge(const LogStatistics& other);
+
+  // Retrieves up to @p max_groups of the groups with the most messages,
+  // by decreasing count.
+  void GetTopGroups(size_t max_groups, std::vector<Group>* groups) const;
+
+  // Forgets all counts.
+  void Clear();
+
+  int group_by() const { return group_by_; }
+  base::TimeDelta bucket_size() const { return bucket_size_; }
+  size_t num_messages() const { return num_messages_; }
+  size_t num_groups() const { return groups_.size(); }
+
+ private:
+  struct Counts {
+    size_t count;
+    base::Time first_time;
+    base::Time last_time;
+  };
+  typedef std::map<Key, Counts> GroupMap;
+
+  void AddCounts(const Key& key, const Counts& counts);
+
+  const int group_by_;
+  const base::TimeDelta bucket_size_;
+
+  size_t num_messages_;
+  GroupMap groups_;
+};
+
+#endif  // SAWBUCK_LOG_LIB_LOG_STATISTICS_H_
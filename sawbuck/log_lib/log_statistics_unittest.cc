@@ -0,0 +1,156 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log statistics unittests.
+#include "sawbuck/log_lib/log_statistics.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const DWORD kPid1 = 0x10;
+const DWORD kPid2 = 0x20;
+const DWORD kTid = 0x42;
+
+class LogStatisticsTest: public testing::Test {
+ public:
+  LogStatisticsTest()
+      : kT0(base::Time::FromTimeT(1300000000)),
+        kT1(kT0 + base::TimeDelta::FromMilliseconds(300)),
+        kT2(kT0 + base::TimeDelta::FromMilliseconds(1700)) {
+  }
+
+ protected:
+  const base::Time kT0;
+  const base::Time kT1;
+  const base::Time kT2;
+};
+
+TEST_F(LogStatisticsTest, Empty) {
+  LogStatistics stats(LogStatistics::GROUP_BY_PROCESS, base::TimeDelta());
+
+  std::vector<LogStatistics::Group> groups;
+  stats.GetTopGroups(10, &groups);
+  EXPECT_TRUE(groups.empty());
+  EXPECT_EQ(0U, stats.num_messages());
+}
+
+TEST_F(LogStatisticsTest, TopFileLines) {
+  LogStatistics stats(LogStatistics::GROUP_BY_FILE_LINE, base::TimeDelta());
+
+  stats.AddMessage(kPid1, kTid, 0, kT0, "foo.cc", 10, 0);
+  stats.AddMessage(kPid2, kTid, 1, kT1, "bar.cc", 20, 0);
+  stats.AddMessage(kPid1, kTid, 2, kT2, "foo.cc", 10, 0);
+  stats.AddMessage(kPid1, kTid, 0, kT1, "foo.cc", 11, 0);
+
+  EXPECT_EQ(4U, stats.num_messages());
+  EXPECT_EQ(3U, stats.num_groups());
+
+  std::vector<LogStatistics::Group> groups;
+  stats.GetTopGroups(2, &groups);
+  ASSERT_EQ(2U, groups.size());
+
+  EXPECT_EQ("foo.cc", groups[0].key.file);
+  EXPECT_EQ(10, groups[0].key.line);
+  // The keys not grouped by are zero.
+  EXPECT_EQ(0U, groups[0].key.process_id);
+  EXPECT_EQ(0, groups[0].key.severity);
+  EXPECT_EQ(2U, groups[0].count);
+  EXPECT_TRUE(kT0 == groups[0].first_time);
+  EXPECT_TRUE(kT2 == groups[0].last_time);
+
+  // The ties are ordered by key.
+  EXPECT_EQ("foo.cc", groups[1].key.file);
+  EXPECT_EQ(11, groups[1].key.line);
+  EXPECT_EQ(1U, groups[1].count);
+}
+
+TEST_F(LogStatisticsTest, TopTemplates) {
+  LogStatistics stats(LogStatistics::GROUP_BY_TEMPLATE |
+                          LogStatistics::GROUP_BY_SEVERITY,
+                      base::TimeDelta());
+
+  stats.AddMessage(kPid1, kTid, 1, kT0, "foo.cc", 10, 7);
+  stats.AddMessage(kPid2, kTid, 1, kT1, "bar.cc", 20, 7);
+  stats.AddMessage(kPid1, kTid, 2, kT2, "foo.cc", 10, 7);
+  stats.AddMessage(kPid1, kTid, 1, kT1, "foo.cc", 11, 3);
+
+  EXPECT_EQ(3U, stats.num_groups());
+
+  std::vector<LogStatistics::Group> groups;
+  stats.GetTopGroups(1, &groups);
+  ASSERT_EQ(1U, groups.size());
+  EXPECT_EQ(7, groups[0].key.template_id);
+  EXPECT_EQ(1, groups[0].key.severity);
+  EXPECT_EQ("", groups[0].key.file);
+  EXPECT_EQ(2U, groups[0].count);
+}
+
+TEST_F(LogStatisticsTest, RatePerProcess) {
+  LogStatistics stats(LogStatistics::GROUP_BY_PROCESS,
+                      base::TimeDelta::FromSeconds(1));
+
+  stats.AddMessage(kPid1, kTid, 0, kT0, "", 0, 0);
+  stats.AddMessage(kPid1, kTid, 0, kT1, "", 0, 0);
+  stats.AddMessage(kPid1, kTid, 0, kT2, "", 0, 0);
+  stats.AddMessage(kPid2, kTid, 0, kT1, "", 0, 0);
+
+  std::vector<LogStatistics::Group> groups;
+  stats.GetTopGroups(10, &groups);
+  ASSERT_EQ(3U, groups.size());
+
+  // kT0 and kT1 fall in the same one second bucket, kT2 in the next.
+  EXPECT_EQ(kPid1, groups[0].key.process_id);
+  EXPECT_TRUE(kT0 == groups[0].key.bucket);
+  EXPECT_EQ(2U, groups[0].count);
+
+  EXPECT_EQ(kPid2, groups[1].key.process_id);
+  EXPECT_TRUE(kT0 == groups[1].key.bucket);
+  EXPECT_EQ(1U, groups[1].count);
+
+  EXPECT_EQ(kPid1, groups[2].key.process_id);
+  EXPECT_TRUE(kT0 + base::TimeDelta::FromSeconds(1) == groups[2].key.bucket);
+  EXPECT_EQ(1U, groups[2].count);
+}
+
+TEST_F(LogStatisticsTest, Merge) {
+  const int kGroupBy =
+      LogStatistics::GROUP_BY_PROCESS | LogStatistics::GROUP_BY_SEVERITY;
+  LogStatistics whole(kGroupBy, base::TimeDelta());
+  LogStatistics first(kGroupBy, base::TimeDelta());
+  LogStatistics second(kGroupBy, base::TimeDelta());
+
+  whole.AddMessage(kPid1, kTid, 1, kT0, "", 0, 0);
+  first.AddMessage(kPid1, kTid, 1, kT0, "", 0, 0);
+  whole.AddMessage(kPid2, kTid, 2, kT1, "", 0, 0);
+  first.AddMessage(kPid2, kTid, 2, kT1, "", 0, 0);
+  whole.AddMessage(kPid1, kTid, 1, kT2, "", 0, 0);
+  second.AddMessage(kPid1, kTid, 1, kT2, "", 0, 0);
+
+  first.Merge(second);
+  EXPECT_EQ(whole.num_messages(), first.num_messages());
+
+  std::vector<LogStatistics::Group> expected;
+  std::vector<LogStatistics::Group> merged;
+  whole.GetTopGroups(10, &expected);
+  first.GetTopGroups(10, &merged);
+  ASSERT_EQ(expected.size(), merged.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_TRUE(expected[i].key == merged[i].key);
+    EXPECT_EQ(expected[i].count, merged[i].count);
+    EXPECT_TRUE(expected[i].first_time == merged[i].first_time);
+    EXPECT_TRUE(expected[i].last_time == merged[i].last_time);
+  }
+}
+
+}  // namespace
@@ -15,6 +15,9 @@
 // Symbol information service implementation.
 #include "sawbuck/log_lib/process_info_service.h"
 
+#include <algorithm>
+#include <set>
+#include "base/logging.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 
@@ -33,6 +36,48 @@ ProcessInfoService::ProcessInfoService() {
 }
 
 ProcessInfoService::~ProcessInfoService() {
+  DCHECK(observers_.empty());
+}
+
+void ProcessInfoService::AddObserver(Observer* observer) {
+  base::AutoLock lock(lock_);
+  DCHECK(observer != NULL);
+  observers_.push_back(observer);
+
+  // Walk up from each process to the first ancestor we've told of, and tell
+  // of the ones below it top down. Pids are reused, but a process' parent
+  // is the one that was running as it started.
+  std::set<ProcessKey> told;
+  ProcessInfoMap::iterator it(process_info_.begin());
+  for (; it != process_info_.end(); ++it) {
+    std::vector<ProcessInfoMap::iterator> ancestry;
+    ProcessInfoMap::iterator process(it);
+    while (process != process_info_.end() &&
+           told.insert(process->first).second) {
+      ancestry.push_back(process);
+      process = FindProcess(process->second.parent_process_id_,
+                            process->second.started_);
+    }
+
+    for (size_t i = ancestry.size(); i > 0; --i)
+      observer->OnProcessInfo(ancestry[i - 1]->second);
+  }
+}
+
+void ProcessInfoService::RemoveObserver(Observer* observer) {
+  base::AutoLock lock(lock_);
+  std::vector<Observer*>::iterator it(
+      std::find(observers_.begin(), observers_.end(), observer));
+  DCHECK(it != observers_.end());
+  if (it != observers_.end())
+    observers_.erase(it);
+}
+
+void ProcessInfoService::NotifyObservers(
+    const IProcessInfoService::ProcessInfo& info) {
+  lock_.AssertAcquired();
+  for (size_t i = 0; i < observers_.size(); ++i)
+    observers_[i]->OnProcessInfo(info);
 }
 
 ProcessInfoService::ProcessInfoMap::iterator ProcessInfoService::FindProcess(
@@ -110,6 +155,7 @@ void ProcessInfoService::OnProcessStarted(const base::Time& time,
 
     ProcessKey key(process_info.process_id, time);
     process_info_.insert(std::make_pair(key, to_insert));
+    NotifyObservers(to_insert);
   } else {
     // Make a copy of the process info.
     IProcessInfoService::ProcessInfo copy = it->second;
@@ -129,6 +175,7 @@ void ProcessInfoService::OnProcessStarted(const base::Time& time,
     copy.started_ = time;
     ProcessKey key(process_info.process_id, time);
     process_info_.insert(std::make_pair(key, copy));
+    NotifyObservers(copy);
   }
 }
 
@@ -159,6 +206,7 @@ void ProcessInfoService::OnProcessEnded(const base::Time& time,
 
     ProcessKey key(process_info.process_id, base::Time());
     process_info_.insert(std::make_pair(key, to_insert));
+    NotifyObservers(to_insert);
   } else {
     // We should not have had an end time in the previous callback.
     DCHECK(base::Time() == it->second.ended_);
@@ -169,5 +217,6 @@ void ProcessInfoService::OnProcessEnded(const base::Time& time,
 
     it->second.ended_ = time;
     it->second.exit_code_ = exit_status;
+    NotifyObservers(it->second);
   }
 }
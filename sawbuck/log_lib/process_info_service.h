@@ -17,6 +17,7 @@
 #define SAWBUCK_LOG_LIB_PROCESS_INFO_SERVICE_H_
 
 #include <map>
+#include <vector>
 #include "base/synchronization/lock.h"
 #include "sawbuck/log_lib/kernel_log_consumer.h"
 
@@ -51,9 +52,27 @@ class ProcessInfoService
     : public IProcessInfoService,
       public KernelProcessEvents {
  public:
+  // Observes the processes of the service.
+  class Observer {
+   public:
+    // Invoked with each process as it's added or updated, on the thread of
+    // the process events and under the service's lock, so this must not
+    // call back into the service.
+    virtual void OnProcessInfo(
+        const IProcessInfoService::ProcessInfo& info) = 0;
+
+   protected:
+    virtual ~Observer() {}
+  };
+
   ProcessInfoService();
   ~ProcessInfoService();
 
+  // Tells @p observer of the processes so far, each after its parent, and
+  // then of every process added or updated until it's removed.
+  void AddObserver(Observer* observer);
+  void RemoveObserver(Observer* observer);
+
   // IProcessInfoService implementation.
   virtual bool GetProcessInfo(DWORD process_id, const base::Time& time,
       IProcessInfoService::ProcessInfo* info);
@@ -74,8 +93,12 @@ class ProcessInfoService
   ProcessInfoMap::iterator FindProcess(DWORD process_id,
       const base::Time& time);
 
+  // Tells our observers of @p info.
+  void NotifyObservers(const IProcessInfoService::ProcessInfo& info);
+
   base::Lock lock_;
   ProcessInfoMap process_info_;  // Under lock_.
+  std::vector<Observer*> observers_;  // Under lock_.
 };
 
 #endif  // SAWBUCK_LOG_LIB_PROCESS_INFO_SERVICE_H_
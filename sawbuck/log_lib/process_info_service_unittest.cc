@@ -19,6 +19,16 @@
 
 namespace {
 
+// Records the processes it's told of.
+class RecordingObserver : public ProcessInfoService::Observer {
+ public:
+  virtual void OnProcessInfo(const IProcessInfoService::ProcessInfo& info) {
+    processes_.push_back(info);
+  }
+
+  std::vector<IProcessInfoService::ProcessInfo> processes_;
+};
+
 class ProcessInfoServiceTest: public testing::Test {
  public:
   ProcessInfoServiceTest() : kT0(base::Time()), kT1(base::Time::Now()),
@@ -209,4 +219,38 @@ TEST_F(ProcessInfoServiceTest, EndStart) {
   EXPECT_FALSE(service_.GetProcessInfo(kPid, kT2, &info));
 }
 
+TEST_F(ProcessInfoServiceTest, Observers) {
+  // The child sorts ahead of its parent by pid.
+  RunningProcess(kPid, kParentPid, kSession, Sids::World(),
+      kImageName, kCommandLine);
+  RunningProcess(kParentPid, 0, kSession, Sids::World(),
+      kImageName, kCommandLine);
+
+  // The processes so far are replayed, parents first.
+  RecordingObserver observer;
+  service_.AddObserver(&observer);
+  ASSERT_EQ(2U, observer.processes_.size());
+  EXPECT_EQ(kParentPid, observer.processes_[0].process_id_);
+  EXPECT_EQ(kPid, observer.processes_[1].process_id_);
+
+  // Then the processes are told of as they start and end.
+  observer.processes_.clear();
+  StartProcess(kT1, kPid + 4, kPid, kSession, Sids::World(),
+      kImageName, kCommandLine);
+  EndProcess(kT2, kPid + 4, kPid, kSession, Sids::World(),
+      kImageName, kCommandLine, kExitCode);
+  ASSERT_EQ(2U, observer.processes_.size());
+  EXPECT_TRUE(kT1 == observer.processes_[0].started_);
+  EXPECT_TRUE(kT0 == observer.processes_[0].ended_);
+  EXPECT_TRUE(kT1 == observer.processes_[1].started_);
+  EXPECT_TRUE(kT2 == observer.processes_[1].ended_);
+
+  // Until the observer is removed.
+  service_.RemoveObserver(&observer);
+  observer.processes_.clear();
+  StartProcess(kT2, kPid + 8, kPid, kSession, Sids::World(),
+      kImageName, kCommandLine);
+  EXPECT_TRUE(observer.processes_.empty());
+}
+
 }  // namespace
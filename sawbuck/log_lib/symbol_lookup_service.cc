@@ -20,9 +20,9 @@
 #include "base/bind.h"
 #include "base/message_loop/message_loop.h"
 
-SymbolLookupService::SymbolLookupService() : background_thread_(NULL),
-    foreground_thread_(base::MessageLoop::current()), next_request_id_(0),
-    unprocessed_id_(0) {
+SymbolLookupService::SymbolLookupService()
+    : foreground_thread_(base::MessageLoop::current()), next_request_id_(0),
+      unprocessed_id_(0) {
 }
 
 SymbolLookupService::~SymbolLookupService() {
@@ -46,18 +46,51 @@ SymbolLookupService::Handle SymbolLookupService::ResolveAddress(
   request.address_ = address;
   request.callback_ = callback;
 
-  // Post a task to do the symbol resolution unless one is already pending,
-  // or currently executing. The task will NULL this field as it exits
-  // on an empty queue.
-  if (resolve_task_.is_null()) {
-    resolve_task_ = base::Bind(&SymbolLookupService::ResolveCallback,
-                               base::Unretained(this));
-    background_thread_->PostTask(FROM_HERE, resolve_task_);
-  }
+  EnsureResolveTask();
+
+  return request_id;
+}
+
+SymbolLookupService::Handle SymbolLookupService::ResolveStack(
+    sym_util::ProcessId process_id, const base::Time& time,
+    const StackTrace& stack_trace, const StackResolvedCallback& callback) {
+  DCHECK_EQ(foreground_thread_, base::MessageLoop::current());
+  DCHECK(!callback.is_null());
+
+  StackKey key(GetStackKey(process_id, time, stack_trace));
+
+  base::AutoLock lock(resolution_lock_);
+  Handle request_id = next_request_id_++;
+  DCHECK(requests_.end() == requests_.find(request_id));
+  Request& request = requests_[request_id];
+  request.process_id_ = process_id;
+  request.time_ = time;
+  request.stack_trace_ = stack_trace;
+  request.stack_key_ = key;
+  request.stack_callback_ = callback;
+
+  EnsureResolveTask();
 
   return request_id;
 }
 
+bool SymbolLookupService::GetResolvedStack(sym_util::ProcessId process_id,
+                                           const base::Time& time,
+                                           const StackTrace& stack_trace,
+                                           ResolvedStack* symbols) {
+  DCHECK(symbols != NULL);
+
+  StackKey key(GetStackKey(process_id, time, stack_trace));
+
+  base::AutoLock lock(resolution_lock_);
+  ResolvedStackMap::const_iterator it(resolved_stacks_.find(key));
+  if (it == resolved_stacks_.end() || it->second.stack_trace_ != stack_trace)
+    return false;
+
+  *symbols = it->second.symbols_;
+  return true;
+}
+
 void SymbolLookupService::CancelRequest(Handle request_handle) {
   DCHECK_EQ(foreground_thread_, base::MessageLoop::current());
   base::AutoLock lock(resolution_lock_);
@@ -67,8 +100,40 @@ void SymbolLookupService::CancelRequest(Handle request_handle) {
   requests_.erase(it);
 }
 
+SymbolLookupService::StackKey SymbolLookupService::GetStackKey(
+    sym_util::ProcessId process_id, const base::Time& time,
+    const StackTrace& stack_trace) {
+  sym_util::ModuleCache::ModuleLoadStateId id;
+  {
+    base::AutoLock lock(module_lock_);
+    id = module_cache_.GetStateId(process_id, time);
+  }
+
+  // FNV-1a over the frame addresses.
+  size_t hash = 2166136261U;
+  for (size_t i = 0; i < stack_trace.size(); ++i) {
+    hash ^= static_cast<size_t>(stack_trace[i]);
+    hash *= 16777619U;
+  }
+
+  return std::make_pair(id, hash);
+}
+
+void SymbolLookupService::EnsureResolveTask() {
+  resolution_lock_.AssertAcquired();
+
+  // Post a task to do the symbol resolution unless one is already pending,
+  // or currently executing. The task will NULL this field as it exits
+  // on an empty queue.
+  if (resolve_task_.is_null()) {
+    resolve_task_ = base::Bind(&SymbolLookupService::ResolveCallback,
+                               base::Unretained(this));
+    background_runner_->PostTask(FROM_HERE, resolve_task_);
+  }
+}
+
 void SymbolLookupService::SetSymbolPath(const wchar_t* symbol_path) {
-  background_thread_->PostTask(FROM_HERE,
+  background_runner_->PostTask(FROM_HERE,
       base::Bind(&SymbolLookupService::SetSymbolPathCallback,
                  base::Unretained(this),
                  symbol_path));
@@ -127,12 +192,14 @@ bool SymbolLookupService::ResolveAddressImpl(sym_util::ProcessId pid,
                                              const base::Time& time,
                                              sym_util::Address address,
                                              sym_util::Symbol* symbol) {
-  DCHECK_EQ(background_thread_, base::MessageLoop::current());
+  DCHECK(background_runner_->RunsTasksOnCurrentThread());
   using sym_util::ModuleCache;
   using sym_util::SymbolCache;
 
   ModuleCache::ModuleLoadStateId id;
   SymbolCacheMap::iterator it;
+  bool is_new_cache = false;
+  base::TimeTicks start(base::TimeTicks::Now());
 
   {
     // Hold the module lock only while accessing the module cache.
@@ -162,6 +229,7 @@ bool SymbolLookupService::ResolveAddressImpl(sym_util::ProcessId pid,
       cache.Initialize(modules.size(), modules.size() ? &modules[0] : NULL);
 
       it = inserted.first;
+      is_new_cache = true;
     } else {
       // We have a hit, manage the LRU by removing our ID.
       // It will be pushed to the back of the LRU just below.
@@ -179,6 +247,10 @@ bool SymbolLookupService::ResolveAddressImpl(sym_util::ProcessId pid,
   // This can take a long time, so it's important not to
   // hold the module lock over this operation.
   bool ret = cache.GetSymbolForAddress(address, symbol);
+  if (is_new_cache) {
+    VLOG(1) << "First symbol for module load state " << id << " in "
+        << (base::TimeTicks::Now() - start).InMilliseconds() << " ms.";
+  }
 
   // Clear the last status we posted.
   if (!status_callback_.is_null())
@@ -188,7 +260,7 @@ bool SymbolLookupService::ResolveAddressImpl(sym_util::ProcessId pid,
 }
 
 void SymbolLookupService::ResolveCallback() {
-  DCHECK_EQ(background_thread_, base::MessageLoop::current());
+  DCHECK(background_runner_->RunsTasksOnCurrentThread());
 
   while (true) {
     Handle request_id;
@@ -211,19 +283,47 @@ void SymbolLookupService::ResolveCallback() {
 
     // Don't hold the lock over the symbol resolution proper.
     sym_util::Symbol symbol;
-    ResolveAddressImpl(request.process_id_,
-                       request.time_,
-                       request.address_,
-                       &symbol);
+    ResolvedStack symbols;
+    bool stack_resolved = true;
+    if (request.stack_callback_.is_null()) {
+      ResolveAddressImpl(request.process_id_,
+                         request.time_,
+                         request.address_,
+                         &symbol);
+    } else {
+      symbols.resize(request.stack_trace_.size());
+      for (size_t i = 0; i < request.stack_trace_.size(); ++i) {
+        if (!ResolveAddressImpl(request.process_id_,
+                                request.time_,
+                                request.stack_trace_[i],
+                                &symbols[i])) {
+          stack_resolved = false;
+        }
+      }
+    }
 
     // Store the result, mindfully of the fact that the request
     // might have been cancelled while we did the resolution.
     {
       base::AutoLock lock(resolution_lock_);
 
+      if (!request.stack_callback_.is_null() && stack_resolved) {
+        // Memoize the stack whether or not the request is still live,
+        // as it's likely to be asked for again. Stacks with frames that
+        // failed to resolve are not memoized, so that they're retried
+        // e.g. once their modules or symbols show up.
+        if (resolved_stacks_.size() >= kMaxResolvedStacks)
+          resolved_stacks_.clear();
+
+        ResolvedStackEntry& entry = resolved_stacks_[request.stack_key_];
+        entry.stack_trace_ = request.stack_trace_;
+        entry.symbols_ = symbols;
+      }
+
       RequestMap::iterator it = requests_.find(request_id);
       if (it != requests_.end()) {
         it->second.resolved_ = symbol;
+        it->second.resolved_stack_.swap(symbols);
 
         if (callback_task_.is_null()) {
           callback_task_ = base::Bind(&SymbolLookupService::IssueCallbacks,
@@ -238,12 +338,16 @@ void SymbolLookupService::ResolveCallback() {
 }
 
 void SymbolLookupService::SetSymbolPathCallback(const std::wstring& path) {
-  DCHECK_EQ(background_thread_, base::MessageLoop::current());
+  DCHECK(background_runner_->RunsTasksOnCurrentThread());
 
   symbol_path_ = path;
   SymbolCacheMap::iterator it(symbol_caches_.begin());
   for (; it != symbol_caches_.end(); ++it)
     it->second.SetSymbolPath(symbol_path_.c_str());
+
+  // The stacks may resolve differently with the new path.
+  base::AutoLock lock(resolution_lock_);
+  resolved_stacks_.clear();
 }
 
 void SymbolLookupService::IssueCallbacks() {
@@ -268,10 +372,17 @@ void SymbolLookupService::IssueCallbacks() {
       requests_.erase(it);
     }
 
-    request.callback_.Run(request.process_id_,
-                          request.time_,
-                          request.address_,
-                          request_id,
-                          request.resolved_);
+    if (!request.stack_callback_.is_null()) {
+      request.stack_callback_.Run(request.process_id_,
+                                  request.time_,
+                                  request_id,
+                                  request.resolved_stack_);
+    } else {
+      request.callback_.Run(request.process_id_,
+                            request.time_,
+                            request.address_,
+                            request_id,
+                            request.resolved_);
+    }
   }
 }
@@ -16,9 +16,12 @@
 #ifndef SAWBUCK_LOG_LIB_SYMBOL_LOOKUP_SERVICE_H_
 #define SAWBUCK_LOG_LIB_SYMBOL_LOOKUP_SERVICE_H_
 
+#include <map>
 #include <string>
 #include <vector>
 #include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/sequenced_task_runner.h"
 #include "base/synchronization/lock.h"
 #include "base/time/time.h"
 #include "sawbuck/log_lib/kernel_log_consumer.h"
@@ -39,6 +42,16 @@ class ISymbolLookupService {
                               const sym_util::Symbol&)>
       SymbolResolvedCallback;
 
+  typedef std::vector<sym_util::Address> StackTrace;
+  typedef std::vector<sym_util::Symbol> ResolvedStack;
+
+  // Type of the stack resolution callback.
+  typedef base::Callback<void(sym_util::ProcessId,
+                              base::Time,
+                              Handle,
+                              const ResolvedStack&)>
+      StackResolvedCallback;
+
   // Enqueues an address resolution request for @p address in the context of
   // @p process_id at @p time.
   // @param process_id the process where @address was observed.
@@ -52,9 +65,27 @@ class ISymbolLookupService {
                                 sym_util::Address address,
                                 const SymbolResolvedCallback& callback) = 0;
 
+  // Enqueues a resolution request for all the frames of @p stack_trace in
+  // the context of @p process_id at @p time. The callback is invoked once,
+  // with the symbols of all the frames in order.
+  // @returns the request handle on success, or kInvalidHandle on error.
+  virtual Handle ResolveStack(sym_util::ProcessId process_id,
+                              const base::Time& time,
+                              const StackTrace& stack_trace,
+                              const StackResolvedCallback& callback) = 0;
+
+  // Retrieves the symbols for @p stack_trace without blocking, if the same
+  // stack has previously been resolved in the same module load state.
+  // @returns true iff @p symbols has been filled in.
+  virtual bool GetResolvedStack(sym_util::ProcessId process_id,
+                                const base::Time& time,
+                                const StackTrace& stack_trace,
+                                ResolvedStack* symbols) = 0;
+
   // Cancel a pending async symbol resolution request.
   // @param request_handle a request handle previously returned from
-  //    ResolveAddress, whose callback has not yet been invoked.
+  //    ResolveAddress or ResolveStack, whose callback has not yet been
+  //    invoked.
   virtual void CancelRequest(Handle request_handle) = 0;
 
   // Change the symbol path to @p symbol_path.
@@ -79,11 +110,14 @@ class SymbolLookupService
     status_callback_ = status_callback;
   }
 
-  // Accessors for our background thread message loop.
-  // Note: This object must outlive the background thread.
-  base::MessageLoop* background_thread() const { return background_thread_; }
-  void set_background_thread(base::MessageLoop* background_thread) {
-    background_thread_ = background_thread;
+  // Accessors for the task runner we do our background work on. The symbol
+  // engine isn't thread safe, so its tasks must run one at a time.
+  // Note: This object must outlive the tasks posted to the runner.
+  base::SequencedTaskRunner* background_runner() const {
+    return background_runner_.get();
+  }
+  void set_background_runner(base::SequencedTaskRunner* background_runner) {
+    background_runner_ = background_runner;
   }
 
   // ISymboLookupService implementation.
@@ -91,6 +125,14 @@ class SymbolLookupService
                                 const base::Time& time,
                                 sym_util::Address address,
                                 const SymbolResolvedCallback& callback);
+  virtual Handle ResolveStack(sym_util::ProcessId process_id,
+                              const base::Time& time,
+                              const StackTrace& stack_trace,
+                              const StackResolvedCallback& callback);
+  virtual bool GetResolvedStack(sym_util::ProcessId process_id,
+                                const base::Time& time,
+                                const StackTrace& stack_trace,
+                                ResolvedStack* symbols);
   virtual void CancelRequest(Handle request_handle);
   virtual void SetSymbolPath(const wchar_t* symbol_path);
 
@@ -111,6 +153,17 @@ class SymbolLookupService
                                   sym_util::Address address,
                                   sym_util::Symbol* symbol);
 
+  // Resolved stacks are keyed on module load state and a hash of the stack.
+  typedef std::pair<sym_util::ModuleCache::ModuleLoadStateId, size_t>
+      StackKey;
+  StackKey GetStackKey(sym_util::ProcessId process_id,
+                       const base::Time& time,
+                       const StackTrace& stack_trace);
+
+  // Posts a resolution task unless one is already pending.
+  // Must be called under resolution_lock_.
+  void EnsureResolveTask();
+
   void SetSymbolPathCallback(const std::wstring& path);
   void ResolveCallback();
   void IssueCallbacks();
@@ -131,11 +184,20 @@ class SymbolLookupService
 
   base::Lock resolution_lock_;
   struct Request {
+    Request() : process_id_(0), address_(0) {
+    }
+
     sym_util::ProcessId process_id_;
     base::Time time_;
     sym_util::Address address_;
     SymbolResolvedCallback callback_;
     sym_util::Symbol resolved_;
+
+    // Only set for stack requests.
+    StackTrace stack_trace_;
+    StackKey stack_key_;
+    StackResolvedCallback stack_callback_;
+    ResolvedStack resolved_stack_;
   };
   // Under resolution_lock_.
   typedef std::map<Handle, Request> RequestMap;
@@ -147,6 +209,16 @@ class SymbolLookupService
   // The id of the largest-id unprocessed request.
   Handle unprocessed_id_;  // Under resolution_lock_.
 
+  // The fully resolved stacks. We keep the stack trace with the symbols
+  // to tell apart stacks that hash to the same key.
+  struct ResolvedStackEntry {
+    StackTrace stack_trace_;
+    ResolvedStack symbols_;
+  };
+  typedef std::map<StackKey, ResolvedStackEntry> ResolvedStackMap;
+  static const size_t kMaxResolvedStacks = 4096;
+  ResolvedStackMap resolved_stacks_;  // Under resolution_lock_.
+
   // Invoked on the worker thread on status changes.
   StatusCallback status_callback_;
 
@@ -156,8 +228,8 @@ class SymbolLookupService
   ProcessingCallback resolve_task_;  // Under resolution_lock_.
   ProcessingCallback callback_task_;  // Under resolution_lock_.
 
-  // The background thread where we do our processing.
-  base::MessageLoop* background_thread_;
+  // The task runner where we do our processing.
+  scoped_refptr<base::SequencedTaskRunner> background_runner_;
 
   // The foreground thread where we deliver result callbacks.
   base::MessageLoop* foreground_thread_;
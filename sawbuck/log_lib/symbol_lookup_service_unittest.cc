@@ -41,7 +41,7 @@ class SymbolLookupServiceTest: public testing::Test {
 
   virtual void SetUp() {
     ASSERT_TRUE(background_thread_.Start());
-    service_.set_background_thread(background_thread_.message_loop());
+    service_.set_background_runner(background_thread_.message_loop_proxy());
   }
 
   virtual void TearDown() {
@@ -102,6 +102,27 @@ class SymbolLookupServiceTest: public testing::Test {
     resolved_.push_back(handle);
   }
 
+  void FooStackResolved(sym_util::ProcessId pid, base::Time time,
+      SymbolLookupService::Handle handle,
+      const SymbolLookupService::ResolvedStack& symbols) {
+    EXPECT_EQ(&message_loop_, base::MessageLoop::current());
+    ASSERT_EQ(2, symbols.size());
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, L"Foo", symbols[0].name);
+    EXPECT_PRED_FORMAT2(testing::IsSubstring, L"Foo", symbols[1].name);
+
+    resolved_.push_back(handle);
+  }
+
+  void FooStackNotResolved(sym_util::ProcessId pid, base::Time time,
+      SymbolLookupService::Handle handle,
+      const SymbolLookupService::ResolvedStack& symbols) {
+    EXPECT_EQ(&message_loop_, base::MessageLoop::current());
+    ASSERT_EQ(1, symbols.size());
+    EXPECT_STREQ(L"", symbols[0].name.c_str());
+
+    resolved_.push_back(handle);
+  }
+
  protected:
   std::vector<SymbolLookupService::Handle> resolved_;
 
@@ -168,4 +189,62 @@ TEST_F(SymbolLookupServiceTest, LookupFooCancel) {
   ASSERT_EQ(5, resolved_.size());
 }
 
+TEST_F(SymbolLookupServiceTest, ResolveStack) {
+  LoadModules();
+
+  SymbolLookupService::StackTrace stack_trace;
+  stack_trace.push_back(reinterpret_cast<sym_util::Address>(&Foo));
+  stack_trace.push_back(reinterpret_cast<sym_util::Address>(&Foo));
+
+  base::Time now(base::Time::Now());
+  SymbolLookupService::ResolvedStack symbols;
+  EXPECT_FALSE(service_.GetResolvedStack(::GetCurrentProcessId(), now,
+                                         stack_trace, &symbols));
+
+  SymbolLookupService::Handle h =
+      service_.ResolveStack(
+          ::GetCurrentProcessId(), now, stack_trace,
+          base::Bind(&SymbolLookupServiceTest::FooStackResolved,
+                     base::Unretained(this)));
+  ASSERT_NE(SymbolLookupService::kInvalidHandle, h);
+
+  ResolveAll();
+
+  // One callback for the whole stack.
+  ASSERT_EQ(1, resolved_.size());
+
+  // The stack is now memoized.
+  ASSERT_TRUE(service_.GetResolvedStack(::GetCurrentProcessId(), now,
+                                        stack_trace, &symbols));
+  ASSERT_EQ(2, symbols.size());
+  EXPECT_PRED_FORMAT2(testing::IsSubstring, L"Foo", symbols[0].name);
+
+  // A different stack is not.
+  stack_trace.pop_back();
+  EXPECT_FALSE(service_.GetResolvedStack(::GetCurrentProcessId(), now,
+                                         stack_trace, &symbols));
+}
+
+TEST_F(SymbolLookupServiceTest, ResolveStackNoModules) {
+  SymbolLookupService::StackTrace stack_trace;
+  stack_trace.push_back(reinterpret_cast<sym_util::Address>(&Foo));
+
+  base::Time now(base::Time::Now());
+  SymbolLookupService::Handle h =
+      service_.ResolveStack(
+          ::GetCurrentProcessId(), now, stack_trace,
+          base::Bind(&SymbolLookupServiceTest::FooStackNotResolved,
+                     base::Unretained(this)));
+  ASSERT_NE(SymbolLookupService::kInvalidHandle, h);
+
+  ResolveAll();
+
+  ASSERT_EQ(1, resolved_.size());
+
+  // The unresolved stack is not memoized.
+  SymbolLookupService::ResolvedStack symbols;
+  EXPECT_FALSE(service_.GetResolvedStack(::GetCurrentProcessId(), now,
+                                         stack_trace, &symbols));
+}
+
 }  // namespace
@@ -0,0 +1,417 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Work-stealing task scheduler implementation.
+#include "sawbuck/log_lib/task_scheduler.h"
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/sys_info.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+
+CancellationToken::CancellationToken() : cancelled_(0) {
+}
+
+CancellationToken::~CancellationToken() {
+}
+
+void CancellationToken::Cancel() {
+  base::subtle::Release_Store(&cancelled_, 1);
+}
+
+bool CancellationToken::IsCancelled() const {
+  return base::subtle::Acquire_Load(&cancelled_) != 0;
+}
+
+ReaderGuard::ReaderGuard()
+    : readers_done_(&lock_), num_readers_(0), revoked_(false) {
+}
+
+ReaderGuard::~ReaderGuard() {
+  DCHECK_EQ(0, num_readers_);
+}
+
+bool ReaderGuard::BeginRead() {
+  base::AutoLock lock(lock_);
+  if (revoked_)
+    return false;
+
+  ++num_readers_;
+  return true;
+}
+
+void ReaderGuard::EndRead() {
+  base::AutoLock lock(lock_);
+  DCHECK_LT(0, num_readers_);
+  if (--num_readers_ == 0)
+    readers_done_.Broadcast();
+}
+
+void ReaderGuard::Revoke() {
+  base::AutoLock lock(lock_);
+  revoked_ = true;
+  while (num_readers_ != 0)
+    readers_done_.Wait();
+}
+
+class TaskScheduler::Worker : public base::DelegateSimpleThread::Delegate {
+ public:
+  Worker(TaskScheduler* scheduler, size_t index)
+      : scheduler_(scheduler), index_(index) {
+  }
+
+  void Start() {
+    thread_.reset(new base::DelegateSimpleThread(
+        this, base::StringPrintf("Task Scheduler Worker %d",
+                                 static_cast<int>(index_))));
+    thread_->Start();
+  }
+
+  void Join() {
+    if (thread_.get() != NULL)
+      thread_->Join();
+  }
+
+  // DelegateSimpleThread::Delegate implementation.
+  virtual void Run() {
+    scheduler_->RunWorker(this);
+  }
+
+  size_t index() const { return index_; }
+
+  base::Lock lock;
+  // The tasks posted from this worker, by priority.
+  TaskQueue queues[NUM_PRIORITIES];  // Under lock.
+
+ private:
+  TaskScheduler* scheduler_;
+  size_t index_;
+  scoped_ptr<base::DelegateSimpleThread> thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+class TaskScheduler::PriorityTaskRunner : public base::TaskRunner {
+ public:
+  PriorityTaskRunner(TaskScheduler* scheduler, Priority priority)
+      : scheduler_(scheduler), priority_(priority) {
+  }
+
+  // base::TaskRunner implementation.
+  virtual bool PostDelayedTask(const tracked_objects::Location& from_here,
+                               const base::Closure& task,
+                               base::TimeDelta delay) {
+    DCHECK_EQ(0, delay.InMicroseconds()) << "Delayed tasks aren't supported.";
+    return scheduler_->PostTask(priority_, task);
+  }
+
+  virtual bool RunsTasksOnCurrentThread() const {
+    return scheduler_->RunsTasksOnCurrentThread();
+  }
+
+ private:
+  virtual ~PriorityTaskRunner() {
+  }
+
+  TaskScheduler* scheduler_;
+  Priority priority_;
+
+  DISALLOW_COPY_AND_ASSIGN(PriorityTaskRunner);
+};
+
+// Runs its tasks one at a time by keeping at most one task of its own
+// queued with the scheduler.
+class TaskScheduler::SequencedTaskRunner : public base::SequencedTaskRunner {
+ public:
+  SequencedTaskRunner(TaskScheduler* scheduler, Priority priority)
+      : scheduler_(scheduler),
+        priority_(priority),
+        scheduled_(false),
+        running_thread_(base::kInvalidThreadId) {
+  }
+
+  // base::SequencedTaskRunner implementation.
+  virtual bool PostDelayedTask(const tracked_objects::Location& from_here,
+                               const base::Closure& task,
+                               base::TimeDelta delay) {
+    DCHECK_EQ(0, delay.InMicroseconds()) << "Delayed tasks aren't supported.";
+
+    base::AutoLock lock(lock_);
+    if (!scheduled_) {
+      if (!scheduler_->PostTask(priority_, base::Bind(
+              &SequencedTaskRunner::RunNextTask, this))) {
+        return false;
+      }
+      scheduled_ = true;
+    }
+
+    queue_.push_back(task);
+    return true;
+  }
+
+  virtual bool PostNonNestableDelayedTask(
+      const tracked_objects::Location& from_here,
+      const base::Closure& task,
+      base::TimeDelta delay) {
+    // We never nest.
+    return PostDelayedTask(from_here, task, delay);
+  }
+
+  virtual bool RunsTasksOnCurrentThread() const {
+    base::AutoLock lock(lock_);
+    return running_thread_ == base::PlatformThread::CurrentId();
+  }
+
+ private:
+  virtual ~SequencedTaskRunner() {
+  }
+
+  void RunNextTask() {
+    base::Closure task;
+    {
+      base::AutoLock lock(lock_);
+      DCHECK(!queue_.empty());
+      task = queue_.front();
+      queue_.pop_front();
+      running_thread_ = base::PlatformThread::CurrentId();
+    }
+
+    task.Run();
+
+    {
+      base::AutoLock lock(lock_);
+      running_thread_ = base::kInvalidThreadId;
+      if (queue_.empty()) {
+        scheduled_ = false;
+        return;
+      }
+    }
+
+    // Go to the back of the line, so as not to hog a worker. Our worker
+    // would take its own newest task first, so go through the shared queue.
+    scheduler_->PostSharedTask(priority_, base::Bind(
+        &SequencedTaskRunner::RunNextTask, this));
+  }
+
+  TaskScheduler* scheduler_;
+  Priority priority_;
+
+  mutable base::Lock lock_;
+  std::deque<base::Closure> queue_;  // Under lock_.
+  // True while a task of ours is queued with or run by the scheduler.
+  bool scheduled_;  // Under lock_.
+  base::PlatformThreadId running_thread_;  // Under lock_.
+
+  DISALLOW_COPY_AND_ASSIGN(SequencedTaskRunner);
+};
+
+namespace {
+
+// Pops the newest or the oldest task of @p queue into @p task.
+template <typename Queue, typename Task>
+bool PopTask(bool newest, Queue* queue, Task* task) {
+  if (queue->empty())
+    return false;
+
+  if (newest) {
+    *task = queue->back();
+    queue->pop_back();
+  } else {
+    *task = queue->front();
+    queue->pop_front();
+  }
+
+  return true;
+}
+
+}  // namespace
+
+TaskScheduler::TaskScheduler(size_t num_workers)
+    : num_workers_(num_workers != 0 ? num_workers :
+                       base::SysInfo::NumberOfProcessors()),
+      num_queued_(0),
+      stopping_(0),
+      work_available_(&idle_lock_) {
+  DCHECK_LT(0U, num_workers_);
+
+  for (int priority = 0; priority < NUM_PRIORITIES; ++priority) {
+    task_runners_[priority] =
+        new PriorityTaskRunner(this, static_cast<Priority>(priority));
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  Stop();
+}
+
+void TaskScheduler::Start() {
+  DCHECK(workers_.empty());
+  DCHECK_EQ(0, base::subtle::Acquire_Load(&stopping_));
+
+  for (size_t i = 0; i < num_workers_; ++i)
+    workers_.push_back(new Worker(this, i));
+
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i]->Start();
+}
+
+void TaskScheduler::Stop() {
+  DCHECK(!RunsTasksOnCurrentThread());
+
+  base::subtle::Release_Store(&stopping_, 1);
+  {
+    base::AutoLock lock(idle_lock_);
+    work_available_.Broadcast();
+  }
+
+  for (size_t i = 0; i < workers_.size(); ++i)
+    workers_[i]->Join();
+
+  // Drop the tasks that didn't get to run, along with the workers' queues.
+  workers_.clear();
+  for (int priority = 0; priority < NUM_PRIORITIES; ++priority) {
+    base::AutoLock lock(shared_lock_);
+    shared_queues_[priority].clear();
+  }
+  base::subtle::NoBarrier_Store(&num_queued_, 0);
+}
+
+bool TaskScheduler::PostTask(Priority priority, const base::Closure& task) {
+  return PostTask(priority, NULL, task);
+}
+
+bool TaskScheduler::PostTask(Priority priority,
+                             CancellationToken* token,
+                             const base::Closure& task) {
+  Task new_task;
+  new_task.closure = task;
+  new_task.token = token;
+
+  return PostTaskImpl(priority, new_task, false);
+}
+
+bool TaskScheduler::PostSharedTask(Priority priority,
+                                   const base::Closure& task) {
+  Task new_task;
+  new_task.closure = task;
+
+  return PostTaskImpl(priority, new_task, true);
+}
+
+bool TaskScheduler::PostTaskImpl(Priority priority,
+                                 const Task& task,
+                                 bool shared) {
+  DCHECK_LE(0, priority);
+  DCHECK_GT(NUM_PRIORITIES, priority);
+  DCHECK(!task.closure.is_null());
+
+  if (base::subtle::Acquire_Load(&stopping_))
+    return false;
+
+  Worker* worker = shared ? NULL : current_worker_.Get();
+  if (worker != NULL) {
+    base::AutoLock lock(worker->lock);
+    worker->queues[priority].push_back(task);
+  } else {
+    base::AutoLock lock(shared_lock_);
+    shared_queues_[priority].push_back(task);
+  }
+
+  base::subtle::Barrier_AtomicIncrement(&num_queued_, 1);
+
+  base::AutoLock lock(idle_lock_);
+  work_available_.Signal();
+
+  return true;
+}
+
+scoped_refptr<base::TaskRunner> TaskScheduler::GetTaskRunner(
+    Priority priority) {
+  DCHECK_LE(0, priority);
+  DCHECK_GT(NUM_PRIORITIES, priority);
+
+  return task_runners_[priority];
+}
+
+scoped_refptr<base::SequencedTaskRunner>
+    TaskScheduler::CreateSequencedTaskRunner(Priority priority) {
+  DCHECK_LE(0, priority);
+  DCHECK_GT(NUM_PRIORITIES, priority);
+
+  return new SequencedTaskRunner(this, priority);
+}
+
+bool TaskScheduler::RunsTasksOnCurrentThread() const {
+  return current_worker_.Get() != NULL;
+}
+
+bool TaskScheduler::TakeTask(Worker* worker, Task* task) {
+  DCHECK(worker != NULL);
+  DCHECK(task != NULL);
+
+  for (int priority = 0; priority < NUM_PRIORITIES; ++priority) {
+    // Our own newest task is likely to have its data in our caches.
+    bool found = false;
+    {
+      base::AutoLock lock(worker->lock);
+      found = PopTask(true, &worker->queues[priority], task);
+    }
+
+    if (!found) {
+      base::AutoLock lock(shared_lock_);
+      found = PopTask(false, &shared_queues_[priority], task);
+    }
+
+    // Steal the oldest task of another worker, which is the most likely
+    // to spawn more work.
+    for (size_t i = 1; !found && i < workers_.size(); ++i) {
+      Worker* victim = workers_[(worker->index() + i) % workers_.size()];
+      base::AutoLock lock(victim->lock);
+      found = PopTask(false, &victim->queues[priority], task);
+    }
+
+    if (found) {
+      base::subtle::Barrier_AtomicIncrement(&num_queued_, -1);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void TaskScheduler::RunWorker(Worker* worker) {
+  current_worker_.Set(worker);
+
+  while (!base::subtle::Acquire_Load(&stopping_)) {
+    Task task;
+    if (TakeTask(worker, &task)) {
+      if (task.token.get() == NULL || !task.token->IsCancelled())
+        task.closure.Run();
+      continue;
+    }
+
+    // Sleep until there's work. A task may have been taken by another
+    // worker by the time we wake up, in which case we'll be back.
+    base::AutoLock lock(idle_lock_);
+    while (!base::subtle::Acquire_Load(&stopping_) &&
+           base::subtle::Acquire_Load(&num_queued_) == 0) {
+      work_available_.Wait();
+    }
+  }
+
+  current_worker_.Set(NULL);
+}
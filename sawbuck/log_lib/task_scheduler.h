@@ -0,0 +1,214 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Work-stealing task scheduler declaration.
+#ifndef SAWBUCK_LOG_LIB_TASK_SCHEDULER_H_
+#define SAWBUCK_LOG_LIB_TASK_SCHEDULER_H_
+
+#include <deque>
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_vector.h"
+#include "base/sequenced_task_runner.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/task_runner.h"
+#include "base/threading/thread_local.h"
+
+// A cancellation token is shared by the tasks of a job and by whoever may
+// cancel the job. Tasks that haven't started when their token is cancelled
+// are dropped, and long-running tasks are expected to poll IsCancelled.
+class CancellationToken
+    : public base::RefCountedThreadSafe<CancellationToken> {
+ public:
+  CancellationToken();
+
+  void Cancel();
+  bool IsCancelled() const;
+
+ private:
+  friend class base::RefCountedThreadSafe<CancellationToken>;
+  ~CancellationToken();
+
+  base::subtle::Atomic32 cancelled_;
+
+  DISALLOW_COPY_AND_ASSIGN(CancellationToken);
+};
+
+// Lets the tasks of a job read an object, e.g. a log view, that its owner
+// may take away when it cancels the job. Readers don't exclude each other,
+// so any number of tasks may read at once.
+class ReaderGuard {
+ public:
+  ReaderGuard();
+  ~ReaderGuard();
+
+  // Registers a reader.
+  // @returns true iff reading hasn't been revoked, in which case the caller
+  //     must call EndRead once it's done reading.
+  bool BeginRead();
+  void EndRead();
+
+  // Revokes reading, and waits for the readers in flight. The object read
+  // may go away after this returns.
+  void Revoke();
+
+ private:
+  base::Lock lock_;
+  // Signaled when the last reader is done.
+  base::ConditionVariable readers_done_;
+  int num_readers_;  // Under lock_.
+  bool revoked_;  // Under lock_.
+
+  DISALLOW_COPY_AND_ASSIGN(ReaderGuard);
+};
+
+// Reads under a ReaderGuard for its lifetime.
+class AutoReader {
+ public:
+  explicit AutoReader(ReaderGuard* guard)
+      : guard_(guard), can_read_(guard->BeginRead()) {
+  }
+
+  ~AutoReader() {
+    if (can_read_)
+      guard_->EndRead();
+  }
+
+  // @returns false iff reading was revoked before we started.
+  bool can_read() const { return can_read_; }
+
+ private:
+  ReaderGuard* guard_;
+  bool can_read_;
+
+  DISALLOW_COPY_AND_ASSIGN(AutoReader);
+};
+
+// Runs tasks on a pool of worker threads, one per processor by default, so
+// that all the background work of the viewer shares the cores without
+// oversubscribing them.
+//
+// Each worker has a queue per priority. Tasks posted from a worker go to its
+// own queues, where they're run most recent first, and tasks posted from
+// other threads go to shared queues. An idle worker steals the oldest task
+// from the other workers. Workers always take the highest priority task
+// they can find, so that interactive work preempts bulk work as soon as a
+// worker finishes a task. Long jobs should therefore be split into tasks
+// of a few milliseconds.
+class TaskScheduler {
+ public:
+  enum Priority {
+    // Work the user is waiting on, e.g. filtering the view.
+    INTERACTIVE,
+    // Work the user will want shortly, e.g. symbolizing stack traces.
+    BACKGROUND,
+    // Work that only needs to be done eventually, e.g. importing files.
+    BULK,
+
+    NUM_PRIORITIES,
+  };
+
+  // @param num_workers the number of worker threads, or zero for one per
+  //     processor.
+  explicit TaskScheduler(size_t num_workers);
+  // Stops the scheduler if it's running.
+  ~TaskScheduler();
+
+  // Starts the worker threads.
+  void Start();
+
+  // Joins the worker threads after their current tasks, dropping the tasks
+  // that haven't started. Tasks posted after this are dropped.
+  void Stop();
+
+  // Posts @p task to run at @p priority.
+  // @returns true iff the task was queued.
+  bool PostTask(Priority priority, const base::Closure& task);
+
+  // Posts @p task to run at @p priority, unless @p token has been cancelled
+  // by the time it's due to run.
+  // @returns true iff the task was queued.
+  bool PostTask(Priority priority,
+                CancellationToken* token,
+                const base::Closure& task);
+
+  // @returns a task runner that posts to this scheduler at @p priority.
+  // Delayed tasks aren't supported.
+  scoped_refptr<base::TaskRunner> GetTaskRunner(Priority priority);
+
+  // @returns a new task runner whose tasks run one at a time and in order,
+  //     at @p priority, on any of our workers. The scheduler must outlive
+  //     the tasks posted to it.
+  scoped_refptr<base::SequencedTaskRunner> CreateSequencedTaskRunner(
+      Priority priority);
+
+  // @returns true iff the calling thread is one of our workers.
+  bool RunsTasksOnCurrentThread() const;
+
+  size_t num_workers() const { return num_workers_; }
+
+ private:
+  struct Task {
+    base::Closure closure;
+    scoped_refptr<CancellationToken> token;
+  };
+  typedef std::deque<Task> TaskQueue;
+
+  class Worker;
+  class PriorityTaskRunner;
+  class SequencedTaskRunner;
+
+  // Posts @p task to the shared queue of @p priority, from which it's taken
+  // after the tasks queued before it, whichever thread we're on.
+  // @returns true iff the task was queued.
+  bool PostSharedTask(Priority priority, const base::Closure& task);
+
+  // Queues @p task, counts it and wakes a worker for it.
+  bool PostTaskImpl(Priority priority, const Task& task, bool shared);
+
+  // Takes the highest priority task available to @p worker.
+  // @returns true iff a task was taken.
+  bool TakeTask(Worker* worker, Task* task);
+
+  // Runs @p worker until we stop.
+  void RunWorker(Worker* worker);
+
+  const size_t num_workers_;
+  ScopedVector<Worker> workers_;
+
+  // The worker running on the current thread, if any.
+  base::ThreadLocalPointer<Worker> current_worker_;
+
+  base::Lock shared_lock_;
+  // The tasks posted from other threads, by priority.
+  TaskQueue shared_queues_[NUM_PRIORITIES];  // Under shared_lock_.
+
+  // The number of queued tasks. Workers sleep while it's zero.
+  base::subtle::Atomic32 num_queued_;
+  // Non-zero once we're stopping.
+  base::subtle::Atomic32 stopping_;
+
+  // Signaled when tasks are queued, or when we stop.
+  base::Lock idle_lock_;
+  base::ConditionVariable work_available_;
+
+  scoped_refptr<base::TaskRunner> task_runners_[NUM_PRIORITIES];
+
+  DISALLOW_COPY_AND_ASSIGN(TaskScheduler);
+};
+
+#endif  // SAWBUCK_LOG_LIB_TASK_SCHEDULER_H_
@@ -0,0 +1,287 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Task scheduler unittests.
+#include "sawbuck/log_lib/task_scheduler.h"
+
+#include <vector>
+#include "base/bind.h"
+#include "base/synchronization/waitable_event.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const base::TimeDelta kTimeout = base::TimeDelta::FromSeconds(10);
+
+// Records the order tasks run in, and signals once they've all run.
+class TaskRecorder {
+ public:
+  explicit TaskRecorder(size_t num_tasks)
+      : num_tasks_(num_tasks), done_(true, false) {
+  }
+
+  void Record(int id) {
+    base::AutoLock lock(lock_);
+    order_.push_back(id);
+    if (order_.size() == num_tasks_)
+      done_.Signal();
+  }
+
+  bool Wait() {
+    return done_.TimedWait(kTimeout);
+  }
+
+  std::vector<int> order() {
+    base::AutoLock lock(lock_);
+    return order_;
+  }
+
+ private:
+  size_t num_tasks_;
+  base::Lock lock_;
+  std::vector<int> order_;  // Under lock_.
+  base::WaitableEvent done_;
+};
+
+void SignalAndWait(base::WaitableEvent* signal,
+                   base::WaitableEvent* wait,
+                   bool* waited) {
+  signal->Signal();
+  *waited = wait->TimedWait(kTimeout);
+}
+
+void PostPair(TaskScheduler* scheduler,
+              base::WaitableEvent* first,
+              base::WaitableEvent* second,
+              bool* first_waited,
+              bool* second_waited) {
+  // Both tasks go to our own queue, so they can only meet if the other
+  // worker steals one of them.
+  scheduler->PostTask(TaskScheduler::BULK,
+                      base::Bind(&SignalAndWait, first, second,
+                                 first_waited));
+  scheduler->PostTask(TaskScheduler::BULK,
+                      base::Bind(&SignalAndWait, second, first,
+                                 second_waited));
+}
+
+void ReadAndWait(ReaderGuard* guard,
+                 base::WaitableEvent* signal,
+                 base::WaitableEvent* wait,
+                 bool* waited) {
+  AutoReader reader(guard);
+  if (reader.can_read())
+    SignalAndWait(signal, wait, waited);
+}
+
+TEST(TaskSchedulerTest, RunsAllTasks) {
+  TaskScheduler scheduler(0);
+  EXPECT_LT(0U, scheduler.num_workers());
+  scheduler.Start();
+
+  const int kNumTasks = 1000;
+  TaskRecorder recorder(kNumTasks);
+  for (int i = 0; i < kNumTasks; ++i) {
+    TaskScheduler::Priority priority =
+        static_cast<TaskScheduler::Priority>(i % TaskScheduler::NUM_PRIORITIES);
+    EXPECT_TRUE(scheduler.PostTask(priority, base::Bind(
+        &TaskRecorder::Record, base::Unretained(&recorder), i)));
+  }
+
+  EXPECT_TRUE(recorder.Wait());
+  scheduler.Stop();
+
+  EXPECT_EQ(kNumTasks, recorder.order().size());
+  EXPECT_FALSE(scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder), kNumTasks)));
+}
+
+TEST(TaskSchedulerTest, Priorities) {
+  TaskScheduler scheduler(1);
+  scheduler.Start();
+
+  // Keep the only worker busy while we queue the tasks.
+  base::WaitableEvent started(true, false);
+  base::WaitableEvent release(true, false);
+  bool waited = false;
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &SignalAndWait, &started, &release, &waited));
+  ASSERT_TRUE(started.TimedWait(kTimeout));
+
+  TaskRecorder recorder(4);
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder),
+      TaskScheduler::BULK));
+  scheduler.PostTask(TaskScheduler::BACKGROUND, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder),
+      TaskScheduler::BACKGROUND));
+  scheduler.PostTask(TaskScheduler::INTERACTIVE, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder),
+      TaskScheduler::INTERACTIVE));
+  scheduler.PostTask(TaskScheduler::INTERACTIVE, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder),
+      TaskScheduler::INTERACTIVE));
+
+  release.Signal();
+  ASSERT_TRUE(recorder.Wait());
+  EXPECT_TRUE(waited);
+
+  std::vector<int> order(recorder.order());
+  ASSERT_EQ(4, order.size());
+  EXPECT_EQ(TaskScheduler::INTERACTIVE, order[0]);
+  EXPECT_EQ(TaskScheduler::INTERACTIVE, order[1]);
+  EXPECT_EQ(TaskScheduler::BACKGROUND, order[2]);
+  EXPECT_EQ(TaskScheduler::BULK, order[3]);
+}
+
+TEST(TaskSchedulerTest, Cancellation) {
+  TaskScheduler scheduler(1);
+  scheduler.Start();
+
+  base::WaitableEvent started(true, false);
+  base::WaitableEvent release(true, false);
+  bool waited = false;
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &SignalAndWait, &started, &release, &waited));
+  ASSERT_TRUE(started.TimedWait(kTimeout));
+
+  scoped_refptr<CancellationToken> cancelled(new CancellationToken());
+  scoped_refptr<CancellationToken> live(new CancellationToken());
+  TaskRecorder recorder(2);
+  scheduler.PostTask(TaskScheduler::INTERACTIVE, cancelled.get(), base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder), 1));
+  scheduler.PostTask(TaskScheduler::INTERACTIVE, live.get(), base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder), 2));
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder), 3));
+
+  EXPECT_FALSE(cancelled->IsCancelled());
+  cancelled->Cancel();
+  EXPECT_TRUE(cancelled->IsCancelled());
+
+  release.Signal();
+  ASSERT_TRUE(recorder.Wait());
+
+  std::vector<int> order(recorder.order());
+  ASSERT_EQ(2, order.size());
+  EXPECT_EQ(2, order[0]);
+  EXPECT_EQ(3, order[1]);
+}
+
+TEST(TaskSchedulerTest, WorkStealing) {
+  TaskScheduler scheduler(2);
+  scheduler.Start();
+
+  base::WaitableEvent first(true, false);
+  base::WaitableEvent second(true, false);
+  bool first_waited = false;
+  bool second_waited = false;
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &PostPair, &scheduler, &first, &second, &first_waited, &second_waited));
+
+  // Stopping joins the workers after their tasks.
+  ASSERT_TRUE(first.TimedWait(kTimeout));
+  ASSERT_TRUE(second.TimedWait(kTimeout));
+  scheduler.Stop();
+
+  EXPECT_TRUE(first_waited);
+  EXPECT_TRUE(second_waited);
+}
+
+TEST(TaskSchedulerTest, SequencedTaskRunner) {
+  TaskScheduler scheduler(4);
+  scheduler.Start();
+
+  scoped_refptr<base::SequencedTaskRunner> runner(
+      scheduler.CreateSequencedTaskRunner(TaskScheduler::BACKGROUND));
+  EXPECT_FALSE(runner->RunsTasksOnCurrentThread());
+
+  const int kNumTasks = 1000;
+  TaskRecorder recorder(kNumTasks);
+  for (int i = 0; i < kNumTasks; ++i) {
+    EXPECT_TRUE(runner->PostTask(FROM_HERE, base::Bind(
+        &TaskRecorder::Record, base::Unretained(&recorder), i)));
+  }
+
+  ASSERT_TRUE(recorder.Wait());
+
+  // The tasks ran in order.
+  std::vector<int> order(recorder.order());
+  ASSERT_EQ(kNumTasks, order.size());
+  for (int i = 0; i < kNumTasks; ++i)
+    EXPECT_EQ(i, order[i]);
+}
+
+TEST(TaskSchedulerTest, ReaderGuard) {
+  TaskScheduler scheduler(2);
+  scheduler.Start();
+
+  // The readers can only meet if they read at once.
+  ReaderGuard guard;
+  base::WaitableEvent first(true, false);
+  base::WaitableEvent second(true, false);
+  bool first_waited = false;
+  bool second_waited = false;
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &ReadAndWait, &guard, &first, &second, &first_waited));
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &ReadAndWait, &guard, &second, &first, &second_waited));
+  ASSERT_TRUE(first.TimedWait(kTimeout));
+  ASSERT_TRUE(second.TimedWait(kTimeout));
+
+  // Revoking waits for the readers, and refuses new ones.
+  guard.Revoke();
+  EXPECT_TRUE(first_waited);
+  EXPECT_TRUE(second_waited);
+  EXPECT_FALSE(guard.BeginRead());
+
+  scheduler.Stop();
+}
+
+TEST(TaskSchedulerTest, SequencedTaskRunnerYields) {
+  TaskScheduler scheduler(1);
+  scheduler.Start();
+
+  // Keep the only worker busy while we queue the tasks.
+  base::WaitableEvent started(true, false);
+  base::WaitableEvent release(true, false);
+  bool waited = false;
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &SignalAndWait, &started, &release, &waited));
+  ASSERT_TRUE(started.TimedWait(kTimeout));
+
+  scoped_refptr<base::SequencedTaskRunner> runner(
+      scheduler.CreateSequencedTaskRunner(TaskScheduler::BULK));
+  TaskRecorder recorder(3);
+  runner->PostTask(FROM_HERE, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder), 1));
+  runner->PostTask(FROM_HERE, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder), 3));
+  scheduler.PostTask(TaskScheduler::BULK, base::Bind(
+      &TaskRecorder::Record, base::Unretained(&recorder), 2));
+
+  release.Signal();
+  ASSERT_TRUE(recorder.Wait());
+  EXPECT_TRUE(waited);
+
+  // The runner's second task waited its turn behind the task queued after
+  // its first.
+  std::vector<int> order(recorder.order());
+  ASSERT_EQ(3, order.size());
+  EXPECT_EQ(1, order[0]);
+  EXPECT_EQ(2, order[1]);
+  EXPECT_EQ(3, order[2]);
+}
+
+}  // namespace
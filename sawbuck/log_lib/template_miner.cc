@@ -0,0 +1,282 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log message template miner implementation.
+#include "sawbuck/log_lib/template_miner.h"
+
+#include "base/logging.h"
+#include "base/stl_util.h"
+
+namespace {
+
+// Splits @p message at single spaces. There's always at least one token.
+void Tokenize(const base::StringPiece& message,
+              std::vector<base::StringPiece>* tokens) {
+  tokens->clear();
+  size_t start = 0;
+  while (true) {
+    size_t end = message.find(' ', start);
+    if (end == base::StringPiece::npos) {
+      tokens->push_back(message.substr(start));
+      return;
+    }
+
+    tokens->push_back(message.substr(start, end - start));
+    start = end + 1;
+  }
+}
+
+// Tokens with digits are most likely numbers, pointers or ids.
+bool HasDigit(const base::StringPiece& token) {
+  for (size_t i = 0; i < token.size(); ++i) {
+    if (token[i] >= '0' && token[i] <= '9')
+      return true;
+  }
+
+  return false;
+}
+
+}  // namespace
+
+const size_t TemplateMiner::kDefaultDepth;
+const int TemplateMiner::kDefaultSimilarityPercent;
+const size_t TemplateMiner::kDefaultMaxChildren;
+const char TemplateMiner::kParameterText[] = "<*>";
+
+struct TemplateMiner::Node {
+  ~Node() {
+    STLDeleteValues(&children);
+  }
+
+  // The children of an inner node, keyed by token.
+  typedef std::map<std::string, Node*> ChildMap;
+  ChildMap children;
+
+  // The clusters at a leaf.
+  std::vector<int> cluster_ids;
+};
+
+TemplateMiner::TemplateMiner()
+    : depth_(kDefaultDepth),
+      similarity_percent_(kDefaultSimilarityPercent),
+      max_children_(kDefaultMaxChildren) {
+}
+
+TemplateMiner::TemplateMiner(size_t depth,
+                             int similarity_percent,
+                             size_t max_children)
+    : depth_(depth),
+      similarity_percent_(similarity_percent),
+      max_children_(max_children) {
+  DCHECK_LE(2U, depth_);
+  DCHECK_LE(1U, max_children_);
+}
+
+TemplateMiner::~TemplateMiner() {
+  STLDeleteValues(&root_);
+}
+
+int TemplateMiner::AddMessage(const base::StringPiece& message,
+                              std::string* parameters) {
+  DCHECK(parameters != NULL);
+
+  std::vector<base::StringPiece> tokens;
+  Tokenize(message, &tokens);
+
+  // Route the message to a leaf on its token count and leading tokens.
+  Node*& length_node = root_[tokens.size()];
+  if (length_node == NULL)
+    length_node = new Node();
+
+  Node* node = length_node;
+  for (size_t i = 0; i + 2 < depth_ && i < tokens.size(); ++i) {
+    std::string key(kParameterText);
+    if (!HasDigit(tokens[i]))
+      tokens[i].CopyToString(&key);
+
+    Node::ChildMap::iterator it(node->children.find(key));
+    if (it == node->children.end() &&
+        node->children.size() >= max_children_) {
+      // This node is full, route the token as a parameter.
+      key = kParameterText;
+      it = node->children.find(key);
+    }
+
+    if (it == node->children.end())
+      it = node->children.insert(std::make_pair(key, new Node())).first;
+
+    node = it->second;
+  }
+
+  int template_id = -1;
+  int cluster_id = FindCluster(node->cluster_ids, tokens);
+  if (cluster_id == -1) {
+    // Start a new cluster, guessing that tokens with digits are parameters.
+    TokenList new_tokens(tokens.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      new_tokens[i].is_parameter = HasDigit(tokens[i]);
+      if (!new_tokens[i].is_parameter)
+        tokens[i].CopyToString(&new_tokens[i].text);
+    }
+
+    cluster_id = clusters_.size();
+    clusters_.push_back(-1);
+    node->cluster_ids.push_back(cluster_id);
+    template_id = AddTemplate(cluster_id, new_tokens);
+  } else {
+    // Join the cluster, making the tokens that differ parameters.
+    template_id = clusters_[cluster_id];
+    const TokenList& old_tokens = templates_[template_id].tokens;
+    DCHECK_EQ(tokens.size(), old_tokens.size());
+
+    TokenList new_tokens(old_tokens);
+    bool generalized = false;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      if (!new_tokens[i].is_parameter && tokens[i] != new_tokens[i].text) {
+        new_tokens[i].is_parameter = true;
+        new_tokens[i].text.clear();
+        generalized = true;
+      }
+    }
+
+    if (generalized)
+      template_id = AddTemplate(cluster_id, new_tokens);
+  }
+
+  // Pack the parameters.
+  parameters->clear();
+  const TokenList& template_tokens = templates_[template_id].tokens;
+  bool first = true;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (!template_tokens[i].is_parameter)
+      continue;
+
+    if (!first)
+      parameters->push_back(' ');
+    tokens[i].AppendToString(parameters);
+    first = false;
+  }
+
+  return template_id;
+}
+
+void TemplateMiner::FormatMessage(int template_id,
+                                  const base::StringPiece& parameters,
+                                  std::string* message) const {
+  DCHECK_LE(0, template_id);
+  DCHECK_GT(templates_.size(), static_cast<size_t>(template_id));
+  DCHECK(message != NULL);
+
+  message->clear();
+  const TokenList& tokens = templates_[template_id].tokens;
+  size_t next_parameter = 0;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (i != 0)
+      message->push_back(' ');
+
+    if (!tokens[i].is_parameter) {
+      message->append(tokens[i].text);
+      continue;
+    }
+
+    // Take the next parameter, up to the next space.
+    size_t end = parameters.find(' ', next_parameter);
+    if (end == base::StringPiece::npos)
+      end = parameters.size();
+    parameters.substr(next_parameter,
+                      end - next_parameter).AppendToString(message);
+    next_parameter = end + 1;
+  }
+}
+
+std::string TemplateMiner::GetTemplateText(int template_id) const {
+  DCHECK_LE(0, template_id);
+  DCHECK_GT(templates_.size(), static_cast<size_t>(template_id));
+
+  std::string text;
+  const TokenList& tokens = templates_[template_id].tokens;
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (i != 0)
+      text.push_back(' ');
+    text.append(tokens[i].is_parameter ? kParameterText : tokens[i].text);
+  }
+
+  return text;
+}
+
+int TemplateMiner::GetClusterId(int template_id) const {
+  DCHECK_LE(0, template_id);
+  DCHECK_GT(templates_.size(), static_cast<size_t>(template_id));
+
+  return templates_[template_id].cluster_id;
+}
+
+int TemplateMiner::GetClusterTemplateId(int cluster_id) const {
+  DCHECK_LE(0, cluster_id);
+  DCHECK_GT(clusters_.size(), static_cast<size_t>(cluster_id));
+
+  return clusters_[cluster_id];
+}
+
+int TemplateMiner::FindCluster(
+    const std::vector<int>& cluster_ids,
+    const std::vector<base::StringPiece>& tokens) const {
+  // Pick the cluster that shares the most tokens with the message, counting
+  // parameters as shared. On ties, prefer the cluster with more parameters,
+  // as it's the more general.
+  int best_cluster_id = -1;
+  size_t best_shared = 0;
+  size_t best_parameters = 0;
+  for (size_t i = 0; i < cluster_ids.size(); ++i) {
+    const TokenList& template_tokens =
+        templates_[clusters_[cluster_ids[i]]].tokens;
+    DCHECK_EQ(tokens.size(), template_tokens.size());
+
+    size_t shared = 0;
+    size_t parameters = 0;
+    for (size_t j = 0; j < tokens.size(); ++j) {
+      if (template_tokens[j].is_parameter) {
+        ++shared;
+        ++parameters;
+      } else if (tokens[j] == template_tokens[j].text) {
+        ++shared;
+      }
+    }
+
+    if (best_cluster_id == -1 || shared > best_shared ||
+        (shared == best_shared && parameters > best_parameters)) {
+      best_cluster_id = cluster_ids[i];
+      best_shared = shared;
+      best_parameters = parameters;
+    }
+  }
+
+  if (best_cluster_id == -1 ||
+      best_shared * 100 < tokens.size() * similarity_percent_) {
+    return -1;
+  }
+
+  return best_cluster_id;
+}
+
+int TemplateMiner::AddTemplate(int cluster_id, const TokenList& tokens) {
+  int template_id = templates_.size();
+  templates_.push_back(Template());
+  templates_.back().cluster_id = cluster_id;
+  templates_.back().tokens = tokens;
+
+  clusters_[cluster_id] = template_id;
+
+  return template_id;
+}
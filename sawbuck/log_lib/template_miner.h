@@ -0,0 +1,128 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log message template miner declaration.
+#ifndef SAWBUCK_LOG_LIB_TEMPLATE_MINER_H_
+#define SAWBUCK_LOG_LIB_TEMPLATE_MINER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
+
+// Mines the templates of log messages online, after the Drain algorithm.
+// Log messages tend to differ only by numbers, pointers and ids, so a
+// message is split into tokens at spaces, and tokens that vary between
+// similar messages become the parameters of a template.
+//
+// Messages are routed through a parse tree of fixed depth, first on their
+// number of tokens, then on their leading tokens. At the leaves, a message
+// joins the most similar cluster of messages, or starts a new one.
+// Joining a cluster may turn more of its tokens into parameters, which
+// yields a new template for the cluster. Templates never change, so that a
+// message can always be restored from its template and parameters.
+//
+// Tokens are split at single spaces, and parameters are packed into a string
+// separated by single spaces. As no token contains a space, this is
+// lossless, and the parameters take no more space than they did in the
+// message.
+class TemplateMiner {
+ public:
+  // The defaults for the parse tree.
+  static const size_t kDefaultDepth = 4;
+  static const int kDefaultSimilarityPercent = 50;
+  static const size_t kDefaultMaxChildren = 100;
+
+  // The text a parameter shows as in templates.
+  static const char kParameterText[];
+
+  TemplateMiner();
+  // @param depth the depth of the parse tree, counting the root and the
+  //     token count layer. Messages are routed on their first depth - 2
+  //     tokens.
+  // @param similarity_percent the percentage of tokens a message must share
+  //     with the template of a cluster to join it.
+  // @param max_children the number of children of an inner node, beyond
+  //     which tokens are routed as parameters.
+  TemplateMiner(size_t depth, int similarity_percent, size_t max_children);
+  ~TemplateMiner();
+
+  // Mines @p message.
+  // @param parameters receives the parameters of the message, separated by
+  //     single spaces.
+  // @returns the id of the template of the message.
+  int AddMessage(const base::StringPiece& message, std::string* parameters);
+
+  // Restores a message from its template and parameters.
+  void FormatMessage(int template_id,
+                     const base::StringPiece& parameters,
+                     std::string* message) const;
+
+  // @returns the text of the template @p template_id, with parameters shown
+  //     as kParameterText.
+  std::string GetTemplateText(int template_id) const;
+
+  // @returns the id of the cluster of template @p template_id. All the
+  //     templates of a cluster are generalizations of its first template.
+  int GetClusterId(int template_id) const;
+
+  // @returns the id of the current, most general template of cluster
+  //     @p cluster_id.
+  int GetClusterTemplateId(int cluster_id) const;
+
+  size_t num_templates() const { return templates_.size(); }
+  size_t num_clusters() const { return clusters_.size(); }
+
+ private:
+  struct Token {
+    std::string text;
+    bool is_parameter;
+  };
+  typedef std::vector<Token> TokenList;
+
+  struct Template {
+    int cluster_id;
+    TokenList tokens;
+  };
+
+  // An inner node of the parse tree, or a leaf holding the ids of clusters.
+  struct Node;
+
+  // Finds the most similar cluster among @p cluster_ids to @p tokens.
+  // @returns the id of the cluster, or -1 if none is similar enough.
+  int FindCluster(const std::vector<int>& cluster_ids,
+                  const std::vector<base::StringPiece>& tokens) const;
+
+  // Adds a template to cluster @p cluster_id.
+  // @returns the id of the template.
+  int AddTemplate(int cluster_id, const TokenList& tokens);
+
+  const size_t depth_;
+  const int similarity_percent_;
+  const size_t max_children_;
+
+  // The root of the parse tree, keyed by number of tokens.
+  typedef std::map<size_t, Node*> LengthMap;
+  LengthMap root_;
+
+  // The templates, indexed by template id.
+  std::vector<Template> templates_;
+  // The current template id of each cluster, indexed by cluster id.
+  std::vector<int> clusters_;
+
+  DISALLOW_COPY_AND_ASSIGN(TemplateMiner);
+};
+
+#endif  // SAWBUCK_LOG_LIB_TEMPLATE_MINER_H_
@@ -0,0 +1,125 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Template miner unittests.
+#include "sawbuck/log_lib/template_miner.h"
+
+#include "base/strings/stringprintf.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// Mines @p message and checks that it's restored from its template and
+// parameters.
+int AddMessage(TemplateMiner* miner,
+               const std::string& message,
+               std::string* parameters) {
+  int template_id = miner->AddMessage(message, parameters);
+
+  std::string restored;
+  miner->FormatMessage(template_id, *parameters, &restored);
+  EXPECT_EQ(message, restored);
+
+  return template_id;
+}
+
+TEST(TemplateMinerTest, NumbersAreParameters) {
+  TemplateMiner miner;
+  std::string parameters;
+
+  int first = AddMessage(&miner, "Loaded 0x1234 in 5 ms", &parameters);
+  EXPECT_EQ("0x1234 5", parameters);
+  EXPECT_EQ("Loaded <*> in <*> ms", miner.GetTemplateText(first));
+
+  int second = AddMessage(&miner, "Loaded 0xABC0 in 17 ms", &parameters);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ("0xABC0 17", parameters);
+
+  EXPECT_EQ(1U, miner.num_templates());
+  EXPECT_EQ(1U, miner.num_clusters());
+}
+
+TEST(TemplateMinerTest, Generalize) {
+  TemplateMiner miner;
+  std::string parameters;
+
+  int foo_id = AddMessage(&miner, "Connected to host foo", &parameters);
+  EXPECT_EQ("", parameters);
+  EXPECT_EQ("Connected to host foo", miner.GetTemplateText(foo_id));
+
+  // The differing token becomes a parameter in a new template of the
+  // same cluster.
+  int bar_id = AddMessage(&miner, "Connected to host bar", &parameters);
+  EXPECT_NE(foo_id, bar_id);
+  EXPECT_EQ("bar", parameters);
+  EXPECT_EQ("Connected to host <*>", miner.GetTemplateText(bar_id));
+  EXPECT_EQ(miner.GetClusterId(foo_id), miner.GetClusterId(bar_id));
+  EXPECT_EQ(bar_id, miner.GetClusterTemplateId(miner.GetClusterId(foo_id)));
+
+  // The first template is unchanged.
+  EXPECT_EQ("Connected to host foo", miner.GetTemplateText(foo_id));
+  std::string restored;
+  miner.FormatMessage(foo_id, "", &restored);
+  EXPECT_EQ("Connected to host foo", restored);
+
+  EXPECT_EQ(bar_id, AddMessage(&miner, "Connected to host baz", &parameters));
+  EXPECT_EQ(2U, miner.num_templates());
+  EXPECT_EQ(1U, miner.num_clusters());
+}
+
+TEST(TemplateMinerTest, DissimilarMessages) {
+  TemplateMiner miner;
+  std::string parameters;
+
+  int first = AddMessage(&miner, "Connected to host foo", &parameters);
+  int second = AddMessage(&miner, "Connected from a proxy", &parameters);
+  int third = AddMessage(&miner, "Connected to host", &parameters);
+
+  EXPECT_NE(miner.GetClusterId(first), miner.GetClusterId(second));
+  EXPECT_NE(miner.GetClusterId(first), miner.GetClusterId(third));
+  EXPECT_EQ(3U, miner.num_clusters());
+}
+
+TEST(TemplateMinerTest, Lossless) {
+  TemplateMiner miner;
+  std::string parameters;
+
+  // Empty tokens and whitespace other than single spaces are preserved.
+  AddMessage(&miner, "", &parameters);
+  AddMessage(&miner, " ", &parameters);
+  AddMessage(&miner, "two  spaces 1", &parameters);
+  AddMessage(&miner, "two  spaces 2", &parameters);
+  AddMessage(&miner, "line\nbreak 3 ", &parameters);
+  AddMessage(&miner, "line\nbreak 4 ", &parameters);
+  AddMessage(&miner, "42", &parameters);
+  AddMessage(&miner, "43", &parameters);
+  AddMessage(&miner, "<*> 44", &parameters);
+}
+
+TEST(TemplateMinerTest, FullNodes) {
+  // Route on a single token, with room for two children.
+  TemplateMiner miner(3, 50, 2);
+  std::string parameters;
+
+  for (int i = 0; i < 10; ++i) {
+    std::string message(base::StringPrintf("%c happened", 'a' + i));
+    AddMessage(&miner, message, &parameters);
+  }
+
+  // Once the node filled up, the other messages were routed together, and
+  // joined in a cluster.
+  EXPECT_EQ(3U, miner.num_clusters());
+}
+
+}  // namespace
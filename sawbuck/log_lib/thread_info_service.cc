@@ -0,0 +1,166 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Thread information service implementation.
+#include "sawbuck/log_lib/thread_info_service.h"
+
+#include "base/logging.h"
+
+bool IThreadInfoService::ThreadInfo::operator == (
+    const ThreadInfo& other) const {
+  return started_ == other.started_ &&
+         ended_ == other.ended_ &&
+         thread_id_ == other.thread_id_ &&
+         process_id_ == other.process_id_ &&
+         start_address_ == other.start_address_ &&
+         name_ == other.name_;
+}
+
+ThreadInfoService::ThreadInfoService() {
+}
+
+ThreadInfoService::~ThreadInfoService() {
+}
+
+ThreadInfoService::ThreadInfoMap::iterator ThreadInfoService::FindThread(
+    DWORD thread_id, const base::Time& time) {
+  lock_.AssertAcquired();
+  ThreadKey key = std::make_pair(thread_id, time);
+  ThreadInfoMap::iterator it(thread_info_.lower_bound(key));
+
+  // Either we have an exact match on {TID, time}, or else lower bound
+  // returned the next largest {TID, time} key, and we need to back up one
+  // to get at the thread that may span time.
+  if (it == thread_info_.end() || it->first != key) {
+    if (it == thread_info_.begin())
+      return thread_info_.end();
+
+    --it;
+  }
+
+  // Match on tid, and (start <= time < end) - where zero end time means
+  // infinity.
+  if (it->first.first == thread_id && it->second.started_ <= time &&
+      (it->second.ended_ == base::Time() || time < it->second.ended_)) {
+    return it;
+  }
+
+  return thread_info_.end();
+}
+
+bool ThreadInfoService::SetThreadName(DWORD thread_id,
+    const base::Time& time, const std::wstring& name) {
+  base::AutoLock lock(lock_);
+
+  ThreadInfoMap::iterator it(FindThread(thread_id, time));
+  if (it == thread_info_.end())
+    return false;
+
+  it->second.name_ = name;
+  return true;
+}
+
+bool ThreadInfoService::GetThreadInfo(DWORD thread_id,
+    const base::Time& time, IThreadInfoService::ThreadInfo* info) {
+  base::AutoLock lock(lock_);
+
+  DCHECK(info != NULL);
+  ThreadInfoMap::iterator it(FindThread(thread_id, time));
+
+  if (it != thread_info_.end()) {
+    *info = it->second;
+    return true;
+  }
+
+  return false;
+}
+
+void ThreadInfoService::OnThreadIsRunning(const base::Time& time,
+    const KernelThreadEvents::ThreadInfo& thread_info) {
+  // Record it as started at epoch.
+  OnThreadStarted(base::Time(), thread_info);
+}
+
+void ThreadInfoService::OnThreadStarted(const base::Time& time,
+    const KernelThreadEvents::ThreadInfo& thread_info) {
+  base::AutoLock lock(lock_);
+
+  // See whether we have a record of this tid/time already.
+  ThreadInfoMap::iterator it(FindThread(thread_info.thread_id, time));
+  if (it == thread_info_.end()) {
+    IThreadInfoService::ThreadInfo to_insert = {
+        time,  // started_
+        base::Time(),  // ended_
+        thread_info.thread_id,
+        thread_info.process_id,
+        thread_info.start_address,
+        L"",
+      };
+
+    ThreadKey key(thread_info.thread_id, time);
+    thread_info_.insert(std::make_pair(key, to_insert));
+  } else {
+    // Make a copy of the thread info.
+    IThreadInfoService::ThreadInfo copy = it->second;
+
+    // We should have had an end time in the previous callback.
+    DCHECK(base::Time() == copy.started_);
+    DCHECK(base::Time() != copy.ended_);
+    DCHECK_EQ(thread_info.process_id, copy.process_id_);
+
+    // Thread end events before version 2 don't carry the start address.
+    if (copy.start_address_ == 0)
+      copy.start_address_ = thread_info.start_address;
+
+    // Drop the old entry, fix up the start time and reinsert it.
+    thread_info_.erase(it);
+
+    copy.started_ = time;
+    ThreadKey key(thread_info.thread_id, time);
+    thread_info_.insert(std::make_pair(key, copy));
+  }
+}
+
+void ThreadInfoService::OnThreadEnded(const base::Time& time,
+    const KernelThreadEvents::ThreadInfo& thread_info) {
+  base::AutoLock lock(lock_);
+
+  // See whether we have a record of this tid/time already.
+  ThreadInfoMap::iterator it(FindThread(thread_info.thread_id, time));
+  if (it == thread_info_.end()) {
+    IThreadInfoService::ThreadInfo to_insert = {
+        base::Time(),  // started_
+        time,  // ended_
+        thread_info.thread_id,
+        thread_info.process_id,
+        thread_info.start_address,
+        L"",
+      };
+
+    ThreadKey key(thread_info.thread_id, base::Time());
+    thread_info_.insert(std::make_pair(key, to_insert));
+  } else {
+    // We should not have had an end time in the previous callback.
+    DCHECK(base::Time() == it->second.ended_);
+    DCHECK_EQ(thread_info.process_id, it->second.process_id_);
+
+    it->second.ended_ = time;
+  }
+}
+
+void ThreadInfoService::OnContextSwitch(const base::Time& time,
+    UCHAR processor,
+    const KernelThreadEvents::ContextSwitchInfo& switch_info) {
+  // Context switches don't affect thread lifetimes.
+}
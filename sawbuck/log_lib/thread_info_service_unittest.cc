@@ -0,0 +1,133 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Thread information service unittests.
+#include "sawbuck/log_lib/thread_info_service.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+const DWORD kTid = 0x42;
+const DWORD kPid = 0x99;
+const DWORD kOtherPid = 0x101;
+const sym_util::Address kStartAddress = 0x77001234;
+
+class ThreadInfoServiceTest: public testing::Test {
+ public:
+  ThreadInfoServiceTest() : kT0(base::Time()), kT1(base::Time::Now()),
+      kT2(kT1 + base::TimeDelta::FromMilliseconds(97)),
+      kT3(kT2 + base::TimeDelta::FromMilliseconds(13)) {
+  }
+
+ protected:
+  KernelThreadEvents::ThreadInfo MakeInfo(DWORD process_id,
+                                          sym_util::Address start_address) {
+    KernelThreadEvents::ThreadInfo info = {
+        process_id,
+        kTid,
+        0,  // user_stack_base
+        0,  // user_stack_limit
+        start_address,
+      };
+    return info;
+  }
+
+  ThreadInfoService service_;
+  const base::Time kT0;
+  const base::Time kT1;
+  const base::Time kT2;
+  const base::Time kT3;
+};
+
+TEST_F(ThreadInfoServiceTest, LookupOnEmpty) {
+  IThreadInfoService::ThreadInfo info = {};
+
+  EXPECT_FALSE(service_.GetThreadInfo(0, kT0, &info));
+  EXPECT_FALSE(service_.GetThreadInfo(kTid, kT0, &info));
+  EXPECT_FALSE(service_.SetThreadName(kTid, kT0, L"Main"));
+}
+
+TEST_F(ThreadInfoServiceTest, IsRunningAndEnds) {
+  service_.OnThreadIsRunning(kT1, MakeInfo(kPid, kStartAddress));
+
+  IThreadInfoService::ThreadInfo info = {};
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT0, &info));
+  EXPECT_TRUE(kT0 == info.started_);
+  EXPECT_TRUE(kT0 == info.ended_);
+  EXPECT_EQ(kTid, info.thread_id_);
+  EXPECT_EQ(kPid, info.process_id_);
+  EXPECT_EQ(kStartAddress, info.start_address_);
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT2, &info));
+
+  service_.OnThreadEnded(kT2, MakeInfo(kPid, kStartAddress));
+
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT1, &info));
+  EXPECT_TRUE(kT2 == info.ended_);
+  EXPECT_FALSE(service_.GetThreadInfo(kTid, kT2, &info));
+}
+
+TEST_F(ThreadInfoServiceTest, ReusedThreadId) {
+  // The same thread id is used by two threads in different processes.
+  service_.OnThreadStarted(kT0, MakeInfo(kPid, kStartAddress));
+  service_.OnThreadEnded(kT1, MakeInfo(kPid, kStartAddress));
+  service_.OnThreadStarted(kT2, MakeInfo(kOtherPid, 0));
+
+  IThreadInfoService::ThreadInfo info = {};
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT0, &info));
+  EXPECT_EQ(kPid, info.process_id_);
+
+  // The thread id is unused between kT1 and kT2.
+  EXPECT_FALSE(service_.GetThreadInfo(kTid, kT1, &info));
+
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT2, &info));
+  EXPECT_EQ(kOtherPid, info.process_id_);
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT3, &info));
+  EXPECT_EQ(kOtherPid, info.process_id_);
+}
+
+TEST_F(ThreadInfoServiceTest, EndStart) {
+  // Signal ending ahead of starting, the result should be as for a start
+  // followed by an end. The version 1 end event has no start address.
+  service_.OnThreadEnded(kT2, MakeInfo(kPid, 0));
+  service_.OnThreadStarted(kT1, MakeInfo(kPid, kStartAddress));
+
+  IThreadInfoService::ThreadInfo info = {};
+  EXPECT_FALSE(service_.GetThreadInfo(kTid, kT0, &info));
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT1, &info));
+
+  EXPECT_TRUE(kT1 == info.started_);
+  EXPECT_TRUE(kT2 == info.ended_);
+  EXPECT_EQ(kPid, info.process_id_);
+  EXPECT_EQ(kStartAddress, info.start_address_);
+
+  EXPECT_FALSE(service_.GetThreadInfo(kTid, kT2, &info));
+}
+
+TEST_F(ThreadInfoServiceTest, SetThreadName) {
+  service_.OnThreadStarted(kT0, MakeInfo(kPid, kStartAddress));
+  service_.OnThreadEnded(kT1, MakeInfo(kPid, kStartAddress));
+  service_.OnThreadStarted(kT2, MakeInfo(kOtherPid, kStartAddress));
+
+  EXPECT_TRUE(service_.SetThreadName(kTid, kT3, L"Worker"));
+
+  IThreadInfoService::ThreadInfo info = {};
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT2, &info));
+  EXPECT_EQ(L"Worker", info.name_);
+
+  // The earlier thread with the same id is unaffected.
+  EXPECT_TRUE(service_.GetThreadInfo(kTid, kT0, &info));
+  EXPECT_EQ(L"", info.name_);
+}
+
+}  // namespace
@@ -0,0 +1,171 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Native event decoder implementation.
+#include "sawbuck/py/etw/decoder/event_decoder.h"
+
+#include "sawbuck/common/buffer_parser.h"
+
+namespace {
+
+// Reads a value of type ValueType from @p reader and stores it to
+// @p field, sign- or zero-extended according to ValueType.
+template <class ValueType>
+bool ReadIntegral(BinaryBufferReader* reader, EtwDecodedField* field) {
+  const ValueType* value = NULL;
+  if (!reader->Read(&value))
+    return false;
+
+  // Casting through the signed or unsigned 64 bit type of the same
+  // signedness as ValueType gives us the proper extension.
+  if (static_cast<ValueType>(-1) < 0)
+    field->value = static_cast<ULONGLONG>(static_cast<LONGLONG>(*value));
+  else
+    field->value = static_cast<ULONGLONG>(*value);
+
+  return true;
+}
+
+template <class CharType>
+bool ReadString(BinaryBufferReader* reader, EtwDecodedField* field) {
+  const CharType* str = NULL;
+  size_t str_len = 0;
+  field->offset = static_cast<ULONG>(reader->pos());
+  if (!reader->ReadString(&str, &str_len))
+    return false;
+
+  field->length = static_cast<ULONG>(str_len);
+  return true;
+}
+
+// Reads an optional SID, which is preceded by two pointers. If the first
+// pointer is NULL there is no SID and the field length is set to zero.
+EtwDecodeResult ReadSid(BinaryBufferReader* reader,
+                        bool is_64_bit_log,
+                        EtwDecodedField* field) {
+  size_t ptr_size = is_64_bit_log ? sizeof(ULONGLONG) : sizeof(ULONG);
+  const void* has_sid = NULL;
+  if (!reader->Read(ptr_size, &has_sid))
+    return kEtwDecodeBufferOverflow;
+
+  bool sid_present = is_64_bit_log ?
+      *reinterpret_cast<const ULONGLONG*>(has_sid) != 0 :
+      *reinterpret_cast<const ULONG*>(has_sid) != 0;
+  if (!sid_present)
+    return kEtwDecodeSuccess;
+
+  // Skip the second pointer.
+  if (!reader->Consume(ptr_size))
+    return kEtwDecodeBufferOverflow;
+
+  // Probe the front of the SID structure.
+  const SID* sid = NULL;
+  if (!reader->Peek(FIELD_OFFSET(SID, SubAuthority), &sid))
+    return kEtwDecodeBufferOverflow;
+  if (!::IsValidSid(const_cast<SID*>(sid)))
+    return kEtwDecodeDataError;
+
+  DWORD sid_len = ::GetLengthSid(const_cast<SID*>(sid));
+  field->offset = static_cast<ULONG>(reader->pos());
+  if (!reader->Consume(sid_len))
+    return kEtwDecodeBufferOverflow;
+
+  field->length = sid_len;
+  return kEtwDecodeSuccess;
+}
+
+EtwDecodeResult DecodeField(BYTE field_type,
+                            bool is_64_bit_log,
+                            BinaryBufferReader* reader,
+                            EtwDecodedField* field) {
+  bool success = false;
+  switch (field_type) {
+    case kEtwFieldBoolean:
+    case kEtwFieldUInt8:
+      success = ReadIntegral<UCHAR>(reader, field);
+      break;
+    case kEtwFieldInt8:
+      success = ReadIntegral<CHAR>(reader, field);
+      break;
+    case kEtwFieldInt16:
+      success = ReadIntegral<SHORT>(reader, field);
+      break;
+    case kEtwFieldUInt16:
+      success = ReadIntegral<USHORT>(reader, field);
+      break;
+    case kEtwFieldInt32:
+      success = ReadIntegral<LONG>(reader, field);
+      break;
+    case kEtwFieldUInt32:
+      success = ReadIntegral<ULONG>(reader, field);
+      break;
+    case kEtwFieldInt64:
+      success = ReadIntegral<LONGLONG>(reader, field);
+      break;
+    case kEtwFieldUInt64:
+    case kEtwFieldWmiTime:
+      success = ReadIntegral<ULONGLONG>(reader, field);
+      break;
+    case kEtwFieldPointer:
+      if (is_64_bit_log)
+        success = ReadIntegral<ULONGLONG>(reader, field);
+      else
+        success = ReadIntegral<ULONG>(reader, field);
+      break;
+    case kEtwFieldString:
+      success = ReadString<char>(reader, field);
+      break;
+    case kEtwFieldWString:
+      success = ReadString<wchar_t>(reader, field);
+      break;
+    case kEtwFieldSid:
+      return ReadSid(reader, is_64_bit_log, field);
+
+    default:
+      return kEtwDecodeBadPlan;
+  }
+
+  return success ? kEtwDecodeSuccess : kEtwDecodeBufferOverflow;
+}
+
+}  // namespace
+
+int __stdcall DecodeEventFields(const BYTE* plan,
+                                int plan_len,
+                                int is_64_bit_log,
+                                const void* data,
+                                int data_len,
+                                EtwDecodedField* fields,
+                                int* failed_field) {
+  if (plan == NULL || fields == NULL || plan_len < 0 || data_len < 0)
+    return kEtwDecodeBadPlan;
+
+  BinaryBufferReader reader(data, data_len);
+  for (int i = 0; i < plan_len; ++i) {
+    EtwDecodedField* field = &fields[i];
+    field->value = 0;
+    field->offset = 0;
+    field->length = 0;
+
+    EtwDecodeResult result =
+        DecodeField(plan[i], is_64_bit_log != 0, &reader, field);
+    if (result != kEtwDecodeSuccess) {
+      if (failed_field != NULL)
+        *failed_field = i;
+      return result;
+    }
+  }
+
+  return kEtwDecodeSuccess;
+}
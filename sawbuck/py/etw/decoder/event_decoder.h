@@ -0,0 +1,88 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Native event decoder backing the etw.descriptors Python package.
+//
+// The Python side compiles the _fields_ list of each EventClass into a
+// decoding plan, which is a byte string of EtwFieldType opcodes. A single
+// call to DecodeEventFields then walks the MOF data of an event according
+// to that plan and reports the value or the location of every field.
+#ifndef SAWBUCK_PY_ETW_DECODER_EVENT_DECODER_H_
+#define SAWBUCK_PY_ETW_DECODER_EVENT_DECODER_H_
+
+#include <windows.h>
+
+// The field types known to the decoder. These values must be kept in sync
+// with the opcodes in etw/descriptors/decoder.py.
+enum EtwFieldType {
+  kEtwFieldBoolean = 0,
+  kEtwFieldInt8 = 1,
+  kEtwFieldUInt8 = 2,
+  kEtwFieldInt16 = 3,
+  kEtwFieldUInt16 = 4,
+  kEtwFieldInt32 = 5,
+  kEtwFieldUInt32 = 6,
+  kEtwFieldInt64 = 7,
+  kEtwFieldUInt64 = 8,
+  kEtwFieldPointer = 9,
+  kEtwFieldString = 10,
+  kEtwFieldWString = 11,
+  kEtwFieldSid = 12,
+  kEtwFieldWmiTime = 13,
+};
+
+// The result codes returned from DecodeEventFields.
+enum EtwDecodeResult {
+  kEtwDecodeSuccess = 0,
+  // The plan ran past the end of the buffer.
+  kEtwDecodeBufferOverflow = 1,
+  // The buffer contained invalid data, e.g. a malformed SID.
+  kEtwDecodeDataError = 2,
+  // The plan contained an unknown opcode.
+  kEtwDecodeBadPlan = 3,
+};
+
+// The decoded representation of a single field.
+struct EtwDecodedField {
+  // For integral fields, the value zero- or sign-extended to 64 bits.
+  ULONGLONG value;
+  // For string and SID fields, the byte offset of the data in the buffer.
+  ULONG offset;
+  // For string fields, the length in characters excluding the terminator.
+  // For SID fields, the length of the SID in bytes, or zero if there is none.
+  ULONG length;
+};
+
+extern "C" {
+
+// Decodes the fields of one event.
+// @param plan an array of EtwFieldType opcodes, one per field.
+// @param plan_len the number of opcodes in @p plan.
+// @param is_64_bit_log non-zero iff pointers in @p data are 64 bits wide.
+// @param data the MOF data of the event.
+// @param data_len the length of @p data in bytes.
+// @param fields an array of @p plan_len entries that receives the fields.
+// @param failed_field on failure receives the index of the offending field.
+// @returns one of the EtwDecodeResult values.
+int __stdcall DecodeEventFields(const BYTE* plan,
+                                int plan_len,
+                                int is_64_bit_log,
+                                const void* data,
+                                int data_len,
+                                EtwDecodedField* fields,
+                                int* failed_field);
+
+}  // extern "C"
+
+#endif  // SAWBUCK_PY_ETW_DECODER_EVENT_DECODER_H_
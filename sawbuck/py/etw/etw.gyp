@@ -17,15 +17,18 @@
     'chromium_code': 1,
     'etw_sources': [
       'etw/__init__.py',
+      'etw/batch.py',
       'etw/consumer.py',
       'etw/controller.py',
       'etw/evntcons.py',
       'etw/evntrace.py',
       'etw/guiddef.py',
+      'etw/parallel.py',
       'etw/provider.py',
       'etw/util.py',
       'etw/descriptors/__init__.py',
       'etw/descriptors/binary_buffer.py',
+      'etw/descriptors/decoder.py',
       'etw/descriptors/event.py',
       'etw/descriptors/field.py',
       'etw/descriptors/fileio.py',
@@ -38,9 +41,27 @@
     ],
   },
   'targets': [
+    {
+      'target_name': 'etw_decoder',
+      'type': 'shared_library',
+      'sources': [
+        'decoder/event_decoder.cc',
+        'decoder/event_decoder.def',
+        'decoder/event_decoder.h',
+      ],
+      'dependencies': [
+        '<(DEPTH)/sawbuck/common/common.gyp:common',
+      ],
+      'include_dirs': [
+        '<(DEPTH)',
+      ],
+    },
     {
       'target_name': 'etw',
       'type': 'none',
+      'dependencies': [
+        'etw_decoder',
+      ],
       'sources': [
         '<@(etw_sources)',
       ],
@@ -17,13 +17,17 @@ Event Tracing for Windows. The classes implement an ETW controller, consumer
 and provider.
 """
 from etw.consumer import TraceEventSource, EventConsumer, EventHandler
+from etw.consumer import BatchEventHandler
 from etw.controller import TraceController, TraceProperties
+from etw.parallel import ParallelImporter
 from etw.provider import TraceProvider, MofEvent
 from etw.guiddef import GUID
 
-__all__ = ['GUID',
+__all__ = ['BatchEventHandler',
+           'GUID',
            'TraceProvider',
            'MofEvent',
+           'ParallelImporter',
            'EventConsumer',
            'EventHandler',
            'TraceEventSource',
@@ -0,0 +1,214 @@
+#!/usr/bin/python2.6
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Columnar accumulation of events for batch event handlers.
+
+Events of one class that arrive on one session are accumulated into an
+EventBatchBuilder, which hands them to batch handlers as an EventBatch of
+numpy arrays, one array per field. Where a native decoding plan exists for
+the event class, integral fields are decoded straight into a block of
+DecodedField structures and only converted to numpy arrays when the batch is
+delivered, so the per-event cost is independent of the number of integral
+fields.
+"""
+import numpy
+from etw.descriptors import binary_buffer
+from etw.descriptors import decoder
+from etw.descriptors import field
+
+
+# The numpy types of the field columns, field types not listed here are
+# stored in object arrays.
+_COLUMN_TYPES = {
+    field.Boolean: numpy.bool_,
+    field.Int8: numpy.int8,
+    field.UInt8: numpy.uint8,
+    field.Int16: numpy.int16,
+    field.UInt16: numpy.uint16,
+    field.Int32: numpy.int32,
+    field.UInt32: numpy.uint32,
+    field.Int64: numpy.int64,
+    field.UInt64: numpy.uint64,
+    field.Pointer: numpy.uint64,
+    field.WmiTime: numpy.float64,
+}
+
+# Mirrors decoder.DecodedField.
+_DECODED_FIELD_DTYPE = numpy.dtype([('value', numpy.uint64),
+                                    ('offset', numpy.uint32),
+                                    ('length', numpy.uint32)])
+
+
+class EventBatch(object):
+  """A block of events of a single event class, stored column-wise.
+
+  Each field of the event class is available as an attribute holding a
+  numpy array with one entry per event, in the order the events were
+  logged. Integral fields are stored in arrays of the matching numpy type,
+  WmiTime fields are converted to seconds since 1.1.1970 as float64, and
+  string and SID fields are stored in object arrays.
+
+  Attributes:
+    event_class: the EventClass subclass of the events.
+    session: the _TraceLogSession the events arrived on.
+    process_id: the IDs of the processes that generated the events.
+    thread_id: the IDs of the threads that generated the events.
+    raw_time_stamp: the raw time stamps of the events.
+    time_stamp: the time stamps of the events (in seconds since 01-01-1970).
+    columns: a dictionary of field name to field array.
+  """
+
+  def __init__(self, event_class, session, header_columns, columns):
+    self.event_class = event_class
+    self.session = session
+    self.process_id, self.thread_id, self.raw_time_stamp = header_columns
+    self.time_stamp = session.SessionTimeToTime(
+        self.raw_time_stamp.astype(numpy.float64))
+    self.columns = columns
+    for name, column in columns.iteritems():
+      setattr(self, name, column)
+
+  def __len__(self):
+    return len(self.process_id)
+
+
+class EventBatchBuilder(object):
+  """Accumulates the events of one event class on one session."""
+
+  def __init__(self, event_class, session, handlers, batch_size):
+    """Creates a builder.
+
+    Args:
+      event_class: the EventClass subclass of the events to accumulate.
+      session: the _TraceLogSession the events arrive on.
+      handlers: the batch handlers to deliver batches to.
+      batch_size: the number of events per delivered batch.
+    """
+    self._event_class = event_class
+    self._session = session
+    self._handlers = handlers
+    self._batch_size = batch_size
+    self._count = 0
+    self._header_columns = ([], [], [])
+
+    self._plan = event_class._GetDecodingPlan()
+    if self._plan:
+      self._names = self._plan.names
+      self._field_types = self._plan.field_types
+      self._num_fields = len(self._names)
+      self._block = (decoder.DecodedField *
+                     max(1, batch_size * self._num_fields))()
+    else:
+      self._names = [name for name, unused_type in event_class._fields_]
+      self._field_types = [field_type for unused_name, field_type in
+                           event_class._fields_]
+
+    # Fields that are converted as each event arrives. With a native plan
+    # that's only the fields whose data lives in the event buffer.
+    self._object_columns = {}
+    for index, field_type in enumerate(self._field_types):
+      if not self._plan or field_type not in _COLUMN_TYPES:
+        self._object_columns[index] = []
+
+  def Append(self, event_trace):
+    """Adds an event to the batch, delivering the batch when it's full.
+
+    Args:
+      event_trace: a POINTER(EVENT_TRACE) for the event.
+
+    Raises:
+      BufferOverflowError: the fields overflow the MOF data.
+      BufferDataError: the MOF data contains an invalid value.
+      In either case the event is not added to the batch.
+    """
+    contents = event_trace.contents
+    start = contents.MofData
+    # Decode all the fields before adding anything to the columns, so that
+    # an event that fails to decode leaves them aligned.
+    if self._plan:
+      row = self._count * self._num_fields
+      self._plan.DecodeRaw(self._session.is_64_bit_log, start,
+                           contents.MofLength, self._block[row])
+      values = [(index, self._plan.Convert(self._session, start, index,
+                                           self._block[row + index]))
+                for index in self._object_columns]
+    else:
+      reader = binary_buffer.BinaryBufferReader(start, contents.MofLength)
+      values = [(index, field_type(self._session, reader))
+                for index, field_type in enumerate(self._field_types)]
+
+    header = contents.Header
+    process_ids, thread_ids, time_stamps = self._header_columns
+    process_ids.append(header.ProcessId)
+    thread_ids.append(header.ThreadId)
+    time_stamps.append(header.TimeStamp)
+    for index, value in values:
+      self._object_columns[index].append(value)
+
+    self._count += 1
+    if self._count == self._batch_size:
+      self.Flush()
+
+  def Flush(self):
+    """Delivers any accumulated events to the handlers."""
+    if not self._count:
+      return
+
+    header_columns = (numpy.array(self._header_columns[0], numpy.uint32),
+                      numpy.array(self._header_columns[1], numpy.uint32),
+                      numpy.array(self._header_columns[2], numpy.int64))
+
+    columns = {}
+    values = None
+    if self._plan:
+      raw = numpy.frombuffer(self._block, _DECODED_FIELD_DTYPE,
+                             self._count * self._num_fields)
+      values = raw['value'].reshape(self._count, self._num_fields)
+    for index, name in enumerate(self._names):
+      if index in self._object_columns:
+        columns[name] = self._MakeObjectColumn(index)
+      else:
+        columns[name] = self._MakeValueColumn(index, values[:, index])
+
+    batch = EventBatch(self._event_class, self._session, header_columns,
+                       columns)
+    self._count = 0
+    self._header_columns = ([], [], [])
+    for column in self._object_columns.itervalues():
+      del column[:]
+
+    for handler in self._handlers:
+      handler(batch)
+
+  def _MakeObjectColumn(self, index):
+    values = self._object_columns[index]
+    column_type = _COLUMN_TYPES.get(self._field_types[index], None)
+    if column_type:
+      return numpy.array(values, column_type)
+
+    # Build object arrays element-wise, as numpy would otherwise turn
+    # equal length strings into a character array.
+    column = numpy.empty(len(values), object)
+    column[:] = values
+    return column
+
+  def _MakeValueColumn(self, index, values):
+    field_type = self._field_types[index]
+    if field_type == field.Boolean:
+      return values != 0
+    if field_type == field.WmiTime:
+      return self._session.SessionTimeToTime(values.astype(numpy.float64))
+    # Signed values are sign-extended to 64 bits, so truncating the raw
+    # values to the column type yields the right result for all types.
+    return values.astype(_COLUMN_TYPES[field_type])
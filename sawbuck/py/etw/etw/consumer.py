@@ -13,14 +13,19 @@
 # limitations under the License.
 """Implements a trace consumer utility class."""
 from collections import defaultdict
-from ctypes import byref, cast, POINTER
+from ctypes import addressof, byref, cast, sizeof, string_at, POINTER
+from ctypes import wintypes
 from etw import evntcons
 from etw import evntrace
+from etw import guiddef
 from etw import util
 from etw.descriptors import event
 import logging
 
 
+_GUID_SIZE = sizeof(guiddef.GUID)
+
+
 def _BindHandler(handler_func, handler_instance):
   def BoundHandler(event):
     handler_func(handler_instance, event)
@@ -40,6 +45,21 @@ def EventHandler(*event_infos):
   return wrapper
 
 
+def BatchEventHandler(*event_infos):
+  """BatchEventHandler decorator factory.
+
+  Like EventHandler, but the decorated function receives an etw.batch.EventBatch
+  holding the fields of up to TraceEventSource.batch_size events in numpy
+  arrays, rather than one event object per event. Batches hold events of a
+  single event class from a single session, and are delivered when full and
+  when Consume completes. Batch handlers require numpy.
+  """
+  def wrapper(func):
+    func.batch_event_infos = event_infos[:]
+    return func
+  return wrapper
+
+
 class MetaEventConsumer(type):
   """Meta class for TraceConsumer.
 
@@ -48,21 +68,30 @@ class MetaEventConsumer(type):
   for functions that have an event_info property and assigns them to a map.
   The map is then assigned to the subclass type. It also handles a hierarchy
   of consumers and will register event handlers defined in parent classes
-  for the given sub class.
+  for the given sub class. Functions with a batch_event_infos property are
+  assigned to a separate map of batch event handlers.
   """
   def __new__(cls, name, bases, dict):
     """Create a new TraceConsumer class type."""
     event_handler_map = defaultdict(list)
+    batch_event_handler_map = defaultdict(list)
     for base in bases:
       base_map = getattr(base, 'event_handler_map', None)
       if base_map:
         event_handler_map.update(base_map)
+      base_map = getattr(base, 'batch_event_handler_map', None)
+      if base_map:
+        batch_event_handler_map.update(base_map)
     for v in dict.values():
       event_infos = getattr(v, 'event_infos', [])
       for event_info in event_infos:
         event_handler_map[event_info].append(v)
+      event_infos = getattr(v, 'batch_event_infos', [])
+      for event_info in event_infos:
+        batch_event_handler_map[event_info].append(v)
     new_type = type.__new__(cls, name, bases, dict)
     new_type.event_handler_map = event_handler_map
+    new_type.batch_event_handler_map = batch_event_handler_map
     return new_type
 
 
@@ -193,6 +222,27 @@ class _TraceLogSession(object):
     except:
       logging.exception('Exception in _ProcessEventCallback')
 
+def _MakeFileTime(time_stamp):
+  """Returns a pointer to a FILETIME for time_stamp, or None."""
+  if time_stamp is None:
+    return None
+
+  file_time = util.TimeToFileTime(time_stamp)
+  return byref(wintypes.FILETIME(file_time & 0xFFFFFFFF, file_time >> 32))
+
+
+class _DispatchEntry(object):
+  """The event class and handlers for events of one guid, version and kind."""
+  __slots__ = ['event_class', 'handlers', 'batch_handlers',
+               'has_batch_handlers']
+
+  def __init__(self, event_class, handlers, batch_handlers):
+    self.event_class = event_class
+    self.handlers = handlers
+    self.batch_handlers = batch_handlers
+    self.has_batch_handlers = bool(batch_handlers)
+
+
 class TraceEventSource(object):
   """An Event Tracing for Windows consumer class.
 
@@ -209,7 +259,7 @@ class TraceEventSource(object):
   session, and no more than 63 sessions overall.
   """
 
-  def __init__(self, handlers=[], raw_time=False):
+  def __init__(self, handlers=[], raw_time=False, batch_size=4096):
     """Creates an idle consumer.
 
     Args:
@@ -217,12 +267,24 @@ class TraceEventSource(object):
           Each handler should be an object derived from EventConsumer.
       raw_time: if True, consume logs with the raw time option. This allows
           converting stamps recorded in events to wall-clock time.
+      batch_size: the maximum number of events delivered to each
+          invocation of a batch event handler.
     """
     self._stop = False
     self._handlers = handlers[:]
     self._raw_time = raw_time
     self._trace_sessions = []
-    self._handler_cache = dict()
+    self.batch_size = batch_size
+    # The handlers and batch handlers by (guid, kind), bound to their
+    # instances.
+    self._subscriptions = dict()
+    self._batch_subscriptions = dict()
+    # Maps the raw (guid, version, kind) of an event to a _DispatchEntry, or
+    # to None when no handler subscribes to the event.
+    self._dispatch_table = dict()
+    # Maps (session, dispatch entry) to an EventBatchBuilder.
+    self._batch_builders = dict()
+    self._CompileSubscriptions()
 
   def __del__(self):
     """Clean up any trace sessions we have open."""
@@ -235,8 +297,11 @@ class TraceEventSource(object):
       handler: the handler to add.
     """
     self._handlers.append(handler)
-    # Clear our handler cache.
-    self._handler_cache.clear()
+    # Deliver the events accumulated for the current batch handlers, and
+    # recompile the subscriptions.
+    self._FlushBatches()
+    self._batch_builders.clear()
+    self._CompileSubscriptions()
 
   def OpenRealtimeSession(self, name):
     """Open a trace session named "name".
@@ -258,11 +323,19 @@ class TraceEventSource(object):
     session.OpenFileSession(path)
     self._trace_sessions.append(session)
 
-  def Consume(self):
+  def Consume(self, start_time=None, end_time=None):
     """Consume all open sessions.
 
     Note: if any of the open sessions are realtime sessions, this function
       will not return until Close() is called to close the realtime session.
+
+    Args:
+      start_time: if not None, the time, as from time.time(), of the first
+          event to consume. The log buffers before the start time are skipped
+          without delivering their events.
+      end_time: if not None, the time of the last event to consume. The
+          consumption stops past the end time. Must be None when consuming
+          realtime sessions.
     """
     handles = (evntrace.TRACEHANDLE *
                len(self._trace_sessions))()
@@ -272,8 +345,14 @@ class TraceEventSource(object):
 
     evntrace.ProcessTrace(cast(handles, POINTER(evntrace.TRACEHANDLE)),
                           len(handles),
-                          None,
-                          None)
+                          _MakeFileTime(start_time),
+                          _MakeFileTime(end_time))
+
+    # Deliver the remainder of the accumulated batches.
+    try:
+      self._FlushBatches()
+    except:
+      logging.exception("Exception in batch event handler")
 
   def Close(self):
     """Close all open trace sessions."""
@@ -286,25 +365,34 @@ class TraceEventSource(object):
 
     Retrieve the guid, version and type from the event and try to find a handler
     for the event and event class that can parse the event data. If both exist,
-    dispatch the event object to the handler.
+    dispatch the event object to the handler. Events that no handler
+    subscribes to are dropped without being decoded.
 
     Args:
       session: the _TraceLogSession on which this event occurred.
       event_trace: a POINTER(EVENT_TRACE) for the current event.
     """
     header = event_trace.contents.Header
-    guid = str(header.Guid)
-    version = header.Class.Version
-    kind = header.Class.Type
+    header_class = header.Class
+    key = (string_at(addressof(header.Guid), _GUID_SIZE),
+           header_class.Version,
+           header_class.Type)
+    try:
+      entry = self._dispatch_table[key]
+    except KeyError:
+      entry = self._CompileDispatchEntry(key, header)
 
-    # Look for a handler and EventClass for the event.
-    event_class = event.EventClass.Get(guid, version, kind)
-    if event_class:
-      handlers = self._GetHandlers(guid, kind)
-      if handlers:
-        event_obj = event_class(session, event_trace)
-        for handler in handlers:
-          handler(event_obj)
+    if entry is None:
+      return
+
+    if entry.handlers:
+      event_obj = entry.event_class(session, event_trace)
+      for handler in entry.handlers:
+        handler(event_obj)
+
+    if entry.has_batch_handlers:
+      builder = self._GetBatchBuilder(session, entry)
+      builder.Append(event_trace)
 
   def ProcessBuffer(self, session, buffer):
     """Process a buffer.
@@ -341,16 +429,63 @@ class TraceEventSource(object):
       logging.exception("Exception in ProcessEvent, terminating parsing")
       self._stop = True
 
-  def _GetHandlers(self, guid, kind):
-    key = (guid, kind)
-    handler_list = self._handler_cache.get(key, None)
-    if handler_list != None:
-      return handler_list
-
-    # We didn't cache this already.
-    handler_list = []
+  def _CompileSubscriptions(self):
+    """Binds the handlers of all handler instances by (guid, kind)."""
+    self._subscriptions.clear()
+    self._batch_subscriptions.clear()
+    self._dispatch_table.clear()
     for handler_instance in self._handlers:
-      for handler_func in handler_instance.event_handler_map.get(key, []):
-        handler_list.append(_BindHandler(handler_func, handler_instance))
+      for key, funcs in handler_instance.event_handler_map.iteritems():
+        handlers = self._subscriptions.setdefault(key, [])
+        for handler_func in funcs:
+          handlers.append(_BindHandler(handler_func, handler_instance))
+
+      handler_map = getattr(handler_instance, 'batch_event_handler_map', {})
+      for key, funcs in handler_map.iteritems():
+        handlers = self._batch_subscriptions.setdefault(key, [])
+        for handler_func in funcs:
+          handlers.append(_BindHandler(handler_func, handler_instance))
+
+  def _CompileDispatchEntry(self, key, header):
+    """Resolves the event class and handlers for a new raw event key.
 
-    return handler_list
+    Args:
+      key: the raw (guid, version, kind) key of the event.
+      header: the EVENT_TRACE_HEADER of the event.
+
+    Returns:
+      the _DispatchEntry for the event, or None if no handler subscribes to
+      it, or there's no event class to decode it with.
+    """
+    guid = str(header.Guid)
+    version = header.Class.Version
+    kind = header.Class.Type
+    handlers = self._subscriptions.get((guid, kind), [])
+    batch_handlers = self._batch_subscriptions.get((guid, kind), [])
+
+    entry = None
+    if handlers or batch_handlers:
+      event_class = event.EventClass.Get(guid, version, kind)
+      if event_class:
+        entry = _DispatchEntry(event_class, handlers, batch_handlers)
+
+    self._dispatch_table[key] = entry
+    return entry
+
+  def _GetBatchBuilder(self, session, entry):
+    key = (session, entry)
+    try:
+      return self._batch_builders[key]
+    except KeyError:
+      pass
+
+    # Imported here, as only batch handlers require numpy.
+    from etw import batch
+    builder = batch.EventBatchBuilder(entry.event_class, session,
+                                      entry.batch_handlers, self.batch_size)
+    self._batch_builders[key] = builder
+    return builder
+
+  def _FlushBatches(self):
+    for builder in self._batch_builders.itervalues():
+      builder.Flush()
@@ -197,7 +197,7 @@ class BinaryBufferReader(object):
 
   def ReadWString(self):
     val = self._buffer.GetWStringAt(self._offset)
-    self.Consume(len(val) + ctypes.sizeof(ctypes.c_wchar))
+    self.Consume((len(val) + 1) * ctypes.sizeof(ctypes.c_wchar))
     return val
 
   _MINIMUM_SID_SIZE = 8
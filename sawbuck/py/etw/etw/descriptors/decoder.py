@@ -0,0 +1,273 @@
+#!/usr/bin/python2.6
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Native decoding of EventClass fields.
+
+Decoding an event field-by-field in Python costs a handful of ctypes calls
+per field. This module compiles the _fields_ list of an EventClass into a
+DecodingPlan, which decodes all fields of an event with a single call into
+etw_decoder.dll (built from sawbuck/py/etw/decoder).
+
+Plans can only be compiled for _fields_ lists that use the field types
+defined in etw.descriptors.field. Classes with custom field callables, or
+environments where the DLL can't be loaded, use the Python decoder.
+"""
+import ctypes
+import os
+import pywintypes
+import threading
+from etw.descriptors import binary_buffer
+from etw.descriptors import field
+
+
+_DLL_NAME = 'etw_decoder.dll'
+
+# The opcodes for the field types, these must be kept in sync with
+# EtwFieldType in decoder/event_decoder.h.
+_OPCODES = {
+    field.Boolean: 0,
+    field.Int8: 1,
+    field.UInt8: 2,
+    field.Int16: 3,
+    field.UInt16: 4,
+    field.Int32: 5,
+    field.UInt32: 6,
+    field.Int64: 7,
+    field.UInt64: 8,
+    field.Pointer: 9,
+    field.String: 10,
+    field.WString: 11,
+    field.Sid: 12,
+    field.WmiTime: 13,
+}
+
+# The result codes of DecodeEventFields, see EtwDecodeResult.
+_DECODE_SUCCESS = 0
+_DECODE_BUFFER_OVERFLOW = 1
+_DECODE_DATA_ERROR = 2
+
+
+class _DecodedValue(ctypes.Union):
+  _fields_ = [('unsigned', ctypes.c_ulonglong),
+              ('signed', ctypes.c_longlong)]
+
+
+class DecodedField(ctypes.Structure):
+  """Mirrors the EtwDecodedField structure."""
+  _anonymous_ = ('value',)
+  _fields_ = [('value', _DecodedValue),
+              ('offset', ctypes.c_ulong),
+              ('length', ctypes.c_ulong)]
+
+
+def _Unsigned(unused_session, unused_start, decoded):
+  return decoded.unsigned
+
+
+def _Signed(unused_session, unused_start, decoded):
+  return decoded.signed
+
+
+def _Boolean(unused_session, unused_start, decoded):
+  return decoded.unsigned != 0
+
+
+def _String(unused_session, start, decoded):
+  return ctypes.string_at(start + decoded.offset, decoded.length)
+
+
+def _WString(unused_session, start, decoded):
+  return ctypes.wstring_at(start + decoded.offset, decoded.length)
+
+
+def _Sid(unused_session, start, decoded):
+  if not decoded.length:
+    return None
+  return pywintypes.SID(ctypes.string_at(start + decoded.offset,
+                                         decoded.length))
+
+
+def _WmiTime(session, unused_start, decoded):
+  return session.SessionTimeToTime(decoded.unsigned)
+
+
+# Converts a decoded field to the value the Python field function returns.
+_CONVERTERS = {
+    field.Boolean: _Boolean,
+    field.Int8: _Signed,
+    field.UInt8: _Unsigned,
+    field.Int16: _Signed,
+    field.UInt16: _Unsigned,
+    field.Int32: _Signed,
+    field.UInt32: _Unsigned,
+    field.Int64: _Signed,
+    field.UInt64: _Unsigned,
+    field.Pointer: _Unsigned,
+    field.String: _String,
+    field.WString: _WString,
+    field.Sid: _Sid,
+    field.WmiTime: _WmiTime,
+}
+
+
+def _LoadDecoder():
+  """Loads the native decoder.
+
+  The DLL is looked for next to this module first, then on the DLL search
+  path.
+
+  Returns:
+    The DecodeEventFields function, or None if the DLL can't be loaded.
+  """
+  candidates = [os.path.join(os.path.dirname(__file__), _DLL_NAME), _DLL_NAME]
+  for path in candidates:
+    try:
+      dll = ctypes.WinDLL(path)
+    except (OSError, AttributeError):
+      continue
+
+    decode = dll.DecodeEventFields
+    decode.argtypes = [ctypes.c_char_p,
+                       ctypes.c_int,
+                       ctypes.c_int,
+                       ctypes.c_void_p,
+                       ctypes.c_int,
+                       ctypes.POINTER(DecodedField),
+                       ctypes.POINTER(ctypes.c_int)]
+    decode.restype = ctypes.c_int
+    return decode
+
+  return None
+
+
+_decode_event_fields = _LoadDecoder()
+
+
+def IsAvailable():
+  """Returns whether the native decoder was loaded."""
+  return _decode_event_fields is not None
+
+
+class DecodingPlan(object):
+  """A compiled _fields_ list.
+
+  Plans are shared by all instances of an EventClass. Each thread decodes
+  into result buffers of its own, as the native decoder runs without the
+  GIL, so a plan may be used to decode on several threads at a time.
+  """
+
+  def __init__(self, fields):
+    """Compiles a decoding plan.
+
+    Args:
+      fields: an EventClass _fields_ list, which must only contain field
+        types from etw.descriptors.field.
+    """
+    self.names = [name for name, unused_field in fields]
+    self.field_types = [field_type for unused_name, field_type in fields]
+    self._converters = [_CONVERTERS[f] for f in self.field_types]
+    self._opcodes = ''.join(chr(_OPCODES[f]) for f in self.field_types)
+    self._buffers = threading.local()
+
+  def _GetBuffers(self):
+    """Returns the calling thread's result array and failed field index."""
+    buffers = self._buffers
+    try:
+      return buffers.results, buffers.failed_field
+    except AttributeError:
+      buffers.results = (DecodedField * max(1, len(self.names)))()
+      buffers.failed_field = ctypes.c_int()
+      return buffers.results, buffers.failed_field
+
+  def Decode(self, session, target, start, length):
+    """Decodes an event and sets the fields as attributes on target.
+
+    Args:
+      session: the _TraceLogSession the event arrived on.
+      target: the object to set the field attributes on.
+      start: integer start address of the MOF data.
+      length: length of the MOF data.
+
+    Raises:
+      BufferOverflowError: the fields overflow the MOF data.
+      BufferDataError: the MOF data contains an invalid value.
+    """
+    results, unused_failed_field = self._GetBuffers()
+    self.DecodeRaw(session.is_64_bit_log, start, length, results[0])
+    for i, name in enumerate(self.names):
+      setattr(target, name, self._converters[i](session, start, results[i]))
+
+  def DecodeRaw(self, is_64_bit_log, start, length, results):
+    """Decodes an event without converting the decoded fields.
+
+    Args:
+      is_64_bit_log: whether pointers in the MOF data are 64 bits wide.
+      start: integer start address of the MOF data.
+      length: length of the MOF data.
+      results: the first of len(self.names) consecutive DecodedField
+        structures to receive the decoded fields.
+
+    Raises:
+      BufferOverflowError: the fields overflow the MOF data.
+      BufferDataError: the MOF data contains an invalid value.
+    """
+    unused_results, failed_field = self._GetBuffers()
+    status = _decode_event_fields(self._opcodes,
+                                  len(self._opcodes),
+                                  is_64_bit_log,
+                                  start,
+                                  length,
+                                  ctypes.byref(results),
+                                  ctypes.byref(failed_field))
+    if status != _DECODE_SUCCESS:
+      if status == _DECODE_BUFFER_OVERFLOW:
+        raise binary_buffer.BufferOverflowError()
+      if status == _DECODE_DATA_ERROR:
+        raise binary_buffer.BufferDataError(
+            'Invalid data in field %s.' % self.names[failed_field.value])
+      raise RuntimeError('Native decoder failed with status %d.' % status)
+
+  def Convert(self, session, start, index, decoded):
+    """Converts a raw decoded field to its Python value.
+
+    Args:
+      session: the _TraceLogSession the event arrived on.
+      start: integer start address of the MOF data the field was decoded from.
+      index: the index of the field in the plan.
+      decoded: the DecodedField for the field.
+
+    Returns:
+      The value the field type in etw.descriptors.field would return.
+    """
+    return self._converters[index](session, start, decoded)
+
+
+def Compile(fields):
+  """Compiles a _fields_ list into a decoding plan.
+
+  Args:
+    fields: an EventClass _fields_ list.
+
+  Returns:
+    A DecodingPlan, or None if the native decoder is unavailable or the
+    list contains field types the native decoder doesn't know.
+  """
+  if not IsAvailable():
+    return None
+
+  for unused_name, field_type in fields:
+    if field_type not in _OPCODES:
+      return None
+
+  return DecodingPlan(fields)
@@ -15,6 +15,7 @@
 """EventClass and EventCategory base classes for Event descriptors."""
 import inspect
 from etw.descriptors import binary_buffer
+from etw.descriptors import decoder
 
 
 class EventClass(object):
@@ -34,6 +35,11 @@ class EventClass(object):
   function in the second half of the tuple should take a TraceLogSession and a
   BinaryBufferReader as parameters and should return a mixed value.
 
+  Where all fields are of the types defined in etw.descriptors.field, the
+  _fields_ list is compiled on first use into a native decoding plan, which
+  decodes the event in a single call. Setting _decoding_plan_ to None on a
+  subclass forces it to decode in Python.
+
   Subclasses must also define the _event_types_ list. This will cause the
   subclass to be registered in the the EventClass's subclass map for each event
   listed in _event_types_. This is used by the log consumer to identify the
@@ -63,11 +69,30 @@ class EventClass(object):
 
     self.raw_time_stamp = header.TimeStamp
     self.time_stamp = log_session.SessionTimeToTime(header.TimeStamp)
+
+    plan = self._GetDecodingPlan()
+    if plan:
+      plan.Decode(log_session, self, event_trace.contents.MofData,
+                  event_trace.contents.MofLength)
+      return
+
     reader = binary_buffer.BinaryBufferReader(event_trace.contents.MofData,
                                               event_trace.contents.MofLength)
     for name, field in self._fields_:
       setattr(self, name, field(log_session, reader))
 
+  @classmethod
+  def _GetDecodingPlan(cls):
+    """Returns the native decoding plan for this class, or None."""
+    # Look in the class' own dictionary, as plans must not be inherited
+    # by subclasses with different fields.
+    try:
+      return cls.__dict__['_decoding_plan_']
+    except KeyError:
+      plan = decoder.Compile(cls._fields_)
+      cls._decoding_plan_ = plan
+      return plan
+
   @staticmethod
   def Get(guid, version, event_type):
     """Returns the subclass for the given guid, version and event_type.
@@ -38,6 +38,7 @@ class Event(object):
   QueryMultipleValue = (GUID, 19)
   SetInformation = (GUID, 20)
   Flush = (GUID, 21)
+  KCBCreate = (GUID, 22)
   RunDown = (GUID, 22)
   KCBDelete = (GUID, 23)
   KCBRundownBegin = (GUID, 24)
@@ -0,0 +1,166 @@
+#!/usr/bin/python2.6
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Parallel consumption of sets of trace log files.
+
+A TraceEventSource consumes all its sessions through a single ProcessTrace
+call on the calling thread. The ParallelImporter instead consumes each file
+in its own TraceEventSource, on a pool of worker processes or threads, and
+reduces the results of the handlers of all files to one result per handler.
+
+As the handlers run in the workers, they're created there by a handler
+factory, and hand back their results through a GetResult method, e.g.
+
+  class ImageLoadCounter(etw.EventConsumer):
+    def __init__(self):
+      self._loads = 0
+
+    @etw.EventHandler(image.Event.Load)
+    def OnImageLoad(self, event):
+      self._loads += 1
+
+    def GetResult(self):
+      return self._loads
+
+  def CreateHandlers():
+    return [ImageLoadCounter()]
+
+  importer = etw.ParallelImporter(CreateHandlers, reducers=[sum])
+  total_loads, = importer.Import(paths)
+
+For worker processes, the handler factory and the handler results must be
+picklable, so the factory is typically a module level function.
+"""
+import heapq
+import multiprocessing
+import multiprocessing.dummy
+import os
+from etw import consumer
+
+
+def MergeOrdered(results):
+  """A reducer that merges time ordered streams into one.
+
+  Args:
+    results: a list of lists of records, each ordered by the records'
+        first element, typically the time stamp of the event.
+
+  Returns:
+    a list of all records, ordered by their first element.
+  """
+  return list(heapq.merge(*results))
+
+
+def Concatenate(results):
+  """A reducer that concatenates lists of records in file order."""
+  merged = []
+  for result in results:
+    merged.extend(result)
+  return merged
+
+
+def _ConsumeFile(args):
+  """Consumes a single file in a worker.
+
+  Args:
+    args: a tuple of (index, path, handler_factory, raw_time, batch_size).
+
+  Returns:
+    a tuple of (index, results), where results holds the result of each
+    handler.
+  """
+  index, path, handler_factory, raw_time, batch_size = args
+  handlers = handler_factory()
+  source = consumer.TraceEventSource(handlers, raw_time, batch_size)
+  try:
+    source.OpenFileSession(path)
+    source.Consume()
+  finally:
+    source.Close()
+
+  return index, [handler.GetResult() for handler in handlers]
+
+
+class ParallelImporter(object):
+  """Consumes a set of log files in parallel."""
+
+  def __init__(self, handler_factory, reducers=None, num_workers=None,
+               use_threads=False, raw_time=False, batch_size=4096):
+    """Creates an importer.
+
+    Args:
+      handler_factory: a callable that returns a list of handlers, each
+          derived from EventConsumer and implementing GetResult. It's
+          invoked once per file.
+      reducers: an optional list of callables, one per handler, that each
+          take the list of results of the handler in file order and return
+          the reduced result. By default the list of results is returned.
+      num_workers: the number of worker processes or threads, defaults to
+          the number of processors.
+      use_threads: if True, consume on worker threads rather than worker
+          processes. This avoids pickling the results, but only the native
+          parts of the consumption run concurrently.
+      raw_time: if True, consume logs with the raw time option.
+      batch_size: the batch size of the TraceEventSource for each file.
+    """
+    self._handler_factory = handler_factory
+    self._reducers = reducers
+    self._num_workers = num_workers or multiprocessing.cpu_count()
+    self._use_threads = use_threads
+    self._raw_time = raw_time
+    self._batch_size = batch_size
+
+  def Import(self, paths):
+    """Consumes the files at paths.
+
+    Args:
+      paths: a list of paths of log files to consume.
+
+    Returns:
+      a list with one reduced result per handler.
+    """
+    if not paths:
+      return []
+
+    # Start on the largest files first, so that the workers finish at
+    # roughly the same time.
+    tasks = [(index, path, self._handler_factory, self._raw_time,
+              self._batch_size) for index, path in enumerate(paths)]
+    tasks.sort(key=lambda task: os.path.getsize(task[1]), reverse=True)
+
+    num_workers = min(self._num_workers, len(paths))
+    if self._use_threads:
+      pool = multiprocessing.dummy.Pool(num_workers)
+    else:
+      pool = multiprocessing.Pool(num_workers)
+
+    file_results = [None] * len(paths)
+    try:
+      for index, results in pool.imap_unordered(_ConsumeFile, tasks):
+        file_results[index] = results
+    finally:
+      pool.close()
+      pool.join()
+
+    # Transpose the per-file results to per-handler results.
+    handler_results = zip(*file_results)
+    reduced = []
+    for index, results in enumerate(handler_results):
+      results = list(results)
+      if self._reducers:
+        reduced.append(self._reducers[index](results))
+      else:
+        reduced.append(results)
+
+    return reduced
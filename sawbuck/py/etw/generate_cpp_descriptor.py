@@ -0,0 +1,300 @@
+#!/usr/bin/python2.6
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""A script to generate C++ event decoders from ETW event descriptors.
+
+The C++ decoders are generated from the same event descriptor modules the
+Python consumer uses, which are in turn generated from the MOF classes by
+generate_descriptor.py. Each event class becomes a struct template with the
+event version and the bitness of the log as template parameters, and with a
+specialization per version described in the descriptors, e.g.
+
+  template <bool kIs64Bit>
+  struct CSwitch<2, kIs64Bit> {
+    ULONG NewThreadId;
+    ...
+    bool Parse(BinaryBufferReader* reader);
+  };
+"""
+import inspect
+import optparse
+import os
+import re
+import textwrap
+
+LICENSE_HEADER = """\
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//"""
+
+DO_NOT_EDIT_HEADER = """\
+// Generated event decoders for MOF GUID %s.
+//
+// DO NOT EDIT. This file was generated by
+// sawbuck/py/etw/generate_cpp_descriptor.py from:"""
+
+# The C++ member types of the field types in etw.descriptors.field.
+_FIELD_TYPES = {
+    'Boolean': 'bool',
+    'Int8': 'CHAR',
+    'UInt8': 'UCHAR',
+    'Int16': 'SHORT',
+    'UInt16': 'USHORT',
+    'Int32': 'LONG',
+    'UInt32': 'ULONG',
+    'Int64': 'LONGLONG',
+    'UInt64': 'ULONGLONG',
+    'Pointer': 'typename field::Pointer<kIs64Bit>::Type',
+    'String': 'std::string',
+    'WString': 'std::wstring',
+    'Sid': 'field::Sid',
+    'WmiTime': 'ULONGLONG',
+}
+
+# The functions that read the field types.
+_FIELD_READERS = {
+    'Sid': 'field::ReadSid<kIs64Bit>',
+}
+_DEFAULT_FIELD_READER = 'field::Read'
+
+_VERSION_SUFFIX_RE = re.compile(r'_V\d+$')
+
+_MAX_LINE_LENGTH = 80
+
+
+def _Comment(text, indent=''):
+  """Returns text as a list of wrapped C++ comment lines."""
+  prefix = indent + '// '
+  return [prefix + line for line in
+          textwrap.wrap(text, _MAX_LINE_LENGTH - len(prefix))]
+
+
+def _IsSubclassNamed(value, base_name):
+  """Tests whether value is a class derived from a class named base_name.
+
+  The descriptor classes are matched by name, so that this script doesn't
+  need to import the etw.descriptors package itself.
+  """
+  if not inspect.isclass(value):
+    return False
+  return base_name in [base.__name__ for base in inspect.getmro(value)[1:]]
+
+
+class CppDescriptorGenerator(object):
+  """Generates a C++ header of event decoders from descriptor modules."""
+
+  def __init__(self, modules):
+    """Creates a generator.
+
+    Args:
+      modules: a list of descriptor modules describing the same MOF GUID.
+        The first module must define the Event class for the GUID.
+    """
+    self._modules = modules
+    self._event_types = modules[0].Event
+
+  def Generate(self, header_path, include_path):
+    """Generates the header.
+
+    Args:
+      header_path: the path of the header file to write.
+      include_path: the path of the header relative to the source root,
+        used to derive the header guard.
+
+    Returns:
+      The generated header as a string.
+    """
+    guid = self._event_types.GUID
+    name = os.path.splitext(os.path.basename(include_path))[0]
+    guard = re.sub(r'[^A-Z0-9]', '_', include_path.upper()) + '_'
+
+    lines = []
+    lines.append(LICENSE_HEADER)
+    lines.append(DO_NOT_EDIT_HEADER % guid)
+    for module in self._modules:
+      lines.append('//   %s' % module.__name__)
+    lines.append('#ifndef %s' % guard)
+    lines.append('#define %s' % guard)
+    lines.append('')
+    lines.append('#include "sawbuck/log_lib/descriptors/field.h"')
+    lines.append('')
+    lines.append('namespace descriptors {')
+    lines.append('namespace %s {' % name)
+    lines.append('')
+    lines.append(self._GenerateGuid(guid))
+    lines.append('')
+    lines.append(self._GenerateEventTypeEnum())
+
+    for event_name, layouts in self._GetEventLayouts():
+      lines.append('')
+      lines.append(self._GenerateEvent(event_name, layouts))
+
+    lines.append('')
+    lines.append('}  // namespace %s' % name)
+    lines.append('}  // namespace descriptors')
+    lines.append('')
+    lines.append('#endif  // %s' % guard)
+    lines.append('')
+
+    output = '\n'.join(lines)
+    if header_path:
+      f = open(header_path, 'wb')
+      f.write(output)
+      f.close()
+    return output
+
+  def _GenerateGuid(self, guid):
+    """Generates the GUID constant for the event category."""
+    parts = guid.strip('{}').split('-')
+    data4 = parts[3] + parts[4]
+    data4_bytes = ['0x%s' % data4[i:i + 2] for i in range(0, len(data4), 2)]
+    return ('// %s\n'
+            'const GUID kGuid = { 0x%s, 0x%s, 0x%s,\n'
+            '    { %s } };' %
+            (guid, parts[0], parts[1], parts[2], ', '.join(data4_bytes)))
+
+  def _GetEventTypes(self):
+    """Returns a sorted list of (number, name) for the event types."""
+    event_types = []
+    for name, value in vars(self._event_types).items():
+      if isinstance(value, tuple) and len(value) == 2:
+        event_types.append((value[1], name))
+    event_types.sort()
+    return event_types
+
+  def _GenerateEventTypeEnum(self):
+    lines = ['enum EventType {']
+    for number, name in self._GetEventTypes():
+      lines.append('  k%s = %d,' % (name, number))
+    lines.append('};')
+    return '\n'.join(lines)
+
+  def _GetEventLayouts(self):
+    """Collects the event classes of all categories in the modules.
+
+    Returns:
+      A list of (event name, layouts) sorted by event name, where layouts
+      is a list of (version, event class) sorted by version.
+    """
+    events = {}
+    for module in self._modules:
+      for category in vars(module).values():
+        if not _IsSubclassNamed(category, 'EventCategory'):
+          continue
+        prefix = _VERSION_SUFFIX_RE.sub('', category.__name__) + '_'
+        for event_class in vars(category).values():
+          if not _IsSubclassNamed(event_class, 'EventClass'):
+            continue
+          # Strip the category name and version off the event name, as the
+          # version is a template parameter.
+          event_name = _VERSION_SUFFIX_RE.sub('', event_class.__name__)
+          if event_name.startswith(prefix):
+            event_name = event_name[len(prefix):]
+          layouts = events.setdefault(event_name, [])
+          if category.VERSION in [version for version, unused in layouts]:
+            raise ValueError('Event %s is described twice for version %d.' %
+                             (event_name, category.VERSION))
+          layouts.append((category.VERSION, event_class))
+
+    result = []
+    for event_name in sorted(events.keys()):
+      layouts = events[event_name]
+      layouts.sort(key=lambda layout: layout[0])
+      result.append((event_name, layouts))
+    return result
+
+  def _GenerateEvent(self, event_name, layouts):
+    """Generates the struct template for an event and its specializations."""
+    lines = []
+    lines.append('template <int kVersion, bool kIs64Bit> struct %s;' %
+                 event_name)
+    for version, event_class in layouts:
+      lines.append('')
+      lines.append(self._GenerateLayout(event_name, version, event_class))
+    return '\n'.join(lines)
+
+  def _GenerateLayout(self, event_name, version, event_class):
+    """Generates the specialization of an event for a version."""
+    type_names = sorted(self._GetEventTypeName(event_type)
+                        for event_type in event_class._event_types_)
+
+    lines = []
+    comment = 'Layout of the %s events, version %d.' % (', '.join(type_names),
+                                                      version)
+    lines.extend(_Comment(comment))
+    lines.append('template <bool kIs64Bit>')
+    lines.append('struct %s<%d, kIs64Bit> {' % (event_name, version))
+    fields = event_class._fields_
+    for name, field_type in fields:
+      lines.append('  %s %s;' % (_FIELD_TYPES[field_type.__name__], name))
+    if fields:
+      lines.append('')
+
+    lines.append('  // Parses the event from @p reader.')
+    lines.append('  // @returns true on success, false if the event data is '
+                 'malformed.')
+    lines.append('  bool Parse(BinaryBufferReader* reader) {')
+    if not fields:
+      lines.append('    return true;')
+    else:
+      reads = []
+      for name, field_type in fields:
+        reader = _FIELD_READERS.get(field_type.__name__, _DEFAULT_FIELD_READER)
+        reads.append('%s(reader, &%s)' % (reader, name))
+      lines.append('    return %s;' % ' &&\n        '.join(reads))
+    lines.append('  }')
+    lines.append('};')
+    return '\n'.join(lines)
+
+  def _GetEventTypeName(self, event_type):
+    for number, name in self._GetEventTypes():
+      if number == event_type[1]:
+        return name
+    return str(event_type[1])
+
+
+def main():
+  parser = optparse.OptionParser(
+      usage='%prog [options] descriptor_module [descriptor_module...]')
+  parser.add_option('-o', '--output', dest='output',
+                    help='Path of the header file to generate.')
+  parser.add_option('-i', '--include_path', dest='include_path',
+                    help='Path of the header relative to the source root.')
+  options, args = parser.parse_args()
+
+  if not args or not options.output or not options.include_path:
+    parser.error('Descriptor modules, output and include path are required.')
+
+  modules = []
+  for module_name in args:
+    module = __import__(module_name, fromlist=['Event'])
+    modules.append(module)
+
+  generator = CppDescriptorGenerator(modules)
+  generator.Generate(options.output, options.include_path)
+
+
+if __name__ == '__main__':
+  main()
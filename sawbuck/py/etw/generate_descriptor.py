@@ -151,15 +151,15 @@ class DescriptorGenerator(object):
     lines.append('class Event(object):')
     lines.append('  GUID = \'%s\'' % guid)
 
-    event_types = dict()
+    # Different versions of a category may use different names for the
+    # same event type, so collect all (type, name) pairs.
+    event_types = set()
     for category in categories:
       for event in self._GetEvents(category):
-        event_types.update(self._GetEventTypes(event))
+        event_types.update(self._GetEventTypes(event).items())
 
-    keys = event_types.keys()
-    keys.sort()
-    for key in keys:
-      lines.append('  %s = (GUID, %d)' % (event_types[key], key))
+    for event_type, name in sorted(event_types):
+      lines.append('  %s = (GUID, %d)' % (name, event_type))
 
     return '\n'.join(lines)
 
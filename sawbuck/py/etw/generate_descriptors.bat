@@ -31,3 +31,20 @@ python generate_descriptor.py -g {ae53722e-c863-11d2-8659-00c04fa321a1} -o etw\d
 :: File Io events
 python generate_descriptor.py -g {90cbdc39-4a3e-11d1-84f4-0000f80464e3} -o etw\descriptors
 
+
+:: C++ decoders generated from the above descriptors.
+set CPP_DIR=..\..\log_lib\descriptors
+set INCLUDE_DIR=sawbuck/log_lib/descriptors
+python generate_cpp_descriptor.py -o %CPP_DIR%\image.h ^
+    -i %INCLUDE_DIR%/image.h etw.descriptors.image
+python generate_cpp_descriptor.py -o %CPP_DIR%\pagefault.h ^
+    -i %INCLUDE_DIR%/pagefault.h ^
+    etw.descriptors.pagefault etw.descriptors.pagefault_xp
+python generate_cpp_descriptor.py -o %CPP_DIR%\process.h ^
+    -i %INCLUDE_DIR%/process.h etw.descriptors.process
+python generate_cpp_descriptor.py -o %CPP_DIR%\thread.h ^
+    -i %INCLUDE_DIR%/thread.h etw.descriptors.thread
+python generate_cpp_descriptor.py -o %CPP_DIR%\registry.h ^
+    -i %INCLUDE_DIR%/registry.h etw.descriptors.registry
+python generate_cpp_descriptor.py -o %CPP_DIR%\fileio.h ^
+    -i %INCLUDE_DIR%/fileio.h etw.descriptors.fileio
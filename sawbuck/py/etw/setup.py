@@ -29,6 +29,8 @@ setup(name = 'ETW',
       author_email = 'siggi@chromium.org',
       url = 'http://code.google.com/p/sawbuck',
       packages = ['etw', 'etw.descriptors'],
+      # Pick up etw_decoder.dll if it's been copied next to the descriptors.
+      package_data = {'etw.descriptors': ['*.dll']},
       tests_require = ["nose>=0.9.2"],
       test_suite = 'nose.collector',
       license = 'Apache 2.0')
@@ -0,0 +1,123 @@
+#!/usr/bin/python2.6
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Compares the native and the Python event decoders.
+
+Decodes the event layouts used by the descriptor unittests, as well as the
+thread CSwitch and fileio Create events, with both decoders and prints the
+throughput of each. Run with etw_decoder.dll on the DLL search path, e.g.
+
+  python test\\descriptors\\benchmark_decoder.py --iterations=100000
+"""
+import ctypes
+import optparse
+import sys
+import time
+from etw import util
+from etw.descriptors import decoder
+from etw.descriptors import event
+from etw.descriptors import field
+from etw.descriptors import fileio
+from etw.descriptors import thread
+
+
+class _MockHeader(object):
+  ProcessId = 1
+  ThreadId = 2
+  TimeStamp = 129000000000000000
+
+
+class _MockContents(object):
+  def __init__(self, data):
+    self.Header = _MockHeader()
+    self.MofData = ctypes.addressof(data)
+    self.MofLength = ctypes.sizeof(data)
+
+
+class _MockEventTrace(object):
+  def __init__(self, data):
+    self.contents = _MockContents(data)
+
+
+class _MockSession(object):
+  is_64_bit_log = False
+
+  def SessionTimeToTime(self, session_time):
+    return util.FileTimeToTime(session_time)
+
+
+class _TestEventClass(event.EventClass):
+  """The layout from test_event.EventClassTest.testCreation."""
+  _fields_ = [('TestString', field.String),
+              ('TestInt32', field.Int32),
+              ('TestInt64', field.Int64)]
+
+
+def _MakeFixtures():
+  """Returns (name, event class, data) for each benchmarked layout."""
+  test_data = ctypes.c_buffer(18)
+  test_data.value = 'Hello'
+
+  # The CSwitch event is 24 bytes of integral fields.
+  cswitch_data = ctypes.c_buffer(24)
+
+  # The FileIo Create event is three pointers, three 32 bit values and a
+  # path, on a 32 bit log.
+  path = u'C:\\Windows\\System32\\kernel32.dll'
+  create_data = ctypes.c_buffer(3 * 4 + 3 * 4 + 2 * (len(path) + 1))
+  ctypes.memmove(ctypes.addressof(create_data) + 24, path, 2 * len(path))
+
+  return [('test_event', _TestEventClass, test_data),
+          ('CSwitch', thread.Thread_V2.CSwitch, cswitch_data),
+          ('FileIo Create', fileio.FileIo.Create, create_data)]
+
+
+def _Time(event_class, event_trace, session, iterations):
+  start = time.clock()
+  for unused_i in xrange(iterations):
+    event_class(session, event_trace)
+  return time.clock() - start
+
+
+def _ForcePython(event_class):
+  """Returns a subclass of event_class that decodes in Python."""
+  return type(event_class.__name__, (event_class,),
+              {'_fields_': event_class._fields_, '_decoding_plan_': None})
+
+
+def main():
+  parser = optparse.OptionParser()
+  parser.add_option('--iterations', type='int', default=50000,
+                    help='Number of events to decode per layout.')
+  options, unused_args = parser.parse_args()
+
+  if not decoder.IsAvailable():
+    print 'etw_decoder.dll could not be loaded.'
+    return 1
+
+  session = _MockSession()
+  for name, event_class, data in _MakeFixtures():
+    event_trace = _MockEventTrace(data)
+    python = _Time(_ForcePython(event_class), event_trace, session,
+                   options.iterations)
+    native = _Time(event_class, event_trace, session, options.iterations)
+    print '%-16s python: %8.0f events/s  native: %8.0f events/s  %.1fx' % (
+        name, options.iterations / python, options.iterations / native,
+        python / native)
+
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -146,6 +146,7 @@ class BinaryBufferReaderTest(unittest.TestCase):
     reader = binary_buffer.BinaryBufferReader(
         ctypes.cast(data, ctypes.c_void_p).value, ctypes.sizeof(data))
     self.assertEqual(u'Hello!', reader.ReadWString())
+    self.assertEqual(ctypes.sizeof(data), reader._offset)
 
   POINTER_SIZE_32 = 4
   MAX_SID_SIZE = 68
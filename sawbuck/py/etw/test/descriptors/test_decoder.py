@@ -0,0 +1,199 @@
+#!/usr/bin/python2.6
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Unit test for the etw.descriptors.decoder module."""
+import ctypes
+import threading
+import unittest
+from etw import util
+from etw.descriptors import binary_buffer
+from etw.descriptors import decoder
+from etw.descriptors import event
+from etw.descriptors import field
+
+
+_FIELDS = [('TestString', field.String),
+           ('TestInt8', field.Int8),
+           ('TestUInt16', field.UInt16),
+           ('TestInt32', field.Int32),
+           ('TestUInt64', field.UInt64),
+           ('TestPointer', field.Pointer),
+           ('TestWString', field.WString),
+           ('TestBoolean', field.Boolean)]
+
+
+class _Target(object):
+  pass
+
+
+class MockEventTrace(object):
+  """This class mocks the EVENT_TRACE structure."""
+
+  class MockContents(object):
+    pass
+
+  class MockHeader(object):
+    def __init__(self, header_dict):
+      for k, v in header_dict.items():
+        setattr(self, k, v)
+
+  def __init__(self, header_dict, mof_data, mof_length):
+    self.contents = MockEventTrace.MockContents()
+    self.contents.Header = MockEventTrace.MockHeader(header_dict)
+    self.contents.MofData = mof_data
+    self.contents.MofLength = mof_length
+
+
+class MockSession(object):
+  """This class mocks a _TraceLogSession object."""
+  def __init__(self):
+    self.is_64_bit_log = False
+
+  def SessionTimeToTime(self, session_time):
+    return util.FileTimeToTime(session_time)
+
+
+def _MakeBuffer():
+  """Returns a ctypes buffer laid out according to _FIELDS."""
+  class Layout(ctypes.Structure):
+    _pack_ = 1
+    _fields_ = [('string', ctypes.c_char * 6),
+                ('int8', ctypes.c_byte),
+                ('uint16', ctypes.c_ushort),
+                ('int32', ctypes.c_int),
+                ('uint64', ctypes.c_ulonglong),
+                ('pointer', ctypes.c_uint),
+                ('wstring', ctypes.c_wchar * 4),
+                ('boolean', ctypes.c_byte)]
+
+  return Layout('Hello', -5, 0xFFFE, -1234, 0xFFFFFFFFFFFFFFFF,
+                0xDEADBEEF, u'abc', 1)
+
+
+class DecoderTest(unittest.TestCase):
+  def setUp(self):
+    self._session = MockSession()
+
+  def _DecodeWithPython(self, fields, data):
+    target = _Target()
+    reader = binary_buffer.BinaryBufferReader(ctypes.addressof(data),
+                                              ctypes.sizeof(data))
+    for name, field_type in fields:
+      setattr(target, name, field_type(self._session, reader))
+    return target
+
+  def _DecodeWithPlan(self, fields, data):
+    plan = decoder.Compile(fields)
+    self.assertNotEqual(None, plan)
+    target = _Target()
+    plan.Decode(self._session, target, ctypes.addressof(data),
+                ctypes.sizeof(data))
+    return target
+
+  def testCompileRejectsUnknownFields(self):
+    def Custom(unused_session, reader):
+      return reader.ReadUInt32()
+
+    self.assertEqual(None, decoder.Compile([('Custom', Custom)]))
+
+  def testMatchesPythonDecoder(self):
+    if not decoder.IsAvailable():
+      return
+
+    data = _MakeBuffer()
+    python = self._DecodeWithPython(_FIELDS, data)
+    native = self._DecodeWithPlan(_FIELDS, data)
+    for name, unused_field in _FIELDS:
+      self.assertEqual(getattr(python, name), getattr(native, name))
+
+    self.assertEqual('Hello', native.TestString)
+    self.assertEqual(-5, native.TestInt8)
+    self.assertEqual(-1234, native.TestInt32)
+    self.assertEqual(0xFFFFFFFFFFFFFFFF, native.TestUInt64)
+    self.assertEqual(u'abc', native.TestWString)
+    self.assertEqual(True, native.TestBoolean)
+
+  def testOverflow(self):
+    if not decoder.IsAvailable():
+      return
+
+    data = ctypes.c_buffer(6)
+    plan = decoder.Compile([('A', field.Int32), ('B', field.Int32)])
+    self.assertRaises(binary_buffer.BufferOverflowError, plan.Decode,
+                      self._session, _Target(), ctypes.addressof(data),
+                      ctypes.sizeof(data))
+
+  def testSid(self):
+    if not decoder.IsAvailable():
+      return
+
+    # A NULL pointer means there's no SID.
+    data = ctypes.c_buffer(4)
+    plan = decoder.Compile([('Sid', field.Sid)])
+    target = _Target()
+    plan.Decode(self._session, target, ctypes.addressof(data),
+                ctypes.sizeof(data))
+    self.assertEqual(None, target.Sid)
+
+  def testDecodesOnThreads(self):
+    if not decoder.IsAvailable():
+      return
+
+    # Two threads decode different values with the same plan at once.
+    plan = decoder.Compile([('A', field.Int32), ('B', field.Int32)])
+    mismatches = []
+
+    def DecodeMany(value):
+      data = (ctypes.c_int * 2)(value, -value)
+      for unused_i in xrange(10000):
+        target = _Target()
+        plan.Decode(self._session, target, ctypes.addressof(data),
+                    ctypes.sizeof(data))
+        if target.A != value or target.B != -value:
+          mismatches.append((value, target.A, target.B))
+
+    threads = [threading.Thread(target=DecodeMany, args=(value,))
+               for value in (1, 2)]
+    for thread in threads:
+      thread.start()
+    for thread in threads:
+      thread.join()
+
+    self.assertEqual([], mismatches)
+
+  def testEventClassUsesPlan(self):
+    class TestEventClass(event.EventClass):
+      _fields_ = [('TestInt32', field.Int32)]
+
+    class PythonEventClass(event.EventClass):
+      _decoding_plan_ = None
+      _fields_ = [('TestInt32', field.Int32)]
+
+    data = ctypes.c_int(1234)
+    header_dict = {'ProcessId': 1, 'ThreadId': 2, 'TimeStamp': 123456789}
+    event_trace = MockEventTrace(
+        header_dict, ctypes.addressof(data), ctypes.sizeof(data))
+
+    obj = TestEventClass(self._session, event_trace)
+    self.assertEqual(1234, obj.TestInt32)
+    self.assertEqual(decoder.IsAvailable(),
+                     TestEventClass._decoding_plan_ is not None)
+
+    obj = PythonEventClass(self._session, event_trace)
+    self.assertEqual(1234, obj.TestInt32)
+    self.assertEqual(None, PythonEventClass._decoding_plan_)
+
+
+if __name__ == '__main__':
+  unittest.main()
@@ -0,0 +1,103 @@
+#!python
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from etw import batch
+from etw.descriptors import binary_buffer
+from etw.descriptors import decoder
+from etw.descriptors import event
+from etw.descriptors import field
+import ctypes
+import unittest
+
+
+class _NativeEventClass(event.EventClass):
+  _fields_ = [('A', field.Int32),
+              ('B', field.Int32)]
+
+
+class _PythonEventClass(event.EventClass):
+  _decoding_plan_ = None
+  _fields_ = [('A', field.Int32),
+              ('B', field.Int32)]
+
+
+class MockEventTrace(object):
+  """This class mocks a POINTER(EVENT_TRACE)."""
+
+  class MockContents(object):
+    pass
+
+  class MockHeader(object):
+    pass
+
+  def __init__(self, process_id, data, length):
+    self.contents = MockEventTrace.MockContents()
+    self.contents.Header = MockEventTrace.MockHeader()
+    self.contents.Header.ProcessId = process_id
+    self.contents.Header.ThreadId = process_id + 1
+    self.contents.Header.TimeStamp = process_id + 2
+    self.contents.MofData = ctypes.addressof(data)
+    self.contents.MofLength = length
+
+
+class MockSession(object):
+  """This class mocks a _TraceLogSession object."""
+  def __init__(self):
+    self.is_64_bit_log = False
+
+  def SessionTimeToTime(self, session_time):
+    return session_time
+
+
+class EventBatchBuilderTest(unittest.TestCase):
+  def setUp(self):
+    self._batches = []
+
+  def _Append(self, builder, process_id, length):
+    data = (ctypes.c_int * 2)(process_id * 10, process_id * 100)
+    builder.Append(MockEventTrace(process_id, data, length))
+
+  def _TestSkipsBadEvents(self, event_class):
+    builder = batch.EventBatchBuilder(event_class, MockSession(),
+                                      [self._batches.append], 16)
+
+    self._Append(builder, 1, 8)
+    # An event whose second field is cut short.
+    self.assertRaises(binary_buffer.BufferOverflowError,
+                      self._Append, builder, 2, 6)
+    self._Append(builder, 3, 8)
+    builder.Flush()
+
+    self.assertEqual(1, len(self._batches))
+    events = self._batches[0]
+    self.assertEqual(2, len(events))
+    self.assertEqual([1, 3], events.process_id.tolist())
+    self.assertEqual([2, 4], events.thread_id.tolist())
+    self.assertEqual([3, 5], events.raw_time_stamp.tolist())
+    self.assertEqual([10, 30], events.A.tolist())
+    self.assertEqual([100, 300], events.B.tolist())
+
+  def testSkipsBadEvents(self):
+    """Test that an event that fails to decode doesn't misalign a batch."""
+    self._TestSkipsBadEvents(_PythonEventClass)
+
+  def testSkipsBadEventsNative(self):
+    if not decoder.IsAvailable():
+      return
+
+    self._TestSkipsBadEvents(_NativeEventClass)
+
+
+if __name__ == '__main__':
+  unittest.main()
@@ -13,6 +13,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 from etw import TraceEventSource, EventConsumer, EventHandler
+from etw import BatchEventHandler
 from etw.descriptors import image
 import exceptions
 import os
@@ -26,8 +27,8 @@ class TraceConsumerTest(unittest.TestCase):
       os.path.join(_SRC_DIR,
                    'sawbuck/log_lib/test_data/image_data_32_v2.etl'))
 
-  def _Consume(self, log_file, handlers, raw_time=False):
-    log_consumer = TraceEventSource(handlers, raw_time)
+  def _Consume(self, log_file, handlers, raw_time=False, batch_size=4096):
+    log_consumer = TraceEventSource(handlers, raw_time, batch_size)
     log_consumer.OpenFileSession(log_file)
     log_consumer.Consume()
 
@@ -154,5 +155,100 @@ class TraceConsumerTest(unittest.TestCase):
 
     self.assertEqual(cooked_times, raw_times)
 
+  def testTimeWindowConsuming(self):
+    """Test consuming a window of time of a test log."""
+    class TestConsumer(EventConsumer):
+      def __init__(self):
+        self.times = []
+
+      @EventHandler(image.Event.Load,
+                    image.Event.UnLoad,
+                    image.Event.DCStart,
+                    image.Event.DCEnd)
+      def OnImageEvent(self, event_data):
+        self.times.append(event_data.time_stamp)
+
+    consumer = TestConsumer()
+    self._Consume(self._TEST_LOG, [consumer])
+    all_times = sorted(consumer.times)
+    start_time = all_times[len(all_times) / 4]
+    end_time = all_times[len(all_times) * 3 / 4]
+    # Only test a window that excludes some events at both ends.
+    self.assertTrue(all_times[0] < start_time < end_time < all_times[-1])
+
+    consumer = TestConsumer()
+    log_consumer = TraceEventSource([consumer])
+    log_consumer.OpenFileSession(self._TEST_LOG)
+    log_consumer.Consume(start_time, end_time)
+
+    self.assertNotEqual(0, len(consumer.times))
+    self.assertTrue(len(consumer.times) < len(all_times))
+    # Allow for the precision lost in converting times to FILETIME.
+    for time_stamp in consumer.times:
+      self.assertTrue(start_time - 1e-6 <= time_stamp <= end_time + 1e-6)
+
+  def testBatchConsuming(self):
+    """Test that batch handlers see the same events as event handlers."""
+    class TestConsumer(EventConsumer):
+      def __init__(self):
+        self.events = []
+        self.batches = []
+
+      @EventHandler(image.Event.Load)
+      def OnImageLoad(self, event_data):
+        self.events.append((event_data.process_id,
+                            event_data.time_stamp,
+                            event_data.ImageBase,
+                            event_data.ImageSize,
+                            event_data.FileName))
+
+      @BatchEventHandler(image.Event.Load)
+      def OnImageLoadBatch(self, batch):
+        self.batches.append(batch)
+
+    consumer = TestConsumer()
+    self._Consume(self._TEST_LOG, [consumer], batch_size=3)
+
+    self.assertNotEqual(0, len(consumer.batches))
+    batched_events = []
+    for batch in consumer.batches:
+      self.assertTrue(len(batch) <= 3)
+      self.assertEqual(image.Image.Load, batch.event_class)
+      batched_events.extend(zip(batch.process_id.tolist(),
+                                batch.time_stamp.tolist(),
+                                batch.ImageBase.tolist(),
+                                batch.ImageSize.tolist(),
+                                batch.FileName.tolist()))
+
+    self.assertEqual(consumer.events, batched_events)
+
+  def testUnsubscribedEventsAreNotDecoded(self):
+    """Test that only events with subscribers are decoded."""
+    class TestConsumer(EventConsumer):
+      def __init__(self):
+        self.image_load_events = 0
+
+      @EventHandler(image.Event.Load)
+      def OnImageLoad(self, event_data):
+        self.image_load_events += 1
+
+    # The log also holds image rundown events, which share the event class
+    # of the image load events.
+    decoded_events = [0]
+    original_init = image.Image.__init__
+    def CountingInit(self, *args, **kwargs):
+      decoded_events[0] += 1
+      original_init(self, *args, **kwargs)
+
+    image.Image.__init__ = CountingInit
+    try:
+      consumer = TestConsumer()
+      self._Consume(self._TEST_LOG, [consumer])
+    finally:
+      image.Image.__init__ = original_init
+
+    self.assertNotEqual(0, consumer.image_load_events)
+    self.assertEqual(consumer.image_load_events, decoded_events[0])
+
 if __name__ == '__main__':
   unittest.main()
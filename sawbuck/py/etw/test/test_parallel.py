@@ -0,0 +1,111 @@
+#!python
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+from etw import TraceEventSource, EventConsumer, EventHandler
+from etw import parallel
+from etw.descriptors import image
+import os
+import unittest
+
+
+_SRC_DIR = os.path.abspath(os.path.join(__file__, '../../../../..'))
+_TEST_DATA_DIR = os.path.join(_SRC_DIR, 'sawbuck/log_lib/test_data')
+_TEST_LOGS = [os.path.normpath(os.path.join(_TEST_DATA_DIR, name))
+              for name in ['image_data_32_v0.etl',
+                           'image_data_32_v1.etl',
+                           'image_data_32_v2.etl']]
+
+
+class ImageLoadRecorder(EventConsumer):
+  """Records the image load events as (time, process id, file name)."""
+  def __init__(self):
+    self._loads = []
+
+  @EventHandler(image.Event.Load)
+  def OnImageLoad(self, event_data):
+    self._loads.append((event_data.time_stamp,
+                        event_data.process_id,
+                        event_data.FileName))
+
+  def GetResult(self):
+    return self._loads
+
+
+class ImageLoadCounter(EventConsumer):
+  def __init__(self):
+    self._loads = 0
+
+  @EventHandler(image.Event.Load)
+  def OnImageLoad(self, event_data):
+    self._loads += 1
+
+  def GetResult(self):
+    return self._loads
+
+
+def _CreateHandlers():
+  return [ImageLoadRecorder(), ImageLoadCounter()]
+
+
+class ParallelImporterTest(unittest.TestCase):
+  def _ConsumeSequentially(self):
+    recorder = ImageLoadRecorder()
+    source = TraceEventSource([recorder])
+    for path in _TEST_LOGS:
+      source.OpenFileSession(path)
+    source.Consume()
+    source.Close()
+    return recorder.GetResult()
+
+  def _Import(self, use_threads):
+    importer = parallel.ParallelImporter(
+        _CreateHandlers,
+        reducers=[parallel.MergeOrdered, sum],
+        num_workers=2,
+        use_threads=use_threads)
+    return importer.Import(_TEST_LOGS)
+
+  def testImportOnThreads(self):
+    """Test that a threaded import yields the sequential results."""
+    loads, num_loads = self._Import(True)
+
+    expected = self._ConsumeSequentially()
+    self.assertEqual(len(expected), num_loads)
+    self.assertEqual(sorted(expected), loads)
+
+  def testImportOnProcesses(self):
+    """Test that importing in worker processes yields the same results."""
+    self.assertEqual(self._Import(True), self._Import(False))
+
+  def testDefaultReduction(self):
+    """Test that results default to a list of per-file results."""
+    importer = parallel.ParallelImporter(_CreateHandlers, use_threads=True)
+    loads, num_loads = importer.Import(_TEST_LOGS)
+
+    self.assertEqual(len(_TEST_LOGS), len(loads))
+    self.assertEqual(len(_TEST_LOGS), len(num_loads))
+    self.assertEqual(num_loads, [len(result) for result in loads])
+
+  def testImportNothing(self):
+    importer = parallel.ParallelImporter(_CreateHandlers)
+    self.assertEqual([], importer.Import([]))
+
+  def testMergeOrdered(self):
+    self.assertEqual([(1, 'a'), (2, 'b'), (3, 'c'), (4, 'd')],
+                     parallel.MergeOrdered([[(1, 'a'), (4, 'd')],
+                                            [(2, 'b'), (3, 'c')]]))
+
+
+if __name__ == '__main__':
+  unittest.main()
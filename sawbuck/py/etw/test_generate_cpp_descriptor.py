@@ -0,0 +1,162 @@
+#!/usr/bin/python2.6
+# Copyright 2011 Google Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Unit test for the generate_cpp_descriptor module."""
+
+import generate_cpp_descriptor
+import types
+import unittest
+
+
+# Stand-ins for the descriptor base classes, which are matched by name.
+class EventCategory(object):
+  pass
+
+
+class EventClass(object):
+  pass
+
+
+class Int32(object):
+  pass
+
+
+class Pointer(object):
+  pass
+
+
+class WString(object):
+  pass
+
+
+class Sid(object):
+  pass
+
+
+class Event(object):
+  GUID = '{84c2c8bc-02c7-4de1-88da-40312efbd84d}'
+  Start = (GUID, 1)
+  Stop = (GUID, 2)
+
+
+class Test_V1(EventCategory):
+  GUID = Event.GUID
+  VERSION = 1
+
+  class Test_Start_V1(EventClass):
+    _event_types_ = [Event.Start]
+    _fields_ = [('Id', Int32)]
+
+
+class Test(EventCategory):
+  GUID = Event.GUID
+  VERSION = 2
+
+  class Test_Start(EventClass):
+    _event_types_ = [Event.Start]
+    _fields_ = [('Id', Int32),
+                ('Address', Pointer)]
+
+  class Stop(EventClass):
+    _event_types_ = [Event.Stop]
+    _fields_ = [('User', Sid),
+                ('Name', WString)]
+
+
+def _MakeModule(name, *values):
+  module = types.ModuleType(name)
+  for value in values:
+    setattr(module, value.__name__, value)
+  return module
+
+
+class CppDescriptorGeneratorTest(unittest.TestCase):
+  _EXPECTED_START_OUTPUT = (
+      'template <int kVersion, bool kIs64Bit> struct Start;\n'
+      '\n'
+      '// Layout of the Start events, version 1.\n'
+      'template <bool kIs64Bit>\n'
+      'struct Start<1, kIs64Bit> {\n'
+      '  LONG Id;\n'
+      '\n'
+      '  // Parses the event from @p reader.\n'
+      '  // @returns true on success, false if the event data is malformed.\n'
+      '  bool Parse(BinaryBufferReader* reader) {\n'
+      '    return field::Read(reader, &Id);\n'
+      '  }\n'
+      '};\n'
+      '\n'
+      '// Layout of the Start events, version 2.\n'
+      'template <bool kIs64Bit>\n'
+      'struct Start<2, kIs64Bit> {\n'
+      '  LONG Id;\n'
+      '  typename field::Pointer<kIs64Bit>::Type Address;\n'
+      '\n'
+      '  // Parses the event from @p reader.\n'
+      '  // @returns true on success, false if the event data is malformed.\n'
+      '  bool Parse(BinaryBufferReader* reader) {\n'
+      '    return field::Read(reader, &Id) &&\n'
+      '        field::Read(reader, &Address);\n'
+      '  }\n'
+      '};')
+
+  def testGenerateVersionedEvent(self):
+    """Test that the versions of an event are merged into one template."""
+    module = _MakeModule('test', Event, Test_V1, Test)
+    generator = generate_cpp_descriptor.CppDescriptorGenerator([module])
+
+    layouts = generator._GetEventLayouts()
+    self.assertEquals(['Start', 'Stop'], [name for name, unused in layouts])
+
+    name, start_layouts = layouts[0]
+    self.assertEquals(self._EXPECTED_START_OUTPUT,
+                      generator._GenerateEvent(name, start_layouts))
+
+  def testGenerateSidField(self):
+    """Test that SID fields use the bitness dependent reader."""
+    module = _MakeModule('test', Event, Test)
+    generator = generate_cpp_descriptor.CppDescriptorGenerator([module])
+    output = generator._GenerateLayout('Stop', 2, Test.Stop)
+    self.assertTrue('  field::Sid User;\n' in output)
+    self.assertTrue('field::ReadSid<kIs64Bit>(reader, &User)' in output)
+    self.assertTrue('  std::wstring Name;\n' in output)
+
+  def testGenerateHeader(self):
+    """Test the overall structure of a generated header."""
+    module = _MakeModule('test', Event, Test)
+    generator = generate_cpp_descriptor.CppDescriptorGenerator([module])
+    output = generator.Generate(None, 'sawbuck/log_lib/descriptors/test.h')
+
+    self.assertTrue('#ifndef SAWBUCK_LOG_LIB_DESCRIPTORS_TEST_H_\n' in output)
+    self.assertTrue('namespace descriptors {\nnamespace test {\n' in output)
+    self.assertTrue('const GUID kGuid = { 0x84c2c8bc, 0x02c7, 0x4de1,\n'
+                    '    { 0x88, 0xda, 0x40, 0x31, 0x2e, 0xfb, 0xd8, 0x4d } };'
+                    in output)
+    self.assertTrue('enum EventType {\n'
+                    '  kStart = 1,\n'
+                    '  kStop = 2,\n'
+                    '};' in output)
+    for line in output.split('\n'):
+      self.assertTrue(len(line) <= 80, line)
+
+  def testDuplicateLayoutFails(self):
+    """Test that an event described twice for a version is an error."""
+    first = _MakeModule('first', Event, Test)
+    second = _MakeModule('second', Test)
+    generator = generate_cpp_descriptor.CppDescriptorGenerator([first, second])
+    self.assertRaises(ValueError, generator._GetEventLayouts)
+
+
+if __name__ == '__main__':
+  unittest.main()
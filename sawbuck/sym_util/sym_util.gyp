@@ -47,6 +47,7 @@
       'type': 'executable',
       'sources': [
         'module_cache_unittest.cc',
+        'symbol_cache_unittest.cc',
       ],
       'dependencies': [
         'sym_util',
@@ -13,11 +13,17 @@
 // limitations under the License.
 #include "sawbuck/sym_util/symbol_cache.h"
 
+#include <algorithm>
 #include "base/strings/string_util.h"
 #include <dbghelp.h>
 
 namespace {
 
+bool ModuleBaseLess(const sym_util::ModuleInformation& a,
+                    const sym_util::ModuleInformation& b) {
+  return a.base_address < b.base_address;
+}
+
 template <size_t name_len>
 class SymbolInfo {
  public:
@@ -71,19 +77,10 @@ bool SymbolCache::Initialize(size_t num_modules,
 
   initialized_ = true;
 
-  // Load the modules.
-  for (size_t i = 0; i < num_modules; ++i) {
-    modules_.push_back(modules[i]);
-
-    DWORD64 load_base = ::SymLoadModuleEx(process_handle_,
-                                          NULL,
-                                          modules[i].image_file_name.c_str(),
-                                          NULL,
-                                          modules[i].base_address,
-                                          modules[i].module_size,
-                                          NULL,
-                                          0);
-  }
+  // Build the range table for registering the modules on demand.
+  modules_.assign(modules, modules + num_modules);
+  std::sort(modules_.begin(), modules_.end(), ModuleBaseLess);
+  registered_.assign(modules_.size(), false);
 
   return true;
 }
@@ -96,6 +93,8 @@ bool SymbolCache::GetSymbolForAddress(Address address, Symbol *symbol) {
     return true;
   }
 
+  EnsureModuleRegistered(address);
+
   IMAGEHLP_MODULE64 module = { sizeof(module) };
   if (::SymGetModuleInfo64(process_handle_, address, &module)) {
     symbol->module = module.ImageName;
@@ -137,6 +136,7 @@ void SymbolCache::Cleanup() {
     ::SymCleanup(process_handle_);
 
   initialized_ = false;
+  registered_.assign(modules_.size(), false);
 }
 
 void SymbolCache::SetSymbolPath(const wchar_t* symbol_path) {
@@ -271,14 +271,62 @@ BOOL CALLBACK SymbolCache::SymbolCallback(HANDLE process,
 
 bool SymbolCache::GetModuleInformation(Address load_address,
                                        ModuleInformation* info) {
-  for (size_t i = 0; i < modules_.size(); ++i) {
-    if (modules_[i].base_address == load_address) {
-      *info = modules_[i];
-      return true;
+  size_t index = FindModule(load_address);
+  if (index == modules_.size() ||
+      modules_[index].base_address != load_address) {
+    return false;
+  }
+
+  *info = modules_[index];
+  return true;
+}
+
+void SymbolCache::EnsureModuleRegistered(Address address) {
+  size_t index = FindModule(address);
+  if (index == modules_.size() || registered_[index])
+    return;
+
+  // Only try each module once, whether or not it registers.
+  registered_[index] = true;
+
+  const ModuleInformation& module = modules_[index];
+  DWORD64 load_base = ::SymLoadModuleEx(process_handle_,
+                                        NULL,
+                                        module.image_file_name.c_str(),
+                                        NULL,
+                                        module.base_address,
+                                        module.module_size,
+                                        NULL,
+                                        0);
+  if (load_base == 0) {
+    // Zero with no error means the module was registered already.
+    DWORD error = ::GetLastError();
+    if (error != ERROR_SUCCESS) {
+      LOG(INFO) << "Failed to register module " << module.image_file_name
+          << ", error " << error;
     }
   }
+}
 
-  return false;
+size_t SymbolCache::FindModule(Address address) const {
+  // Find the last module based at or below address.
+  ModuleInformation key;
+  key.base_address = address;
+  ModuleList::const_iterator it(
+      std::upper_bound(modules_.begin(), modules_.end(), key,
+                       ModuleBaseLess));
+  if (it == modules_.begin())
+    return modules_.size();
+
+  --it;
+  if (address - it->base_address >= it->module_size)
+    return modules_.size();
+
+  return it - modules_.begin();
+}
+
+size_t SymbolCache::num_registered_modules() const {
+  return std::count(registered_.begin(), registered_.end(), true);
 }
 
 }  // namespace sym_util
@@ -39,13 +39,18 @@ class SymbolCache {
 
   bool GetSymbolForAddress(Address address, Symbol *symbol);
 
-  // Initialize to the set of modules provided.
+  // Initialize to the set of modules provided. The modules are registered
+  // with the symbol engine on demand, when an address first falls in their
+  // range, so that modules that never appear in stacks cost nothing.
   bool Initialize(size_t num_modules, ModuleInformation* modules);
   void Cleanup();
 
   // Sets a new symbol path, flushes the current cache.
   void SetSymbolPath(const wchar_t* symbol_path);
 
+  // @returns the number of modules registered with the symbol engine.
+  size_t num_registered_modules() const;
+
  private:
   // We handle symbol callbacks to provide more information about images,
   // such as checksums and timestamps.
@@ -56,6 +61,14 @@ class SymbolCache {
 
   bool GetModuleInformation(Address load_address, ModuleInformation* info);
 
+  // Registers the module containing @p address with the symbol engine,
+  // unless it's been registered already.
+  void EnsureModuleRegistered(Address address);
+
+  // Returns the position of the module containing @p address in modules_,
+  // or modules_.size() if there is none.
+  size_t FindModule(Address address) const;
+
   // The process handle we provide SymInitialize.
   HANDLE process_handle_;
 
@@ -74,8 +87,12 @@ class SymbolCache {
   typedef std::map<Address, Symbol> SymbolMap;
   SymbolMap cache_;
 
+  // Our modules, sorted by base address.
   typedef std::vector<ModuleInformation> ModuleList;
   ModuleList modules_;
+  // True for the modules we've registered with the symbol engine,
+  // parallel to modules_.
+  std::vector<bool> registered_;
 
   // To ensure we only retry loading each module once.
   typedef std::set<Address> RetriedModuleSet;
@@ -0,0 +1,85 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Symbol cache unittests.
+#include "sawbuck/sym_util/symbol_cache.h"
+
+#include "base/logging.h"
+#include "base/time/time.h"
+#include "gtest/gtest.h"
+
+namespace sym_util {
+
+namespace {
+
+// An address that's in none of our modules.
+const Address kUnknownAddress = 0x10;
+
+int FunctionToResolve(int value) {
+  return value * 3 + 1;
+}
+
+// Retrieves the module information of the module that contains us.
+void GetOwnModuleInformation(ModuleInformation* info) {
+  HMODULE module = ::GetModuleHandle(NULL);
+  const IMAGE_DOS_HEADER* dos_header =
+      reinterpret_cast<const IMAGE_DOS_HEADER*>(module);
+  const IMAGE_NT_HEADERS* nt_headers =
+      reinterpret_cast<const IMAGE_NT_HEADERS*>(
+          reinterpret_cast<const char*>(module) + dos_header->e_lfanew);
+
+  wchar_t path[MAX_PATH];
+  ASSERT_NE(0U, ::GetModuleFileName(module, path, arraysize(path)));
+
+  info->base_address = reinterpret_cast<Address>(module);
+  info->module_size = nt_headers->OptionalHeader.SizeOfImage;
+  info->image_checksum = nt_headers->OptionalHeader.CheckSum;
+  info->time_date_stamp = nt_headers->FileHeader.TimeDateStamp;
+  info->image_file_name = path;
+}
+
+}  // namespace
+
+TEST(SymbolCacheTest, RegistersModulesOnDemand) {
+  ModuleInformation modules[2] = {};
+  ASSERT_NO_FATAL_FAILURE(GetOwnModuleInformation(&modules[0]));
+
+  // A module that no address falls in.
+  modules[1].base_address = modules[0].base_address + modules[0].module_size;
+  modules[1].module_size = 0x10000;
+  modules[1].image_file_name = L"C:\\no\\such\\module.dll";
+
+  SymbolCache cache;
+  base::TimeTicks start(base::TimeTicks::Now());
+  ASSERT_TRUE(cache.Initialize(arraysize(modules), modules));
+  EXPECT_EQ(0U, cache.num_registered_modules());
+
+  Symbol symbol;
+  EXPECT_FALSE(cache.GetSymbolForAddress(kUnknownAddress, &symbol));
+  EXPECT_EQ(0U, cache.num_registered_modules());
+
+  Address address = reinterpret_cast<Address>(&FunctionToResolve);
+  EXPECT_TRUE(cache.GetSymbolForAddress(address, &symbol));
+  EXPECT_EQ(1U, cache.num_registered_modules());
+
+  // Report the time to first symbol for a fresh cache.
+  LOG(INFO) << "Time to first symbol: "
+      << (base::TimeTicks::Now() - start).InMillisecondsF() << " ms.";
+
+  // Resolving again doesn't register anything further.
+  EXPECT_TRUE(cache.GetSymbolForAddress(address, &symbol));
+  EXPECT_EQ(1U, cache.num_registered_modules());
+}
+
+}  // namespace sym_util
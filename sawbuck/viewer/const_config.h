@@ -52,6 +52,9 @@ const wchar_t kLogViewColumnWidths[] = L"log_view_column_widths";
 const wchar_t kStackTraceColumnOrder[] = L"stack_trace_column_order";
 const wchar_t kStackTraceColumnWidths[] = L"stack_trace_column_widths";
 
+const wchar_t kStatisticsColumnOrder[] = L"statistics_column_order";
+const wchar_t kStatisticsColumnWidths[] = L"statistics_column_widths";
+
 const wchar_t kFilterViewColumnOrder[] = L"filter_view_column_order";
 const wchar_t kFilterViewColumnWidths[] = L"filter_view_column_widths";
 
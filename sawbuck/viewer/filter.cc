@@ -34,8 +34,7 @@ const wchar_t kSeparator[] = L"|";
 
 Filter::Filter(Column column, Relation relation, Action action,
                const wchar_t* value)
-    : column_(column), relation_(relation), action_(action), is_valid_(true),
-      match_re_("") {
+    : column_(column), relation_(relation), action_(action), is_valid_(true) {
   DCHECK(column < NUM_COLUMNS && relation < NUM_RELATIONS &&
          action < NUM_ACTIONS && value != NULL);
   value_ = base::WideToUTF8(value);
@@ -43,7 +42,7 @@ Filter::Filter(Column column, Relation relation, Action action,
 }
 
 
-Filter::Filter(const base::DictionaryValue* const serialized) : match_re_("") {
+Filter::Filter(const base::DictionaryValue* const serialized) {
   is_valid_ = Deserialize(serialized);
   BuildRegExp();
 }
@@ -54,7 +53,9 @@ void Filter::BuildRegExp() {
     case TIME:
     case FILE:
     case MESSAGE:
-      match_re_ = pcrecpp::RE(value_.c_str(),
+    case TEMPLATE:
+    case PROCESS_IMAGE:
+      matcher_ = PatternMatcher::Get(value_,
           PCRE_NEWLINE_ANYCRLF | PCRE_DOTALL | PCRE_UTF8 | PCRE_CASELESS);
       break;
   }
@@ -64,7 +65,7 @@ std::string Filter::value() const {
   return value_;
 }
 
-bool Filter::Matches(ILogView* log_view, int row_index) const {
+bool Filter::Matches(ILogView* log_view, int64 row_index) const {
   DCHECK(log_view);
 
   bool matches = false;
@@ -100,6 +101,14 @@ bool Filter::Matches(ILogView* log_view, int row_index) const {
       matches = ValueMatchesString(log_view->GetMessage(row_index));
       break;
     }
+    case TEMPLATE: {
+      matches = TemplateMatches(log_view, row_index);
+      break;
+    }
+    case PROCESS_IMAGE: {
+      matches = ImageMatches(log_view, row_index);
+      break;
+    }
     default:
       NOTREACHED() << "Invalid column type in filter!";
   }
@@ -124,16 +133,47 @@ bool Filter::ValueMatchesInt(int check_value) const {
 }
 
 bool Filter::ValueMatchesString(const std::string& check_string) const {
-  DCHECK(!match_re_.pattern().empty());
+  DCHECK(matcher_.get() != NULL);
   bool matches = false;
   if (relation_ == IS) {
-    matches = match_re_.FullMatch(check_string);
+    matches = matcher_->FullMatch(check_string);
   } else if (relation_ == CONTAINS) {
-    matches = match_re_.PartialMatch(check_string);
+    matches = matcher_->PartialMatch(check_string);
   }
   return matches;
 }
 
+bool Filter::TemplateMatches(ILogView* log_view, int64 row_index) const {
+  size_t template_id = log_view->GetTemplateId(row_index);
+  IdMatch& match = GetIdMatch(&template_matches_, template_id);
+  if (match == ID_UNKNOWN) {
+    match = ValueMatchesString(log_view->GetTemplateText(template_id)) ?
+        ID_MATCHES : ID_DOES_NOT_MATCH;
+  }
+
+  return match == ID_MATCHES;
+}
+
+bool Filter::ImageMatches(ILogView* log_view, int64 row_index) const {
+  size_t image_id = log_view->GetImageId(row_index);
+  IdMatch& match = GetIdMatch(&image_matches_, image_id);
+  if (match == ID_UNKNOWN) {
+    match = ValueMatchesString(log_view->GetImageName(image_id)) ?
+        ID_MATCHES : ID_DOES_NOT_MATCH;
+  }
+
+  return match == ID_MATCHES;
+}
+
+// static
+Filter::IdMatch& Filter::GetIdMatch(std::vector<IdMatch>* matches,
+                                    size_t id) {
+  if (id >= matches->size())
+    matches->resize(id + 1, ID_UNKNOWN);
+
+  return (*matches)[id];
+}
+
 base::DictionaryValue* Filter::Serialize() const {
   scoped_ptr<base::DictionaryValue> filter_dict(new base::DictionaryValue());
   filter_dict->SetInteger("column", column_);
@@ -245,3 +285,24 @@ bool Filter::operator==(const Filter& other) const{
          other.action_ == action_ &&
          other.value_ == value_;
 }
+
+void FilterStats::Add(const FilterStats& other) {
+  evaluations += other.evaluations;
+  matches += other.matches;
+  timed_evaluations += other.timed_evaluations;
+  timed_time += other.timed_time;
+}
+
+double FilterStats::GetHitRate() const {
+  if (evaluations == 0)
+    return 0.0;
+
+  return static_cast<double>(matches) / evaluations;
+}
+
+double FilterStats::GetNanosecondsPerEvaluation() const {
+  if (timed_evaluations == 0)
+    return 0.0;
+
+  return timed_time.InMillisecondsF() * 1000000.0 / timed_evaluations;
+}
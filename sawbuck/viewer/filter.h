@@ -20,8 +20,10 @@
 
 #include <string>
 #include <vector>
+#include "base/memory/ref_counted.h"
+#include "base/time/time.h"
 #include "sawbuck/viewer/log_list_view.h"
-#include "pcrecpp.h"  // NOLINT
+#include "sawbuck/viewer/pattern_matcher.h"
 
 // forward
 namespace base {
@@ -40,7 +42,8 @@ class ListValue;
 // Note that filter uses char strings internally.
 class Filter {
  public:
-  // Make this synonymous to the logview formatters enum.
+  // Make this synonymous to the logview formatters enum. Filters are
+  // serialized with their column's value, so new columns go last.
   enum Column {
     SEVERITY = LogViewFormatter::SEVERITY,
     PROCESS_ID = LogViewFormatter::PROCESS_ID,
@@ -49,6 +52,10 @@ class Filter {
     FILE = LogViewFormatter::FILE,
     LINE = LogViewFormatter::LINE,
     MESSAGE = LogViewFormatter::MESSAGE,
+    // Matches the text of the message template.
+    TEMPLATE,
+    // Matches the image name of the process, e.g. "chrome.exe".
+    PROCESS_IMAGE,
     NUM_COLUMNS
   };
 
@@ -75,7 +82,7 @@ class Filter {
   bool IsValid() { return is_valid_; }
 
   // Returns true if this filter matches the log entry in log_view on row_index.
-  bool Matches(ILogView* log_view, int row_index) const;
+  bool Matches(ILogView* log_view, int64 row_index) const;
 
   // Returns a JSON value representation of this filter. This representation
   // can be used in the constructor that takes a serialized representation.
@@ -111,12 +118,15 @@ class Filter {
 
   bool ValueMatchesInt(int check_value) const;
   bool ValueMatchesString(const std::string& check_string) const;
+  bool TemplateMatches(ILogView* log_view, int64 row_index) const;
+  bool ImageMatches(ILogView* log_view, int64 row_index) const;
 
-  // Sets up match_re_ if needed.
+  // Sets up matcher_ if needed.
   void BuildRegExp();
 
-  // As an optimization, we compile a matching reg exp at construction.
-  pcrecpp::RE match_re_;
+  // As an optimization, we get a compiled matcher at construction, which
+  // the filters with the same value share.
+  scoped_refptr<PatternMatcher> matcher_;
 
   Column column_;
   Relation relation_;
@@ -127,6 +137,46 @@ class Filter {
   std::string value_;
 
   bool is_valid_;
+
+  // Whether we match each message template and each process image, indexed
+  // by id. As many rows share a template or an image, this spares matching
+  // their text on every row.
+  enum IdMatch {
+    ID_UNKNOWN,
+    ID_MATCHES,
+    ID_DOES_NOT_MATCH,
+  };
+  mutable std::vector<IdMatch> template_matches_;
+  mutable std::vector<IdMatch> image_matches_;
+
+  // @returns the entry of @p id in @p matches, growing it as need be.
+  static IdMatch& GetIdMatch(std::vector<IdMatch>* matches, size_t id);
+};
+
+// The runtime statistics of a filter over the rows it has been evaluated
+// on. Only a sample of the evaluations is timed, as timing costs about as
+// much as the cheaper filters.
+struct FilterStats {
+  FilterStats() : evaluations(0), matches(0), timed_evaluations(0) {
+  }
+
+  // Adds the counts of @p other to ours.
+  void Add(const FilterStats& other);
+
+  // @returns the fraction of the evaluations that matched, or 0 if there
+  //     were none.
+  double GetHitRate() const;
+
+  // @returns the mean time of an evaluation in nanoseconds, or 0 if none
+  //     was timed.
+  double GetNanosecondsPerEvaluation() const;
+
+  int64 evaluations;
+  int64 matches;
+
+  // The evaluations we timed, and the time they took all told.
+  int64 timed_evaluations;
+  base::TimeDelta timed_time;
 };
 
 
@@ -17,9 +17,12 @@
 #include "sawbuck/viewer/filter_dialog.h"
 
 #include <atldlgs.h>
+#include <algorithm>
 
 #include "base/file_util.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "pcrecpp.h"  // NOLINT
 #include "sawbuck/viewer/const_config.h"
@@ -32,6 +35,9 @@ const FilterListView::ColumnInfo FilterListView::kColumns[] = {
   { 80, L"Relation" },
   { 240, L"Value" },
   { 80, L"Action" },
+  { 80, L"Evaluations" },
+  { 60, L"Hit rate" },
+  { 60, L"ns/eval" },
 };
 const wchar_t* FilterListView::kConfigKeyName =
     config::kSettingsKey;
@@ -54,6 +60,8 @@ const wchar_t* FilterDialog::kColumns[] = {
   L"File",
   L"Line",
   L"Message",
+  L"Template",
+  L"Image",
 };
 
 const wchar_t* FilterDialog::kRelations[] = {
@@ -131,6 +139,21 @@ void FilterDialog::PopulateFilterList() {
                               FilterDialog::kRelations[iter->relation()]);
     filter_list_view_.AddItem(item, 2, base::UTF8ToWide(iter->value()).c_str());
     filter_list_view_.AddItem(item, 3, FilterDialog::kActions[iter->action()]);
+
+    std::vector<Filter>::const_iterator stats_iter(
+        std::find(stats_filters_.begin(), stats_filters_.end(), *iter));
+    if (stats_iter == stats_filters_.end())
+      continue;
+
+    const FilterStats& stats = stats_[stats_iter - stats_filters_.begin()];
+    std::wstring evaluations(base::Int64ToString16(stats.evaluations));
+    std::wstring hit_rate(
+        base::StringPrintf(L"%.1f%%", stats.GetHitRate() * 100));
+    std::wstring cost(
+        base::StringPrintf(L"%.0f", stats.GetNanosecondsPerEvaluation()));
+    filter_list_view_.AddItem(item, 4, evaluations.c_str());
+    filter_list_view_.AddItem(item, 5, hit_rate.c_str());
+    filter_list_view_.AddItem(item, 6, cost.c_str());
   }
 }
 
@@ -56,6 +56,9 @@ class FilterListView : public ListViewBase<FilterListView,
     COL_RELATION,
     COL_VALUE,
     COL_ACTION,
+    COL_EVALUATIONS,
+    COL_HIT_RATE,
+    COL_COST,
     // Must be last.
     COL_MAX,
   };
@@ -100,6 +103,14 @@ class FilterDialog: public CDialogImpl<FilterDialog>,
 
   std::vector<Filter> get_filters() { return filters_; }
 
+  // Shows the runtime statistics @p stats of the filters @p filters, where
+  // they're in the list.
+  void set_filter_stats(const std::vector<Filter>& filters,
+                        const std::vector<FilterStats>& stats) {
+    stats_filters_ = filters;
+    stats_ = stats;
+  }
+
  private:
   BOOL OnInitDialog(CWindow focus_window, LPARAM init_param);
   void OnClose();
@@ -118,6 +129,10 @@ class FilterDialog: public CDialogImpl<FilterDialog>,
   int current_filter_;
   std::vector<Filter> filters_;
 
+  // The filters we have statistics of, and their statistics.
+  std::vector<Filter> stats_filters_;
+  std::vector<FilterStats> stats_;
+
   FilterListView filter_list_view_;
 
   CComboBox column_dropdown_;
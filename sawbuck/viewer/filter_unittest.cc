@@ -103,6 +103,51 @@ TEST_F(FilterTest, TestPIDMatching) {
   }
 }
 
+TEST_F(FilterTest, TestTemplateMatching) {
+  const int kNumRows = 4;
+  EXPECT_CALL(mock_view_, GetTemplateId(0)).WillRepeatedly(Return(0));
+  EXPECT_CALL(mock_view_, GetTemplateId(1)).WillRepeatedly(Return(3));
+  EXPECT_CALL(mock_view_, GetTemplateId(2)).WillRepeatedly(Return(0));
+  EXPECT_CALL(mock_view_, GetTemplateId(3)).WillRepeatedly(Return(3));
+
+  // The template text is matched once per template.
+  EXPECT_CALL(mock_view_, GetTemplateText(0))
+      .WillOnce(Return("Loaded <*> in <*> ms"));
+  EXPECT_CALL(mock_view_, GetTemplateText(3))
+      .WillOnce(Return("Connected to host <*>"));
+
+  Filter include_is(Filter::TEMPLATE, Filter::IS,
+                    Filter::INCLUDE, L"Loaded <\\*> in <\\*> ms");
+  for (int i = 0; i < kNumRows; i++) {
+    if (i % 2 == 0)
+      EXPECT_TRUE(include_is.Matches(&mock_view_, i));
+    else
+      EXPECT_FALSE(include_is.Matches(&mock_view_, i));
+  }
+}
+
+TEST_F(FilterTest, TestImageMatching) {
+  const int kNumRows = 4;
+  EXPECT_CALL(mock_view_, GetImageId(0)).WillRepeatedly(Return(1));
+  EXPECT_CALL(mock_view_, GetImageId(1)).WillRepeatedly(Return(2));
+  EXPECT_CALL(mock_view_, GetImageId(2)).WillRepeatedly(Return(1));
+  EXPECT_CALL(mock_view_, GetImageId(3)).WillRepeatedly(Return(0));
+
+  // The image name is matched once per image.
+  EXPECT_CALL(mock_view_, GetImageName(0)).WillOnce(Return(""));
+  EXPECT_CALL(mock_view_, GetImageName(1)).WillOnce(Return("chrome.exe"));
+  EXPECT_CALL(mock_view_, GetImageName(2)).WillOnce(Return("notepad.exe"));
+
+  Filter include_is(Filter::PROCESS_IMAGE, Filter::IS,
+                    Filter::INCLUDE, L"Chrome\\.exe");
+  for (int i = 0; i < kNumRows; i++) {
+    if (i % 2 == 0)
+      EXPECT_TRUE(include_is.Matches(&mock_view_, i));
+    else
+      EXPECT_FALSE(include_is.Matches(&mock_view_, i));
+  }
+}
+
 TEST_F(FilterTest, TestTimeMatching) {
   // TODO(siggi): Test time filtering.
 }
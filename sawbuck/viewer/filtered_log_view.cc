@@ -15,14 +15,360 @@
 // Filtered list view implementation.
 #include "sawbuck/viewer/filtered_log_view.h"
 
+#include <algorithm>
+#include <utility>
 #include "base/bind.h"
 #include "base/logging.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/task_runner_util.h"
 #include "pcrecpp.h"  // NOLINT
 
+namespace {
+
+// The evaluations a filter or a list of filters needs for its statistics to
+// order it.
+const int64 kMinEvaluations = 100;
+
+// The hit rate we assume of the filters that never match, to order them by
+// their cost.
+const double kMinHitRate = 0.001;
+
+// The cost we assume of the filters too quick to time, in nanoseconds.
+const double kMinNanoseconds = 1.0;
+
+}  // namespace
+
+class FilteredLogView::FilterPlan
+    : public base::RefCountedThreadSafe<FilterPlan> {
+ public:
+  FilterPlan(const std::vector<Filter>& inclusion_filters,
+             const std::vector<Filter>& exclusion_filters,
+             const LogSiteTable::SiteSet& muted_sites,
+             ProcessTree* process_tree)
+      : inclusion_filters_(inclusion_filters),
+        exclusion_filters_(exclusion_filters),
+        muted_sites_(muted_sites),
+        process_tree_(process_tree) {
+    stats_.inclusions.resize(inclusion_filters_.size());
+    stats_.exclusions.resize(exclusion_filters_.size());
+    for (size_t i = 0; i < inclusion_filters_.size(); ++i)
+      order_.inclusions.push_back(i);
+    for (size_t i = 0; i < exclusion_filters_.size(); ++i)
+      order_.exclusions.push_back(i);
+    order_.exclusions_first = false;
+  }
+
+  // @returns the rows of @p original from @p start up to @p end that pass
+  //     the filters, or whatever was found when @p token got cancelled.
+  std::vector<int64> FilterRows(ILogView* original,
+                                int64 start,
+                                int64 end,
+                                CancellationToken* token);
+
+  // Retrieves our filters, inclusions first, to @p filters, and their
+  // statistics so far to @p stats.
+  void GetFilterStats(std::vector<Filter>* filters,
+                      std::vector<FilterStats>* stats);
+
+ private:
+  friend class base::RefCountedThreadSafe<FilterPlan>;
+  ~FilterPlan() {
+  }
+
+  // The order we evaluate the filters in, as indices into each list, and
+  // which list goes first.
+  struct Order {
+    std::vector<size_t> inclusions;
+    std::vector<size_t> exclusions;
+    bool exclusions_first;
+  };
+
+  // The statistics of each filter, and of each list as a whole.
+  struct Stats {
+    void Add(const Stats& other);
+
+    std::vector<FilterStats> inclusions;
+    std::vector<FilterStats> exclusions;
+    FilterStats inclusion_list;
+    FilterStats exclusion_list;
+  };
+
+  // Returns true if the item at |index| passes the list of exclusion
+  // filters if |exclusions|, or else the list of inclusion filters. The
+  // list's filters are evaluated in |order|, and tallied in |stats|.
+  bool PassesFilterList(bool exclusions,
+                        const Order& order,
+                        ILogView* original,
+                        int64 index,
+                        bool timed,
+                        Stats* stats) const;
+
+  // Returns true if the item at |index| would match a filter in |list|,
+  // false otherwise. The filters are evaluated in |order|, tallied in
+  // |stats|, and timed if |timed|.
+  bool MatchesFilterList(const std::vector<Filter>& list,
+                         const std::vector<size_t>& order,
+                         ILogView* original,
+                         int64 index,
+                         bool timed,
+                         std::vector<FilterStats>* stats) const;
+
+  // Returns true if the item at |index| was logged from a muted site.
+  bool IsMutedSite(ILogView* original, int64 index) const;
+
+  // Returns true if the item at |index| was logged by a process outside
+  // the process tree |members|, if any.
+  bool IsOutsideProcessTree(const ProcessTree::Members* members,
+                            ILogView* original,
+                            int64 index) const;
+
+  // Reorders order_ by stats_.
+  void UpdateOrder();
+
+  // Orders a list of filters with |stats| to |order|, those likeliest to
+  // match for their cost first, as a match ends the list.
+  static void OrderFilterList(const std::vector<FilterStats>& stats,
+                              std::vector<size_t>* order);
+
+  // Returns the mean time of an evaluation of a list, in nanoseconds, from
+  // the statistics of its filters |stats| and of the list |list_stats|.
+  static double GetListCost(const std::vector<FilterStats>& stats,
+                            const FilterStats& list_stats);
+
+  // The filters we are using. We break them into two lists, one that
+  // contains inclusion filters, the other exclusion filters.
+  std::vector<Filter> inclusion_filters_;
+  std::vector<Filter> exclusion_filters_;
+
+  // The sites whose rows we exclude, indexed by site id.
+  LogSiteTable::SiteSet muted_sites_;
+
+  // The processes whose rows we include, or NULL for all processes.
+  scoped_refptr<ProcessTree> process_tree_;
+
+  // The chunks take the order as they start, and add their statistics
+  // as they end, which reorders the filters for the chunks that follow.
+  base::Lock lock_;
+  Stats stats_;  // Under lock_.
+  Order order_;  // Under lock_.
+
+  DISALLOW_COPY_AND_ASSIGN(FilterPlan);
+};
+
+void FilteredLogView::FilterPlan::Stats::Add(const Stats& other) {
+  DCHECK_EQ(inclusions.size(), other.inclusions.size());
+  DCHECK_EQ(exclusions.size(), other.exclusions.size());
+
+  for (size_t i = 0; i < inclusions.size(); ++i)
+    inclusions[i].Add(other.inclusions[i]);
+  for (size_t i = 0; i < exclusions.size(); ++i)
+    exclusions[i].Add(other.exclusions[i]);
+  inclusion_list.Add(other.inclusion_list);
+  exclusion_list.Add(other.exclusion_list);
+}
+
+std::vector<int64> FilteredLogView::FilterPlan::FilterRows(
+    ILogView* original, int64 start, int64 end, CancellationToken* token) {
+  // How often we check for cancellation.
+  const int kCancellationCheckRows = 256;
+  // How often we time the evaluations of a row.
+  const int kTimingSampleRows = 16;
+
+  Order order;
+  Stats stats;
+  {
+    base::AutoLock lock(lock_);
+    order = order_;
+  }
+  stats.inclusions.resize(inclusion_filters_.size());
+  stats.exclusions.resize(exclusion_filters_.size());
+
+  // The chunk checks its rows against the members as it starts.
+  scoped_refptr<const ProcessTree::Members> members;
+  if (process_tree_.get() != NULL)
+    members = process_tree_->GetMembers();
+
+  std::vector<int64> rows;
+  for (int64 i = start; i < end; ++i) {
+    if ((i - start) % kCancellationCheckRows == 0 && token->IsCancelled())
+      break;
+
+    // With no inclusion filters, show all rows that do not match a filter
+    // in the exclusion list. Otherwise, show all rows that match a filter
+    // in the inclusion list but match no filter in the exclusion list.
+    // Whichever list rejects rows the cheapest goes first.
+    bool timed = (i - start) % kTimingSampleRows == 0;
+    if (!IsMutedSite(original, i) &&
+        !IsOutsideProcessTree(members.get(), original, i) &&
+        PassesFilterList(order.exclusions_first, order, original, i, timed,
+                         &stats) &&
+        PassesFilterList(!order.exclusions_first, order, original, i, timed,
+                         &stats)) {
+      rows.push_back(i);
+    }
+  }
+
+  base::AutoLock lock(lock_);
+  stats_.Add(stats);
+  UpdateOrder();
+
+  return rows;
+}
+
+void FilteredLogView::FilterPlan::GetFilterStats(
+    std::vector<Filter>* filters, std::vector<FilterStats>* stats) {
+  DCHECK(filters != NULL);
+  DCHECK(stats != NULL);
+
+  filters->assign(inclusion_filters_.begin(), inclusion_filters_.end());
+  filters->insert(filters->end(),
+                  exclusion_filters_.begin(), exclusion_filters_.end());
+
+  base::AutoLock lock(lock_);
+  stats->assign(stats_.inclusions.begin(), stats_.inclusions.end());
+  stats->insert(stats->end(),
+                stats_.exclusions.begin(), stats_.exclusions.end());
+}
+
+bool FilteredLogView::FilterPlan::PassesFilterList(bool exclusions,
+                                                   const Order& order,
+                                                   ILogView* original,
+                                                   int64 index,
+                                                   bool timed,
+                                                   Stats* stats) const {
+  const std::vector<Filter>& list =
+      exclusions ? exclusion_filters_ : inclusion_filters_;
+  if (list.empty())
+    return true;
+
+  FilterStats& list_stats =
+      exclusions ? stats->exclusion_list : stats->inclusion_list;
+  bool matches = MatchesFilterList(
+      list, exclusions ? order.exclusions : order.inclusions, original, index,
+      timed, exclusions ? &stats->exclusions : &stats->inclusions);
+  ++list_stats.evaluations;
+  if (matches)
+    ++list_stats.matches;
+
+  return matches != exclusions;
+}
+
+bool FilteredLogView::FilterPlan::MatchesFilterList(
+    const std::vector<Filter>& list,
+    const std::vector<size_t>& order,
+    ILogView* original,
+    int64 index,
+    bool timed,
+    std::vector<FilterStats>* stats) const {
+  DCHECK_EQ(list.size(), order.size());
+
+  for (size_t i = 0; i < order.size(); ++i) {
+    const Filter& filter = list[order[i]];
+    FilterStats& filter_stats = (*stats)[order[i]];
+
+    bool matches = false;
+    if (timed) {
+      base::TimeTicks start(base::TimeTicks::HighResNow());
+      matches = filter.Matches(original, index);
+      filter_stats.timed_time += base::TimeTicks::HighResNow() - start;
+      ++filter_stats.timed_evaluations;
+    } else {
+      matches = filter.Matches(original, index);
+    }
+
+    ++filter_stats.evaluations;
+    if (matches) {
+      ++filter_stats.matches;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FilteredLogView::FilterPlan::IsMutedSite(ILogView* original,
+                                              int64 index) const {
+  if (muted_sites_.empty())
+    return false;
+
+  size_t site_id = original->GetSiteId(index);
+  return site_id < muted_sites_.size() && muted_sites_[site_id];
+}
+
+bool FilteredLogView::FilterPlan::IsOutsideProcessTree(
+    const ProcessTree::Members* members,
+    ILogView* original,
+    int64 index) const {
+  if (members == NULL)
+    return false;
+
+  return !members->Contains(original->GetProcessId(index),
+                            original->GetTime(index));
+}
+
+void FilteredLogView::FilterPlan::UpdateOrder() {
+  lock_.AssertAcquired();
+
+  OrderFilterList(stats_.inclusions, &order_.inclusions);
+  OrderFilterList(stats_.exclusions, &order_.exclusions);
+
+  if (stats_.inclusion_list.evaluations < kMinEvaluations ||
+      stats_.exclusion_list.evaluations < kMinEvaluations) {
+    return;
+  }
+
+  // A row must pass both lists, so the list likeliest to reject it for its
+  // cost goes first. The inclusions reject the rows they don't match, and
+  // the exclusions the rows they do. This compares the costs per rejection
+  // without dividing by a rate of zero.
+  double inclusion_cost = GetListCost(stats_.inclusions, stats_.inclusion_list);
+  double exclusion_cost = GetListCost(stats_.exclusions, stats_.exclusion_list);
+  double inclusion_rejections = 1.0 - stats_.inclusion_list.GetHitRate();
+  double exclusion_rejections = stats_.exclusion_list.GetHitRate();
+  order_.exclusions_first = exclusion_cost * inclusion_rejections <
+      inclusion_cost * exclusion_rejections;
+}
+
+// static
+void FilteredLogView::FilterPlan::OrderFilterList(
+    const std::vector<FilterStats>& stats, std::vector<size_t>* order) {
+  DCHECK(order != NULL);
+
+  // The filters are ordered by their cost per match. The ones we know too
+  // little of go first, to learn about them, and ties keep their order.
+  std::vector<std::pair<double, size_t> > keys;
+  for (size_t i = 0; i < stats.size(); ++i) {
+    double cost_per_match = 0.0;
+    if (stats[i].evaluations >= kMinEvaluations) {
+      cost_per_match =
+          std::max(stats[i].GetNanosecondsPerEvaluation(), kMinNanoseconds) /
+          std::max(stats[i].GetHitRate(), kMinHitRate);
+    }
+    keys.push_back(std::make_pair(cost_per_match, i));
+  }
+  std::sort(keys.begin(), keys.end());
+
+  order->clear();
+  for (size_t i = 0; i < keys.size(); ++i)
+    order->push_back(keys[i].second);
+}
+
+// static
+double FilteredLogView::FilterPlan::GetListCost(
+    const std::vector<FilterStats>& stats, const FilterStats& list_stats) {
+  if (list_stats.evaluations == 0)
+    return 0.0;
+
+  double total = 0.0;
+  for (size_t i = 0; i < stats.size(); ++i)
+    total += stats[i].evaluations * stats[i].GetNanosecondsPerEvaluation();
+  return total / list_stats.evaluations;
+}
+
 FilteredLogView::FilteredLogView(ILogView* original,
                                  const std::vector<Filter>& filters) :
-    filtered_rows_(0), original_(original),
-    registration_cookie_(0), next_sink_cookie_(1) {
+    filtered_rows_(0), published_rows_(-1), chunk_pending_(false),
+    filter_runner_(base::MessageLoopProxy::current()), original_(original),
+    registration_cookie_(0), next_sink_cookie_(1), weak_factory_(this) {
   DCHECK(original_ != NULL);
   original_->Register(this, &registration_cookie_);
   SetFilters(filters);
@@ -33,21 +379,26 @@ FilteredLogView::~FilteredLogView() {
   if (!task_.IsCancelled())
     task_.Cancel();
 
+  // Stop the chunk in progress, if any.
+  if (token_.get() != NULL)
+    token_->Cancel();
+
   original_->Unregister(registration_cookie_);
 }
 
-void FilteredLogView::LogViewNewItems() {
+void FilteredLogView::LogViewNewItems(int64 first_row, int64 num_rows) {
+  // Filter exactly the rows published to us.
+  published_rows_ = std::max(published_rows_, first_row + num_rows);
   PostFilteringTask();
 }
 
 void FilteredLogView::LogViewCleared() {
   RestartFiltering();
-  EventSinkMap::iterator it(event_sinks_.begin());
-  for (; it != event_sinks_.end(); ++it)
-    it->second->LogViewCleared();
+  NotifyLogViewCleared();
 }
 
-int FilteredLogView::GetNumRows() {
+int64 FilteredLogView::GetNumRows() {
+  base::AutoLock lock(rows_lock_);
   return included_rows_.size();
 }
 
@@ -55,52 +406,95 @@ void FilteredLogView::ClearAll() {
   original_->ClearAll();
 }
 
-int FilteredLogView::GetSeverity(int row) {
-  DCHECK(row < GetNumRows());
+int FilteredLogView::GetSeverity(int64 row) {
+  return original_->GetSeverity(GetOriginalRow(row));
+}
 
-  return original_->GetSeverity(included_rows_[row]);
+DWORD FilteredLogView::GetProcessId(int64 row) {
+  return original_->GetProcessId(GetOriginalRow(row));
 }
 
-DWORD FilteredLogView::GetProcessId(int row) {
-  DCHECK(row < GetNumRows());
+DWORD FilteredLogView::GetThreadId(int64 row) {
+  return original_->GetThreadId(GetOriginalRow(row));
+}
 
-  return original_->GetProcessId(included_rows_[row]);
+base::Time FilteredLogView::GetTime(int64 row) {
+  return original_->GetTime(GetOriginalRow(row));
 }
 
-DWORD FilteredLogView::GetThreadId(int row) {
-  DCHECK(row < GetNumRows());
+std::string FilteredLogView::GetFileName(int64 row) {
+  return original_->GetFileName(GetOriginalRow(row));
+}
 
-  return original_->GetThreadId(included_rows_[row]);
+int FilteredLogView::GetLine(int64 row) {
+  return original_->GetLine(GetOriginalRow(row));
 }
 
-base::Time FilteredLogView::GetTime(int row) {
-  DCHECK(row < GetNumRows());
+std::string FilteredLogView::GetMessage(int64 row) {
+  return original_->GetMessage(GetOriginalRow(row));
+}
 
-  return original_->GetTime(included_rows_[row]);
+void FilteredLogView::GetStackTrace(int64 row, std::vector<void*>* trace) {
+  return original_->GetStackTrace(GetOriginalRow(row), trace);
 }
 
-std::string FilteredLogView::GetFileName(int row) {
-  DCHECK(row < GetNumRows());
+int FilteredLogView::GetSiteId(int64 row) {
+  return original_->GetSiteId(GetOriginalRow(row));
+}
 
-  return original_->GetFileName(included_rows_[row]);
+int FilteredLogView::GetTemplateId(int64 row) {
+  return original_->GetTemplateId(GetOriginalRow(row));
 }
 
-int FilteredLogView::GetLine(int row) {
-  DCHECK(row < GetNumRows());
+std::string FilteredLogView::GetTemplateText(int template_id) {
+  return original_->GetTemplateText(template_id);
+}
+
+int FilteredLogView::GetImageId(int64 row) {
+  return original_->GetImageId(GetOriginalRow(row));
+}
 
-  return original_->GetLine(included_rows_[row]);
+std::string FilteredLogView::GetImageName(int image_id) {
+  return original_->GetImageName(image_id);
 }
 
-std::string FilteredLogView::GetMessage(int row) {
-  DCHECK(row < GetNumRows());
+int64 FilteredLogView::FindFirstRowAtTime(base::Time time) {
+  int64 row = GetRowAtOriginalRow(original_->FindFirstRowAtTime(time));
 
-  return original_->GetMessage(included_rows_[row]);
+  // Rows delivered late may follow, but none past where the original has
+  // no more rows logged before time.
+  int64 num_rows = GetNumRows();
+  while (row < num_rows && GetTime(row) < time)
+    ++row;
+
+  return row;
 }
 
-void FilteredLogView::GetStackTrace(int row, std::vector<void*>* trace) {
-  DCHECK(row < GetNumRows());
+int64 FilteredLogView::FindEndOfRowsBefore(base::Time time) {
+  int64 row = GetRowAtOriginalRow(original_->FindEndOfRowsBefore(time));
+
+  // The rows before may have been logged at or after time, but none before
+  // where the original reaches it.
+  while (row > 0 && !(GetTime(row - 1) < time))
+    --row;
 
-  return original_->GetStackTrace(included_rows_[row], trace);
+  return row;
+}
+
+int64 FilteredLogView::GetOriginalRow(int64 row) {
+  base::AutoLock lock(rows_lock_);
+
+  // A reader on another thread may race a restart. The rows cleared from
+  // under it map past the end of the original, which reads them as empty.
+  if (static_cast<uint64>(row) >= static_cast<uint64>(included_rows_.size()))
+    return kint64max;
+
+  return included_rows_.Get(row);
+}
+
+int64 FilteredLogView::GetRowAtOriginalRow(int64 original_row) {
+  base::AutoLock lock(rows_lock_);
+  return included_rows_.LowerBound(original_row);
 }
 
 void FilteredLogView::Register(ILogViewEvents* event_sink,
@@ -115,61 +509,62 @@ void FilteredLogView::Unregister(int registration_cookie) {
   event_sinks_.erase(registration_cookie);
 }
 
-bool FilteredLogView::MatchesFilterList(const std::vector<Filter>& list,
-                                        int index) {
-  std::vector<Filter>::const_iterator iter(list.begin());
-  for (; iter != list.end(); ++iter) {
-    if (iter->Matches(original_, index)) {
-      return true;
-    }
-  }
-  return false;
-}
-
 void FilteredLogView::FilterChunk() {
   task_.Cancel();
 
+  // Figure the range we're going to filter.
+  if (published_rows_ == -1)
+    published_rows_ = original_->GetNumRows();
+
+  const int kMaxFilterRows = 10000;
+  int64 start = filtered_rows_;
+  int64 end = std::min(filtered_rows_ + kMaxFilterRows, published_rows_);
+  if (start == end)
+    return;
+
+  // The plan, the token and the original view all outlive the chunk, which
+  // replies to us on this thread unless we're gone by then.
+  chunk_pending_ = true;
+  base::PostTaskAndReplyWithResult(
+      filter_runner_.get(),
+      FROM_HERE,
+      base::Bind(&FilterPlan::FilterRows, plan_, original_, start, end,
+                 token_),
+      base::Bind(&FilteredLogView::OnChunkFiltered,
+                 weak_factory_.GetWeakPtr(), token_, end));
+}
+
+void FilteredLogView::OnChunkFiltered(CancellationToken* token,
+                                      int64 end,
+                                      const std::vector<int64>& rows) {
+  // Ignore the chunks of abandoned passes.
+  if (token != token_.get())
+    return;
+
+  DCHECK(chunk_pending_);
+  chunk_pending_ = false;
+
   // Stash our starting row count.
-  int starting_rows = GetNumRows();
+  int64 starting_rows = GetNumRows();
 
-  // Figure the range we're going to filter.
-  const int kMaxFilterRows = 1000;
-  int start = filtered_rows_;
-  int end = std::min(filtered_rows_ + kMaxFilterRows, original_->GetNumRows());
-
-
-  if (inclusion_filters_.empty()) {
-    // If the inclusion_filters_ list is empty, show all rows that do not match
-    // a filter in the exclusion list
-    for (int i = start; i < end; ++i) {
-      // Run the exclusion filters here..
-      if (!MatchesFilterList(exclusion_filters_, i)) {
-        included_rows_.push_back(i);
-      }
-    }
-  } else {
-    // Otherwise, show all rows that match a filter in the inclusion list but
-    // match no rows in the exclusion list.
-    for (int i = start; i < end; ++i) {
-      if (MatchesFilterList(inclusion_filters_, i) &&
-          !MatchesFilterList(exclusion_filters_, i)) {
-        included_rows_.push_back(i);
-      }
-    }
+  {
+    base::AutoLock lock(rows_lock_);
+    included_rows_.Append(rows);
   }
 
   // Update our cursor.
   filtered_rows_ = end;
 
   // Post again if we're not done.
-  if (end != original_->GetNumRows())
+  if (end != published_rows_)
     PostFilteringTask();
 
   // If we added rows, signal the change.
-  if (starting_rows != GetNumRows()) {
+  int64 num_rows = GetNumRows() - starting_rows;
+  if (num_rows != 0) {
     EventSinkMap::iterator it(event_sinks_.begin());
     for (; it != event_sinks_.end(); ++it)
-      it->second->LogViewNewItems();
+      it->second->LogViewNewItems(starting_rows, num_rows);
   }
 }
 
@@ -189,16 +584,58 @@ void FilteredLogView::SetFilters(const std::vector<Filter>& filters) {
   }
 
   RestartFiltering();
+  NotifyLogViewCleared();
+}
+
+void FilteredLogView::GetFilterStats(std::vector<Filter>* filters,
+                                     std::vector<FilterStats>* stats) {
+  plan_->GetFilterStats(filters, stats);
+}
+
+void FilteredLogView::SetMutedSites(const LogSiteTable::SiteSet& muted_sites) {
+  muted_sites_ = muted_sites;
+
+  RestartFiltering();
+  NotifyLogViewCleared();
+}
+
+void FilteredLogView::SetProcessTree(ProcessTree* process_tree) {
+  process_tree_ = process_tree;
+
+  RestartFiltering();
+  NotifyLogViewCleared();
 }
 
 void FilteredLogView::RestartFiltering() {
+  // Abandon the pass in progress.
+  if (token_.get() != NULL)
+    token_->Cancel();
+  token_ = new CancellationToken();
+  chunk_pending_ = false;
+  plan_ = new FilterPlan(inclusion_filters_, exclusion_filters_, muted_sites_,
+                         process_tree_.get());
+
   // Reset our included state and our filtering state.
   filtered_rows_ = 0;
-  included_rows_.clear();
+  published_rows_ = -1;
+  {
+    base::AutoLock lock(rows_lock_);
+    included_rows_.Clear();
+  }
   PostFilteringTask();
 }
 
+void FilteredLogView::NotifyLogViewCleared() {
+  EventSinkMap::iterator it(event_sinks_.begin());
+  for (; it != event_sinks_.end(); ++it)
+    it->second->LogViewCleared();
+}
+
 void FilteredLogView::PostFilteringTask() {
+  // The chunk in flight posts again as it completes.
+  if (chunk_pending_)
+    return;
+
   if (task_.IsCancelled()) {
     task_.Reset(base::Bind(&FilteredLogView::FilterChunk,
                            base::Unretained(this)));
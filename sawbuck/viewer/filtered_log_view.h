@@ -21,11 +21,21 @@
 #include <vector>
 
 #include "base/cancelable_callback.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/task_runner.h"
+#include "sawbuck/log_lib/task_scheduler.h"
 #include "sawbuck/viewer/filter.h"
 #include "sawbuck/viewer/log_list_view.h"
+#include "sawbuck/viewer/log_site_table.h"
+#include "sawbuck/viewer/process_tree.h"
+#include "sawbuck/viewer/row_index.h"
 
-// Provides a filtered view on a log.
+// Provides a filtered view on a log. The rows are filtered in chunks on a
+// task runner, and the included rows are published back on the thread the
+// view lives on. The rows may be read from any thread.
 class FilteredLogView
     : public ILogViewEvents,
       public ILogView {
@@ -35,21 +45,28 @@ class FilteredLogView
   ~FilteredLogView();
 
   // ILogViewEvents implementation.
-  virtual void LogViewNewItems();
+  virtual void LogViewNewItems(int64 first_row, int64 num_rows);
   virtual void LogViewCleared();
 
   // ILogView implementation;
   // @{
-  virtual int GetNumRows();
+  virtual int64 GetNumRows();
   virtual void ClearAll();
-  virtual int GetSeverity(int row);
-  virtual DWORD GetProcessId(int row);
-  virtual DWORD GetThreadId(int row);
-  virtual base::Time GetTime(int row);
-  virtual std::string GetFileName(int row);
-  virtual int GetLine(int row);
-  virtual std::string GetMessage(int row);
-  virtual void GetStackTrace(int row, std::vector<void*>* trace);
+  virtual int GetSeverity(int64 row);
+  virtual DWORD GetProcessId(int64 row);
+  virtual DWORD GetThreadId(int64 row);
+  virtual base::Time GetTime(int64 row);
+  virtual std::string GetFileName(int64 row);
+  virtual int GetLine(int64 row);
+  virtual std::string GetMessage(int64 row);
+  virtual void GetStackTrace(int64 row, std::vector<void*>* trace);
+  virtual int GetSiteId(int64 row);
+  virtual int GetTemplateId(int64 row);
+  virtual std::string GetTemplateText(int template_id);
+  virtual int GetImageId(int64 row);
+  virtual std::string GetImageName(int image_id);
+  virtual int64 FindFirstRowAtTime(base::Time time);
+  virtual int64 FindEndOfRowsBefore(base::Time time);
   virtual void Register(ILogViewEvents* event_sink,
                         int* registration_cookie);
   virtual void Unregister(int registration_cookie);
@@ -57,30 +74,89 @@ class FilteredLogView
 
  void SetFilters(const std::vector<Filter>& filters);
 
+ // Retrieves the filters, inclusions first, to @p filters, and their
+ // statistics since filtering last restarted to @p stats. The filters are
+ // evaluated in the order these suggest, cheap and selective ones first.
+ void GetFilterStats(std::vector<Filter>* filters,
+                     std::vector<FilterStats>* stats);
+
+ // Excludes the rows logged from the sites in @p muted_sites.
+ void SetMutedSites(const LogSiteTable::SiteSet& muted_sites);
+
+ // Excludes the rows logged by processes outside @p process_tree, or no
+ // rows if it's NULL. The processes that join the tree as it grows are
+ // seen by the rows filtered from then on.
+ void SetProcessTree(ProcessTree* process_tree);
+
+ // Filters on @p filter_runner rather than on the current message loop.
+ // The original view must then be safe to call from the runner's threads.
+ void set_filter_runner(base::TaskRunner* filter_runner) {
+   filter_runner_ = filter_runner;
+ }
+
  protected:
+  // The filters, muted sites and process tree of a filtering pass. Each
+  // pass gets its own plan, so that chunks can be evaluated on other
+  // threads.
+  class FilterPlan;
+
+  // @returns the row of |original_| that is our @p row.
+  int64 GetOriginalRow(int64 row);
+
+  // @returns the first of our rows that is @p original_row of |original_|
+  //     or follows it.
+  int64 GetRowAtOriginalRow(int64 original_row);
+
   void PostFilteringTask();
   void FilterChunk();
   virtual void RestartFiltering();
 
-  // Returns true if the item at |index| would match a filter in |list|,
-  // false otherwise.
-  bool MatchesFilterList(const std::vector<Filter>& list, int index);
+  // Tells our event sinks that our rows are gone, which they must be told
+  // whenever we restart filtering.
+  void NotifyLogViewCleared();
+
+  // Invoked with the @p rows included from the chunk that ends at row
+  // @p end of |original_|, by the pass with @p token.
+  void OnChunkFiltered(CancellationToken* token,
+                       int64 end,
+                       const std::vector<int64>& rows);
 
   // The filters we are using. We break them into two lists, one that contains
   // inclusion filters, the other exclusion filters.
   std::vector<Filter> inclusion_filters_;
   std::vector<Filter> exclusion_filters_;
 
-  // The included rows we have filtered.
-  std::vector<int> included_rows_;
+  // The sites whose rows we exclude, indexed by site id. Sites beyond its
+  // end are not muted.
+  LogSiteTable::SiteSet muted_sites_;
+
+  // The processes whose rows we include, or NULL for all processes.
+  scoped_refptr<ProcessTree> process_tree_;
+
+  // The included rows we have filtered, which are read from other threads
+  // by the views stacked on us.
+  base::Lock rows_lock_;
+  RowIndex included_rows_;  // Under rows_lock_.
   // Row number of last row in |original_| that we've processed.
-  int filtered_rows_;
+  int64 filtered_rows_;
+  // The number of rows |original_| has published to us, or -1 to filter
+  // all its rows after a restart.
+  int64 published_rows_;
 
   typedef base::CancelableCallback<void()> FilterCallback;
 
   // Non-NULL if there's a task pending to process additional rows.
   FilterCallback task_;
 
+  // The plan of the current filtering pass.
+  scoped_refptr<FilterPlan> plan_;
+  // Cancelled when filtering restarts, to abandon the chunks of the pass.
+  scoped_refptr<CancellationToken> token_;
+  // True while a chunk is being filtered on filter_runner_.
+  bool chunk_pending_;
+  // Where we filter our chunks.
+  scoped_refptr<base::TaskRunner> filter_runner_;
+
   ILogView* original_;
   int registration_cookie_;
 
@@ -88,6 +164,9 @@ class FilteredLogView
   EventSinkMap event_sinks_;
   int next_sink_cookie_;
 
+  // Drops the replies of the chunks in flight when we're destroyed.
+  base::WeakPtrFactory<FilteredLogView> weak_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(FilteredLogView);
 };
 
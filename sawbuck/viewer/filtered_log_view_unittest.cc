@@ -122,11 +122,11 @@ TEST_F(FilteredLogViewTest, IdentityFilter) {
   const int kNumRows = 12345;
   EXPECT_CALL(mock_view_, GetNumRows())
       .WillRepeatedly(Return(kNumRows));
-  EXPECT_CALL(mock_view_events_, LogViewNewItems())
+  EXPECT_CALL(mock_view_events_, LogViewNewItems(_, _))
       .Times(AtLeast(1));
 
   EXPECT_EQ(0, filtered.GetNumRows());
-  filtered.LogViewNewItems();
+  filtered.LogViewNewItems(0, kNumRows);
   EXPECT_EQ(0, filtered.GetNumRows());
 
   EXPECT_CALL(mock_view_, GetMessage(_))
@@ -139,6 +139,33 @@ TEST_F(FilteredLogViewTest, IdentityFilter) {
   ExpectUnregistration();
 }
 
+TEST_F(FilteredLogViewTest, FiltersPublishedRows) {
+  ExpectCreation(0);
+  TestingFilteredLogView filtered(&mock_view_, filters_);
+
+  int cookie = 0;
+  filtered.Register(&mock_view_events_, &cookie);
+
+  // Filter the empty view.
+  EXPECT_CALL(mock_view_, GetNumRows()).WillOnce(Return(0));
+  RunMessageLoopToIdle();
+
+  // Only the rows published so far are filtered, though there are more.
+  EXPECT_CALL(mock_view_, GetMessage(_))
+      .WillRepeatedly(Return("foo"));
+  EXPECT_CALL(mock_view_events_, LogViewNewItems(0, 4)).Times(1);
+  filtered.LogViewNewItems(0, 4);
+  RunMessageLoopToIdle();
+  EXPECT_EQ(4, filtered.GetNumRows());
+
+  EXPECT_CALL(mock_view_events_, LogViewNewItems(4, 6)).Times(1);
+  filtered.LogViewNewItems(4, 6);
+  RunMessageLoopToIdle();
+  EXPECT_EQ(10, filtered.GetNumRows());
+
+  ExpectUnregistration();
+}
+
 TEST_F(FilteredLogViewTest, Filtering) {
   const int kNumRows = 3;
   ExpectCreation(kNumRows);
@@ -203,6 +230,223 @@ TEST_F(FilteredLogViewTest, Filtering) {
   ExpectUnregistration();
 }
 
+TEST_F(FilteredLogViewTest, FilterStats) {
+  const int kNumRows = 3;
+  ExpectCreation(kNumRows);
+
+  std::vector<Filter> filters;
+  filters.push_back(Filter(Filter::MESSAGE, Filter::CONTAINS,
+                           Filter::INCLUDE, L"NothingIncluded"));
+  filters.push_back(Filter(Filter::MESSAGE, Filter::CONTAINS,
+                           Filter::INCLUDE, L"I'm incl"));
+  filters.push_back(Filter(Filter::MESSAGE, Filter::CONTAINS,
+                           Filter::EXCLUDE, L"Excluded"));
+  TestingFilteredLogView filtered(&mock_view_, filters);
+
+  EXPECT_CALL(mock_view_, GetNumRows())
+      .WillRepeatedly(Return(kNumRows));
+  EXPECT_CALL(mock_view_, GetMessage(0))
+      .WillRepeatedly(Return("I'm not included"));
+  EXPECT_CALL(mock_view_, GetMessage(1))
+      .WillRepeatedly(Return("I'm Included"));
+  EXPECT_CALL(mock_view_, GetMessage(2))
+      .WillRepeatedly(Return("I'm Included but also Excluded"));
+
+  RunMessageLoopToIdle();
+  ASSERT_EQ(1, filtered.GetNumRows());
+
+  std::vector<Filter> stats_filters;
+  std::vector<FilterStats> stats;
+  filtered.GetFilterStats(&stats_filters, &stats);
+  ASSERT_EQ(3U, stats_filters.size());
+  ASSERT_EQ(3U, stats.size());
+  EXPECT_TRUE(stats_filters[0] == filters[0]);
+  EXPECT_TRUE(stats_filters[2] == filters[2]);
+
+  // The exclusions only see the rows the inclusions let through.
+  EXPECT_EQ(3, stats[0].evaluations);
+  EXPECT_EQ(0, stats[0].matches);
+  EXPECT_EQ(3, stats[1].evaluations);
+  EXPECT_EQ(2, stats[1].matches);
+  EXPECT_EQ(2, stats[2].evaluations);
+  EXPECT_EQ(1, stats[2].matches);
+  EXPECT_DOUBLE_EQ(0.5, stats[2].GetHitRate());
+
+  ExpectUnregistration();
+}
+
+TEST_F(FilteredLogViewTest, ReordersFilters) {
+  const int kNumRows = 25000;
+  ExpectCreation(kNumRows);
+
+  // The first filter never matches, so the second goes first once the
+  // first chunk tells them apart.
+  std::vector<Filter> filters;
+  filters.push_back(Filter(Filter::MESSAGE, Filter::CONTAINS,
+                           Filter::INCLUDE, L"never"));
+  filters.push_back(Filter(Filter::MESSAGE, Filter::CONTAINS,
+                           Filter::INCLUDE, L"foo"));
+  TestingFilteredLogView filtered(&mock_view_, filters);
+
+  EXPECT_CALL(mock_view_, GetNumRows())
+      .WillRepeatedly(Return(kNumRows));
+  EXPECT_CALL(mock_view_, GetMessage(_))
+      .WillRepeatedly(Return("foo"));
+
+  RunMessageLoopToIdle();
+  EXPECT_EQ(kNumRows, filtered.GetNumRows());
+
+  std::vector<Filter> stats_filters;
+  std::vector<FilterStats> stats;
+  filtered.GetFilterStats(&stats_filters, &stats);
+  ASSERT_EQ(2U, stats.size());
+  EXPECT_LT(stats[0].evaluations, kNumRows);
+  EXPECT_EQ(0, stats[0].matches);
+  EXPECT_EQ(kNumRows, stats[1].evaluations);
+  EXPECT_EQ(kNumRows, stats[1].matches);
+
+  ExpectUnregistration();
+}
+
+TEST_F(FilteredLogViewTest, MutedSites) {
+  const int kNumRows = 4;
+  ExpectCreation(kNumRows);
+
+  TestingFilteredLogView filtered(&mock_view_, filters_);
+
+  EXPECT_CALL(mock_view_, GetNumRows())
+      .WillRepeatedly(Return(kNumRows));
+  EXPECT_CALL(mock_view_, GetSiteId(0)).WillRepeatedly(Return(0));
+  EXPECT_CALL(mock_view_, GetSiteId(1)).WillRepeatedly(Return(1));
+  EXPECT_CALL(mock_view_, GetSiteId(2)).WillRepeatedly(Return(0));
+  // A site that's newer than the set of muted sites.
+  EXPECT_CALL(mock_view_, GetSiteId(3)).WillRepeatedly(Return(2));
+
+  LogSiteTable::SiteSet muted_sites(2);
+  muted_sites[0] = true;
+  filtered.SetMutedSites(muted_sites);
+
+  RunMessageLoopToIdle();
+  ASSERT_EQ(2, filtered.GetNumRows());
+  EXPECT_EQ(1, filtered.GetSiteId(0));
+  EXPECT_EQ(2, filtered.GetSiteId(1));
+
+  // Muted sites are excluded along with the inclusion filters.
+  EXPECT_CALL(mock_view_, GetMessage(1))
+      .WillRepeatedly(Return("Included"));
+  EXPECT_CALL(mock_view_, GetMessage(3))
+      .WillRepeatedly(Return("Not"));
+  std::vector<Filter> filters;
+  filters.push_back(Filter(Filter::MESSAGE, Filter::CONTAINS, Filter::INCLUDE,
+                           L"Incl"));
+  filtered.SetFilters(filters);
+
+  RunMessageLoopToIdle();
+  ASSERT_EQ(1, filtered.GetNumRows());
+  EXPECT_EQ(1, filtered.GetSiteId(0));
+
+  // Unmute.
+  filtered.SetMutedSites(LogSiteTable::SiteSet());
+  filtered.SetFilters(filters_);
+
+  RunMessageLoopToIdle();
+  EXPECT_EQ(kNumRows, filtered.GetNumRows());
+
+  ExpectUnregistration();
+}
+
+base::Time TimeAtMs(int64 ms) {
+  return base::Time::FromInternalValue((1000000 + ms) * 1000);
+}
+
+TEST_F(FilteredLogViewTest, ProcessTree) {
+  const int kNumRows = 3;
+  const DWORD kBrowserPid = 0x10;
+  const DWORD kRendererPid = 0x20;
+  const DWORD kOtherPid = 0x40;
+  ExpectCreation(kNumRows);
+
+  TestingFilteredLogView filtered(&mock_view_, filters_);
+
+  // The rows of a browser, a renderer it started and another process.
+  EXPECT_CALL(mock_view_, GetNumRows())
+      .WillRepeatedly(Return(kNumRows));
+  EXPECT_CALL(mock_view_, GetProcessId(0)).WillRepeatedly(Return(kBrowserPid));
+  EXPECT_CALL(mock_view_, GetProcessId(1)).WillRepeatedly(Return(kOtherPid));
+  EXPECT_CALL(mock_view_, GetProcessId(2)).WillRepeatedly(Return(kRendererPid));
+  for (int i = 0; i < kNumRows; ++i)
+    EXPECT_CALL(mock_view_, GetTime(i)).WillRepeatedly(Return(TimeAtMs(i)));
+
+  IProcessInfoService::ProcessInfo browser = {};
+  browser.process_id_ = kBrowserPid;
+  IProcessInfoService::ProcessInfo renderer = {};
+  renderer.process_id_ = kRendererPid;
+  renderer.parent_process_id_ = kBrowserPid;
+  renderer.started_ = TimeAtMs(1);
+
+  scoped_refptr<ProcessTree> tree(new ProcessTree(kBrowserPid, TimeAtMs(0)));
+  tree->OnProcessInfo(browser);
+  tree->OnProcessInfo(renderer);
+  filtered.SetProcessTree(tree.get());
+
+  RunMessageLoopToIdle();
+  ASSERT_EQ(2, filtered.GetNumRows());
+  EXPECT_EQ(kBrowserPid, filtered.GetProcessId(0));
+  EXPECT_EQ(kRendererPid, filtered.GetProcessId(1));
+
+  filtered.SetProcessTree(NULL);
+
+  RunMessageLoopToIdle();
+  EXPECT_EQ(kNumRows, filtered.GetNumRows());
+
+  ExpectUnregistration();
+}
+
+TEST_F(FilteredLogViewTest, FindsTimes) {
+  const int kNumRows = 7;
+  ExpectCreation(kNumRows);
+
+  TestingFilteredLogView filtered(&mock_view_, filters_);
+
+  // The rows of site 1 are muted, and some rows are delivered late.
+  const int64 kTimes[kNumRows] = { 0, 4, 1, 5, 8, 6, 9 };
+  const int kSites[kNumRows] = { 0, 0, 1, 0, 1, 0, 0 };
+  EXPECT_CALL(mock_view_, GetNumRows())
+      .WillRepeatedly(Return(kNumRows));
+  for (int i = 0; i < kNumRows; ++i) {
+    EXPECT_CALL(mock_view_, GetTime(i))
+        .WillRepeatedly(Return(TimeAtMs(kTimes[i])));
+    EXPECT_CALL(mock_view_, GetSiteId(i))
+        .WillRepeatedly(Return(kSites[i]));
+  }
+
+  LogSiteTable::SiteSet muted_sites(2);
+  muted_sites[1] = true;
+  filtered.SetMutedSites(muted_sites);
+
+  // Our rows were logged at 0, 4, 5, 6 and 9 ms.
+  RunMessageLoopToIdle();
+  ASSERT_EQ(5, filtered.GetNumRows());
+
+  // Our row before the original's end was logged after the time.
+  EXPECT_CALL(mock_view_, FindFirstRowAtTime(TimeAtMs(3)))
+      .WillOnce(Return(1));
+  EXPECT_EQ(1, filtered.FindFirstRowAtTime(TimeAtMs(3)));
+  EXPECT_CALL(mock_view_, FindEndOfRowsBefore(TimeAtMs(3)))
+      .WillOnce(Return(3));
+  EXPECT_EQ(1, filtered.FindEndOfRowsBefore(TimeAtMs(3)));
+
+  // A late row follows the original's first row at the time.
+  EXPECT_CALL(mock_view_, FindFirstRowAtTime(TimeAtMs(7)))
+      .WillOnce(Return(4));
+  EXPECT_EQ(4, filtered.FindFirstRowAtTime(TimeAtMs(7)));
+  EXPECT_CALL(mock_view_, FindEndOfRowsBefore(TimeAtMs(7)))
+      .WillOnce(Return(6));
+  EXPECT_EQ(4, filtered.FindEndOfRowsBefore(TimeAtMs(7)));
+
+  ExpectUnregistration();
+}
+
 class MockFilteredLogView : public TestingFilteredLogView {
  public:
   explicit MockFilteredLogView(ILogView* original,
@@ -246,4 +490,28 @@ TEST_F(FilteredLogViewTest, ClearAll) {
   ExpectUnregistration();
 }
 
+TEST_F(FilteredLogViewTest, RestartClearsSinks) {
+  ExpectCreation(0);
+  StrictMock<MockFilteredLogView> filtered(&mock_view_, filters_);
+
+  int reg_cookie = 0;
+  filtered.Register(&mock_view_events_, &reg_cookie);
+
+  // Our rows are gone each time we filter afresh.
+  EXPECT_CALL(mock_view_events_, LogViewCleared()).Times(1);
+  EXPECT_CALL(filtered, RestartFiltering()).Times(1);
+  filtered.SetMutedSites(LogSiteTable::SiteSet(1, true));
+
+  EXPECT_CALL(mock_view_events_, LogViewCleared()).Times(1);
+  EXPECT_CALL(filtered, RestartFiltering()).Times(1);
+  filtered.SetProcessTree(NULL);
+
+  EXPECT_CALL(mock_view_events_, LogViewCleared()).Times(1);
+  EXPECT_CALL(filtered, RestartFiltering()).Times(1);
+  filtered.SetFilters(filters_);
+
+  filtered.Unregister(reg_cookie);
+  ExpectUnregistration();
+}
+
 }  // namespace
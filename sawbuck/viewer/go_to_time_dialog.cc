@@ -0,0 +1,70 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Go to time dialog implementation.
+#include "sawbuck/viewer/go_to_time_dialog.h"
+
+#include "base/strings/string_util.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/win/scoped_bstr.h"
+
+GoToTimeDialog::GoToTimeDialog(const GoToTimeParameters& defaults)
+    : params_(defaults) {
+}
+
+GoToTimeDialog::~GoToTimeDialog() {
+}
+
+LRESULT GoToTimeDialog::OnInitDialog(CWindow focus_window,
+                                     LPARAM init_param) {
+  SetDlgItemText(IDC_GOTO_FROM, base::UTF8ToWide(params_.from_).c_str());
+  SetDlgItemText(IDC_GOTO_TO, base::UTF8ToWide(params_.to_).c_str());
+  CheckDlgButton(IDC_GOTO_SET_BASE,
+      params_.set_base_time_ ? BST_CHECKED : BST_UNCHECKED);
+
+  CWindow from_wnd(GetDlgItem(IDC_GOTO_FROM));
+  from_wnd.SetFocus();
+  from_wnd.SendMessage(EM_SETSEL, 0, -1);
+  return FALSE;
+}
+
+LRESULT GoToTimeDialog::OnGo(UINT notify_code, int id, CWindow window) {
+  std::string from(GetItemText(IDC_GOTO_FROM));
+  if (from.empty()) {
+    GetDlgItem(IDC_GOTO_FROM).SetFocus();
+    return 0;
+  }
+
+  params_.from_ = from;
+  params_.to_ = GetItemText(IDC_GOTO_TO);
+  params_.set_base_time_ =
+      (IsDlgButtonChecked(IDC_GOTO_SET_BASE) == BST_CHECKED);
+  EndDialog(IDOK);
+  return 0;
+}
+
+LRESULT GoToTimeDialog::OnCancel(UINT notify_code, int id, CWindow window) {
+  EndDialog(IDCANCEL);
+  return 0;
+}
+
+std::string GoToTimeDialog::GetItemText(int id) {
+  base::win::ScopedBstr text;
+  GetDlgItem(id).GetWindowText(text.Receive());
+
+  std::string utf8_text;
+  base::WideToUTF8(text, text.Length(), &utf8_text);
+  base::TrimWhitespaceASCII(utf8_text, base::TRIM_ALL, &utf8_text);
+  return utf8_text;
+}
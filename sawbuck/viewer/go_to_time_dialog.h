@@ -0,0 +1,66 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Go to time dialog declaration.
+#ifndef SAWBUCK_VIEWER_GO_TO_TIME_DIALOG_H_
+#define SAWBUCK_VIEWER_GO_TO_TIME_DIALOG_H_
+
+#include <atlbase.h>
+#include <atlcrack.h>
+#include <atlwin.h>
+#include <string>
+#include "resource.h"
+
+struct GoToTimeParameters {
+  GoToTimeParameters() : set_base_time_(false) {
+  }
+
+  // UTF8 encoded times, as shown in the time column. An empty |to_| goes to
+  // |from_|, otherwise the rows logged from |from_| up to |to_| are
+  // selected.
+  std::string from_;
+  std::string to_;
+  // True to make |from_| the base time.
+  bool set_base_time_;
+};
+
+class GoToTimeDialog : public CDialogImpl<GoToTimeDialog> {
+ public:
+  enum { IDD = IDD_GOTOTIMEDIALOG };
+
+  BEGIN_MSG_MAP(GoToTimeDialog)
+    MSG_WM_INITDIALOG(OnInitDialog)
+    COMMAND_ID_HANDLER_EX(IDOK, OnGo)
+    COMMAND_ID_HANDLER_EX(IDCANCEL, OnCancel)
+  END_MSG_MAP()
+
+  explicit GoToTimeDialog(const GoToTimeParameters& defaults);
+  ~GoToTimeDialog();
+
+  LRESULT OnInitDialog(CWindow focus_window, LPARAM init_param);
+  LRESULT OnGo(UINT notify_code, int id, CWindow window);
+  LRESULT OnCancel(UINT notify_code, int id, CWindow window);
+
+  const GoToTimeParameters& params() const {
+    return params_;
+  }
+
+ protected:
+  // @returns the UTF8 text of the edit control @p id.
+  std::string GetItemText(int id);
+
+  GoToTimeParameters params_;
+};
+
+#endif  // SAWBUCK_VIEWER_GO_TO_TIME_DIALOG_H_
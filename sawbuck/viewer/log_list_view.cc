@@ -15,24 +15,67 @@
 // Log viewer window implementation.
 #include "sawbuck/viewer/log_list_view.h"
 
+#include <algorithm>
 #include <atlalloc.h>
 #include <atlframe.h>
 #include <wmistr.h>
 #include <evntrace.h>
 #include "base/logging.h"
 #include "base/i18n/time_formatting.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "pcrecpp.h"  // NOLINT
 #include "sawbuck/log_lib/process_info_service.h"
+#include "sawbuck/log_lib/thread_info_service.h"
 #include "sawbuck/viewer/const_config.h"
+#include "sawbuck/viewer/pattern_matcher.h"
 #include "sawbuck/viewer/resource.h"
 #include "sawbuck/viewer/stack_trace_list_view.h"
 
 namespace {
 
-const char* GetSeverityText(UCHAR severity) {
+// Returns true iff state indicates a selected listview item.
+bool IsSelected(UINT state) {
+  return (state & LVIS_SELECTED) == LVIS_SELECTED;
+}
+
+const int kNoItem = -1;
+
+// The most rows we show in the list control at once.
+const int64 kMaxItems = 16 * 1024 * 1024;
+
+// @returns the start of the window that shows the last of @p num_rows.
+int64 GetTailWindowStart(int64 num_rows) {
+  return std::max<int64>(0, num_rows - kMaxItems);
+}
+
+}  // namespace
+
+using base::StringPrintf;
+
+const LogListView::ColumnInfo LogListView::kColumns[] = {
+  { 24, L"Severity" },
+  { 42, L"Process ID" },
+  { 42, L"Thread ID" },
+  { 80, L"Time" },
+  { 180, L"File" },
+  { 30, L"Line" },
+  { 640, L"Message", },
+  { 80, L"Image" },
+};
+
+const wchar_t* LogListView::kConfigKeyName =
+    config::kSettingsKey;
+const wchar_t* LogListView::kColumnOrderValueName =
+    config::kLogViewColumnOrder;
+const wchar_t* LogListView::kColumnWidthValueName =
+    config::kLogViewColumnWidths;
+
+
+// static
+const char* LogViewFormatter::GetSeverityText(int severity) {
   switch (severity)  {
     case TRACE_LEVEL_NONE:
       return "NONE";
@@ -59,40 +102,66 @@ const char* GetSeverityText(UCHAR severity) {
   return "UNKNOWN";
 }
 
-// Returns true iff state indicates a selected listview item.
-bool IsSelected(UINT state) {
-  return (state & LVIS_SELECTED) == LVIS_SELECTED;
+LogViewFormatter::LogViewFormatter() {
 }
 
-const int kNoItem = -1;
-
-}  // namespace
-
-using base::StringPrintf;
+bool LogViewFormatter::ParseTime(const std::string& str,
+                                 base::Time reference,
+                                 base::Time* time) const {
+  DCHECK(time != NULL);
+
+  // Take the times as we show them, with the seconds and the milliseconds
+  // optional.
+  pcrecpp::RE time_re("(-?)(\\d+):(\\d\\d)(?::(\\d\\d)(?:[-.](\\d{1,3}))?)?");
+  std::string sign;
+  std::string hours_str;
+  std::string minutes_str;
+  std::string seconds_str;
+  std::string milliseconds_str;
+  if (!time_re.FullMatch(str, &sign, &hours_str, &minutes_str, &seconds_str,
+                         &milliseconds_str)) {
+    return false;
+  }
 
-const LogListView::ColumnInfo LogListView::kColumns[] = {
-  { 24, L"Severity" },
-  { 42, L"Process ID" },
-  { 42, L"Thread ID" },
-  { 80, L"Time" },
-  { 180, L"File" },
-  { 30, L"Line" },
-  { 640, L"Message", }
-};
+  // The milliseconds are a fraction of a second.
+  milliseconds_str.resize(3, '0');
+
+  int hours = 0;
+  int minutes = 0;
+  int seconds = 0;
+  int milliseconds = 0;
+  if (!base::StringToInt(hours_str, &hours) ||
+      !base::StringToInt(minutes_str, &minutes) ||
+      (!seconds_str.empty() && !base::StringToInt(seconds_str, &seconds)) ||
+      !base::StringToInt(milliseconds_str, &milliseconds) ||
+      minutes >= 60 || seconds >= 60) {
+    return false;
+  }
 
-const wchar_t* LogListView::kConfigKeyName =
-    config::kSettingsKey;
-const wchar_t* LogListView::kColumnOrderValueName =
-    config::kLogViewColumnOrder;
-const wchar_t* LogListView::kColumnWidthValueName =
-    config::kLogViewColumnWidths;
+  if (!base_time_.is_null()) {
+    base::TimeDelta delta = base::TimeDelta::FromHours(hours) +
+        base::TimeDelta::FromMinutes(minutes) +
+        base::TimeDelta::FromSeconds(seconds) +
+        base::TimeDelta::FromMilliseconds(milliseconds);
+    *time = sign.empty() ? base_time_ + delta : base_time_ - delta;
+    return true;
+  }
 
+  if (!sign.empty() || hours >= 24)
+    return false;
 
-LogViewFormatter::LogViewFormatter() {
+  base::Time::Exploded exploded;
+  reference.LocalExplode(&exploded);
+  exploded.hour = hours;
+  exploded.minute = minutes;
+  exploded.second = seconds;
+  exploded.millisecond = milliseconds;
+  *time = base::Time::FromLocalExploded(exploded);
+  return true;
 }
 
 bool LogViewFormatter::FormatColumn(ILogView* log_view,
-                                    int row,
+                                    int64 row,
                                     Column col,
                                     std::string* str) {
   DCHECK(log_view != NULL);
@@ -160,6 +229,10 @@ bool LogViewFormatter::FormatColumn(ILogView* log_view,
       *str = log_view->GetMessage(row);
       break;
 
+    case PROCESS_IMAGE:
+      *str = log_view->GetImageName(log_view->GetImageId(row));
+      break;
+
     default:
       return false;
       break;
@@ -169,9 +242,10 @@ bool LogViewFormatter::FormatColumn(ILogView* log_view,
 }
 
 LogListView::LogListView(CUpdateUIBase* update_ui)
-    : log_view_(NULL), event_cookie_(0),
+    : log_view_(NULL), event_cookie_(0), window_start_(0),
       update_ui_(update_ui), stack_trace_view_(NULL),
-      process_info_service_(NULL) {
+      process_info_service_(NULL),
+      thread_info_service_(NULL) {
   ui_loop_ = base::MessageLoop::current();
 
   context_menu_bar_.LoadMenu(IDR_LIST_VIEW_CONTEXT_MENU);
@@ -196,10 +270,9 @@ void LogListView::SetLogView(ILogView* log_view) {
 
   // Adjust our size if we've been created already.
   if (IsWindow()) {
-    int num_rows = log_view_->GetNumRows();
-    SetItemCountEx(num_rows, 0);  // Invalidate the whole list.
+    SetWindow(GetTailWindowStart(log_view_->GetNumRows()));
     // We initially want to show the latest items
-    EnsureVisible(num_rows - 1, TRUE /* PartialOK */);
+    EnsureVisible(GetItemCount() - 1, TRUE /* PartialOK */);
   }
 
   // Register for event notifications.
@@ -238,10 +311,9 @@ LRESULT LogListView::OnCreate(UINT msg,
                            LVS_EX_INFOTIP |
                            LVS_EX_DOUBLEBUFFER);
 
-  int num_rows = log_view_->GetNumRows();
-  SetItemCountEx(num_rows, 0);
+  SetWindow(GetTailWindowStart(log_view_->GetNumRows()));
   // We initially want to show the latest items
-  EnsureVisible(num_rows - 1, TRUE /* PartialOK */);
+  EnsureVisible(GetItemCount() - 1, TRUE /* PartialOK */);
 
   return ret;
 }
@@ -256,7 +328,7 @@ void LogListView::OnDestroy() {
 LRESULT LogListView::OnGetDispInfo(NMHDR* pnmh) {
   NMLVDISPINFO* info = reinterpret_cast<NMLVDISPINFO*>(pnmh);
   int col = info->item.iSubItem;
-  size_t row = info->item.iItem;
+  int64 row = GetRowForItem(info->item.iItem);
 
   if (col == COL_SEVERITY && info->item.mask & LVIF_IMAGE) {
     info->item.iImage =
@@ -281,12 +353,13 @@ LRESULT LogListView::OnGetDispInfo(NMHDR* pnmh) {
 LRESULT LogListView::OnItemChanged(NMHDR* pnmh) {
   NMLISTVIEW* info = reinterpret_cast<NMLISTVIEW*>(pnmh);
 
-  int row = info->iItem;
+  int item = info->iItem;
 
   if (stack_trace_view_ != NULL) {
     if (IsSelected(info->uNewState) && !IsSelected(info->uOldState)) {
       // Set the stack trace for a single row selection only.
-      if (row != kNoItem) {
+      if (item != kNoItem) {
+        int64 row = GetRowForItem(item);
         std::vector<void*> trace;
         log_view_->GetStackTrace(row, &trace);
 
@@ -311,16 +384,15 @@ LRESULT LogListView::OnItemChanged(NMHDR* pnmh) {
 
 LRESULT LogListView::OnGetInfoTip(NMHDR* pnmh) {
   NMLVGETINFOTIP* info_tip = reinterpret_cast<NMLVGETINFOTIP*>(pnmh);
-  size_t row = info_tip->iItem;
+  int64 row = GetRowForItem(info_tip->iItem);
+  base::Time time = log_view_->GetTime(row);
+  std::wstringstream text;
 
   if (process_info_service_ != NULL) {
     DWORD pid = log_view_->GetProcessId(row);
-    base::Time time = log_view_->GetTime(row);
 
     IProcessInfoService::ProcessInfo info = {};
     if (process_info_service_->GetProcessInfo(pid, time, &info)) {
-      std::wstringstream text;
-
       text << L"Process: " << info.command_line_ << std::endl;
       if (info.started_ != base::Time()) {
         text << L"Started: "
@@ -331,11 +403,32 @@ LRESULT LogListView::OnGetInfoTip(NMHDR* pnmh) {
             << base::TimeFormatShortDateAndTime(info.ended_) << std::endl
             << L"Exit code: " << info.exit_code_ << std::endl;
       }
+    }
+  }
 
-      wcscpy_s(info_tip->pszText, info_tip->cchTextMax, text.str().c_str());
+  if (thread_info_service_ != NULL) {
+    DWORD tid = log_view_->GetThreadId(row);
+
+    IThreadInfoService::ThreadInfo info = {};
+    if (thread_info_service_->GetThreadInfo(tid, time, &info)) {
+      text << L"Thread: " << tid;
+      if (!info.name_.empty())
+        text << L" (" << info.name_ << L")";
+      text << std::endl;
+      if (info.started_ != base::Time()) {
+        text << L"Thread started: "
+            << base::TimeFormatShortDateAndTime(info.started_) << std::endl;
+      }
+      if (info.ended_ != base::Time()) {
+        text << L"Thread ended: "
+            << base::TimeFormatShortDateAndTime(info.ended_) << std::endl;
+      }
     }
   }
 
+  if (!text.str().empty())
+    wcscpy_s(info_tip->pszText, info_tip->cchTextMax, text.str().c_str());
+
   return 0;
 }
 
@@ -468,6 +561,16 @@ void LogListView::OnContextMenu(CWindow wnd, CPoint point) {
                   ID_RESET_BASE_TIME,
                   L"&Reset Base Time");
 
+  if (!process_tree_callback_.is_null()) {
+    menu.AppendMenu(MF_SEPARATOR);
+    menu.AppendMenu(row == -1 ? MF_GRAYED : MF_ENABLED,
+                    ID_SHOW_PROCESS_TREE,
+                    L"Show Process &Tree");
+    menu.AppendMenu(MF_ENABLED,
+                    ID_SHOW_ALL_PROCESSES,
+                    L"Show &All Processes");
+  }
+
   // TODO(siggi): Implement popup menu items to include/exclude
   //      the clicked column by its value.
 #if 0
@@ -503,6 +606,117 @@ void LogListView::OnFind(UINT code, int id, CWindow window) {
   }
 }
 
+void LogListView::OnGoToTime(UINT code, int id, CWindow window) {
+  GoToTimeDialog dialog(go_to_time_params_);
+  if (dialog.DoModal(m_hWnd) != IDOK)
+    return;
+  go_to_time_params_ = dialog.params();
+
+  int64 num_rows = log_view_->GetNumRows();
+  if (num_rows == 0)
+    return;
+
+  // Times of day are on the day of the focused row.
+  int item = GetNextItem(kNoItem, LVIS_FOCUSED);
+  base::Time reference =
+      log_view_->GetTime(item == kNoItem ? 0 : GetRowForItem(item));
+
+  base::Time from;
+  base::Time to;
+  if (!formatter_.ParseTime(go_to_time_params_.from_, reference, &from) ||
+      (!go_to_time_params_.to_.empty() &&
+       !formatter_.ParseTime(go_to_time_params_.to_, reference, &to))) {
+    MessageBox(L"The specified time is not valid.");
+    return;
+  }
+
+  if (go_to_time_params_.set_base_time_) {
+    formatter_.set_base_time(from);
+    RedrawItems(0, GetItemCount());
+  }
+
+  // Past the last row, go to the last row.
+  int64 first = std::min(log_view_->FindFirstRowAtTime(from), num_rows - 1);
+  int64 end = first + 1;
+  if (!to.is_null())
+    end = std::max(end, log_view_->FindEndOfRowsBefore(to));
+
+  SelectRows(first, end);
+}
+
+void LogListView::SelectRows(int64 first, int64 end) {
+  // Clear the existing selection.
+  SetItemState(kNoItem, 0, LVIS_SELECTED | LVIS_FOCUSED);
+  ShowRow(first);
+
+  // Skip the stack traces of the rows we select on the way.
+  StackTraceListView* stack_trace_view = stack_trace_view_;
+  stack_trace_view_ = NULL;
+
+  int64 window_end = window_start_ + GetItemCount();
+  for (int64 row = first + 1; row < std::min(end, window_end); ++row) {
+    SetItemState(static_cast<int>(row - window_start_), LVIS_SELECTED,
+                 LVIS_SELECTED);
+  }
+
+  stack_trace_view_ = stack_trace_view;
+}
+
+void LogListView::ShowRow(int64 row) {
+  DCHECK_LE(0, row);
+  DCHECK_LT(row, log_view_->GetNumRows());
+
+  // Center the window on a row outside it.
+  if (row < window_start_ || row - window_start_ >= GetItemCount()) {
+    int64 window_start = std::min(row - kMaxItems / 2,
+                                  log_view_->GetNumRows() - kMaxItems);
+    SetWindow(std::max<int64>(0, window_start));
+  }
+
+  int item = static_cast<int>(row - window_start_);
+  SetItemState(item, LVIS_SELECTED | LVIS_FOCUSED,
+               LVIS_SELECTED | LVIS_FOCUSED);
+  EnsureVisible(item, FALSE);
+}
+
+void LogListView::SetWindow(int64 window_start) {
+  // The selection refers to items, which will show other rows.
+  if (window_start != window_start_)
+    SetItemState(kNoItem, 0, LVIS_SELECTED | LVIS_FOCUSED);
+  window_start_ = window_start;
+
+  int64 num_rows = log_view_ != NULL ? log_view_->GetNumRows() : 0;
+  int64 item_count = std::min(num_rows - window_start_, kMaxItems);
+  SetItemCountEx(static_cast<int>(std::max<int64>(0, item_count)),
+                 0);  // Invalidate the whole list.
+}
+
+LRESULT LogListView::OnColumnClick(NMHDR* pnmh) {
+  NMLISTVIEW* info = reinterpret_cast<NMLISTVIEW*>(pnmh);
+  if (info->iSubItem < 0 || info->iSubItem >= COL_MAX)
+    return 0;
+
+  if (!sort_callback_.is_null())
+    sort_callback_.Run(static_cast<LogViewFormatter::Column>(info->iSubItem));
+
+  return 0;
+}
+
+void LogListView::SetSortIndicator(LogViewFormatter::Column column,
+                                   bool ascending) {
+  CHeaderCtrl header(GetHeader());
+  int columns = header.GetItemCount();
+  for (int i = 0; i < columns; ++i) {
+    HDITEM item = {};
+    item.mask = HDI_FORMAT;
+    header.GetItem(i, &item);
+    item.fmt &= ~(HDF_SORTUP | HDF_SORTDOWN);
+    if (i == column)
+      item.fmt |= ascending ? HDF_SORTUP : HDF_SORTDOWN;
+    header.SetItem(i, &item);
+  }
+}
+
 void LogListView::OnFindNext(UINT code, int id, CWindow window) {
   if (!find_params_.expression_.empty())
     FindNext();
@@ -516,32 +730,33 @@ void LogListView::OnAutoSizeColumns(UINT code, int id, CWindow window) {
 }
 
 void LogListView::FindNext() {
-  pcrecpp::RE_Options options = PCRE_UTF8;
-  options.set_caseless(!find_params_.match_case_);
-  pcrecpp::RE expression(find_params_.expression_, options);
-
-  int start = GetNextItem(-1, LVIS_FOCUSED);
-  int num_rows = log_view_->GetNumRows();
+  int options = PCRE_UTF8;
+  if (!find_params_.match_case_)
+    options |= PCRE_CASELESS;
+  scoped_refptr<PatternMatcher> expression(
+      PatternMatcher::Get(find_params_.expression_, options));
+
+  int start_item = GetNextItem(-1, LVIS_FOCUSED);
+  int64 start = start_item == kNoItem ? -1 : GetRowForItem(start_item);
+  int64 num_rows = log_view_->GetNumRows();
   bool down = find_params_.direction_down_;
-  int i = down ? start + 1 : start - 1;
+  int64 i = down ? start + 1 : start - 1;
   if (i < 0)
     i = 0;  // in case start == -1.
 
   for (; down ? i < num_rows : i >= 0; down ? ++i : --i) {
     std::string message(log_view_->GetMessage(i));
-    if (expression.PartialMatch(message))
+    if (expression->PartialMatch(message))
       break;
   }
 
   if (i >= 0 && i < num_rows) {
     // Clear the existing selection.
-    if (start >= 0)
-      SetItemState(start, 0, LVIS_SELECTED | LVIS_FOCUSED);
+    if (start_item != kNoItem)
+      SetItemState(start_item, 0, LVIS_SELECTED | LVIS_FOCUSED);
 
     // Select and focus the new item.
-    SetItemState(i, LVIS_SELECTED | LVIS_FOCUSED,
-                 LVIS_SELECTED | LVIS_FOCUSED);
-    EnsureVisible(i, false);
+    ShowRow(i);
   } else {
     MessageBox(L"The specified text was not found.");
   }
@@ -549,14 +764,14 @@ void LogListView::FindNext() {
 
 void LogListView::OnSetBaseTime(UINT code, int id, CWindow window) {
   // Get the focused item.
-  int row = GetNextItem(-1, LVIS_FOCUSED);
-  if (row == -1) {
+  int item = GetNextItem(-1, LVIS_FOCUSED);
+  if (item == kNoItem) {
     NOTREACHED() << "No focused element";
     return;
   }
 
   // Get the corresponding time.
-  formatter_.set_base_time(log_view_->GetTime(row));
+  formatter_.set_base_time(log_view_->GetTime(GetRowForItem(item)));
 
   // Refresh the list.
   RedrawItems(0, GetItemCount());
@@ -569,25 +784,61 @@ void LogListView::OnResetBaseTime(UINT code, int id, CWindow window) {
   RedrawItems(0, GetItemCount());
 }
 
-void LogListView::LogViewNewItems() {
+void LogListView::OnShowProcessTree(UINT code, int id, CWindow window) {
+  // Get the focused item.
+  int item = GetNextItem(-1, LVIS_FOCUSED);
+  if (item == kNoItem) {
+    NOTREACHED() << "No focused element";
+    return;
+  }
+
+  int64 row = GetRowForItem(item);
+  process_tree_callback_.Run(log_view_->GetProcessId(row),
+                             log_view_->GetTime(row));
+}
+
+void LogListView::OnShowAllProcesses(UINT code, int id, CWindow window) {
+  process_tree_callback_.Run(0, base::Time());
+}
+
+void LogListView::LogViewNewItems(int64 first_row, int64 num_rows) {
   DCHECK_EQ(ui_loop_, base::MessageLoop::current());
 
   if (IsWindow()) {
     // Check if last item was previously visible...
+    int old_item_count = GetItemCount();
     BOOL is_last_item_visible = ListView_IsItemVisible(m_hWnd,
-                                                       GetItemCount() - 1);
-    int num_rows = log_view_->GetNumRows();
-    SetItemCountEx(num_rows, LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+                                                       old_item_count - 1);
+    int64 total_rows = first_row + num_rows;
+
+    // Move the window along to follow the latest items.
+    if (is_last_item_visible && total_rows - window_start_ > kMaxItems) {
+      SetWindow(GetTailWindowStart(total_rows));
+      EnsureVisible(GetItemCount() - 1, TRUE /* PartialOK */);
+      return;
+    }
+
+    int item_count = static_cast<int>(
+        std::min(total_rows - window_start_, kMaxItems));
+    SetItemCountEx(item_count, LVSICF_NOINVALIDATEALL | LVSICF_NOSCROLL);
+
+    // Redraw the rows that changed in place.
+    int64 first_item = std::max<int64>(0, first_row - window_start_);
+    if (first_item < old_item_count) {
+      RedrawItems(static_cast<int>(first_item),
+                  std::min(old_item_count, item_count) - 1);
+    }
 
     // We want to show the latest items if the
     // previously latest one was visible.
     if (is_last_item_visible)
-      EnsureVisible(num_rows - 1, TRUE /* PartialOK */);
+      EnsureVisible(item_count - 1, TRUE /* PartialOK */);
   }
 }
 
 void LogListView::LogViewCleared() {
   DCHECK_EQ(ui_loop_, base::MessageLoop::current());
+  window_start_ = 0;
   DeleteAllItems();
 }
 
@@ -600,6 +851,8 @@ void LogListView::UpdateCommandStatus(bool has_focus) {
   update_ui_->UIEnable(ID_EDIT_FIND, has_focus);
   update_ui_->UIEnable(ID_EDIT_FIND_NEXT, has_focus &&
                        !find_params_.expression_.empty());
+  update_ui_->UIEnable(ID_EDIT_GO_TO_TIME,
+                       has_focus && log_view_->GetNumRows() != 0);
   update_ui_->UIEnable(ID_EDIT_AUTOSIZE_COLUMNS,
-                       has_focus && log_view_->GetNumRows());
+                       has_focus && log_view_->GetNumRows() != 0);
 }
@@ -23,8 +23,10 @@
 #include <atlmisc.h>
 #include <string>
 #include <vector>
+#include "base/callback.h"
 #include "base/message_loop/message_loop.h"
 #include "sawbuck/viewer/find_dialog.h"
+#include "sawbuck/viewer/go_to_time_dialog.h"
 #include "sawbuck/viewer/list_view_base.h"
 #include "sawbuck/viewer/resource.h"
 
@@ -32,27 +34,53 @@
 class ILogViewEvents {
  public:
   // Called on the UI thread.
-  virtual void LogViewNewItems() = 0;
+  // Rows @p first_row through @p first_row + @p num_rows - 1 were appended,
+  // or changed in place, and the view now has @p first_row + @p num_rows
+  // rows. Rows only change in views that reorder them, e.g. sorted views.
+  // Appended rows are published in batches, at a bounded rate.
+  virtual void LogViewNewItems(int64 first_row, int64 num_rows) = 0;
   virtual void LogViewCleared() = 0;
 };
 
-// Provides a view on a log, the view may be filtered or sorted.
+// Provides a view on a log, the view may be filtered or sorted. Rows are
+// addressed with 64-bit ids, so that long captures don't overflow them.
 class ILogView {
  public:
   // Returns the number of rows in this view.
-  virtual int GetNumRows() = 0;
+  virtual int64 GetNumRows() = 0;
 
   // Clear all the items in this view.
   virtual void ClearAll() = 0;
 
-  virtual int GetSeverity(int row) = 0;
-  virtual DWORD GetProcessId(int row) = 0;
-  virtual DWORD GetThreadId(int row) = 0;
-  virtual base::Time GetTime(int row) = 0;
-  virtual std::string GetFileName(int row) = 0;
-  virtual int GetLine(int row) = 0;
-  virtual std::string GetMessage(int row) = 0;
-  virtual void GetStackTrace(int row, std::vector<void*>* trace) = 0;
+  virtual int GetSeverity(int64 row) = 0;
+  virtual DWORD GetProcessId(int64 row) = 0;
+  virtual DWORD GetThreadId(int64 row) = 0;
+  virtual base::Time GetTime(int64 row) = 0;
+  virtual std::string GetFileName(int64 row) = 0;
+  virtual int GetLine(int64 row) = 0;
+  virtual std::string GetMessage(int64 row) = 0;
+  virtual void GetStackTrace(int64 row, std::vector<void*>* trace) = 0;
+  // Returns the id of the row's site in the log site table.
+  virtual int GetSiteId(int64 row) = 0;
+  // Returns the id of the row's message template.
+  virtual int GetTemplateId(int64 row) = 0;
+  // Returns the text of the message template @p template_id.
+  virtual std::string GetTemplateText(int template_id) = 0;
+  // Returns the id of the image of the row's process, which may change
+  // from unknown to known as the process becomes known.
+  virtual int GetImageId(int64 row) = 0;
+  // Returns the name of the process image @p image_id.
+  virtual std::string GetImageName(int image_id) = 0;
+
+  // The rows of a log are only roughly in time order, so these find where
+  // the log reaches a time without relying on the order.
+  // Returns the first row logged at or after @p time, such that all the
+  // rows before it were logged before @p time, or GetNumRows() if there's
+  // no such row.
+  virtual int64 FindFirstRowAtTime(base::Time time) = 0;
+  // Returns one past the last row logged before @p time, such that all the
+  // rows from it on were logged at or after @p time.
+  virtual int64 FindEndOfRowsBefore(base::Time time) = 0;
 
   // Register for change notifications. Notifications will be issued
   // on the thread where the registration was made.
@@ -71,6 +99,7 @@ class LogViewFormatter {
     FILE,
     LINE,
     MESSAGE,
+    PROCESS_IMAGE,
 
     // Must be last.
     NUM_COLUMNS
@@ -78,11 +107,22 @@ class LogViewFormatter {
 
   LogViewFormatter();
 
+  // Returns the name of the trace level @p severity.
+  static const char* GetSeverityText(int severity);
+
   bool FormatColumn(ILogView* log_view,
-                    int row,
+                    int64 row,
                     Column col,
                     std::string* str);
 
+  // Parses @p str as a time shown in the time column, which is relative to
+  // the base time if there's one, and otherwise a time of day on the day of
+  // @p reference.
+  // @returns true iff @p str is such a time.
+  bool ParseTime(const std::string& str,
+                 base::Time reference,
+                 base::Time* time) const;
+
   base::Time base_time() const { return base_time_; }
   void set_base_time(base::Time base_time) { base_time_ = base_time; }
 
@@ -94,6 +134,7 @@ class LogViewFormatter {
 // Forward decls.
 class StackTraceListView;
 class IProcessInfoService;
+class IThreadInfoService;
 namespace WTL {
 class CUpdateUIBase;
 };
@@ -123,11 +164,15 @@ class LogListView
     COMMAND_ID_HANDLER_EX(ID_EDIT_SELECT_ALL, OnSelectAll)
     COMMAND_ID_HANDLER_EX(ID_EDIT_FIND, OnFind)
     COMMAND_ID_HANDLER_EX(ID_EDIT_FIND_NEXT, OnFindNext)
+    COMMAND_ID_HANDLER_EX(ID_EDIT_GO_TO_TIME, OnGoToTime)
     COMMAND_ID_HANDLER_EX(ID_SET_TIME_ZERO, OnSetBaseTime)
     COMMAND_ID_HANDLER_EX(ID_RESET_BASE_TIME, OnResetBaseTime)
+    COMMAND_ID_HANDLER_EX(ID_SHOW_PROCESS_TREE, OnShowProcessTree)
+    COMMAND_ID_HANDLER_EX(ID_SHOW_ALL_PROCESSES, OnShowAllProcesses)
     REFLECTED_NOTIFY_CODE_HANDLER_EX(LVN_GETDISPINFO, OnGetDispInfo)
     REFLECTED_NOTIFY_CODE_HANDLER_EX(LVN_ITEMCHANGED, OnItemChanged)
     REFLECTED_NOTIFY_CODE_HANDLER_EX(LVN_GETINFOTIP, OnGetInfoTip)
+    REFLECTED_NOTIFY_CODE_HANDLER_EX(LVN_COLUMNCLICK, OnColumnClick)
     DEFAULT_REFLECTION_HANDLER()
   END_MSG_MAP()
 
@@ -139,10 +184,35 @@ class LogListView
   void set_process_info_service(IProcessInfoService* process_info_service) {
     process_info_service_ = process_info_service;
   }
+  void set_thread_info_service(IThreadInfoService* thread_info_service) {
+    thread_info_service_ = thread_info_service;
+  }
+
+  // Invoked with the column the user clicked to sort on.
+  typedef base::Callback<void(LogViewFormatter::Column)> SortCallback;
+  void set_sort_callback(const SortCallback& sort_callback) {
+    sort_callback_ = sort_callback;
+  }
+
+  // Invoked with the process and time of a row to show the rows of the
+  // process tree of, or with a null time to show the rows of all processes.
+  typedef base::Callback<void(DWORD, base::Time)> ProcessTreeCallback;
+  void set_process_tree_callback(
+      const ProcessTreeCallback& process_tree_callback) {
+    process_tree_callback_ = process_tree_callback;
+  }
 
   void SetLogView(ILogView* log_view);
 
-  virtual void LogViewNewItems();
+  // Selects, focuses and shows @p row of the log view, moving the window
+  // of rows we show if need be.
+  void ShowRow(int64 row);
+
+  // Shows the sort order on the header of @p column, or on no header if
+  // @p column is LogViewFormatter::NUM_COLUMNS.
+  void SetSortIndicator(LogViewFormatter::Column column, bool ascending);
+
+  virtual void LogViewNewItems(int64 first_row, int64 num_rows);
   virtual void LogViewCleared();
 
   // Our column definitions and config data to satisfy our contract
@@ -163,6 +233,7 @@ class LogListView
     COL_FILE = LogViewFormatter::FILE,
     COL_LINE = LogViewFormatter::LINE,
     COL_MESSAGE = LogViewFormatter::MESSAGE,
+    COL_IMAGE = LogViewFormatter::PROCESS_IMAGE,
 
     // Must be last.
     COL_MAX,
@@ -174,6 +245,7 @@ class LogListView
   LRESULT OnGetDispInfo(LPNMHDR notification);
   LRESULT OnItemChanged(LPNMHDR notification);
   LRESULT OnGetInfoTip(LPNMHDR notification);
+  LRESULT OnColumnClick(LPNMHDR notification);
 
   void OnCopyCommand(UINT code, int id, CWindow window);
   virtual void OnClearAll(UINT code, int id, CWindow window);
@@ -183,17 +255,31 @@ class LogListView
   void OnContextMenu(CWindow wnd, CPoint point);
   void OnFind(UINT code, int id, CWindow window);
   void OnFindNext(UINT code, int id, CWindow window);
+  void OnGoToTime(UINT code, int id, CWindow window);
   void OnAutoSizeColumns(UINT code, int id, CWindow window);
 
   // Context menu command handlers.
   void OnSetBaseTime(UINT code, int id, CWindow window);
   void OnResetBaseTime(UINT code, int id, CWindow window);
+  void OnShowProcessTree(UINT code, int id, CWindow window);
+  void OnShowAllProcesses(UINT code, int id, CWindow window);
 
   // Updates the UI status for commands we support, disables
   // all our commands unless we have focus.
   // @param has_focus true iff this window has the focus.
   void UpdateCommandStatus(bool has_focus);
 
+  // @returns the row of the log view shown as @p item.
+  int64 GetRowForItem(int item) const { return window_start_ + item; }
+
+  // Shows the rows of the log view from @p window_start on, as many as
+  // the list control can hold, and redraws all items.
+  void SetWindow(int64 window_start);
+
+  // Selects the rows from @p first up to @p end, as far as they're in our
+  // window, and focuses and shows @p first.
+  void SelectRows(int64 first, int64 end);
+
   // Finds the next item matching with the current find parameters.
   // See |find_params_|.
   void FindNext();
@@ -209,9 +295,17 @@ class LogListView
   // Our process info service, if any.
   IProcessInfoService* process_info_service_;
 
+  // Our thread info service, if any.
+  IThreadInfoService* thread_info_service_;
+
   ILogView* log_view_;
   int event_cookie_;
 
+  // The list control addresses items with ints, and slows to a crawl well
+  // before it runs out of them, so we show a window of the log view's rows
+  // from this row on.
+  int64 window_start_;
+
   // Image indexes for severity, stored by severity value.
   std::vector<int> image_indexes_;
   int GetImageIndexForSeverity(int severity);
@@ -219,12 +313,21 @@ class LogListView
   // Used to update our command state.
   CUpdateUIBase* update_ui_;
 
+  // Invoked when the user clicks a column header.
+  SortCallback sort_callback_;
+
+  // Invoked when the user picks the processes to show.
+  ProcessTreeCallback process_tree_callback_;
+
   // Temporary storage for strings returned from OnGetDispInfo.
   std::wstring item_text_;
 
   // The last piece of text we searched for.
   FindParameters find_params_;
 
+  // The last times we went to.
+  GoToTimeParameters go_to_time_params_;
+
   // Asserting on correct threading.
   base::MessageLoop* ui_loop_;
 
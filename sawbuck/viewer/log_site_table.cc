@@ -0,0 +1,131 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log site table implementation.
+#include "sawbuck/viewer/log_site_table.h"
+
+#include "base/logging.h"
+
+LogSiteTable::Site::Site() : line(0), severity(0), count(0), muted(false) {
+}
+
+double LogSiteTable::Site::MessagesPerSecond() const {
+  double seconds = (last_time - first_time).InSecondsF();
+  if (seconds < 1.0)
+    seconds = 1.0;
+
+  return count / seconds;
+}
+
+bool LogSiteTable::Key::operator < (const Key& other) const {
+  if (line != other.line)
+    return line < other.line;
+  if (severity != other.severity)
+    return severity < other.severity;
+
+  return file < other.file;
+}
+
+LogSiteTable::LogSiteTable() {
+}
+
+LogSiteTable::~LogSiteTable() {
+}
+
+int LogSiteTable::AddMessage(const base::StringPiece& file,
+                             int line,
+                             int severity,
+                             const base::Time& time) {
+  Key key;
+  key.file = file;
+  key.line = line;
+  key.severity = severity;
+
+  base::AutoLock lock(lock_);
+  int site_id = 0;
+  SiteMap::iterator it(site_map_.find(key));
+  if (it != site_map_.end()) {
+    site_id = it->second;
+  } else {
+    site_id = sites_.size();
+    sites_.push_back(Site());
+
+    Site& site = sites_.back();
+    file.CopyToString(&site.file);
+    site.line = line;
+    site.severity = severity;
+
+    // Key the site on its own copy of the file name.
+    key.file = site.file;
+    site_map_.insert(std::make_pair(key, site_id));
+  }
+
+  Site& site = sites_[site_id];
+  if (site.count++ == 0 || time < site.first_time)
+    site.first_time = time;
+  if (time > site.last_time)
+    site.last_time = time;
+
+  return site_id;
+}
+
+bool LogSiteTable::GetSite(int site_id, Site* site) const {
+  DCHECK(site != NULL);
+
+  base::AutoLock lock(lock_);
+  if (site_id < 0 || static_cast<size_t>(site_id) >= sites_.size())
+    return false;
+
+  *site = sites_[site_id];
+  return true;
+}
+
+void LogSiteTable::GetSites(std::vector<Site>* sites) const {
+  DCHECK(sites != NULL);
+
+  base::AutoLock lock(lock_);
+  sites->assign(sites_.begin(), sites_.end());
+}
+
+void LogSiteTable::SetMuted(int site_id, bool muted) {
+  base::AutoLock lock(lock_);
+  DCHECK_LE(0, site_id);
+  DCHECK_GT(sites_.size(), static_cast<size_t>(site_id));
+
+  sites_[site_id].muted = muted;
+}
+
+void LogSiteTable::GetMutedSites(SiteSet* muted) const {
+  DCHECK(muted != NULL);
+
+  base::AutoLock lock(lock_);
+  muted->resize(sites_.size());
+  for (size_t i = 0; i < sites_.size(); ++i)
+    (*muted)[i] = sites_[i].muted;
+}
+
+size_t LogSiteTable::GetNumSites() const {
+  base::AutoLock lock(lock_);
+  return sites_.size();
+}
+
+void LogSiteTable::ResetCounts() {
+  base::AutoLock lock(lock_);
+  for (size_t i = 0; i < sites_.size(); ++i) {
+    Site& site = sites_[i];
+    site.count = 0;
+    site.first_time = base::Time();
+    site.last_time = base::Time();
+  }
+}
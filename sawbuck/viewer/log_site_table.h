@@ -0,0 +1,111 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log site table declaration.
+#ifndef SAWBUCK_VIEWER_LOG_SITE_TABLE_H_
+#define SAWBUCK_VIEWER_LOG_SITE_TABLE_H_
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+
+// Log messages come from a bounded set of sites, each a file/line logging
+// at a given severity. The site table assigns each site a small, dense id
+// as messages are ingested, and keeps live counts for it. This allows the
+// log store to keep a site id per row, and filters on sites to be a lookup
+// in a bit set rather than string matching on every row.
+// The table is safe to use from multiple threads.
+class LogSiteTable {
+ public:
+  // A set of sites, indexed by site id.
+  typedef std::vector<bool> SiteSet;
+
+  struct Site {
+    Site();
+
+    std::string file;
+    int line;
+    int severity;
+
+    // The number of messages logged at the site, and when.
+    size_t count;
+    base::Time first_time;
+    base::Time last_time;
+
+    // True iff the site is muted.
+    bool muted;
+
+    // @returns the average number of messages logged per second, over no
+    //     less than a second.
+    double MessagesPerSecond() const;
+  };
+
+  LogSiteTable();
+  ~LogSiteTable();
+
+  // Counts a message logged at @p time from the site of @p file, @p line
+  // and @p severity, adding the site if it's new.
+  // @returns the id of the site.
+  int AddMessage(const base::StringPiece& file,
+                 int line,
+                 int severity,
+                 const base::Time& time);
+
+  // Retrieves the site @p site_id.
+  // @returns false if there is no such site.
+  bool GetSite(int site_id, Site* site) const;
+
+  // Retrieves all sites, indexed by site id.
+  void GetSites(std::vector<Site>* sites) const;
+
+  // Mutes or unmutes the site @p site_id.
+  void SetMuted(int site_id, bool muted);
+
+  // Retrieves the set of muted sites.
+  void GetMutedSites(SiteSet* muted) const;
+
+  // @returns the number of sites.
+  size_t GetNumSites() const;
+
+  // Zeroes the counts of all sites. The sites keep their ids and mutes.
+  void ResetCounts();
+
+ private:
+  // Looks up a site. The file refers to the site's own copy, or to the
+  // caller's string for lookups.
+  struct Key {
+    base::StringPiece file;
+    int line;
+    int severity;
+
+    bool operator < (const Key& other) const;
+  };
+  typedef std::map<Key, int> SiteMap;
+
+  mutable base::Lock lock_;
+
+  // The sites, indexed by id. A deque so that the keys of site_map_ can
+  // refer to the file names of the sites.
+  std::deque<Site> sites_;  // Under lock_.
+  SiteMap site_map_;  // Under lock_.
+
+  DISALLOW_COPY_AND_ASSIGN(LogSiteTable);
+};
+
+#endif  // SAWBUCK_VIEWER_LOG_SITE_TABLE_H_
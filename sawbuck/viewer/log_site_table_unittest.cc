@@ -0,0 +1,131 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Log site table unittests.
+#include "sawbuck/viewer/log_site_table.h"
+
+#include <string>
+#include "gtest/gtest.h"
+
+namespace {
+
+const base::Time kStartTime = base::Time::FromDoubleT(1000.0);
+
+TEST(LogSiteTableTest, AddMessage) {
+  LogSiteTable table;
+  EXPECT_EQ(0U, table.GetNumSites());
+
+  std::string file("foo.cc");
+  int foo_id = table.AddMessage(file, 10, 1, kStartTime);
+  int bar_id = table.AddMessage("bar.cc", 10, 1, kStartTime);
+  EXPECT_NE(foo_id, bar_id);
+
+  // The same file/line at another severity is another site.
+  int foo_error_id = table.AddMessage("foo.cc", 10, 2, kStartTime);
+  EXPECT_NE(foo_id, foo_error_id);
+  EXPECT_NE(bar_id, foo_error_id);
+
+  // The table keeps its own copy of the file name.
+  file[0] = 'g';
+  EXPECT_EQ(foo_id, table.AddMessage("foo.cc", 10, 1,
+      kStartTime + base::TimeDelta::FromSeconds(4)));
+  EXPECT_EQ(3U, table.GetNumSites());
+
+  LogSiteTable::Site site;
+  ASSERT_TRUE(table.GetSite(foo_id, &site));
+  EXPECT_EQ("foo.cc", site.file);
+  EXPECT_EQ(10, site.line);
+  EXPECT_EQ(1, site.severity);
+  EXPECT_EQ(2U, site.count);
+  EXPECT_EQ(kStartTime, site.first_time);
+  EXPECT_EQ(kStartTime + base::TimeDelta::FromSeconds(4), site.last_time);
+  EXPECT_DOUBLE_EQ(0.5, site.MessagesPerSecond());
+
+  // A single message counts over a second.
+  ASSERT_TRUE(table.GetSite(bar_id, &site));
+  EXPECT_EQ(1U, site.count);
+  EXPECT_DOUBLE_EQ(1.0, site.MessagesPerSecond());
+
+  EXPECT_FALSE(table.GetSite(-1, &site));
+  EXPECT_FALSE(table.GetSite(3, &site));
+}
+
+TEST(LogSiteTableTest, GetSites) {
+  LogSiteTable table;
+  int foo_id = table.AddMessage("foo.cc", 10, 1, kStartTime);
+  int bar_id = table.AddMessage("bar.cc", 20, 1, kStartTime);
+  table.AddMessage("bar.cc", 20, 1, kStartTime);
+
+  std::vector<LogSiteTable::Site> sites;
+  table.GetSites(&sites);
+  ASSERT_EQ(2U, sites.size());
+  EXPECT_EQ("foo.cc", sites[foo_id].file);
+  EXPECT_EQ(1U, sites[foo_id].count);
+  EXPECT_EQ("bar.cc", sites[bar_id].file);
+  EXPECT_EQ(2U, sites[bar_id].count);
+}
+
+TEST(LogSiteTableTest, Mute) {
+  LogSiteTable table;
+  int foo_id = table.AddMessage("foo.cc", 10, 1, kStartTime);
+  int bar_id = table.AddMessage("bar.cc", 20, 1, kStartTime);
+
+  LogSiteTable::SiteSet muted;
+  table.GetMutedSites(&muted);
+  ASSERT_EQ(2U, muted.size());
+  EXPECT_FALSE(muted[foo_id]);
+  EXPECT_FALSE(muted[bar_id]);
+
+  table.SetMuted(bar_id, true);
+  table.GetMutedSites(&muted);
+  EXPECT_FALSE(muted[foo_id]);
+  EXPECT_TRUE(muted[bar_id]);
+
+  // Muted sites are still counted.
+  EXPECT_EQ(bar_id, table.AddMessage("bar.cc", 20, 1, kStartTime));
+  LogSiteTable::Site site;
+  ASSERT_TRUE(table.GetSite(bar_id, &site));
+  EXPECT_TRUE(site.muted);
+  EXPECT_EQ(2U, site.count);
+
+  table.SetMuted(bar_id, false);
+  table.GetMutedSites(&muted);
+  EXPECT_FALSE(muted[bar_id]);
+}
+
+TEST(LogSiteTableTest, ResetCounts) {
+  LogSiteTable table;
+  int foo_id = table.AddMessage("foo.cc", 10, 1, kStartTime);
+  int bar_id = table.AddMessage("bar.cc", 20, 1, kStartTime);
+  table.SetMuted(bar_id, true);
+
+  table.ResetCounts();
+  EXPECT_EQ(2U, table.GetNumSites());
+
+  LogSiteTable::Site site;
+  ASSERT_TRUE(table.GetSite(foo_id, &site));
+  EXPECT_EQ(0U, site.count);
+  EXPECT_TRUE(site.first_time.is_null());
+
+  // The sites keep their ids and mutes.
+  base::Time later = kStartTime + base::TimeDelta::FromSeconds(10);
+  EXPECT_EQ(bar_id, table.AddMessage("bar.cc", 20, 1, later));
+  ASSERT_TRUE(table.GetSite(bar_id, &site));
+  EXPECT_TRUE(site.muted);
+  EXPECT_EQ(1U, site.count);
+  EXPECT_EQ(later, site.first_time);
+  EXPECT_EQ(later, site.last_time);
+}
+
+}  // namespace
@@ -17,6 +17,8 @@
 
 #include <atlbase.h>
 #include <atlframe.h>
+#include <algorithm>
+#include "base/bind.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "pcrecpp.h"  // NOLINT
@@ -24,21 +26,69 @@
 #include "sawbuck/viewer/filter_dialog.h"
 #include "sawbuck/viewer/const_config.h"
 #include "sawbuck/viewer/preferences.h"
+#include "sawbuck/viewer/query_dialog.h"
+#include "sawbuck/viewer/sorted_log_view.h"
+
+namespace {
+
+// The width of the timeline, in pixels.
+const int kTimelineWidth = 80;
+
+// The query the query dialog starts with.
+const char kDefaultQuery[] =
+    "SELECT file, line, COUNT(*) WHERE severity >= WARNING "
+    "GROUP BY file, line ORDER BY 3 DESC LIMIT 20";
+
+}  // namespace
+
+LRESULT PaneSplitter::OnCommand(UINT msg,
+                                WPARAM wparam,
+                                LPARAM lparam,
+                                BOOL& handled) {
+  int pane = GetActivePane();
+  if (pane == SPLIT_PANE_NONE)
+    pane = GetDefaultActivePane();
+
+  HWND window = GetSplitterPane(pane);
+  return ::SendMessage(window, msg, wparam, lparam);
+}
 
 LogViewer::LogViewer(CUpdateUIBase* update_ui)
     : log_list_view_(update_ui),
       stack_trace_list_view_(update_ui),
+      sort_column_(LogViewFormatter::NUM_COLUMNS),
+      sort_ascending_(true),
       log_view_(NULL),
+      site_table_(NULL),
+      process_info_service_(NULL),
+      query_text_(kDefaultQuery),
       update_ui_(update_ui) {
+  statistics_list_view_.set_mute_callback(
+      base::Bind(&LogViewer::OnMuteSites, base::Unretained(this)));
+  log_list_view_.set_sort_callback(
+      base::Bind(&LogViewer::OnSortColumn, base::Unretained(this)));
+  timeline_view_.set_time_callback(
+      base::Bind(&LogViewer::OnTimelineClicked, base::Unretained(this)));
+  log_list_view_.set_process_tree_callback(
+      base::Bind(&LogViewer::OnShowProcessTree, base::Unretained(this)));
 }
 
 LogViewer::~LogViewer() {
+  if (process_tree_.get() != NULL)
+    process_info_service_->RemoveObserver(process_tree_.get());
 }
 
 void LogViewer::SetLogView(ILogView* log_view) {
   DCHECK(log_view_ == NULL);
   log_view_ = log_view;
   log_list_view_.SetLogView(log_view);
+  statistics_list_view_.SetLogView(log_view);
+  timeline_view_.SetLogView(log_view);
+}
+
+void LogViewer::SetLogSiteTable(LogSiteTable* site_table) {
+  site_table_ = site_table;
+  statistics_list_view_.SetLogSiteTable(site_table);
 }
 
 int LogViewer::OnCreate(LPCREATESTRUCT create_struct) {
@@ -50,20 +100,43 @@ int LogViewer::OnCreate(LPCREATESTRUCT create_struct) {
                   reinterpret_cast<LPARAM>(create_struct),
                   bHandled);
 
-  // Create the log list view.
-  log_list_view_.Create(m_hWnd);
+  // Create the log list view, with the timeline to its right.
+  log_splitter_.Create(m_hWnd, rcDefault, NULL,
+                       WS_CHILD | WS_VISIBLE | WS_CLIPCHILDREN |
+                       WS_CLIPSIBLINGS);
+  log_list_view_.Create(log_splitter_.m_hWnd);
+  timeline_view_.Create(log_splitter_.m_hWnd);
+  log_splitter_.SetDefaultActivePane(SPLIT_PANE_LEFT);
+  log_splitter_.SetSplitterPanes(log_list_view_.m_hWnd,
+                                 timeline_view_.m_hWnd);
+  log_splitter_.SetSplitterExtendedStyle(SPLIT_RIGHTALIGNED);
+
+  // Lay out the timeline as a narrow strip, which it then stays as the
+  // splitter is resized.
+  CRect rect(0, 0, kTimelineWidth * 10, kTimelineWidth);
+  log_splitter_.SetSplitterRect(&rect, false);
+  log_splitter_.SetSplitterPos(rect.Width() - kTimelineWidth, false);
 
-  // Create the stack trace list view.
-  stack_trace_list_view_.Create(m_hWnd);
+  // Create the stack trace and statistics list views side by side.
+  details_splitter_.Create(m_hWnd, rcDefault, NULL,
+                           WS_CHILD | WS_VISIBLE | WS_CLIPCHILDREN |
+                           WS_CLIPSIBLINGS);
+  stack_trace_list_view_.Create(details_splitter_.m_hWnd);
+  statistics_list_view_.Create(details_splitter_.m_hWnd);
+  details_splitter_.SetDefaultActivePane(SPLIT_PANE_LEFT);
+  details_splitter_.SetSplitterPanes(stack_trace_list_view_.m_hWnd,
+                                     statistics_list_view_.m_hWnd);
+  details_splitter_.SetSplitterExtendedStyle(SPLIT_LEFTALIGNED);
 
   log_list_view_.set_stack_trace_view(&stack_trace_list_view_);
 
   SetDefaultActivePane(SPLIT_PANE_TOP);
-  SetSplitterPanes(log_list_view_.m_hWnd, stack_trace_list_view_.m_hWnd);
+  SetSplitterPanes(log_splitter_.m_hWnd, details_splitter_.m_hWnd);
   SetSplitterExtendedStyle(SPLIT_BOTTOMALIGNED);
 
-  // This is enabled so long as we live.
+  // These are enabled so long as we live.
   update_ui_->UIEnable(ID_LOG_FILTER, true);
+  update_ui_->UIEnable(ID_LOG_QUERY, true);
 
   // Read in any previously set filters.
   std::string filter_string;
@@ -71,12 +144,8 @@ int LogViewer::OnCreate(LPCREATESTRUCT create_struct) {
   prefs.ReadStringValue(config::kFilterValues, &filter_string, "");
   if (!filter_string.empty()) {
     std::vector<Filter> filters(Filter::DeserializeFilters(filter_string));
-    if (!filters.empty()) {
-      scoped_ptr<FilteredLogView> new_view(new FilteredLogView(log_view_,
-                                                               filters));
-      log_list_view_.SetLogView(new_view.get());
-      filtered_log_view_.reset(new_view.release());
-    }
+    if (!filters.empty())
+      SetFilteredLogView(CreateFilteredLogView(filters));
   }
 
   SetMsgHandled(FALSE);
@@ -93,6 +162,12 @@ LRESULT LogViewer::OnCommand(UINT msg,
 
 void LogViewer::OnLogFilter(UINT code, int id, CWindow window) {
   FilterDialog dialog;
+  if (filtered_log_view_.get() != NULL) {
+    std::vector<Filter> filters;
+    std::vector<FilterStats> stats;
+    filtered_log_view_->GetFilterStats(&filters, &stats);
+    dialog.set_filter_stats(filters, stats);
+  }
 
   if (dialog.DoModal(m_hWnd) == IDOK) {
     std::vector<Filter> filters = dialog.get_filters();
@@ -102,13 +177,21 @@ void LogViewer::OnLogFilter(UINT code, int id, CWindow window) {
 
     // TODO(robertshield): If dialog.get_filters() is empty, we should set it
     // back to the non filtered log view.
-    scoped_ptr<FilteredLogView> new_view(new FilteredLogView(log_view_,
-                                                             filters));
-    log_list_view_.SetLogView(new_view.get());
-    filtered_log_view_.reset(new_view.release());
+    SetFilteredLogView(CreateFilteredLogView(filters));
   }
 }
 
+void LogViewer::OnLogQuery(UINT code, int id, CWindow window) {
+  // Query the rows as filtered, in their original order.
+  ILogView* view = log_view_;
+  if (filtered_log_view_.get() != NULL)
+    view = filtered_log_view_.get();
+
+  QueryDialog dialog(view, task_runner_.get(), query_text_);
+  dialog.DoModal(m_hWnd);
+  query_text_ = dialog.text();
+}
+
 void LogViewer::OnIncludeColumn(UINT code, int id, CWindow window) {
   // TODO(siggi): write me.
 }
@@ -116,3 +199,122 @@ void LogViewer::OnIncludeColumn(UINT code, int id, CWindow window) {
 void LogViewer::OnExcludeColumn(UINT code, int id, CWindow window) {
   // TODO(siggi): write me.
 }
+
+void LogViewer::OnMuteSites() {
+  // Muting sites needs a filtered view, filters or no.
+  if (filtered_log_view_.get() == NULL) {
+    SetFilteredLogView(CreateFilteredLogView(std::vector<Filter>()));
+    return;
+  }
+
+  ApplyMutedSites(filtered_log_view_.get());
+}
+
+void LogViewer::OnShowProcessTree(DWORD process_id, base::Time time) {
+  if (process_info_service_ == NULL)
+    return;
+
+  if (process_tree_.get() != NULL)
+    process_info_service_->RemoveObserver(process_tree_.get());
+  process_tree_ = NULL;
+
+  // The service tells the tree of the processes it knows, parents first,
+  // which settles their membership up front.
+  if (!time.is_null()) {
+    process_tree_ = new ProcessTree(process_id, time);
+    process_info_service_->AddObserver(process_tree_.get());
+  }
+
+  // Showing a process tree needs a filtered view, filters or no.
+  if (filtered_log_view_.get() == NULL) {
+    SetFilteredLogView(CreateFilteredLogView(std::vector<Filter>()));
+    return;
+  }
+
+  filtered_log_view_->SetProcessTree(process_tree_.get());
+}
+
+void LogViewer::OnSortColumn(LogViewFormatter::Column column) {
+  if (column != sort_column_) {
+    sort_column_ = column;
+    sort_ascending_ = true;
+  } else if (sort_ascending_) {
+    sort_ascending_ = false;
+  } else {
+    sort_column_ = LogViewFormatter::NUM_COLUMNS;
+  }
+
+  UpdateSortedLogView();
+}
+
+void LogViewer::OnTimelineClicked(base::Time time) {
+  // The sorted views don't keep the rows in time order.
+  if (sort_column_ != LogViewFormatter::NUM_COLUMNS) {
+    sort_column_ = LogViewFormatter::NUM_COLUMNS;
+    UpdateSortedLogView();
+  }
+
+  ILogView* view = log_view_;
+  if (filtered_log_view_.get() != NULL)
+    view = filtered_log_view_.get();
+
+  int64 num_rows = view->GetNumRows();
+  if (num_rows == 0)
+    return;
+
+  log_list_view_.ShowRow(std::min(view->FindFirstRowAtTime(time),
+                                  num_rows - 1));
+}
+
+void LogViewer::SetFilteredLogView(FilteredLogView* view) {
+  // The old view goes once the views stacked on it are gone.
+  scoped_ptr<FilteredLogView> old_view(filtered_log_view_.release());
+  filtered_log_view_.reset(view);
+
+  if (view != NULL)
+    timeline_view_.SetLogView(view);
+  else
+    timeline_view_.SetLogView(log_view_);
+
+  UpdateSortedLogView();
+}
+
+void LogViewer::UpdateSortedLogView() {
+  // The old view goes once the list view is done with it.
+  scoped_ptr<SortedLogView> old_view(sorted_log_view_.release());
+
+  ILogView* view = log_view_;
+  if (filtered_log_view_.get() != NULL)
+    view = filtered_log_view_.get();
+
+  if (sort_column_ != LogViewFormatter::NUM_COLUMNS) {
+    sorted_log_view_.reset(new SortedLogView(view, sort_column_,
+                                             sort_ascending_,
+                                             task_runner_.get()));
+    view = sorted_log_view_.get();
+  }
+
+  log_list_view_.SetLogView(view);
+  log_list_view_.SetSortIndicator(sort_column_, sort_ascending_);
+}
+
+FilteredLogView* LogViewer::CreateFilteredLogView(
+    const std::vector<Filter>& filters) {
+  FilteredLogView* view = new FilteredLogView(log_view_, filters);
+  if (task_runner_.get() != NULL)
+    view->set_filter_runner(task_runner_.get());
+  ApplyMutedSites(view);
+  view->SetProcessTree(process_tree_.get());
+
+  return view;
+}
+
+void LogViewer::ApplyMutedSites(FilteredLogView* view) {
+  DCHECK(view != NULL);
+  if (site_table_ == NULL)
+    return;
+
+  LogSiteTable::SiteSet muted_sites;
+  site_table_->GetMutedSites(&muted_sites);
+  view->SetMutedSites(muted_sites);
+}
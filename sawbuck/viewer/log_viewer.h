@@ -22,17 +22,42 @@
 #include <atlctrls.h>
 #include <atlsplit.h>
 #include <atlmisc.h>
+#include <string>
+#include <vector>
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/task_runner.h"
+#include "sawbuck/viewer/filter.h"
 #include "sawbuck/viewer/log_list_view.h"
+#include "sawbuck/viewer/process_tree.h"
 #include "sawbuck/viewer/resource.h"
 #include "sawbuck/viewer/stack_trace_list_view.h"
+#include "sawbuck/viewer/statistics_list_view.h"
+#include "sawbuck/viewer/timeline_view.h"
 
 // Forward decl.
 namespace WTL {
 class CUpdateUIBase;
 };
 class FilteredLogView;
-class IProcessInfoService;
+class SortedLogView;
+class IThreadInfoService;
+
+// Hosts two panes of the log viewer side by side, reflecting their
+// notifications back to them, and forwarding commands to the active pane.
+class PaneSplitter : public CSplitterWindowImpl<PaneSplitter, true> {
+ public:
+  typedef CSplitterWindowImpl<PaneSplitter, true> Super;
+
+  BEGIN_MSG_MAP_EX(PaneSplitter)
+    REFLECT_NOTIFICATIONS()
+    MESSAGE_HANDLER(WM_COMMAND, OnCommand)
+    CHAIN_MSG_MAP(Super)
+  END_MSG_MAP()
+
+ private:
+  LRESULT OnCommand(UINT msg, WPARAM wparam, LPARAM lparam, BOOL& handled);
+};
 
 // The log viewer window plays host to a listview, taking care of handling
 // its notification requests etc.
@@ -45,6 +70,7 @@ class LogViewer : public CSplitterWindowImpl<LogViewer, false> {
     MSG_WM_CREATE(OnCreate)
     REFLECT_NOTIFICATIONS()
     COMMAND_ID_HANDLER_EX(ID_LOG_FILTER, OnLogFilter)
+    COMMAND_ID_HANDLER_EX(ID_LOG_QUERY, OnLogQuery)
     COMMAND_ID_HANDLER_EX(ID_INCLUDE_COLUMN, OnIncludeColumn)
     COMMAND_ID_HANDLER_EX(ID_EXCLUDE_COLUMN, OnExcludeColumn)
     MESSAGE_HANDLER(WM_COMMAND, OnCommand)
@@ -60,32 +86,114 @@ class LogViewer : public CSplitterWindowImpl<LogViewer, false> {
   void SetSymbolLookupService(ISymbolLookupService* symbol_lookup_service) {
     stack_trace_list_view_.SetSymbolLookupService(symbol_lookup_service);
   }
-  void SetProcessInfoService(IProcessInfoService* process_info_service) {
+  void SetProcessInfoService(ProcessInfoService* process_info_service) {
+    process_info_service_ = process_info_service;
     log_list_view_.set_process_info_service(process_info_service);
   }
+  void SetThreadInfoService(IThreadInfoService* thread_info_service) {
+    log_list_view_.set_thread_info_service(thread_info_service);
+  }
+  void SetLogSiteTable(LogSiteTable* site_table);
+
+  // Filtered and sorted views and the timeline do their work on
+  // @p task_runner. The log view must be safe to call from the runner's
+  // threads.
+  void SetTaskRunner(base::TaskRunner* task_runner) {
+    task_runner_ = task_runner;
+    timeline_view_.set_count_runner(task_runner);
+  }
 
  private:
   int OnCreate(LPCREATESTRUCT create_struct);
   LRESULT OnCommand(UINT msg, WPARAM wparam, LPARAM lparam, BOOL& handled);
   void OnLogFilter(UINT code, int id, CWindow window);
+  void OnLogQuery(UINT code, int id, CWindow window);
   void OnIncludeColumn(UINT code, int id, CWindow window);
   void OnExcludeColumn(UINT code, int id, CWindow window);
 
+  // Invoked when the user mutes or unmutes a log site.
+  void OnMuteSites();
+
+  // Invoked when the user picks the tree of the instance of @p process_id
+  // running at @p time to show the rows of, or all processes if @p time is
+  // null.
+  void OnShowProcessTree(DWORD process_id, base::Time time);
+
+  // Invoked when the user clicks the header of @p column. Successive clicks
+  // sort ascending, sort descending, and stop sorting.
+  void OnSortColumn(LogViewFormatter::Column column);
+
+  // Invoked when the user clicks @p time on the timeline. Shows the first
+  // row logged from then on, in time order.
+  void OnTimelineClicked(base::Time time);
+
+  // Shows @p view, which replaces the filtered view, if any.
+  void SetFilteredLogView(FilteredLogView* view);
+
+  // Stacks a sorted view on the filtered view or on log_view_, as per the
+  // sort order, and shows it.
+  void UpdateSortedLogView();
+
+  // Excludes the rows of the muted sites from @p view.
+  void ApplyMutedSites(FilteredLogView* view);
+
+  // @returns a new filtered view of log_view_ with @p filters, which
+  //     excludes the rows of the muted sites and of the processes outside
+  //     the process tree.
+  FilteredLogView* CreateFilteredLogView(const std::vector<Filter>& filters);
+
   // Non-null iff filtering is enabled.
   scoped_ptr<FilteredLogView> filtered_log_view_;
 
+  // Non-null iff sorting is enabled. It sorts the filtered view if there's
+  // one, which it must not outlive.
+  scoped_ptr<SortedLogView> sorted_log_view_;
+
+  // The column we sort on, or LogViewFormatter::NUM_COLUMNS to show the
+  // rows in their original order.
+  LogViewFormatter::Column sort_column_;
+  bool sort_ascending_;
+
   // The original log view we're handed.
   ILogView* log_view_;
 
+  // The sites of log_view_.
+  LogSiteTable* site_table_;
+
+  // The processes of log_view_, if known.
+  ProcessInfoService* process_info_service_;
+
+  // The processes whose rows we show, or NULL for all processes. It
+  // observes process_info_service_ as long as we have it.
+  scoped_refptr<ProcessTree> process_tree_;
+
+  // Where our filtered and sorted views work, if not on the UI thread.
+  scoped_refptr<base::TaskRunner> task_runner_;
+
+  // The UTF8 text of the last query run.
+  std::string query_text_;
+
   // The list view that displays the log.
   LogListView log_list_view_;
 
+  // The timeline of the filtered view, or of log_view_.
+  TimelineView timeline_view_;
+
+  // Splits the top pane between the log and its timeline.
+  PaneSplitter log_splitter_;
+
   // The row # of the item currently displayed in the stack trace.
-  int stack_trace_item_row_;
+  int64 stack_trace_item_row_;
 
   // The list that displays the stack trace for the currently selected log.
   StackTraceListView stack_trace_list_view_;
 
+  // The live summary of the log sites.
+  StatisticsListView statistics_list_view_;
+
+  // Splits the bottom pane between the stack trace and the statistics.
+  PaneSplitter details_splitter_;
+
   // Used to update our UI.
   CUpdateUIBase* update_ui_;
 };
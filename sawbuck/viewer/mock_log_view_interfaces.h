@@ -24,23 +24,30 @@ namespace testing {
 
 class MockILogViewEvents: public ILogViewEvents {
  public:
-  MOCK_METHOD0(LogViewNewItems, void());
+  MOCK_METHOD2(LogViewNewItems, void(int64 first_row, int64 num_rows));
   MOCK_METHOD0(LogViewCleared, void());
 };
 
 class MockILogView: public ILogView {
  public:
-  MOCK_METHOD0(GetNumRows, int());
+  MOCK_METHOD0(GetNumRows, int64());
   MOCK_METHOD0(ClearAll, void());
 
-  MOCK_METHOD1(GetSeverity, int(int row));
-  MOCK_METHOD1(GetProcessId, DWORD(int row));
-  MOCK_METHOD1(GetThreadId, DWORD(int row));
-  MOCK_METHOD1(GetTime, base::Time(int row));
-  MOCK_METHOD1(GetFileName, std::string(int row));
-  MOCK_METHOD1(GetLine, int(int row));
-  MOCK_METHOD1(GetMessage, std::string(int row));
-  MOCK_METHOD2(GetStackTrace, void(int row, std::vector<void*>* trace));
+  MOCK_METHOD1(GetSeverity, int(int64 row));
+  MOCK_METHOD1(GetProcessId, DWORD(int64 row));
+  MOCK_METHOD1(GetThreadId, DWORD(int64 row));
+  MOCK_METHOD1(GetTime, base::Time(int64 row));
+  MOCK_METHOD1(GetFileName, std::string(int64 row));
+  MOCK_METHOD1(GetLine, int(int64 row));
+  MOCK_METHOD1(GetMessage, std::string(int64 row));
+  MOCK_METHOD2(GetStackTrace, void(int64 row, std::vector<void*>* trace));
+  MOCK_METHOD1(GetSiteId, int(int64 row));
+  MOCK_METHOD1(GetTemplateId, int(int64 row));
+  MOCK_METHOD1(GetTemplateText, std::string(int template_id));
+  MOCK_METHOD1(GetImageId, int(int64 row));
+  MOCK_METHOD1(GetImageName, std::string(int image_id));
+  MOCK_METHOD1(FindFirstRowAtTime, int64(base::Time time));
+  MOCK_METHOD1(FindEndOfRowsBefore, int64(base::Time time));
 
   MOCK_METHOD2(Register, void(ILogViewEvents* event_sink,
                               int* registration_cookie));
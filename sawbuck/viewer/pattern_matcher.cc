@@ -0,0 +1,876 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Pattern matcher implementation.
+#include "sawbuck/viewer/pattern_matcher.h"
+
+#include <string.h>
+#include <algorithm>
+#include <utility>
+#include "base/lazy_instance.h"
+#include "base/logging.h"
+#include "base/stl_util.h"
+#include "base/strings/string_util.h"
+
+namespace {
+
+// The options the automaton supports.
+const int kNewlineOptions = PCRE_NEWLINE_CR | PCRE_NEWLINE_LF |
+    PCRE_NEWLINE_ANY;
+const int kSupportedOptions = PCRE_CASELESS | PCRE_DOTALL | PCRE_UTF8 |
+    kNewlineOptions;
+
+// The most states of an automaton, and the most a quantifier may repeat
+// its atom, beyond which we leave the pattern to PCRE.
+const size_t kMaxStates = 10000;
+const int kMaxRepeat = 1000;
+
+// The patterns we keep compiled, beyond which we drop the ones no one
+// uses.
+const size_t kMaxPatterns = 256;
+
+// In UTF8 mode, the sets of characters hold the ASCII characters as
+// bytes, and all other characters as this byte.
+const int kNonAscii = 0x80;
+
+typedef std::bitset<256> ByteSet;
+
+void AddRange(int first, int last, ByteSet* set) {
+  for (int c = first; c <= last; ++c)
+    set->set(c);
+}
+
+// Adds @p c to @p set, in both cases if @p caseless.
+void AddChar(int c, bool caseless, ByteSet* set) {
+  set->set(c);
+  if (caseless && IsAsciiAlpha(c)) {
+    set->set(c | 0x20);
+    set->set(c & ~0x20);
+  }
+}
+
+ByteSet AsciiBytes() {
+  ByteSet set;
+  AddRange(0, 0x7F, &set);
+  return set;
+}
+
+// The matchers of the patterns compiled so far.
+struct PatternCache {
+  typedef std::pair<std::string, int> Key;
+  typedef std::map<Key, scoped_refptr<PatternMatcher> > MatcherMap;
+
+  base::Lock lock;
+  MatcherMap matchers;  // Under lock.
+};
+
+base::LazyInstance<PatternCache>::Leaky g_pattern_cache =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// Compiles a pattern to an automaton, Thompson style, or gives up on the
+// patterns outside our subset, which includes the invalid ones.
+class PatternMatcher::Compiler {
+ public:
+  Compiler(const std::string& pattern, int options, std::vector<State>* states)
+      : pattern_(pattern), options_(options), states_(states), position_(0) {
+  }
+
+  // @returns true iff the pattern is in our subset, with its start state
+  //     in @p start.
+  bool Compile(int* start);
+
+ private:
+  // A piece of the automaton, with the transitions out of it that are yet
+  // to be pointed somewhere. These holes are encoded as twice the state,
+  // plus one for its next2.
+  struct Fragment {
+    int start;
+    std::vector<int> holes;
+  };
+
+  bool ParseAlternatives(Fragment* fragment);
+  bool ParseSequence(Fragment* fragment);
+  bool ParseRepeat(Fragment* fragment);
+  bool ParseAtom(Fragment* fragment);
+  bool ParseEscape(Fragment* fragment);
+  bool ParseClass(Fragment* fragment);
+
+  // Parses a counted quantifier, e.g. "{2,5}", to @p min and @p max, where
+  // @p max is -1 if unbounded.
+  // @returns false, parsing nothing, if there's no such quantifier.
+  bool ParseCount(int* min, int* max);
+
+  // Parses the escape of a character class, past its backslash, to @p set.
+  // @returns false if it's not such an escape.
+  bool ParseClassEscape(ByteSet* set);
+  // Parses the escape of a character, past its backslash, to @p c.
+  // @returns false if it's not such an escape.
+  bool ParseCharEscape(int* c);
+
+  // Fragments of @p c, of one of @p set, and of the byte range @p bytes.
+  void MakeChar(int c, Fragment* fragment);
+  void MakeSet(const ByteSet& set, Fragment* fragment);
+  void MakeBytes(const ByteSet& bytes, Fragment* fragment);
+  // A fragment that consumes nothing.
+  void MakeEmpty(Fragment* fragment);
+
+  // Appends @p next to @p fragment.
+  void Concatenate(const Fragment& next, Fragment* fragment);
+  // Makes @p fragment match once or not, any number of times, or at least
+  // once.
+  void MakeOptional(Fragment* fragment);
+  void MakeStar(Fragment* fragment);
+  void MakePlus(Fragment* fragment);
+
+  int AddState(State::Type type, int next, int next2);
+  void Patch(const std::vector<int>& holes, int state);
+
+  bool utf8() const { return (options_ & PCRE_UTF8) != 0; }
+  bool caseless() const { return (options_ & PCRE_CASELESS) != 0; }
+
+  bool AtEnd() const { return position_ == pattern_.size(); }
+  int Peek() const { return static_cast<unsigned char>(pattern_[position_]); }
+
+  const std::string& pattern_;
+  const int options_;
+  std::vector<State>* states_;
+  size_t position_;
+};
+
+bool PatternMatcher::Compiler::Compile(int* start) {
+  if ((options_ & ~kSupportedOptions) != 0)
+    return false;
+
+  // Only the default newline and any of CR, LF or CRLF are supported.
+  int newline = options_ & kNewlineOptions;
+  if (newline != 0 && newline != PCRE_NEWLINE_LF &&
+      newline != PCRE_NEWLINE_ANYCRLF) {
+    return false;
+  }
+
+  Fragment fragment;
+  if (!ParseAlternatives(&fragment) || !AtEnd())
+    return false;
+
+  Patch(fragment.holes, AddState(State::MATCH, -1, -1));
+  *start = fragment.start;
+  return states_->size() <= kMaxStates;
+}
+
+bool PatternMatcher::Compiler::ParseAlternatives(Fragment* fragment) {
+  if (!ParseSequence(fragment))
+    return false;
+
+  while (!AtEnd() && Peek() == '|') {
+    ++position_;
+    Fragment alternative;
+    if (!ParseSequence(&alternative))
+      return false;
+
+    fragment->start = AddState(State::SPLIT, fragment->start,
+                               alternative.start);
+    fragment->holes.insert(fragment->holes.end(),
+                           alternative.holes.begin(),
+                           alternative.holes.end());
+  }
+
+  return true;
+}
+
+bool PatternMatcher::Compiler::ParseSequence(Fragment* fragment) {
+  MakeEmpty(fragment);
+  while (!AtEnd() && Peek() != '|' && Peek() != ')') {
+    Fragment next;
+    if (!ParseRepeat(&next))
+      return false;
+    Concatenate(next, fragment);
+
+    if (states_->size() > kMaxStates)
+      return false;
+  }
+
+  return true;
+}
+
+bool PatternMatcher::Compiler::ParseRepeat(Fragment* fragment) {
+  size_t atom_start = position_;
+  if (!ParseAtom(fragment))
+    return false;
+  if (AtEnd())
+    return true;
+
+  int min = 1;
+  int max = 1;
+  switch (Peek()) {
+    case '*': min = 0; max = -1; ++position_; break;
+    case '+': min = 1; max = -1; ++position_; break;
+    case '?': min = 0; max = 1; ++position_; break;
+    case '{':
+      if (!ParseCount(&min, &max))
+        return true;
+      break;
+    default:
+      return true;
+  }
+
+  // Laziness makes no difference to whether there's a match. Possessive
+  // quantifiers do, and a quantifier can't repeat another.
+  if (!AtEnd() && Peek() == '?')
+    ++position_;
+  if (!AtEnd() && (Peek() == '+' || Peek() == '*' || Peek() == '?'))
+    return false;
+  if (max != -1 && max < min)
+    return false;
+
+  if (min == 1 && max == -1) {
+    MakePlus(fragment);
+    return true;
+  }
+  if (min == 0 && max == 1) {
+    MakeOptional(fragment);
+    return true;
+  }
+  if (min == 0 && max == -1) {
+    MakeStar(fragment);
+    return true;
+  }
+
+  // Counted repeats spell the atom out, parsing it again for each copy.
+  if (min > kMaxRepeat || max > kMaxRepeat)
+    return false;
+
+  size_t atom_end = position_;
+  Fragment repeat;
+  MakeEmpty(&repeat);
+  int copies = max == -1 ? min + 1 : max;
+  for (int i = 0; i < copies; ++i) {
+    Fragment copy;
+    if (i == 0) {
+      copy = *fragment;
+    } else {
+      position_ = atom_start;
+      if (!ParseAtom(&copy))
+        return false;
+    }
+
+    if (i >= min) {
+      if (max == -1)
+        MakeStar(&copy);
+      else
+        MakeOptional(&copy);
+    }
+    Concatenate(copy, &repeat);
+
+    if (states_->size() > kMaxStates)
+      return false;
+  }
+
+  position_ = atom_end;
+  *fragment = repeat;
+  return true;
+}
+
+bool PatternMatcher::Compiler::ParseAtom(Fragment* fragment) {
+  int c = Peek();
+  ++position_;
+  switch (c) {
+    case '(':
+      // Only non-capturing groups, of all the (? constructs.
+      if (!AtEnd() && Peek() == '?') {
+        if (position_ + 1 >= pattern_.size() || pattern_[position_ + 1] != ':')
+          return false;
+        position_ += 2;
+      }
+      if (!ParseAlternatives(fragment) || AtEnd() || Peek() != ')')
+        return false;
+      ++position_;
+      return true;
+
+    case '[':
+      return ParseClass(fragment);
+
+    case '\\':
+      return ParseEscape(fragment);
+
+    case '.': {
+      ByteSet set;
+      set.set();
+      if ((options_ & PCRE_DOTALL) == 0) {
+        set.reset('\n');
+        if ((options_ & kNewlineOptions) == PCRE_NEWLINE_ANYCRLF)
+          set.reset('\r');
+      }
+      MakeSet(set, fragment);
+      return true;
+    }
+
+    case '^':
+      fragment->start = AddState(State::BEGIN, -1, -1);
+      fragment->holes.assign(1, fragment->start * 2);
+      return true;
+
+    case '$':
+      fragment->start = AddState(State::END, -1, -1);
+      fragment->holes.assign(1, fragment->start * 2);
+      return true;
+
+    case '*':
+    case '+':
+    case '?':
+      // Nothing to repeat.
+      return false;
+
+    case '{': {
+      // A brace is literal unless it's a quantifier, which has nothing to
+      // repeat here.
+      int min = 0;
+      int max = 0;
+      --position_;
+      if (ParseCount(&min, &max))
+        return false;
+      ++position_;
+      MakeChar(c, fragment);
+      return true;
+    }
+  }
+
+  if (c < 0x80) {
+    MakeChar(c, fragment);
+    return true;
+  }
+
+  // Case folding of other characters is left to PCRE.
+  if (caseless())
+    return false;
+
+  // Characters of several bytes are repeated whole.
+  ByteSet byte;
+  byte.set(c);
+  MakeBytes(byte, fragment);
+  if (utf8() && c >= 0xC0) {
+    while (!AtEnd() && (Peek() & 0xC0) == 0x80) {
+      Fragment next;
+      ByteSet continuation;
+      continuation.set(Peek());
+      MakeBytes(continuation, &next);
+      Concatenate(next, fragment);
+      ++position_;
+    }
+  }
+  return true;
+}
+
+bool PatternMatcher::Compiler::ParseEscape(Fragment* fragment) {
+  if (AtEnd())
+    return false;
+
+  ByteSet set;
+  if (ParseClassEscape(&set)) {
+    MakeSet(set, fragment);
+    return true;
+  }
+
+  int c = 0;
+  if (!ParseCharEscape(&c))
+    return false;
+
+  MakeChar(c, fragment);
+  return true;
+}
+
+bool PatternMatcher::Compiler::ParseClass(Fragment* fragment) {
+  bool negated = false;
+  if (!AtEnd() && Peek() == '^') {
+    negated = true;
+    ++position_;
+  }
+
+  ByteSet set;
+  bool first = true;
+  while (true) {
+    if (AtEnd())
+      return false;
+
+    // A leading bracket is literal.
+    int c = Peek();
+    if (c == ']' && !first)
+      break;
+    first = false;
+    ++position_;
+
+    if (c == '[' && !AtEnd() && Peek() == ':')
+      return false;
+
+    if (c == '\\') {
+      if (AtEnd())
+        return false;
+      ByteSet escaped;
+      if (ParseClassEscape(&escaped)) {
+        set |= escaped;
+        continue;
+      }
+      // Within classes, \b is a backspace.
+      if (Peek() == 'b') {
+        ++position_;
+        c = '\b';
+      } else if (!ParseCharEscape(&c)) {
+        return false;
+      }
+    }
+    if (c >= 0x80)
+      return false;
+
+    // A range, unless the dash is last.
+    int last = c;
+    if (position_ + 1 < pattern_.size() && Peek() == '-' &&
+        pattern_[position_ + 1] != ']') {
+      ++position_;
+      last = Peek();
+      ++position_;
+      if (last == '\\') {
+        if (AtEnd() || !ParseCharEscape(&last))
+          return false;
+      } else if (last == '[') {
+        return false;
+      }
+      if (last >= 0x80 || last < c)
+        return false;
+    }
+
+    for (int i = c; i <= last; ++i)
+      AddChar(i, caseless(), &set);
+  }
+  ++position_;
+
+  if (negated)
+    set.flip();
+  MakeSet(set, fragment);
+  return true;
+}
+
+bool PatternMatcher::Compiler::ParseCount(int* min, int* max) {
+  DCHECK_EQ('{', Peek());
+
+  // The bounds, or -1 where they have no digits.
+  size_t position = position_ + 1;
+  int values[2] = { -1, -1 };
+  bool comma = false;
+  for (int i = 0; i < 2; ++i) {
+    while (position < pattern_.size() && IsAsciiDigit(pattern_[position])) {
+      if (values[i] == -1)
+        values[i] = 0;
+      values[i] = std::min(values[i] * 10 + pattern_[position] - '0',
+                           kMaxRepeat + 1);
+      ++position;
+    }
+    if (i == 0 && position < pattern_.size() && pattern_[position] == ',') {
+      comma = true;
+      ++position;
+    } else {
+      break;
+    }
+  }
+
+  if (position == pattern_.size() || pattern_[position] != '}' ||
+      values[0] == -1) {
+    return false;
+  }
+
+  *min = values[0];
+  *max = comma ? values[1] : values[0];
+  position_ = position + 1;
+  return true;
+}
+
+bool PatternMatcher::Compiler::ParseClassEscape(ByteSet* set) {
+  set->reset();
+  switch (Peek()) {
+    case 'd':
+    case 'D':
+      AddRange('0', '9', set);
+      break;
+    case 'w':
+    case 'W':
+      AddRange('a', 'z', set);
+      AddRange('A', 'Z', set);
+      AddRange('0', '9', set);
+      set->set('_');
+      break;
+    case 's':
+    case 'S':
+      set->set(' ');
+      set->set('\t');
+      set->set('\n');
+      set->set('\f');
+      set->set('\r');
+      break;
+    default:
+      return false;
+  }
+
+  // The upper case escapes match what the lower case ones don't.
+  if (IsAsciiUpper(static_cast<char>(Peek())))
+    set->flip();
+  ++position_;
+  return true;
+}
+
+bool PatternMatcher::Compiler::ParseCharEscape(int* c) {
+  int escaped = Peek();
+  ++position_;
+  switch (escaped) {
+    case 'a': *c = '\a'; return true;
+    case 'e': *c = 0x1B; return true;
+    case 'f': *c = '\f'; return true;
+    case 'n': *c = '\n'; return true;
+    case 'r': *c = '\r'; return true;
+    case 't': *c = '\t'; return true;
+    case 'x': {
+      // One or two hex digits, for an ASCII character.
+      int value = 0;
+      int digits = 0;
+      while (digits < 2 && !AtEnd() && IsHexDigit(Peek())) {
+        value = value * 16 + HexDigitToInt(Peek());
+        ++position_;
+        ++digits;
+      }
+      if (value >= 0x80 || (digits == 0 && !AtEnd() && Peek() == '{'))
+        return false;
+      *c = value;
+      return true;
+    }
+  }
+
+  // Other letters and digits escape constructs we leave to PCRE, while
+  // the rest escape themselves.
+  if (escaped >= 0x80 || IsAsciiAlpha(escaped) || IsAsciiDigit(escaped))
+    return false;
+
+  *c = escaped;
+  return true;
+}
+
+void PatternMatcher::Compiler::MakeChar(int c, Fragment* fragment) {
+  ByteSet set;
+  AddChar(c, caseless(), &set);
+  MakeBytes(set, fragment);
+}
+
+void PatternMatcher::Compiler::MakeSet(const ByteSet& set,
+                                       Fragment* fragment) {
+  if (!utf8() || !set.test(kNonAscii)) {
+    MakeBytes(utf8() ? set & AsciiBytes() : set, fragment);
+    return;
+  }
+
+  // Any character of several bytes: a leading byte, then any continuation
+  // bytes, alongside the ASCII characters of the set.
+  Fragment single;
+  MakeBytes(set & AsciiBytes(), &single);
+
+  ByteSet lead;
+  AddRange(0xC0, 0xFF, &lead);
+  Fragment multi;
+  MakeBytes(lead, &multi);
+  ByteSet continuation;
+  AddRange(0x80, 0xBF, &continuation);
+  Fragment rest;
+  MakeBytes(continuation, &rest);
+  MakeStar(&rest);
+  Concatenate(rest, &multi);
+
+  fragment->start = AddState(State::SPLIT, single.start, multi.start);
+  fragment->holes = single.holes;
+  fragment->holes.insert(fragment->holes.end(),
+                         multi.holes.begin(), multi.holes.end());
+}
+
+void PatternMatcher::Compiler::MakeBytes(const ByteSet& bytes,
+                                         Fragment* fragment) {
+  fragment->start = AddState(State::BYTES, -1, -1);
+  (*states_)[fragment->start].bytes = bytes;
+  fragment->holes.assign(1, fragment->start * 2);
+}
+
+void PatternMatcher::Compiler::MakeEmpty(Fragment* fragment) {
+  fragment->start = AddState(State::EMPTY, -1, -1);
+  fragment->holes.assign(1, fragment->start * 2);
+}
+
+void PatternMatcher::Compiler::Concatenate(const Fragment& next,
+                                           Fragment* fragment) {
+  Patch(fragment->holes, next.start);
+  fragment->holes = next.holes;
+}
+
+void PatternMatcher::Compiler::MakeOptional(Fragment* fragment) {
+  int split = AddState(State::SPLIT, fragment->start, -1);
+  fragment->start = split;
+  fragment->holes.push_back(split * 2 + 1);
+}
+
+void PatternMatcher::Compiler::MakeStar(Fragment* fragment) {
+  int split = AddState(State::SPLIT, fragment->start, -1);
+  Patch(fragment->holes, split);
+  fragment->start = split;
+  fragment->holes.assign(1, split * 2 + 1);
+}
+
+void PatternMatcher::Compiler::MakePlus(Fragment* fragment) {
+  int split = AddState(State::SPLIT, fragment->start, -1);
+  Patch(fragment->holes, split);
+  fragment->holes.assign(1, split * 2 + 1);
+}
+
+int PatternMatcher::Compiler::AddState(State::Type type, int next, int next2) {
+  State state;
+  state.type = type;
+  state.next = next;
+  state.next2 = next2;
+  states_->push_back(state);
+  return states_->size() - 1;
+}
+
+void PatternMatcher::Compiler::Patch(const std::vector<int>& holes,
+                                     int state) {
+  for (size_t i = 0; i < holes.size(); ++i) {
+    State& patched = (*states_)[holes[i] / 2];
+    if (holes[i] % 2 == 0)
+      patched.next = state;
+    else
+      patched.next2 = state;
+  }
+}
+
+const size_t PatternMatcher::kMaxDfaStates;
+
+// static
+scoped_refptr<PatternMatcher> PatternMatcher::Get(const std::string& pattern,
+                                                  int options) {
+  PatternCache* cache = g_pattern_cache.Pointer();
+  base::AutoLock lock(cache->lock);
+
+  PatternCache::Key key(pattern, options);
+  PatternCache::MatcherMap::iterator it = cache->matchers.find(key);
+  if (it != cache->matchers.end())
+    return it->second;
+
+  // Drop the matchers only the cache holds, rather than grow without bounds.
+  if (cache->matchers.size() >= kMaxPatterns) {
+    it = cache->matchers.begin();
+    while (it != cache->matchers.end()) {
+      if (it->second->HasOneRef())
+        cache->matchers.erase(it++);
+      else
+        ++it;
+    }
+  }
+
+  scoped_refptr<PatternMatcher> matcher(new PatternMatcher(pattern, options));
+  cache->matchers[key] = matcher;
+  return matcher;
+}
+
+PatternMatcher::PatternMatcher(const std::string& pattern, int options)
+    : pattern_(pattern), options_(options), start_(-1) {
+  Compiler compiler(pattern_, options_, &states_);
+  if (!compiler.Compile(&start_)) {
+    states_.clear();
+    re_.reset(new pcrecpp::RE(pattern_.c_str(), options_));
+  }
+}
+
+PatternMatcher::~PatternMatcher() {
+  STLDeleteElements(&idle_dfas_);
+}
+
+bool PatternMatcher::FullMatch(const base::StringPiece& text) const {
+  if (re_.get() != NULL)
+    return re_->FullMatch(pcrecpp::StringPiece(text.data(), text.size()));
+
+  return Match(text, true);
+}
+
+bool PatternMatcher::PartialMatch(const base::StringPiece& text) const {
+  if (re_.get() != NULL)
+    return re_->PartialMatch(pcrecpp::StringPiece(text.data(), text.size()));
+
+  return Match(text, false);
+}
+
+bool PatternMatcher::Match(const base::StringPiece& text, bool full) const {
+  // Take an idle DFA, warm from earlier matches, or start a new one.
+  Dfa* dfa = NULL;
+  {
+    base::AutoLock lock(lock_);
+    if (!idle_dfas_.empty()) {
+      dfa = idle_dfas_.back();
+      idle_dfas_.pop_back();
+    }
+  }
+  if (dfa == NULL)
+    dfa = new Dfa();
+
+  bool matches = MatchWithDfa(text, full, dfa);
+
+  base::AutoLock lock(lock_);
+  idle_dfas_.push_back(dfa);
+  return matches;
+}
+
+bool PatternMatcher::MatchWithDfa(const base::StringPiece& text,
+                                  bool full,
+                                  Dfa* dfa) const {
+  // Away from the ends of the text, the closures and transitions of the
+  // DFA states are cached. At the ends, where the assertions may hold,
+  // they're worked out afresh.
+  std::vector<int> kernel(1, start_);
+  int dfa_state = GetDfaState(kernel, dfa);
+  std::vector<int> closure;
+  for (size_t i = 0; ; ++i) {
+    int context = GetContext(text, i);
+    const std::vector<int>* states = &dfa->states[dfa_state].closure;
+    bool matches = dfa->states[dfa_state].matches;
+    if (context != 0) {
+      GetClosure(dfa->states[dfa_state].kernel, context, &closure);
+      states = &closure;
+      matches = !closure.empty() &&
+          states_[closure.back()].type == State::MATCH;
+    }
+
+    if (matches && (!full || i == text.size()))
+      return true;
+    if (i == text.size())
+      return false;
+
+    unsigned char byte = text[i];
+    int next = dfa->states[dfa_state].next[full][byte];
+    if (context == 0 && next != -1) {
+      dfa_state = next;
+      continue;
+    }
+
+    // Partial matches may start afresh at every byte.
+    kernel.clear();
+    if (!full)
+      kernel.push_back(start_);
+    for (size_t j = 0; j < states->size(); ++j) {
+      const State& state = states_[(*states)[j]];
+      if (state.type == State::BYTES && state.bytes.test(byte))
+        kernel.push_back(state.next);
+    }
+    std::sort(kernel.begin(), kernel.end());
+    kernel.erase(std::unique(kernel.begin(), kernel.end()), kernel.end());
+    if (kernel.empty())
+      return false;
+
+    // Only cache the transitions away from the ends, and out of the states
+    // we've not just forgotten.
+    size_t num_dfa_states = dfa->states.size();
+    next = GetDfaState(kernel, dfa);
+    if (context == 0 && dfa->states.size() >= num_dfa_states)
+      dfa->states[dfa_state].next[full][byte] = next;
+    dfa_state = next;
+  }
+}
+
+int PatternMatcher::GetContext(const base::StringPiece& text,
+                               size_t position) const {
+  int context = 0;
+  if (position == 0)
+    context |= AT_BEGIN;
+
+  // "$" also matches before a final newline.
+  if (text.size() - position <= 2) {
+    base::StringPiece rest(text.substr(position));
+    if (rest.empty() || rest == "\n") {
+      context |= AT_END;
+    } else if ((options_ & kNewlineOptions) == PCRE_NEWLINE_ANYCRLF &&
+               (rest == "\r" || rest == "\r\n")) {
+      context |= AT_END;
+    }
+  }
+
+  return context;
+}
+
+void PatternMatcher::GetClosure(const std::vector<int>& kernel,
+                                int context,
+                                std::vector<int>* closure) const {
+  closure->clear();
+
+  std::vector<bool> seen(states_.size());
+  std::vector<int> stack(kernel.rbegin(), kernel.rend());
+  while (!stack.empty()) {
+    int index = stack.back();
+    stack.pop_back();
+    if (index == -1 || seen[index])
+      continue;
+    seen[index] = true;
+
+    const State& state = states_[index];
+    switch (state.type) {
+      case State::BYTES:
+      case State::MATCH:
+        closure->push_back(index);
+        break;
+      case State::SPLIT:
+        stack.push_back(state.next2);
+        stack.push_back(state.next);
+        break;
+      case State::EMPTY:
+        stack.push_back(state.next);
+        break;
+      case State::BEGIN:
+        if (context & AT_BEGIN)
+          stack.push_back(state.next);
+        break;
+      case State::END:
+        if (context & AT_END)
+          stack.push_back(state.next);
+        break;
+    }
+  }
+
+  // The match state is last, as the compiler adds it last.
+  std::sort(closure->begin(), closure->end());
+}
+
+int PatternMatcher::GetDfaState(const std::vector<int>& kernel,
+                                Dfa* dfa) const {
+  std::map<std::vector<int>, int>::const_iterator it =
+      dfa->state_ids.find(kernel);
+  if (it != dfa->state_ids.end())
+    return it->second;
+
+  // Start over rather than grow without bounds.
+  if (dfa->states.size() >= kMaxDfaStates) {
+    dfa->states.clear();
+    dfa->state_ids.clear();
+  }
+
+  dfa->states.push_back(DfaState());
+  DfaState& state = dfa->states.back();
+  state.kernel = kernel;
+  GetClosure(kernel, 0, &state.closure);
+  state.matches = !state.closure.empty() &&
+      states_[state.closure.back()].type == State::MATCH;
+  memset(state.next, -1, sizeof(state.next));
+
+  int id = dfa->states.size() - 1;
+  dfa->state_ids[kernel] = id;
+  return id;
+}
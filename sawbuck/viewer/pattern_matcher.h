@@ -0,0 +1,160 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Pattern matcher declaration.
+#ifndef SAWBUCK_VIEWER_PATTERN_MATCHER_H_
+#define SAWBUCK_VIEWER_PATTERN_MATCHER_H_
+
+#include <bitset>
+#include <map>
+#include <string>
+#include <vector>
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+#include "pcrecpp.h"  // NOLINT
+
+// A compiled regular expression, with PCRE syntax and options.
+//
+// The patterns in the subset we support, which is literals, ".", classes,
+// the common escapes, groups, alternatives, greedy and lazy quantifiers,
+// and "^" and "$", are compiled to an automaton that matches in time
+// linear in the length of the text, whatever the pattern. The automaton
+// is turned into a DFA lazily, a state per distinct set of automaton
+// states met, which makes most matching a table lookup per byte. Other
+// patterns, e.g. with back references or lookarounds, are matched by PCRE.
+//
+// Matchers are shared by all their users through a process-wide cache,
+// and are safe to use from any thread.
+class PatternMatcher : public base::RefCountedThreadSafe<PatternMatcher> {
+ public:
+  // The DFA states we keep per DFA, beyond which we start over.
+  static const size_t kMaxDfaStates = 256;
+
+  // @returns the matcher of @p pattern with the PCRE @p options, compiled
+  //     once and shared for as long as it is in use.
+  static scoped_refptr<PatternMatcher> Get(const std::string& pattern,
+                                           int options);
+
+  // @returns true iff the pattern matches all of @p text.
+  bool FullMatch(const base::StringPiece& text) const;
+
+  // @returns true iff the pattern matches some of @p text.
+  bool PartialMatch(const base::StringPiece& text) const;
+
+  // @returns true iff we match with the automaton rather than with PCRE.
+  bool is_linear() const { return !states_.empty(); }
+
+  const std::string& pattern() const { return pattern_; }
+  int options() const { return options_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<PatternMatcher>;
+  class Compiler;
+
+  // A state of the automaton.
+  struct State {
+    enum Type {
+      // Consumes a byte of bytes, then goes to next.
+      BYTES,
+      // Goes to next and to next2 without consuming.
+      SPLIT,
+      // Goes to next without consuming.
+      EMPTY,
+      // Goes to next at the start of the text.
+      BEGIN,
+      // Goes to next at the end of the text, or before a final newline.
+      END,
+      MATCH,
+    };
+
+    Type type;
+    int next;
+    int next2;
+    std::bitset<256> bytes;
+  };
+
+  // Where in the text the automaton is, for the assertions.
+  enum Context {
+    AT_BEGIN = 1 << 0,
+    AT_END = 1 << 1,
+  };
+
+  // A state of the lazy DFA, the set of automaton states it stands for.
+  struct DfaState {
+    // The states reached by consuming a byte, before following the
+    // transitions that don't consume, sorted. This keys the DFA state.
+    std::vector<int> kernel;
+    // The consuming and matching states reached from the kernel, away
+    // from the begin and the end of the text.
+    std::vector<int> closure;
+    bool matches;
+    // The DFA state after each byte from the closure, or -1 if unknown,
+    // for partial and for full matches.
+    int next[2][256];
+  };
+
+  // A lazy DFA. Matches running at once each use their own, and leave it
+  // for the next match when done.
+  struct Dfa {
+    std::vector<DfaState> states;
+    std::map<std::vector<int>, int> state_ids;
+  };
+
+  PatternMatcher(const std::string& pattern, int options);
+  ~PatternMatcher();
+
+  // @returns true iff we match all of @p text, or some of it if not
+  //     @p full, with the automaton.
+  bool Match(const base::StringPiece& text, bool full) const;
+
+  // Matches as Match does, using and extending @p dfa.
+  bool MatchWithDfa(const base::StringPiece& text,
+                    bool full,
+                    Dfa* dfa) const;
+
+  // @returns the context of @p position in @p text.
+  int GetContext(const base::StringPiece& text, size_t position) const;
+
+  // Retrieves the consuming and matching states reached from @p kernel in
+  // @p context to @p closure.
+  void GetClosure(const std::vector<int>& kernel,
+                  int context,
+                  std::vector<int>* closure) const;
+
+  // @returns the index in @p dfa of the DFA state of @p kernel, adding it
+  //     as need be. This may forget all other DFA states.
+  int GetDfaState(const std::vector<int>& kernel, Dfa* dfa) const;
+
+  const std::string pattern_;
+  const int options_;
+
+  // The automaton, empty if we match with re_.
+  std::vector<State> states_;
+  int start_;
+
+  // Matches the patterns we don't support.
+  scoped_ptr<pcrecpp::RE> re_;
+
+  // The lazy DFAs not in use by a match, which we own. The automaton is
+  // shared by all matches, and the lock is only held to take or leave a
+  // DFA, so matches on several threads don't wait on each other.
+  mutable base::Lock lock_;
+  mutable std::vector<Dfa*> idle_dfas_;  // Under lock_.
+
+  DISALLOW_COPY_AND_ASSIGN(PatternMatcher);
+};
+
+#endif  // SAWBUCK_VIEWER_PATTERN_MATCHER_H_
@@ -0,0 +1,213 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Pattern matcher unittests.
+#include "sawbuck/viewer/pattern_matcher.h"
+
+#include <string>
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/message_loop/message_loop.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+// The options the filters match with.
+const int kFilterOptions = PCRE_NEWLINE_ANYCRLF | PCRE_DOTALL | PCRE_UTF8 |
+    PCRE_CASELESS;
+
+const char* const kPatterns[] = {
+    "", "a", "abc", "a.c", "a*", "a+b", "ab?c", "(ab|cd)+", "(?:ab)*c",
+    "^ab", "ab$", "^$", "[a-c]+", "[^a-c]", "[]a]", "[a-]", "\\d+\\.\\d*",
+    "\\w+\\s\\W", "\\S\\D", "a{2}", "a{2,}", "a{1,3}b", "x{", "a{,2}",
+    "(a|b)*c(d|e)?", "a*?b", "[\\d_]x", "\\x41", "\\.\\*\\[", "(|a)b",
+    ".", "[^x]y", "a|", "((a))", "[\\]]", "\\t", "A[B-D]e",
+};
+
+// Patterns of characters of several bytes, whose case PCRE folds.
+const char* const kUtf8Patterns[] = {
+    "\xC3\xA9+", "^.$", "^..$", "[^x]y", "\\W+", "\xC3.",
+};
+
+const char* const kTexts[] = {
+    "", "a", "A", "abc", "ABC", "abd", "aabb", "xabcx", "abab", "cdabc",
+    "ab\n", "ab\r\n", "ab\nx", "\n", "12.5", "12.", "foo bar", "foo  ",
+    "xy", "aaa", "aaab", "abcde", "x{", "a{,2}", "]", "-", "_x", "5x",
+    ".*[", "b", "\xC3\xA9\xC3\xA9", "\xC3\xA9", "\xC3\xA9y", "\t",
+    "aBce", "abdE", "a\nc",
+};
+
+// Partially matches @p text with @p matcher @p num_times times, counting
+// the matches to @p num_matches.
+void MatchRepeatedly(PatternMatcher* matcher,
+                     const std::string& text,
+                     int num_times,
+                     int* num_matches) {
+  for (int i = 0; i < num_times; ++i) {
+    if (matcher->PartialMatch(text))
+      ++*num_matches;
+  }
+}
+
+class PatternMatcherTest : public testing::Test {
+ protected:
+  // Compares our matches with PCRE's for the @p num_patterns @p patterns
+  // and all the texts.
+  void ExpectSameAsPcre(const char* const* patterns,
+                        size_t num_patterns,
+                        int options) {
+    for (size_t i = 0; i < num_patterns; ++i) {
+      scoped_refptr<PatternMatcher> matcher(
+          PatternMatcher::Get(patterns[i], options));
+      EXPECT_TRUE(matcher->is_linear()) << patterns[i];
+
+      pcrecpp::RE re(patterns[i], options);
+      for (size_t j = 0; j < arraysize(kTexts); ++j) {
+        EXPECT_EQ(re.FullMatch(kTexts[j]), matcher->FullMatch(kTexts[j]))
+            << "\"" << patterns[i] << "\" on \"" << kTexts[j] << "\"";
+        EXPECT_EQ(re.PartialMatch(kTexts[j]),
+                  matcher->PartialMatch(kTexts[j]))
+            << "\"" << patterns[i] << "\" in \"" << kTexts[j] << "\"";
+      }
+    }
+  }
+};
+
+}  // namespace
+
+TEST_F(PatternMatcherTest, MatchesLikePcre) {
+  ExpectSameAsPcre(kPatterns, arraysize(kPatterns), kFilterOptions);
+}
+
+TEST_F(PatternMatcherTest, MatchesLikePcreWithDefaultOptions) {
+  ExpectSameAsPcre(kPatterns, arraysize(kPatterns), 0);
+}
+
+TEST_F(PatternMatcherTest, MatchesLikePcreInUtf8) {
+  ExpectSameAsPcre(kUtf8Patterns, arraysize(kUtf8Patterns),
+                   PCRE_UTF8 | PCRE_NEWLINE_ANYCRLF);
+  ExpectSameAsPcre(kUtf8Patterns, arraysize(kUtf8Patterns), 0);
+}
+
+TEST_F(PatternMatcherTest, Matches) {
+  scoped_refptr<PatternMatcher> matcher(
+      PatternMatcher::Get("I'm included", kFilterOptions));
+  EXPECT_TRUE(matcher->FullMatch("I'm Included"));
+  EXPECT_FALSE(matcher->FullMatch("I'm Included but also Excluded"));
+  EXPECT_TRUE(matcher->PartialMatch("I'm Included but also Excluded"));
+  EXPECT_FALSE(matcher->PartialMatch("I'm not included"));
+
+  matcher = PatternMatcher::Get("^(foo|bar)\\d{2}$", kFilterOptions);
+  EXPECT_TRUE(matcher->FullMatch("FOO42"));
+  EXPECT_TRUE(matcher->PartialMatch("bar12\r\n"));
+  EXPECT_FALSE(matcher->PartialMatch("xbar12"));
+  EXPECT_FALSE(matcher->PartialMatch("bar123"));
+
+  // In UTF8 mode, any character is one.
+  matcher = PatternMatcher::Get("^.$", kFilterOptions);
+  EXPECT_TRUE(matcher->FullMatch("\xE2\x82\xAC"));
+  EXPECT_TRUE(matcher->FullMatch("\n"));
+  EXPECT_FALSE(matcher->FullMatch("ab"));
+}
+
+TEST_F(PatternMatcherTest, FallsBackToPcre) {
+  const char* const kPatterns[] = {
+      "(a)\\1", "a(?=b)", "(?<!a)b", "\\bword\\b", "[[:alpha:]]", "a++",
+      "\\p{L}", "(?i)a", "\xC3\xA9",
+  };
+  for (size_t i = 0; i < arraysize(kPatterns); ++i) {
+    scoped_refptr<PatternMatcher> matcher(
+        PatternMatcher::Get(kPatterns[i], kFilterOptions));
+    EXPECT_FALSE(matcher->is_linear()) << kPatterns[i];
+  }
+
+  scoped_refptr<PatternMatcher> matcher(
+      PatternMatcher::Get("(\\w)\\1", kFilterOptions));
+  EXPECT_TRUE(matcher->PartialMatch("hello"));
+  EXPECT_FALSE(matcher->PartialMatch("helo"));
+}
+
+TEST_F(PatternMatcherTest, LinearInTheText) {
+  // PCRE backtracks exponentially on these.
+  scoped_refptr<PatternMatcher> matcher(
+      PatternMatcher::Get("(a*)*b", kFilterOptions));
+  ASSERT_TRUE(matcher->is_linear());
+
+  std::string text(100000, 'a');
+  base::TimeTicks start = base::TimeTicks::Now();
+  EXPECT_FALSE(matcher->PartialMatch(text));
+  EXPECT_FALSE(matcher->FullMatch(text));
+  text += 'b';
+  EXPECT_TRUE(matcher->FullMatch(text));
+  EXPECT_GT(5, (base::TimeTicks::Now() - start).InSeconds());
+}
+
+TEST_F(PatternMatcherTest, ManyDfaStates) {
+  // The DFA needs a state per distinct suffix seen, more than we keep.
+  scoped_refptr<PatternMatcher> matcher(
+      PatternMatcher::Get("[ab]*a[ab]{9}$", kFilterOptions));
+  ASSERT_TRUE(matcher->is_linear());
+
+  std::string text;
+  uint32 seed = 1;
+  for (int i = 0; i < 4000; ++i) {
+    seed = seed * 1103515245 + 12345;
+    text += (seed >> 16) & 1 ? 'a' : 'b';
+  }
+  EXPECT_EQ(text[text.size() - 10] == 'a', matcher->PartialMatch(text));
+  text += "abbbbbbbbb";
+  EXPECT_TRUE(matcher->PartialMatch(text));
+  text += "b";
+  EXPECT_FALSE(matcher->PartialMatch(text));
+}
+
+TEST_F(PatternMatcherTest, MatchesOnManyThreads) {
+  scoped_refptr<PatternMatcher> matcher(
+      PatternMatcher::Get("[ab]*a[ab]{3}$", kFilterOptions));
+  ASSERT_TRUE(matcher->is_linear());
+
+  // Each thread needs DFA states of its own, which mustn't get mixed up.
+  const int kNumTimes = 1000;
+  const char* const kThreadTexts[] = { "abababbb", "babababa" };
+  int num_matches[arraysize(kThreadTexts)] = {};
+  base::Thread first("First Thread");
+  base::Thread second("Second Thread");
+  base::Thread* threads[] = { &first, &second };
+  for (size_t i = 0; i < arraysize(threads); ++i) {
+    ASSERT_TRUE(threads[i]->Start());
+    threads[i]->message_loop()->PostTask(
+        FROM_HERE, base::Bind(&MatchRepeatedly, matcher,
+                              std::string(kThreadTexts[i]), kNumTimes,
+                              &num_matches[i]));
+  }
+  for (size_t i = 0; i < arraysize(threads); ++i)
+    threads[i]->Stop();
+
+  EXPECT_EQ(kNumTimes, num_matches[0]);
+  EXPECT_EQ(0, num_matches[1]);
+}
+
+TEST_F(PatternMatcherTest, SharesMatchers) {
+  scoped_refptr<PatternMatcher> matcher(
+      PatternMatcher::Get("shared", kFilterOptions));
+  EXPECT_EQ(matcher.get(),
+            PatternMatcher::Get("shared", kFilterOptions).get());
+  EXPECT_NE(matcher.get(), PatternMatcher::Get("shared", 0).get());
+  EXPECT_NE(matcher.get(),
+            PatternMatcher::Get("Shared", kFilterOptions).get());
+  EXPECT_EQ("shared", matcher->pattern());
+  EXPECT_EQ(kFilterOptions, matcher->options());
+}
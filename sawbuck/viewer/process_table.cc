@@ -0,0 +1,163 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Process table implementation.
+#include "sawbuck/viewer/process_table.h"
+
+#include "base/logging.h"
+#include "base/strings/utf_string_conversions.h"
+
+namespace {
+
+// @returns the file name of the executable of @p command_line, which may
+//     be quoted, or may be just the image name.
+std::string GetImageNameOfCommandLine(const std::wstring& command_line) {
+  std::wstring path;
+  if (!command_line.empty() && command_line[0] == L'"') {
+    size_t end = command_line.find(L'"', 1);
+    path = command_line.substr(1, end == std::wstring::npos ?
+                                      std::wstring::npos : end - 1);
+  } else {
+    path = command_line.substr(0, command_line.find(L' '));
+  }
+
+  size_t separator = path.find_last_of(L"\\/");
+  if (separator != std::wstring::npos)
+    path.erase(0, separator + 1);
+
+  return base::WideToUTF8(path);
+}
+
+}  // namespace
+
+const int ProcessTable::kUnknownImage;
+
+bool ProcessTable::Process::IsRunningAt(base::Time time) const {
+  return started <= time && (ended.is_null() || time < ended);
+}
+
+ProcessTable::ProcessTable() {
+  image_names_.push_back(std::string());
+  image_ids_.insert(std::make_pair(std::string(), kUnknownImage));
+}
+
+ProcessTable::~ProcessTable() {
+}
+
+void ProcessTable::OnProcessInfo(const IProcessInfoService::ProcessInfo& info) {
+  base::AutoLock lock(lock_);
+
+  std::vector<int>& ids = process_map_[info.process_id_];
+
+  // A process we know may have ended, or have been seen to end before it
+  // was seen to start.
+  for (size_t i = 0; i < ids.size(); ++i) {
+    Process& process = processes_[ids[i]];
+    if (process.bound &&
+        (process.started == info.started_ ||
+         (!process.ended.is_null() && process.ended == info.ended_))) {
+      process.started = info.started_;
+      process.ended = info.ended_;
+      return;
+    }
+  }
+
+  Process process = {};
+  process.process_id = info.process_id_;
+  process.bound = true;
+  process.started = info.started_;
+  process.ended = info.ended_;
+  process.image_id = InternImage(
+      GetImageNameOfCommandLine(info.command_line_));
+
+  // Bind the instance that logged before we knew its process, if any.
+  for (size_t i = 0; i < ids.size(); ++i) {
+    Process& unbound = processes_[ids[i]];
+    if (!unbound.bound && process.IsRunningAt(unbound.first_time)) {
+      process.first_time = unbound.first_time;
+      unbound = process;
+      return;
+    }
+  }
+
+  ids.push_back(processes_.size());
+  processes_.push_back(process);
+}
+
+int ProcessTable::AddMessage(DWORD process_id, const base::Time& time) {
+  base::AutoLock lock(lock_);
+
+  // Prefer the known process running at the time, and otherwise take the
+  // messages of the pid as being from the one process until it's known.
+  std::vector<int>& ids = process_map_[process_id];
+  int unbound_id = -1;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    Process& process = processes_[ids[i]];
+    if (!process.bound)
+      unbound_id = ids[i];
+    else if (process.IsRunningAt(time))
+      return ids[i];
+  }
+  if (unbound_id != -1)
+    return unbound_id;
+
+  Process process = {};
+  process.process_id = process_id;
+  process.bound = false;
+  process.first_time = time;
+  process.image_id = kUnknownImage;
+
+  int id = processes_.size();
+  ids.push_back(id);
+  processes_.push_back(process);
+
+  return id;
+}
+
+int ProcessTable::GetImageId(int process) const {
+  base::AutoLock lock(lock_);
+  DCHECK_LE(0, process);
+  if (static_cast<size_t>(process) >= processes_.size())
+    return kUnknownImage;
+
+  return processes_[process].image_id;
+}
+
+std::string ProcessTable::GetImageName(int image_id) const {
+  base::AutoLock lock(lock_);
+  DCHECK_LE(0, image_id);
+  if (static_cast<size_t>(image_id) >= image_names_.size())
+    return std::string();
+
+  return image_names_[image_id];
+}
+
+size_t ProcessTable::GetNumProcesses() const {
+  base::AutoLock lock(lock_);
+  return processes_.size();
+}
+
+int ProcessTable::InternImage(const std::string& name) {
+  lock_.AssertAcquired();
+
+  std::map<std::string, int>::iterator it(image_ids_.find(name));
+  if (it != image_ids_.end())
+    return it->second;
+
+  int image_id = image_names_.size();
+  image_names_.push_back(name);
+  image_ids_.insert(std::make_pair(name, image_id));
+
+  return image_id;
+}
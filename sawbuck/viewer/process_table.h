@@ -0,0 +1,94 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Process table declaration.
+#ifndef SAWBUCK_VIEWER_PROCESS_TABLE_H_
+#define SAWBUCK_VIEWER_PROCESS_TABLE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "sawbuck/log_lib/process_info_service.h"
+
+// Pids are reused, so the log store keeps the process instance of each
+// message rather than asking the process info service about its pid and
+// time on every read. The process table assigns each process instance a
+// small, dense id as messages are ingested, and interns the image names of
+// the processes, so that the image of a row is a lookup by id.
+// Messages may be logged before their process is known, notably when the
+// processes are only learned from the kernel's rundown at the end of a
+// log. Their instance is then bound to its process once it's known.
+// The table is safe to use from multiple threads.
+class ProcessTable : public ProcessInfoService::Observer {
+ public:
+  // The image of the processes we don't know yet.
+  static const int kUnknownImage = 0;
+
+  ProcessTable();
+  ~ProcessTable();
+
+  // ProcessInfoService::Observer implementation.
+  virtual void OnProcessInfo(const IProcessInfoService::ProcessInfo& info);
+
+  // Finds the instance of @p process_id that logged a message at @p time,
+  // adding an instance if it's new.
+  // @returns the id of the process instance.
+  int AddMessage(DWORD process_id, const base::Time& time);
+
+  // @returns the image of @p process, or kUnknownImage if we don't know the
+  //     process yet.
+  int GetImageId(int process) const;
+
+  // @returns the name of the image @p image_id, e.g. "chrome.exe", or an
+  //     empty string for kUnknownImage.
+  std::string GetImageName(int image_id) const;
+
+  // @returns the number of process instances.
+  size_t GetNumProcesses() const;
+
+ private:
+  struct Process {
+    DWORD process_id;
+    // True once we know the process, and its lifetime.
+    bool bound;
+    base::Time started;
+    base::Time ended;
+    // When the process first logged, which binds it to its process.
+    base::Time first_time;
+    int image_id;
+
+    // @returns true iff the process was running at @p time, where a null
+    //     start is before the log and a null end is after it.
+    bool IsRunningAt(base::Time time) const;
+  };
+  typedef std::map<DWORD, std::vector<int> > ProcessMap;
+
+  // @returns the id of the image @p name, adding it if it's new.
+  int InternImage(const std::string& name);
+
+  mutable base::Lock lock_;
+  // The process instances, indexed by id.
+  std::vector<Process> processes_;  // Under lock_.
+  // The ids of the instances of each pid.
+  ProcessMap process_map_;  // Under lock_.
+  // The image names, indexed by id, and their ids.
+  std::vector<std::string> image_names_;  // Under lock_.
+  std::map<std::string, int> image_ids_;  // Under lock_.
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessTable);
+};
+
+#endif  // SAWBUCK_VIEWER_PROCESS_TABLE_H_
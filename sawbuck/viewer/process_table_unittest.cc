@@ -0,0 +1,104 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Process table unittests.
+#include "sawbuck/viewer/process_table.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+const DWORD kPid = 0x10;
+const DWORD kOtherPid = 0x20;
+
+base::Time TimeAtMs(int64 ms) {
+  return base::Time::FromInternalValue((1000000 + ms) * 1000);
+}
+
+IProcessInfoService::ProcessInfo MakeProcess(DWORD process_id,
+                                             base::Time started,
+                                             base::Time ended,
+                                             const wchar_t* command_line) {
+  IProcessInfoService::ProcessInfo info = {};
+  info.started_ = started;
+  info.ended_ = ended;
+  info.process_id_ = process_id;
+  info.command_line_ = command_line;
+  return info;
+}
+
+TEST(ProcessTableTest, KnownProcesses) {
+  ProcessTable table;
+
+  table.OnProcessInfo(MakeProcess(kPid, base::Time(), base::Time(),
+      L"\"c:\\program files\\chrome\\chrome.exe\" --type=renderer"));
+  table.OnProcessInfo(MakeProcess(kOtherPid, TimeAtMs(10), base::Time(),
+                                  L"c:\\windows\\notepad.exe foo.txt"));
+
+  int chrome = table.AddMessage(kPid, TimeAtMs(0));
+  int notepad = table.AddMessage(kOtherPid, TimeAtMs(20));
+  EXPECT_NE(chrome, notepad);
+  EXPECT_EQ(chrome, table.AddMessage(kPid, TimeAtMs(30)));
+  EXPECT_EQ(2U, table.GetNumProcesses());
+
+  EXPECT_EQ("chrome.exe", table.GetImageName(table.GetImageId(chrome)));
+  EXPECT_EQ("notepad.exe", table.GetImageName(table.GetImageId(notepad)));
+}
+
+TEST(ProcessTableTest, ReusedPids) {
+  ProcessTable table;
+
+  table.OnProcessInfo(MakeProcess(kPid, TimeAtMs(0), TimeAtMs(10),
+                                  L"chrome.exe"));
+  table.OnProcessInfo(MakeProcess(kPid, TimeAtMs(20), base::Time(),
+                                  L"notepad.exe"));
+
+  int first = table.AddMessage(kPid, TimeAtMs(5));
+  int second = table.AddMessage(kPid, TimeAtMs(25));
+  EXPECT_NE(first, second);
+  EXPECT_EQ("chrome.exe", table.GetImageName(table.GetImageId(first)));
+  EXPECT_EQ("notepad.exe", table.GetImageName(table.GetImageId(second)));
+
+  // The images are interned.
+  table.OnProcessInfo(MakeProcess(kOtherPid, TimeAtMs(0), base::Time(),
+                                  L"chrome.exe"));
+  EXPECT_EQ(table.GetImageId(first),
+            table.GetImageId(table.AddMessage(kOtherPid, TimeAtMs(30))));
+}
+
+TEST(ProcessTableTest, LateBinding) {
+  ProcessTable table;
+
+  // The process logs before it's known.
+  int process = table.AddMessage(kPid, TimeAtMs(5));
+  EXPECT_EQ(process, table.AddMessage(kPid, TimeAtMs(6)));
+  EXPECT_EQ(ProcessTable::kUnknownImage, table.GetImageId(process));
+  EXPECT_EQ("", table.GetImageName(ProcessTable::kUnknownImage));
+
+  // The rundown tells of the process, which binds the instance.
+  table.OnProcessInfo(MakeProcess(kPid, base::Time(), base::Time(),
+                                  L"chrome.exe"));
+  EXPECT_EQ("chrome.exe", table.GetImageName(table.GetImageId(process)));
+  EXPECT_EQ(process, table.AddMessage(kPid, TimeAtMs(7)));
+  EXPECT_EQ(1U, table.GetNumProcesses());
+
+  // The process ends, and the pid is reused by a process we don't know.
+  table.OnProcessInfo(MakeProcess(kPid, base::Time(), TimeAtMs(10),
+                                  L"chrome.exe"));
+  int reused = table.AddMessage(kPid, TimeAtMs(20));
+  EXPECT_NE(process, reused);
+  EXPECT_EQ(ProcessTable::kUnknownImage, table.GetImageId(reused));
+}
+
+}  // namespace
@@ -0,0 +1,119 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Process tree implementation.
+#include "sawbuck/viewer/process_tree.h"
+
+bool ProcessTree::Lifetime::Contains(base::Time time) const {
+  return started <= time && (ended.is_null() || time < ended);
+}
+
+ProcessTree::ProcessTree(DWORD process_id, base::Time time)
+    : process_id_(process_id), time_(time) {
+  Members* members = new Members();
+  Lifetime root = { time_, base::Time() };
+  members->Add(process_id_, root);
+  members_ = members;
+}
+
+ProcessTree::~ProcessTree() {
+}
+
+void ProcessTree::OnProcessInfo(const IProcessInfoService::ProcessInfo& info) {
+  base::AutoLock lock(lock_);
+
+  Lifetime lifetime = { info.started_, info.ended_ };
+  bool is_root = info.process_id_ == process_id_ && lifetime.Contains(time_);
+
+  // A member we know of may have ended, or have been seen to end before
+  // it was seen to start. The root's lifetime replaces the one we assumed.
+  MemberMap::const_iterator it(members_->lifetimes_.find(info.process_id_));
+  if (it != members_->lifetimes_.end()) {
+    for (size_t i = 0; i < it->second.size(); ++i) {
+      const Lifetime& member = it->second[i];
+      if (member.started == lifetime.started ||
+          (!member.ended.is_null() && member.ended == lifetime.ended) ||
+          (is_root && member.Contains(time_))) {
+        Members* members = members_->Copy();
+        members->lifetimes_[info.process_id_][i] = lifetime;
+        members_ = members;
+        return;
+      }
+    }
+  }
+
+  if (!is_root &&
+      members_->Find(info.parent_process_id_, info.started_) == NULL) {
+    return;
+  }
+
+  Members* members = members_->Copy();
+  members->Add(info.process_id_, lifetime);
+  members_ = members;
+}
+
+scoped_refptr<const ProcessTree::Members> ProcessTree::GetMembers() const {
+  base::AutoLock lock(lock_);
+  return members_;
+}
+
+bool ProcessTree::Contains(DWORD process_id, base::Time time) const {
+  return GetMembers()->Contains(process_id, time);
+}
+
+ProcessTree::Members::Members() {
+}
+
+ProcessTree::Members::~Members() {
+}
+
+bool ProcessTree::Members::Contains(DWORD process_id,
+                                    base::Time time) const {
+  size_t index = GetPidIndex(process_id);
+  if (index >= pids_.size() || !pids_[index])
+    return false;
+
+  return Find(process_id, time) != NULL;
+}
+
+ProcessTree::Members* ProcessTree::Members::Copy() const {
+  Members* copy = new Members();
+  copy->pids_ = pids_;
+  copy->lifetimes_ = lifetimes_;
+  return copy;
+}
+
+void ProcessTree::Members::Add(DWORD process_id, const Lifetime& lifetime) {
+  size_t index = GetPidIndex(process_id);
+  if (index >= pids_.size())
+    pids_.resize(index + 1);
+  pids_[index] = true;
+
+  lifetimes_[process_id].push_back(lifetime);
+}
+
+const ProcessTree::Lifetime* ProcessTree::Members::Find(
+    DWORD process_id, base::Time time) const {
+  MemberMap::const_iterator it(lifetimes_.find(process_id));
+  if (it == lifetimes_.end())
+    return NULL;
+
+  Lifetimes::const_iterator member(it->second.begin());
+  for (; member != it->second.end(); ++member) {
+    if (member->Contains(time))
+      return &*member;
+  }
+
+  return NULL;
+}
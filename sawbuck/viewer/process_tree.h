@@ -0,0 +1,120 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Process tree declaration.
+#ifndef SAWBUCK_VIEWER_PROCESS_TREE_H_
+#define SAWBUCK_VIEWER_PROCESS_TREE_H_
+
+#include <map>
+#include <vector>
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "sawbuck/log_lib/process_info_service.h"
+
+// A process and all the processes it started, directly or not. Pids are
+// reused, so the tree has process instances, each a pid over a lifetime,
+// and a process belongs to the tree if the instance of its parent pid
+// running as it started does. The tree observes a process info service,
+// which tells it of the processes it already knows parents first, and of
+// the processes started from then on, so membership is settled once per
+// process rather than by walking the ancestry of each row.
+// The tree is safe to use from multiple threads. The members are published
+// as immutable snapshots, which readers check rows against without locking.
+class ProcessTree
+    : public base::RefCountedThreadSafe<ProcessTree>,
+      public ProcessInfoService::Observer {
+ public:
+  class Members;
+
+  // The tree of the instance of @p process_id that's running at @p time.
+  // That instance is a member from @p time on until the process info
+  // service tells us its lifetime.
+  ProcessTree(DWORD process_id, base::Time time);
+
+  // ProcessInfoService::Observer implementation.
+  virtual void OnProcessInfo(const IProcessInfoService::ProcessInfo& info);
+
+  // @returns the members as of now, to check any number of rows against.
+  scoped_refptr<const Members> GetMembers() const;
+
+  // @returns true iff the instance of @p process_id running at @p time is
+  //     in the tree.
+  bool Contains(DWORD process_id, base::Time time) const;
+
+  DWORD process_id() const { return process_id_; }
+  base::Time time() const { return time_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<ProcessTree>;
+  ~ProcessTree();
+
+  // The lifetime of a process instance, where a null start is before the
+  // log and a null end is after it.
+  struct Lifetime {
+    base::Time started;
+    base::Time ended;
+
+    bool Contains(base::Time time) const;
+  };
+  typedef std::vector<Lifetime> Lifetimes;
+  typedef std::map<DWORD, Lifetimes> MemberMap;
+
+  // Windows pids are multiples of four, so we index the pids by quarter.
+  static size_t GetPidIndex(DWORD process_id) { return process_id / 4; }
+
+  DWORD process_id_;
+  base::Time time_;
+
+  // Serializes the updates, which replace members_ with an updated copy.
+  mutable base::Lock lock_;
+  scoped_refptr<const Members> members_;  // Under lock_.
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessTree);
+};
+
+// A snapshot of the members of a process tree, which never changes.
+class ProcessTree::Members : public base::RefCountedThreadSafe<Members> {
+ public:
+  // @returns true iff the instance of @p process_id running at @p time is
+  //     a member.
+  bool Contains(DWORD process_id, base::Time time) const;
+
+ private:
+  friend class base::RefCountedThreadSafe<Members>;
+  friend class ProcessTree;
+
+  Members();
+  ~Members();
+
+  // @returns a copy of these members to update.
+  Members* Copy() const;
+
+  // Adds the instance of @p process_id over @p lifetime.
+  void Add(DWORD process_id, const Lifetime& lifetime);
+
+  // @returns the lifetime of the member instance of @p process_id running
+  //     at @p time, or NULL if there's none.
+  const Lifetime* Find(DWORD process_id, base::Time time) const;
+
+  // Whether each pid has had a member, indexed by GetPidIndex. This rules
+  // out the rows of most other processes without looking them up.
+  std::vector<bool> pids_;
+  // The lifetimes of the member instances of each pid.
+  MemberMap lifetimes_;
+
+  DISALLOW_COPY_AND_ASSIGN(Members);
+};
+
+#endif  // SAWBUCK_VIEWER_PROCESS_TREE_H_
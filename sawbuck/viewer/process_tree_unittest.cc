@@ -0,0 +1,140 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Process tree unittests.
+#include "sawbuck/viewer/process_tree.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+const DWORD kBrowserPid = 0x10;
+const DWORD kRendererPid = 0x20;
+const DWORD kGpuPid = 0x30;
+const DWORD kOtherPid = 0x40;
+
+base::Time TimeAtMs(int64 ms) {
+  return base::Time::FromInternalValue((1000000 + ms) * 1000);
+}
+
+IProcessInfoService::ProcessInfo MakeProcess(DWORD process_id,
+                                             DWORD parent_process_id,
+                                             base::Time started,
+                                             base::Time ended) {
+  IProcessInfoService::ProcessInfo info = {};
+  info.started_ = started;
+  info.ended_ = ended;
+  info.process_id_ = process_id;
+  info.parent_process_id_ = parent_process_id;
+  return info;
+}
+
+TEST(ProcessTreeTest, ContainsUnknownRoot) {
+  scoped_refptr<ProcessTree> tree(new ProcessTree(kBrowserPid, TimeAtMs(10)));
+
+  // The root is a member from its time on, even if it's never reported.
+  EXPECT_TRUE(tree->Contains(kBrowserPid, TimeAtMs(10)));
+  EXPECT_TRUE(tree->Contains(kBrowserPid, TimeAtMs(100)));
+  EXPECT_FALSE(tree->Contains(kBrowserPid, TimeAtMs(0)));
+  EXPECT_FALSE(tree->Contains(kOtherPid, TimeAtMs(10)));
+
+  // Once it is, its lifetime replaces the one assumed.
+  tree->OnProcessInfo(MakeProcess(kBrowserPid, 4, TimeAtMs(5),
+                                  TimeAtMs(50)));
+  EXPECT_TRUE(tree->Contains(kBrowserPid, TimeAtMs(5)));
+  EXPECT_FALSE(tree->Contains(kBrowserPid, TimeAtMs(50)));
+}
+
+TEST(ProcessTreeTest, MembersAreSnapshots) {
+  scoped_refptr<ProcessTree> tree(new ProcessTree(kBrowserPid, TimeAtMs(0)));
+  scoped_refptr<const ProcessTree::Members> before(tree->GetMembers());
+
+  tree->OnProcessInfo(MakeProcess(kRendererPid, kBrowserPid, TimeAtMs(10),
+                                  base::Time()));
+
+  EXPECT_FALSE(before->Contains(kRendererPid, TimeAtMs(10)));
+  EXPECT_TRUE(tree->GetMembers()->Contains(kRendererPid, TimeAtMs(10)));
+  EXPECT_TRUE(before->Contains(kBrowserPid, TimeAtMs(10)));
+}
+
+TEST(ProcessTreeTest, ContainsDescendants) {
+  scoped_refptr<ProcessTree> tree(new ProcessTree(kBrowserPid, TimeAtMs(50)));
+
+  // The browser was running before the log, and starts a renderer, which
+  // starts a GPU process. Another process runs alongside.
+  tree->OnProcessInfo(MakeProcess(kBrowserPid, 4, base::Time(),
+                                  base::Time()));
+  tree->OnProcessInfo(MakeProcess(kOtherPid, 4, base::Time(),
+                                  base::Time()));
+  tree->OnProcessInfo(MakeProcess(kRendererPid, kBrowserPid, TimeAtMs(10),
+                                  base::Time()));
+  tree->OnProcessInfo(MakeProcess(kGpuPid, kRendererPid, TimeAtMs(20),
+                                  base::Time()));
+
+  EXPECT_TRUE(tree->Contains(kBrowserPid, TimeAtMs(0)));
+  EXPECT_TRUE(tree->Contains(kRendererPid, TimeAtMs(10)));
+  EXPECT_TRUE(tree->Contains(kGpuPid, TimeAtMs(100)));
+  EXPECT_FALSE(tree->Contains(kOtherPid, TimeAtMs(100)));
+
+  // Not before they started.
+  EXPECT_FALSE(tree->Contains(kRendererPid, TimeAtMs(9)));
+
+  // The renderer ends, and its pid is reused by another process.
+  tree->OnProcessInfo(MakeProcess(kRendererPid, kBrowserPid, TimeAtMs(10),
+                                  TimeAtMs(30)));
+  tree->OnProcessInfo(MakeProcess(kRendererPid, kOtherPid, TimeAtMs(40),
+                                  base::Time()));
+
+  EXPECT_TRUE(tree->Contains(kRendererPid, TimeAtMs(29)));
+  EXPECT_FALSE(tree->Contains(kRendererPid, TimeAtMs(30)));
+  EXPECT_FALSE(tree->Contains(kRendererPid, TimeAtMs(40)));
+}
+
+TEST(ProcessTreeTest, RootIsTheInstanceRunningAtTime) {
+  scoped_refptr<ProcessTree> tree(new ProcessTree(kBrowserPid, TimeAtMs(50)));
+
+  // An earlier instance of the pid isn't the root, nor are its children.
+  tree->OnProcessInfo(MakeProcess(kBrowserPid, 4, TimeAtMs(0),
+                                  TimeAtMs(10)));
+  tree->OnProcessInfo(MakeProcess(kRendererPid, kBrowserPid, TimeAtMs(5),
+                                  base::Time()));
+  tree->OnProcessInfo(MakeProcess(kBrowserPid, 4, TimeAtMs(20),
+                                  base::Time()));
+
+  EXPECT_FALSE(tree->Contains(kBrowserPid, TimeAtMs(5)));
+  EXPECT_FALSE(tree->Contains(kRendererPid, TimeAtMs(50)));
+  EXPECT_TRUE(tree->Contains(kBrowserPid, TimeAtMs(20)));
+}
+
+TEST(ProcessTreeTest, ObservesService) {
+  ProcessInfoService service;
+
+  KernelProcessEvents::ProcessInfo browser = {
+      kBrowserPid, 4, 1, {}, "chrome.exe", L"chrome.exe" };
+  KernelProcessEvents::ProcessInfo renderer = {
+      kRendererPid, kBrowserPid, 1, {}, "chrome.exe", L"chrome.exe" };
+  service.OnProcessIsRunning(TimeAtMs(0), browser);
+
+  scoped_refptr<ProcessTree> tree(new ProcessTree(kBrowserPid, TimeAtMs(0)));
+  service.AddObserver(tree.get());
+  EXPECT_TRUE(tree->Contains(kBrowserPid, TimeAtMs(0)));
+
+  // Processes started live join the tree.
+  service.OnProcessStarted(TimeAtMs(10), renderer);
+  EXPECT_TRUE(tree->Contains(kRendererPid, TimeAtMs(10)));
+
+  service.RemoveObserver(tree.get());
+}
+
+}  // namespace
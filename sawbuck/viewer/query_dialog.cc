@@ -0,0 +1,229 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Query dialog implementation.
+#include "sawbuck/viewer/query_dialog.h"
+
+#include <algorithm>
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/task_runner_util.h"
+#include "base/win/scoped_bstr.h"
+
+const int64 QueryDialog::kQueryChunkRows;
+
+// The chunks read and evaluate their rows concurrently, and the dialog can
+// go away from under them once they're done reading.
+class QueryDialog::QueryJob : public base::RefCountedThreadSafe<QueryJob> {
+ public:
+  QueryJob(ILogView* log_view, const LogQuery& query)
+      : log_view_(log_view), query_(query) {
+  }
+
+  // @returns the partial result of the rows from @p start up to @p end, or
+  //     an empty result if we're cancelled.
+  LogQueryResult Run(int64 start, int64 end) {
+    LogRowBatch batch;
+    {
+      AutoReader reader(&guard_);
+      if (!reader.can_read())
+        return LogQueryResult();
+
+      ReadRows(start, end, &batch);
+    }
+
+    LogQueryResult result;
+    query_.Execute(batch, &result);
+    return result;
+  }
+
+  // Waits for any chunk reading the log view. The log view may go away
+  // after this returns.
+  void Cancel() {
+    guard_.Revoke();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<QueryJob>;
+  ~QueryJob() {
+  }
+
+  // Reads the columns the query reads of the rows from @p start up to
+  // @p end into @p batch.
+  void ReadRows(int64 start, int64 end, LogRowBatch* batch) {
+    std::vector<void*> trace;
+    for (int64 row = start; row < end; ++row) {
+      batch->rows.push_back(row);
+      if (query_.ReadsColumn(LogQuery::TIME))
+        batch->times.push_back(log_view_->GetTime(row).ToInternalValue());
+      if (query_.ReadsColumn(LogQuery::PROCESS_ID))
+        batch->process_ids.push_back(log_view_->GetProcessId(row));
+      if (query_.ReadsColumn(LogQuery::THREAD_ID))
+        batch->thread_ids.push_back(log_view_->GetThreadId(row));
+      if (query_.ReadsColumn(LogQuery::SEVERITY))
+        batch->severities.push_back(log_view_->GetSeverity(row));
+      if (query_.ReadsColumn(LogQuery::FILE))
+        batch->files.push_back(log_view_->GetFileName(row));
+      if (query_.ReadsColumn(LogQuery::LINE))
+        batch->lines.push_back(log_view_->GetLine(row));
+      if (query_.ReadsColumn(LogQuery::MESSAGE))
+        batch->messages.push_back(log_view_->GetMessage(row));
+      if (query_.ReadsColumn(LogQuery::STACK)) {
+        trace.clear();
+        log_view_->GetStackTrace(row, &trace);
+        batch->stacks.push_back(
+            LogQuery::GetStackId(trace.empty() ? NULL : &trace[0],
+                                 trace.size()));
+      }
+    }
+  }
+
+  ILogView* const log_view_;
+  // Guards the reads of |log_view_|.
+  ReaderGuard guard_;
+
+  const LogQuery query_;
+
+  DISALLOW_COPY_AND_ASSIGN(QueryJob);
+};
+
+QueryDialog::QueryDialog(ILogView* log_view,
+                         base::TaskRunner* runner,
+                         const std::string& text)
+    : log_view_(log_view), runner_(runner), text_(text), pending_chunks_(0),
+      weak_factory_(this) {
+  DCHECK(log_view != NULL);
+}
+
+QueryDialog::~QueryDialog() {
+  CancelQuery();
+}
+
+LRESULT QueryDialog::OnInitDialog(CWindow focus_window, LPARAM init_param) {
+  SetDlgItemText(IDC_QUERY_TEXT, base::UTF8ToWide(text_).c_str());
+
+  // Line up the columns of the results.
+  GetDlgItem(IDC_QUERY_RESULTS).SetFont(
+      static_cast<HFONT>(::GetStockObject(ANSI_FIXED_FONT)));
+
+  CWindow text_wnd(GetDlgItem(IDC_QUERY_TEXT));
+  text_wnd.SetFocus();
+  text_wnd.SendMessage(EM_SETSEL, 0, -1);
+  return FALSE;
+}
+
+LRESULT QueryDialog::OnRun(UINT notify_code, int id, CWindow window) {
+  CancelQuery();
+
+  base::win::ScopedBstr text;
+  GetDlgItem(IDC_QUERY_TEXT).GetWindowText(text.Receive());
+  base::WideToUTF8(text, text.Length(), &text_);
+  base::TrimWhitespaceASCII(text_, base::TRIM_ALL, &text_);
+
+  std::string error;
+  if (!query_.Parse(text_, &error)) {
+    ShowResult(error);
+    GetDlgItem(IDC_QUERY_TEXT).SetFocus();
+    return 0;
+  }
+
+  // Only the rows logged within the span of time of the query can match.
+  int64 start = 0;
+  int64 end = log_view_->GetNumRows();
+  base::Time earliest;
+  base::Time time_end;
+  query_.GetTimeSpan(&earliest, &time_end);
+  if (!earliest.is_null())
+    start = log_view_->FindFirstRowAtTime(earliest);
+  if (!time_end.is_null())
+    end = std::min(end, log_view_->FindEndOfRowsBefore(time_end));
+
+  result_ = LogQueryResult();
+  start_ticks_ = base::TimeTicks::Now();
+  job_ = new QueryJob(log_view_, query_);
+
+  scoped_refptr<base::TaskRunner> runner(runner_);
+  if (runner.get() == NULL)
+    runner = base::MessageLoopProxy::current();
+
+  // The chunks are evaluated in parallel, and merged in any order.
+  pending_chunks_ = 0;
+  for (int64 chunk = start; chunk < end; chunk += kQueryChunkRows) {
+    ++pending_chunks_;
+    base::PostTaskAndReplyWithResult(
+        runner.get(),
+        FROM_HERE,
+        base::Bind(&QueryJob::Run, job_, chunk,
+                   std::min(chunk + kQueryChunkRows, end)),
+        base::Bind(&QueryDialog::OnChunkDone,
+                   weak_factory_.GetWeakPtr(), job_));
+  }
+
+  if (pending_chunks_ == 0) {
+    // Finish with the empty result.
+    ++pending_chunks_;
+    OnChunkDone(job_.get(), LogQueryResult());
+    return 0;
+  }
+
+  GetDlgItem(IDC_QUERY_RUN).EnableWindow(FALSE);
+  ShowResult("Running...");
+  return 0;
+}
+
+LRESULT QueryDialog::OnClose(UINT notify_code, int id, CWindow window) {
+  CancelQuery();
+  EndDialog(IDCANCEL);
+  return 0;
+}
+
+void QueryDialog::OnChunkDone(QueryJob* job, const LogQueryResult& result) {
+  // Ignore the chunks of abandoned queries.
+  if (job != job_.get())
+    return;
+
+  query_.Merge(result, &result_);
+  DCHECK_LT(0, pending_chunks_);
+  if (--pending_chunks_ > 0)
+    return;
+
+  job_ = NULL;
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start_ticks_;
+  ShowResult(query_.Format(result_) +
+             base::Int64ToString(result_.num_matches()) +
+             " matching rows in " +
+             base::Int64ToString(elapsed.InMilliseconds()) + " ms.\n");
+  GetDlgItem(IDC_QUERY_RUN).EnableWindow(TRUE);
+}
+
+void QueryDialog::CancelQuery() {
+  // The chunks in flight must be done with the log view.
+  if (job_.get() != NULL)
+    job_->Cancel();
+  job_ = NULL;
+  pending_chunks_ = 0;
+
+  if (IsWindow())
+    GetDlgItem(IDC_QUERY_RUN).EnableWindow(TRUE);
+}
+
+void QueryDialog::ShowResult(const std::string& text) {
+  std::string lines(text);
+  ReplaceSubstringsAfterOffset(&lines, 0, "\n", "\r\n");
+  SetDlgItemText(IDC_QUERY_RESULTS, base::UTF8ToWide(lines).c_str());
+}
@@ -0,0 +1,97 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Query dialog declaration.
+#ifndef SAWBUCK_VIEWER_QUERY_DIALOG_H_
+#define SAWBUCK_VIEWER_QUERY_DIALOG_H_
+
+#include <atlbase.h>
+#include <atlcrack.h>
+#include <atlwin.h>
+#include <string>
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/task_runner.h"
+#include "base/time/time.h"
+#include "sawbuck/log_lib/log_query.h"
+#include "sawbuck/viewer/log_list_view.h"
+#include "resource.h"
+
+// Runs queries over the rows of a log view, and shows their results.
+// The rows are read and evaluated in chunks, in parallel, and the partial
+// results of the chunks merged as they come in.
+class QueryDialog : public CDialogImpl<QueryDialog> {
+ public:
+  enum { IDD = IDD_QUERYDIALOG };
+
+  // The rows we evaluate per chunk.
+  static const int64 kQueryChunkRows = 64 * 1024;
+
+  BEGIN_MSG_MAP(QueryDialog)
+    MSG_WM_INITDIALOG(OnInitDialog)
+    COMMAND_ID_HANDLER_EX(IDC_QUERY_RUN, OnRun)
+    COMMAND_ID_HANDLER_EX(IDCANCEL, OnClose)
+  END_MSG_MAP()
+
+  // @param log_view the view to query, which must be safe to call from the
+  //     threads of @p runner, and must outlive us.
+  // @param runner where the chunks are evaluated, or NULL to evaluate them
+  //     on the current message loop.
+  // @param text the UTF8 text of the query to start with.
+  QueryDialog(ILogView* log_view,
+              base::TaskRunner* runner,
+              const std::string& text);
+  ~QueryDialog();
+
+  LRESULT OnInitDialog(CWindow focus_window, LPARAM init_param);
+  LRESULT OnRun(UINT notify_code, int id, CWindow window);
+  LRESULT OnClose(UINT notify_code, int id, CWindow window);
+
+  // The UTF8 text of the last query run.
+  const std::string& text() const { return text_; }
+
+ protected:
+  // Evaluates chunks of rows of a log view, until it's cancelled.
+  class QueryJob;
+
+  // Invoked with the partial @p result of a chunk evaluated by @p job.
+  void OnChunkDone(QueryJob* job, const LogQueryResult& result);
+
+  // Stops the query running, if any.
+  void CancelQuery();
+
+  // Shows the UTF8 @p text as the result.
+  void ShowResult(const std::string& text);
+
+  ILogView* log_view_;
+  scoped_refptr<base::TaskRunner> runner_;
+  std::string text_;
+
+  // The query running or last run, and its result so far.
+  LogQuery query_;
+  LogQueryResult result_;
+  // The number of chunks of the running query yet to be merged.
+  int pending_chunks_;
+  base::TimeTicks start_ticks_;
+
+  // Reads log_view_ for the chunks we post.
+  scoped_refptr<QueryJob> job_;
+
+  // Drops the replies of the chunks in flight when we're destroyed.
+  base::WeakPtrFactory<QueryDialog> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(QueryDialog);
+};
+
+#endif  // SAWBUCK_VIEWER_QUERY_DIALOG_H_
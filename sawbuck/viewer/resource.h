@@ -27,6 +27,8 @@
 #define IDD_SYMBOLPATH                  106
 #define IDD_FINDDIALOG                  107
 #define IDD_FILTERDIALOG2               108
+#define IDD_GOTOTIMEDIALOG              109
+#define IDD_QUERYDIALOG                 110
 #define IDC_PROVIDERS                   1002
 #define IDC_EXCLUDE_RE                  1003
 #define IDC_INCLUDE_RE                  1004
@@ -47,6 +49,12 @@
 #define IDC_FILTER_SAVE                 1019
 #define IDC_BUTTON2                     1020
 #define IDC_FILTER_LOAD                 1021
+#define IDC_GOTO_FROM                   1022
+#define IDC_GOTO_TO                     1023
+#define IDC_GOTO_SET_BASE               1024
+#define IDC_QUERY_TEXT                  1025
+#define IDC_QUERY_RESULTS               1026
+#define IDC_QUERY_RUN                   1027
 #define ID_FILE_EXIT                    4001
 #define ID_FILE_IMPORT                  4002
 #define ID_LOG_CAPTURE                  4003
@@ -60,14 +68,18 @@
 #define ID_EDIT_AUTOSIZE_COLUMNS        4011
 #define ID_INCLUDE_COLUMN               4012
 #define ID_EXCLUDE_COLUMN               4013
+#define ID_EDIT_GO_TO_TIME              4014
+#define ID_SHOW_PROCESS_TREE            4015
+#define ID_SHOW_ALL_PROCESSES           4016
+#define ID_LOG_QUERY                    4017
 
 // Next default values for new objects
 //
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
-#define _APS_NEXT_RESOURCE_VALUE        109
-#define _APS_NEXT_COMMAND_VALUE         4013
-#define _APS_NEXT_CONTROL_VALUE         1022
+#define _APS_NEXT_RESOURCE_VALUE        111
+#define _APS_NEXT_COMMAND_VALUE         4018
+#define _APS_NEXT_CONTROL_VALUE         1028
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
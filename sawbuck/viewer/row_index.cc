@@ -0,0 +1,94 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Row index implementation.
+#include "sawbuck/viewer/row_index.h"
+
+#include <limits>
+#include "base/logging.h"
+
+const size_t RowIndex::kBlockSize;
+
+RowIndex::RowIndex() : size_(0) {
+}
+
+RowIndex::~RowIndex() {
+}
+
+void RowIndex::Append(int64 row) {
+  DCHECK_LE(0, row);
+  DCHECK(empty() || row > Get(size_ - 1));
+
+  if (size_ % kBlockSize == 0) {
+    blocks_.push_back(Block());
+    Block& block = blocks_.back();
+    block.first_row = row;
+    block.offsets.reserve(kBlockSize);
+  }
+
+  Block& block = blocks_.back();
+  uint64 offset = row - block.first_row;
+  if (block.rows.empty() && offset > std::numeric_limits<uint32>::max()) {
+    // Widen the block.
+    block.rows.reserve(kBlockSize);
+    for (size_t i = 0; i < block.offsets.size(); ++i)
+      block.rows.push_back(block.first_row + block.offsets[i]);
+    std::vector<uint32>().swap(block.offsets);
+  }
+
+  if (block.rows.empty())
+    block.offsets.push_back(static_cast<uint32>(offset));
+  else
+    block.rows.push_back(row);
+
+  ++size_;
+}
+
+void RowIndex::Append(const std::vector<int64>& rows) {
+  for (size_t i = 0; i < rows.size(); ++i)
+    Append(rows[i]);
+}
+
+int64 RowIndex::Get(int64 position) const {
+  DCHECK_LE(0, position);
+  DCHECK_LT(position, size_);
+
+  const Block& block = blocks_[static_cast<size_t>(position / kBlockSize)];
+  size_t index = static_cast<size_t>(position % kBlockSize);
+  if (!block.rows.empty())
+    return block.rows[index];
+
+  return block.first_row + block.offsets[index];
+}
+
+int64 RowIndex::LowerBound(int64 row) const {
+  int64 first = 0;
+  int64 count = size_;
+  while (count > 0) {
+    int64 step = count / 2;
+    if (Get(first + step) < row) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+
+  return first;
+}
+
+void RowIndex::Clear() {
+  blocks_.clear();
+  size_ = 0;
+}
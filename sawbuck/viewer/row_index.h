@@ -0,0 +1,73 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Row index declaration.
+#ifndef SAWBUCK_VIEWER_ROW_INDEX_H_
+#define SAWBUCK_VIEWER_ROW_INDEX_H_
+
+#include <deque>
+#include <vector>
+#include "base/basictypes.h"
+
+// An append-only list of increasing 64-bit row ids, e.g. the rows of a log
+// that pass a filter. The rows are kept in blocks of kBlockSize, each as
+// 32-bit offsets from the block's first row, which halves the memory of
+// 64-bit ids. A block whose rows span more than 32 bits of ids falls back
+// to 64-bit ids. Lookups by position are constant time.
+class RowIndex {
+ public:
+  static const size_t kBlockSize = 64 * 1024;
+
+  RowIndex();
+  ~RowIndex();
+
+  // Appends @p row, which must be greater than the last row.
+  void Append(int64 row);
+
+  // Appends @p rows, which must be increasing and greater than the last
+  // row.
+  void Append(const std::vector<int64>& rows);
+
+  // @returns the row at @p position, which must be less than size().
+  int64 Get(int64 position) const;
+
+  // @returns the position of the first row no less than @p row, or size()
+  //     if there's none.
+  int64 LowerBound(int64 row) const;
+
+  void Clear();
+
+  int64 size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  struct Block {
+    Block() : first_row(0) {
+    }
+
+    int64 first_row;
+    // The offsets of the rows from first_row, unless they don't all fit.
+    std::vector<uint32> offsets;
+    // The rows, once they don't fit in offsets.
+    std::vector<int64> rows;
+  };
+
+  // A deque doesn't copy the blocks as it grows.
+  std::deque<Block> blocks_;
+  int64 size_;
+
+  DISALLOW_COPY_AND_ASSIGN(RowIndex);
+};
+
+#endif  // SAWBUCK_VIEWER_ROW_INDEX_H_
@@ -0,0 +1,72 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Row index unittests.
+#include "sawbuck/viewer/row_index.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(RowIndexTest, Empty) {
+  RowIndex index;
+
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(0, index.size());
+  EXPECT_EQ(0, index.LowerBound(42));
+}
+
+TEST(RowIndexTest, AppendAndGet) {
+  RowIndex index;
+
+  // Span several blocks.
+  const int64 kNumRows = 3 * RowIndex::kBlockSize + 17;
+  for (int64 i = 0; i < kNumRows; ++i)
+    index.Append(i * 3 + 1);
+
+  ASSERT_EQ(kNumRows, index.size());
+  for (int64 i = 0; i < kNumRows; ++i)
+    ASSERT_EQ(i * 3 + 1, index.Get(i));
+
+  EXPECT_EQ(0, index.LowerBound(0));
+  EXPECT_EQ(0, index.LowerBound(1));
+  EXPECT_EQ(1, index.LowerBound(2));
+  EXPECT_EQ(1, index.LowerBound(4));
+  EXPECT_EQ(kNumRows, index.LowerBound(kNumRows * 3 + 1));
+
+  index.Clear();
+  EXPECT_TRUE(index.empty());
+}
+
+TEST(RowIndexTest, RowsBeyond32Bits) {
+  RowIndex index;
+
+  const int64 k4G = 1LL << 32;
+  std::vector<int64> rows;
+  rows.push_back(5);
+  rows.push_back(k4G);
+  // This doesn't fit in an offset from the first row of the block.
+  rows.push_back(k4G + 6);
+  rows.push_back(3 * k4G);
+  index.Append(rows);
+
+  ASSERT_EQ(4, index.size());
+  for (size_t i = 0; i < rows.size(); ++i)
+    EXPECT_EQ(rows[i], index.Get(i));
+
+  EXPECT_EQ(2, index.LowerBound(k4G + 1));
+  EXPECT_EQ(3, index.LowerBound(2 * k4G));
+}
+
+}  // namespace
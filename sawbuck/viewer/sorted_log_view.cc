@@ -0,0 +1,568 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Sorted log view implementation.
+#include "sawbuck/viewer/sorted_log_view.h"
+
+#include <algorithm>
+#include "base/atomicops.h"
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "sawbuck/log_lib/task_scheduler.h"
+
+namespace {
+
+// The number of rows each task of a job sorts.
+const int kSortChunkRows = 64 * 1024;
+
+// An original row and its sort key, while its chunk is sorted.
+struct Entry {
+  std::string key;
+  int64 row;
+};
+
+bool KeyLess(const std::string& a, const std::string& b, bool ascending) {
+  return ascending ? a < b : b < a;
+}
+
+class EntryLess {
+ public:
+  explicit EntryLess(bool ascending) : ascending_(ascending) {
+  }
+
+  bool operator()(const Entry& a, const Entry& b) const {
+    return KeyLess(a.key, b.key, ascending_);
+  }
+
+ private:
+  bool ascending_;
+};
+
+// Appends @p value to @p key big-endian with the sign bit flipped, so that
+// the keys of integers compare as the integers do.
+void AppendIntegerKey(int64 value, std::string* key) {
+  uint64 bits = static_cast<uint64>(value) ^ (1ULL << 63);
+  for (int shift = 56; shift >= 0; shift -= 8)
+    key->push_back(static_cast<char>((bits >> shift) & 0xFF));
+}
+
+// Gets the sort key of @p row of @p original on @p column into @p key.
+void GetSortKey(ILogView* original,
+                LogViewFormatter::Column column,
+                int64 row,
+                std::string* key) {
+  key->clear();
+  switch (column) {
+    case LogViewFormatter::SEVERITY:
+      AppendIntegerKey(original->GetSeverity(row), key);
+      break;
+    case LogViewFormatter::PROCESS_ID:
+      AppendIntegerKey(original->GetProcessId(row), key);
+      break;
+    case LogViewFormatter::THREAD_ID:
+      AppendIntegerKey(original->GetThreadId(row), key);
+      break;
+    case LogViewFormatter::TIME:
+      AppendIntegerKey(original->GetTime(row).ToInternalValue(), key);
+      break;
+    case LogViewFormatter::FILE:
+      *key = original->GetFileName(row);
+      break;
+    case LogViewFormatter::LINE:
+      AppendIntegerKey(original->GetLine(row), key);
+      break;
+    case LogViewFormatter::MESSAGE:
+      *key = original->GetMessage(row);
+      break;
+    case LogViewFormatter::PROCESS_IMAGE:
+      *key = original->GetImageName(original->GetImageId(row));
+      break;
+    default:
+      NOTREACHED() << "Impossible column.";
+      break;
+  }
+}
+
+}  // namespace
+
+class SortedLogView::SortedRun
+    : public base::RefCountedThreadSafe<SortedRun> {
+ public:
+  SortedRun() {
+  }
+
+  // Merges @p left and @p right into this empty run, taking their keys.
+  // Rows of @p left go first among equal keys, to keep the sort stable.
+  // @returns the position of the first row of @p right in the merged run.
+  size_t Merge(SortedRun* left, SortedRun* right, bool ascending);
+
+  // The original rows in sorted order, which the view reads.
+  std::vector<int64> rows;
+  // The sort keys of |rows|. Only the job that merges the next run into
+  // this one touches them, after the run is published.
+  std::vector<std::string> keys;
+
+ private:
+  friend class base::RefCountedThreadSafe<SortedRun>;
+  ~SortedRun() {
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(SortedRun);
+};
+
+size_t SortedLogView::SortedRun::Merge(SortedRun* left,
+                                       SortedRun* right,
+                                       bool ascending) {
+  DCHECK(rows.empty());
+
+  size_t size = left->rows.size() + right->rows.size();
+  rows.resize(size);
+  keys.resize(size);
+
+  size_t first_right = size;
+  size_t l = 0;
+  size_t r = 0;
+  for (size_t i = 0; i < size; ++i) {
+    bool take_right = l == left->rows.size() ||
+        (r < right->rows.size() &&
+         KeyLess(right->keys[r], left->keys[l], ascending));
+    if (take_right) {
+      if (first_right == size)
+        first_right = i;
+      rows[i] = right->rows[r];
+      keys[i].swap(right->keys[r]);
+      ++r;
+    } else {
+      rows[i] = left->rows[l];
+      keys[i].swap(left->keys[l]);
+      ++l;
+    }
+  }
+
+  return first_right;
+}
+
+// A job reads the keys of and sorts chunks of rows in parallel, then merges
+// the sorted runs pairwise in rounds, and finally merges the result into the
+// previous order.
+class SortedLogView::SortJob : public base::RefCountedThreadSafe<SortJob> {
+ public:
+  typedef base::Callback<void(SortJob*, SortedRun*, int64)> DoneCallback;
+
+  // @param original the view whose rows we sort.
+  // @param start, end the range of rows we sort.
+  // @param base the order of the rows before @p start.
+  // @param done invoked on the current thread with the new order and the
+  //     first row that changed in it, unless the job is cancelled.
+  SortJob(ILogView* original,
+          LogViewFormatter::Column column,
+          bool ascending,
+          int64 start,
+          int64 end,
+          SortedRun* base,
+          base::TaskRunner* runner,
+          const DoneCallback& done)
+      : original_(original),
+        column_(column),
+        ascending_(ascending),
+        start_(start),
+        end_(end),
+        base_(base),
+        runner_(runner),
+        origin_(base::MessageLoopProxy::current()),
+        done_(done),
+        token_(new CancellationToken()),
+        stride_(1),
+        pending_tasks_(0) {
+    DCHECK_LT(start_, end_);
+  }
+
+  // Posts the tasks that sort our chunks.
+  void Start();
+
+  // Abandons the job, and waits for any task reading the original view.
+  // The original view may go away after this returns.
+  void Cancel();
+
+  int64 end() const { return end_; }
+
+ private:
+  friend class base::RefCountedThreadSafe<SortJob>;
+  ~SortJob() {
+  }
+
+  void SortChunk(size_t chunk);
+  void MergeRuns(size_t left, size_t right);
+
+  // Posts the next round of merges after the last task of a round, or
+  // finishes the job after the last round.
+  void OnTaskDone();
+  void Finish();
+
+  ILogView* const original_;
+  // Guards the reads of |original_|.
+  ReaderGuard original_guard_;
+
+  LogViewFormatter::Column column_;
+  bool ascending_;
+  int64 start_;
+  int64 end_;
+  scoped_refptr<SortedRun> base_;
+  scoped_refptr<base::TaskRunner> runner_;
+  scoped_refptr<base::MessageLoopProxy> origin_;
+  DoneCallback done_;
+  scoped_refptr<CancellationToken> token_;
+
+  // The sorted runs, one per chunk to start with. Each round merges pairs
+  // of runs |stride_| apart into the first of the pair, until the first
+  // run holds all of them.
+  std::vector<scoped_refptr<SortedRun> > runs_;
+  size_t stride_;
+  // The tasks of the current round that haven't completed.
+  base::subtle::Atomic32 pending_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(SortJob);
+};
+
+void SortedLogView::SortJob::Start() {
+  size_t num_chunks = static_cast<size_t>(
+      (end_ - start_ + kSortChunkRows - 1) / kSortChunkRows);
+  for (size_t i = 0; i < num_chunks; ++i)
+    runs_.push_back(new SortedRun());
+
+  base::subtle::Release_Store(&pending_tasks_,
+                              static_cast<base::subtle::Atomic32>(num_chunks));
+  for (size_t i = 0; i < num_chunks; ++i) {
+    runner_->PostTask(FROM_HERE,
+                      base::Bind(&SortJob::SortChunk, this, i));
+  }
+}
+
+void SortedLogView::SortJob::Cancel() {
+  token_->Cancel();
+  original_guard_.Revoke();
+}
+
+void SortedLogView::SortJob::SortChunk(size_t chunk) {
+  int64 start = start_ + static_cast<int64>(chunk) * kSortChunkRows;
+  int64 end = std::min(start + kSortChunkRows, end_);
+
+  std::vector<Entry> entries(static_cast<size_t>(end - start));
+  {
+    AutoReader reader(&original_guard_);
+    if (!reader.can_read())
+      return;
+
+    for (int64 row = start; row < end; ++row) {
+      Entry& entry = entries[static_cast<size_t>(row - start)];
+      entry.row = row;
+      GetSortKey(original_, column_, row, &entry.key);
+    }
+  }
+
+  std::stable_sort(entries.begin(), entries.end(), EntryLess(ascending_));
+
+  SortedRun* run = runs_[chunk];
+  run->rows.resize(entries.size());
+  run->keys.resize(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) {
+    run->rows[i] = entries[i].row;
+    run->keys[i].swap(entries[i].key);
+  }
+
+  OnTaskDone();
+}
+
+void SortedLogView::SortJob::MergeRuns(size_t left, size_t right) {
+  if (token_->IsCancelled())
+    return;
+
+  scoped_refptr<SortedRun> merged(new SortedRun());
+  merged->Merge(runs_[left], runs_[right], ascending_);
+  runs_[left] = merged;
+  runs_[right] = NULL;
+
+  OnTaskDone();
+}
+
+void SortedLogView::SortJob::OnTaskDone() {
+  // The barrier publishes our run to whoever runs the next round.
+  if (base::subtle::Barrier_AtomicIncrement(&pending_tasks_, -1) != 0)
+    return;
+
+  if (stride_ >= runs_.size()) {
+    Finish();
+    return;
+  }
+
+  // Count the merges before posting any of them, as the last of them may
+  // complete the round before we're done posting.
+  size_t stride = stride_;
+  size_t num_merges = 0;
+  for (size_t i = 0; i + stride < runs_.size(); i += 2 * stride)
+    ++num_merges;
+
+  stride_ *= 2;
+  base::subtle::Release_Store(&pending_tasks_,
+                              static_cast<base::subtle::Atomic32>(num_merges));
+  for (size_t i = 0; i + stride < runs_.size(); i += 2 * stride) {
+    runner_->PostTask(FROM_HERE,
+                      base::Bind(&SortJob::MergeRuns, this, i, i + stride));
+  }
+}
+
+void SortedLogView::SortJob::Finish() {
+  if (token_->IsCancelled())
+    return;
+
+  // The new rows follow the previous ones in the original, so they go
+  // after them among equal keys.
+  scoped_refptr<SortedRun> order(runs_[0]);
+  size_t first_changed = 0;
+  if (base_.get() != NULL && !base_->rows.empty()) {
+    order = new SortedRun();
+    first_changed = order->Merge(base_, runs_[0], ascending_);
+  }
+  runs_.clear();
+  base_ = NULL;
+
+  origin_->PostTask(FROM_HERE,
+                    base::Bind(done_, make_scoped_refptr(this), order,
+                               static_cast<int64>(first_changed)));
+}
+
+SortedLogView::SortedLogView(ILogView* original,
+                             LogViewFormatter::Column column,
+                             bool ascending,
+                             base::TaskRunner* sort_runner)
+    : original_(original),
+      registration_cookie_(0),
+      column_(column),
+      ascending_(ascending),
+      order_(new SortedRun()),
+      sorted_rows_(0),
+      published_rows_(-1),
+      sort_runner_(sort_runner != NULL ? sort_runner :
+                       base::MessageLoopProxy::current().get()),
+      next_sink_cookie_(1),
+      weak_factory_(this) {
+  DCHECK(original_ != NULL);
+  DCHECK_LE(0, column_);
+  DCHECK_GT(LogViewFormatter::NUM_COLUMNS, column_);
+
+  original_->Register(this, &registration_cookie_);
+  PostSortTask();
+}
+
+SortedLogView::~SortedLogView() {
+  // Make sure we're not pinged post-destruction.
+  if (!task_.IsCancelled())
+    task_.Cancel();
+
+  // The job must be done with the original before it goes away.
+  if (job_.get() != NULL)
+    job_->Cancel();
+
+  original_->Unregister(registration_cookie_);
+}
+
+void SortedLogView::LogViewNewItems(int64 first_row, int64 num_rows) {
+  // Sort exactly the rows published to us.
+  published_rows_ = std::max(published_rows_, first_row + num_rows);
+  PostSortTask();
+}
+
+void SortedLogView::LogViewCleared() {
+  RestartSorting();
+  EventSinkMap::iterator it(event_sinks_.begin());
+  for (; it != event_sinks_.end(); ++it)
+    it->second->LogViewCleared();
+}
+
+int64 SortedLogView::GetNumRows() {
+  return order_->rows.size();
+}
+
+void SortedLogView::ClearAll() {
+  original_->ClearAll();
+}
+
+int SortedLogView::GetSeverity(int64 row) {
+  return original_->GetSeverity(GetOriginalRow(row));
+}
+
+DWORD SortedLogView::GetProcessId(int64 row) {
+  return original_->GetProcessId(GetOriginalRow(row));
+}
+
+DWORD SortedLogView::GetThreadId(int64 row) {
+  return original_->GetThreadId(GetOriginalRow(row));
+}
+
+base::Time SortedLogView::GetTime(int64 row) {
+  return original_->GetTime(GetOriginalRow(row));
+}
+
+std::string SortedLogView::GetFileName(int64 row) {
+  return original_->GetFileName(GetOriginalRow(row));
+}
+
+int SortedLogView::GetLine(int64 row) {
+  return original_->GetLine(GetOriginalRow(row));
+}
+
+std::string SortedLogView::GetMessage(int64 row) {
+  return original_->GetMessage(GetOriginalRow(row));
+}
+
+void SortedLogView::GetStackTrace(int64 row, std::vector<void*>* trace) {
+  return original_->GetStackTrace(GetOriginalRow(row), trace);
+}
+
+int SortedLogView::GetSiteId(int64 row) {
+  return original_->GetSiteId(GetOriginalRow(row));
+}
+
+int SortedLogView::GetTemplateId(int64 row) {
+  return original_->GetTemplateId(GetOriginalRow(row));
+}
+
+std::string SortedLogView::GetTemplateText(int template_id) {
+  return original_->GetTemplateText(template_id);
+}
+
+int SortedLogView::GetImageId(int64 row) {
+  return original_->GetImageId(GetOriginalRow(row));
+}
+
+std::string SortedLogView::GetImageName(int image_id) {
+  return original_->GetImageName(image_id);
+}
+
+int64 SortedLogView::FindFirstRowAtTime(base::Time time) {
+  // Rows sorted on another column aren't in time order, so all we can
+  // tell is that the log reaches the time somewhere in the view.
+  if (column_ != LogViewFormatter::TIME || !ascending_)
+    return 0;
+
+  return LowerBoundTime(time);
+}
+
+int64 SortedLogView::FindEndOfRowsBefore(base::Time time) {
+  if (column_ != LogViewFormatter::TIME || !ascending_)
+    return GetNumRows();
+
+  return LowerBoundTime(time);
+}
+
+int64 SortedLogView::LowerBoundTime(base::Time time) {
+  int64 first = 0;
+  int64 count = GetNumRows();
+  while (count > 0) {
+    int64 step = count / 2;
+    if (GetTime(first + step) < time) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+
+  return first;
+}
+
+int64 SortedLogView::GetOriginalRow(int64 row) {
+  DCHECK(row < GetNumRows());
+
+  return order_->rows[static_cast<size_t>(row)];
+}
+
+void SortedLogView::Register(ILogViewEvents* event_sink,
+                             int* registration_cookie) {
+  int cookie = next_sink_cookie_++;
+
+  event_sinks_.insert(std::make_pair(cookie, event_sink));
+  *registration_cookie = cookie;
+}
+
+void SortedLogView::Unregister(int registration_cookie) {
+  event_sinks_.erase(registration_cookie);
+}
+
+void SortedLogView::PostSortTask() {
+  // The job in flight posts again as it completes.
+  if (job_.get() != NULL)
+    return;
+
+  if (task_.IsCancelled()) {
+    task_.Reset(base::Bind(&SortedLogView::SortRows,
+                           base::Unretained(this)));
+    base::MessageLoop::current()->PostTask(FROM_HERE, task_.callback());
+  }
+}
+
+void SortedLogView::SortRows() {
+  task_.Cancel();
+
+  if (published_rows_ == -1)
+    published_rows_ = original_->GetNumRows();
+
+  if (sorted_rows_ == published_rows_)
+    return;
+
+  job_ = new SortJob(original_, column_, ascending_, sorted_rows_,
+                     published_rows_, order_, sort_runner_,
+                     base::Bind(&SortedLogView::OnRowsSorted,
+                                weak_factory_.GetWeakPtr()));
+  job_->Start();
+}
+
+void SortedLogView::RestartSorting() {
+  // Abandon the job in progress.
+  if (job_.get() != NULL) {
+    job_->Cancel();
+    job_ = NULL;
+  }
+
+  order_ = new SortedRun();
+  sorted_rows_ = 0;
+  published_rows_ = -1;
+  PostSortTask();
+}
+
+void SortedLogView::OnRowsSorted(SortJob* job,
+                                 SortedRun* order,
+                                 int64 first_changed) {
+  // Ignore abandoned jobs.
+  if (job != job_.get())
+    return;
+
+  order_ = order;
+  sorted_rows_ = job->end();
+  job_ = NULL;
+
+  // Post again if we're not done.
+  if (sorted_rows_ != published_rows_)
+    PostSortTask();
+
+  // Signal the rows that moved, along with the new ones.
+  int64 num_rows = GetNumRows() - first_changed;
+  if (num_rows != 0) {
+    EventSinkMap::iterator it(event_sinks_.begin());
+    for (; it != event_sinks_.end(); ++it)
+      it->second->LogViewNewItems(first_changed, num_rows);
+  }
+}
@@ -0,0 +1,141 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Sorted log view declaration.
+#ifndef SAWBUCK_VIEWER_SORTED_LOG_VIEW_H_
+#define SAWBUCK_VIEWER_SORTED_LOG_VIEW_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/cancelable_callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/task_runner.h"
+#include "sawbuck/viewer/log_list_view.h"
+
+// Provides a view on a log sorted on one of its columns. The sort is
+// stable, so rows with equal keys keep the order of the original view.
+//
+// The order is a permutation of the original rows. It's computed on a task
+// runner by sorting chunks of rows in parallel and merging the sorted runs
+// pairwise. Rows published by the original later are sorted into a run of
+// their own, which is merged into the order rather than re-sorting it. The
+// view shows the previous order until the new one is ready.
+class SortedLogView
+    : public ILogViewEvents,
+      public ILogView {
+ public:
+  // @param original the view to sort, which must be safe to call from the
+  //     threads of @p sort_runner.
+  // @param column the column to sort on.
+  // @param ascending true to sort in ascending order.
+  // @param sort_runner where we sort, or NULL to sort on the current
+  //     message loop.
+  SortedLogView(ILogView* original,
+                LogViewFormatter::Column column,
+                bool ascending,
+                base::TaskRunner* sort_runner);
+  ~SortedLogView();
+
+  // ILogViewEvents implementation.
+  // @{
+  virtual void LogViewNewItems(int64 first_row, int64 num_rows);
+  virtual void LogViewCleared();
+  // @}
+
+  // ILogView implementation.
+  // @{
+  virtual int64 GetNumRows();
+  virtual void ClearAll();
+  virtual int GetSeverity(int64 row);
+  virtual DWORD GetProcessId(int64 row);
+  virtual DWORD GetThreadId(int64 row);
+  virtual base::Time GetTime(int64 row);
+  virtual std::string GetFileName(int64 row);
+  virtual int GetLine(int64 row);
+  virtual std::string GetMessage(int64 row);
+  virtual void GetStackTrace(int64 row, std::vector<void*>* trace);
+  virtual int GetSiteId(int64 row);
+  virtual int GetTemplateId(int64 row);
+  virtual std::string GetTemplateText(int template_id);
+  virtual int GetImageId(int64 row);
+  virtual std::string GetImageName(int image_id);
+  virtual int64 FindFirstRowAtTime(base::Time time);
+  virtual int64 FindEndOfRowsBefore(base::Time time);
+  virtual void Register(ILogViewEvents* event_sink,
+                        int* registration_cookie);
+  virtual void Unregister(int registration_cookie);
+  // @}
+
+  LogViewFormatter::Column column() const { return column_; }
+  bool ascending() const { return ascending_; }
+
+ protected:
+  // The rows of |original_| in sorted order, along with their sort keys.
+  class SortedRun;
+
+  // Sorts a range of rows of |original_| on a task runner, and merges them
+  // into the order.
+  class SortJob;
+
+  // @returns the row of |original_| that is our @p row.
+  int64 GetOriginalRow(int64 row);
+
+  // @returns the first of our rows logged at or after @p time, when we're
+  //     sorted on ascending time.
+  int64 LowerBoundTime(base::Time time);
+
+  void PostSortTask();
+  void SortRows();
+  void RestartSorting();
+
+  // Invoked with the new @p order computed by @p job, in which our rows
+  // from @p first_changed on have changed.
+  void OnRowsSorted(SortJob* job, SortedRun* order, int64 first_changed);
+
+  ILogView* original_;
+  int registration_cookie_;
+
+  LogViewFormatter::Column column_;
+  bool ascending_;
+
+  // The sorted rows we publish.
+  scoped_refptr<SortedRun> order_;
+  // The number of rows of |original_| in |order_|.
+  int64 sorted_rows_;
+  // The number of rows |original_| has published to us, or -1 to sort all
+  // its rows after a restart.
+  int64 published_rows_;
+
+  typedef base::CancelableCallback<void()> SortCallback;
+
+  // Non-NULL if there's a task pending to sort additional rows.
+  SortCallback task_;
+
+  // The job sorting on |sort_runner_|, if any.
+  scoped_refptr<SortJob> job_;
+  // Where we sort.
+  scoped_refptr<base::TaskRunner> sort_runner_;
+
+  typedef std::map<int, ILogViewEvents*> EventSinkMap;
+  EventSinkMap event_sinks_;
+  int next_sink_cookie_;
+
+  // Vends the weak pointers our jobs reply to.
+  base::WeakPtrFactory<SortedLogView> weak_factory_;
+};
+
+#endif  // SAWBUCK_VIEWER_SORTED_LOG_VIEW_H_
@@ -0,0 +1,247 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Sorted log view unittests.
+#include "sawbuck/viewer/sorted_log_view.h"
+
+#include "base/run_loop.h"
+#include "base/message_loop/message_loop.h"
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "sawbuck/viewer/mock_log_view_interfaces.h"
+
+namespace {
+
+using testing::_;
+using testing::Invoke;
+using testing::Return;
+using testing::ReturnArg;
+using testing::SetArgumentPointee;
+using testing::StrictMock;
+
+// Queues the tasks posted to it until they're run.
+class QueueingTaskRunner : public base::TaskRunner {
+ public:
+  virtual bool PostDelayedTask(const tracked_objects::Location& from_here,
+                               const base::Closure& task,
+                               base::TimeDelta delay) {
+    tasks_.push_back(task);
+    return true;
+  }
+
+  virtual bool RunsTasksOnCurrentThread() const {
+    return true;
+  }
+
+  void RunTasks() {
+    while (!tasks_.empty()) {
+      base::Closure task = tasks_.front();
+      tasks_.erase(tasks_.begin());
+      task.Run();
+    }
+  }
+
+  size_t num_tasks() const { return tasks_.size(); }
+
+ private:
+  virtual ~QueueingTaskRunner() {
+  }
+
+  std::vector<base::Closure> tasks_;
+};
+
+// Many rows share each thread id, and rows of a thread are spread across
+// the log.
+DWORD ThreadIdOfRow(int64 row) {
+  return static_cast<DWORD>((row * 7919) % 1000);
+}
+
+std::string MessageOfRow(int64 row) {
+  return row % 2 == 0 ? "even" : "odd";
+}
+
+class SortedLogViewTest: public testing::Test {
+ public:
+  static const int kRegCookie = 42;
+
+  virtual void SetUp() {
+    EXPECT_CALL(mock_view_, Register(_, _))
+        .WillOnce(SetArgumentPointee<1>(kRegCookie));
+    EXPECT_CALL(mock_view_, GetThreadId(_))
+        .WillRepeatedly(Invoke(&ThreadIdOfRow));
+    EXPECT_CALL(mock_view_, GetMessage(_))
+        .WillRepeatedly(Invoke(&MessageOfRow));
+    // Identify the original rows by their line numbers.
+    EXPECT_CALL(mock_view_, GetLine(_))
+        .WillRepeatedly(ReturnArg<0>());
+  }
+
+  void ExpectUnregistration() {
+    EXPECT_CALL(mock_view_, Unregister(kRegCookie)).Times(1);
+  }
+
+  void RunMessageLoopToIdle() {
+    base::RunLoop run_loop;
+
+    run_loop.RunUntilIdle();
+  }
+
+  // Checks that @p sorted is sorted on thread id, and stable.
+  void ExpectSortedOnThreadId(SortedLogView* sorted, bool ascending) {
+    for (int64 row = 1; row < sorted->GetNumRows(); ++row) {
+      DWORD previous = sorted->GetThreadId(row - 1);
+      DWORD current = sorted->GetThreadId(row);
+      if (previous == current) {
+        EXPECT_LT(sorted->GetLine(row - 1), sorted->GetLine(row));
+      } else if (ascending) {
+        EXPECT_LT(previous, current);
+      } else {
+        EXPECT_GT(previous, current);
+      }
+    }
+  }
+
+ protected:
+  base::MessageLoop message_loop_;
+  StrictMock<testing::MockILogView> mock_view_;
+  StrictMock<testing::MockILogViewEvents> mock_view_events_;
+};
+
+TEST_F(SortedLogViewTest, Construction) {
+  SortedLogView sorted(&mock_view_, LogViewFormatter::THREAD_ID, true, NULL);
+
+  EXPECT_EQ(0, sorted.GetNumRows());
+  EXPECT_EQ(LogViewFormatter::THREAD_ID, sorted.column());
+  EXPECT_TRUE(sorted.ascending());
+
+  ExpectUnregistration();
+}
+
+TEST_F(SortedLogViewTest, DestroyWithJobPending) {
+  scoped_refptr<QueueingTaskRunner> sort_runner(new QueueingTaskRunner());
+  {
+    SortedLogView sorted(&mock_view_, LogViewFormatter::THREAD_ID, true,
+                         sort_runner);
+
+    // Start a job, but leave its tasks queued.
+    EXPECT_CALL(mock_view_, GetNumRows()).WillOnce(Return(1000));
+    RunMessageLoopToIdle();
+    EXPECT_NE(0U, sort_runner->num_tasks());
+
+    ExpectUnregistration();
+  }
+
+  // The abandoned job must neither read the original nor reply.
+  EXPECT_CALL(mock_view_, GetThreadId(_)).Times(0);
+  sort_runner->RunTasks();
+
+  // We hope not to crash here.
+  RunMessageLoopToIdle();
+}
+
+TEST_F(SortedLogViewTest, SortsStably) {
+  SortedLogView sorted(&mock_view_, LogViewFormatter::MESSAGE, true, NULL);
+  int cookie = 0;
+  sorted.Register(&mock_view_events_, &cookie);
+
+  const int kNumRows = 10;
+  EXPECT_CALL(mock_view_, GetNumRows()).WillOnce(Return(kNumRows));
+  EXPECT_CALL(mock_view_events_, LogViewNewItems(0, kNumRows)).Times(1);
+  RunMessageLoopToIdle();
+
+  // The even rows go first, and each keeps its original order.
+  ASSERT_EQ(kNumRows, sorted.GetNumRows());
+  for (int row = 0; row < kNumRows / 2; ++row) {
+    EXPECT_EQ(row * 2, sorted.GetLine(row));
+    EXPECT_EQ(row * 2 + 1, sorted.GetLine(row + kNumRows / 2));
+  }
+
+  ExpectUnregistration();
+}
+
+TEST_F(SortedLogViewTest, SortsManyChunks) {
+  SortedLogView sorted(&mock_view_, LogViewFormatter::THREAD_ID, true, NULL);
+
+  // Three chunks take two rounds of merges.
+  const int kNumRows = 150000;
+  EXPECT_CALL(mock_view_, GetNumRows()).WillOnce(Return(kNumRows));
+  RunMessageLoopToIdle();
+
+  ASSERT_EQ(kNumRows, sorted.GetNumRows());
+  ExpectSortedOnThreadId(&sorted, true);
+
+  ExpectUnregistration();
+}
+
+TEST_F(SortedLogViewTest, MergesPublishedRows) {
+  SortedLogView sorted(&mock_view_, LogViewFormatter::THREAD_ID, false,
+                       NULL);
+  int cookie = 0;
+  sorted.Register(&mock_view_events_, &cookie);
+
+  // Sort the empty view.
+  EXPECT_CALL(mock_view_, GetNumRows()).WillOnce(Return(0));
+  RunMessageLoopToIdle();
+  EXPECT_EQ(0, sorted.GetNumRows());
+
+  // Only the rows published so far are sorted.
+  EXPECT_CALL(mock_view_events_, LogViewNewItems(0, 1000)).Times(1);
+  sorted.LogViewNewItems(0, 1000);
+  RunMessageLoopToIdle();
+  ASSERT_EQ(1000, sorted.GetNumRows());
+  ExpectSortedOnThreadId(&sorted, false);
+
+  // Row 1000 has the smallest thread id, like row 0, which it follows.
+  // Only the new last row changes.
+  EXPECT_CALL(mock_view_events_, LogViewNewItems(1000, 1)).Times(1);
+  sorted.LogViewNewItems(1000, 1);
+  RunMessageLoopToIdle();
+  ASSERT_EQ(1001, sorted.GetNumRows());
+  EXPECT_EQ(1000, sorted.GetLine(1000));
+
+  // Row 1001 has a large thread id, so the rows after it change.
+  EXPECT_CALL(mock_view_events_, LogViewNewItems(_, _)).Times(1);
+  sorted.LogViewNewItems(1001, 100);
+  RunMessageLoopToIdle();
+  ASSERT_EQ(1101, sorted.GetNumRows());
+  ExpectSortedOnThreadId(&sorted, false);
+
+  ExpectUnregistration();
+}
+
+TEST_F(SortedLogViewTest, ClearRestartsSorting) {
+  SortedLogView sorted(&mock_view_, LogViewFormatter::THREAD_ID, true, NULL);
+  int cookie = 0;
+  sorted.Register(&mock_view_events_, &cookie);
+
+  EXPECT_CALL(mock_view_, GetNumRows()).WillOnce(Return(100));
+  EXPECT_CALL(mock_view_events_, LogViewNewItems(0, 100)).Times(1);
+  RunMessageLoopToIdle();
+  EXPECT_EQ(100, sorted.GetNumRows());
+
+  EXPECT_CALL(mock_view_, ClearAll()).Times(1);
+  sorted.ClearAll();
+
+  EXPECT_CALL(mock_view_events_, LogViewCleared()).Times(1);
+  sorted.LogViewCleared();
+  EXPECT_EQ(0, sorted.GetNumRows());
+
+  EXPECT_CALL(mock_view_, GetNumRows()).WillOnce(Return(0));
+  RunMessageLoopToIdle();
+  EXPECT_EQ(0, sorted.GetNumRows());
+
+  ExpectUnregistration();
+}
+
+}  // namespace
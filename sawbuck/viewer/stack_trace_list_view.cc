@@ -44,7 +44,8 @@ const wchar_t* StackTraceListView::kColumnWidthValueName =
     config::kStackTraceColumnWidths;
 
 StackTraceListView::StackTraceListView(CUpdateUIBase* update_ui)
-    : update_ui_(update_ui), lookup_service_(NULL), pid_(0) {
+    : update_ui_(update_ui), lookup_service_(NULL), pid_(0),
+      lookup_handle_(ISymbolLookupService::kInvalidHandle) {
   COMPILE_ASSERT(arraysize(kColumns) == COL_MAX,
                  wrong_number_of_column_names);
 }
@@ -61,14 +62,12 @@ void StackTraceListView::SetStackTrace(sym_util::ProcessId pid,
   pid_ = pid;
   time_ = time;
 
-  // Cancel any in-progress symbol resolutions.
-  TraceList::iterator it(trace_.begin());
-  for (; it != trace_.end(); ++it)
-    CancelResolution(&*it);
+  // Cancel any in-progress symbol resolution.
+  CancelResolution();
 
   trace_.clear();
   for (size_t i = 0; i < num_traces; ++i)
-    trace_.push_back(TraceItem(traces[i]));
+    trace_.push_back(reinterpret_cast<sym_util::Address>(traces[i]));
 
   DeleteAllItems();
 
@@ -82,6 +81,21 @@ void StackTraceListView::SetStackTrace(sym_util::ProcessId pid,
       SetItem(item, 1, LVIF_TEXT, LPSTR_TEXTCALLBACK, 0, 0, 0, NULL);
     }
   }
+
+  if (trace_.empty() || lookup_service_ == NULL)
+    return;
+
+  // Stacks are often revisited, so the service may already have this one.
+  // Otherwise resolve the whole stack in a single request.
+  ISymbolLookupService::ResolvedStack symbols;
+  if (lookup_service_->GetResolvedStack(pid_, time_, trace_, &symbols)) {
+    SetSymbols(symbols);
+  } else {
+    lookup_handle_ = lookup_service_->ResolveStack(
+        pid_, time_, trace_,
+        base::Bind(&StackTraceListView::StackResolved,
+                   base::Unretained(this)));
+  }
 }
 
 LRESULT StackTraceListView::OnCreate(UINT msg,
@@ -103,6 +117,7 @@ LRESULT StackTraceListView::OnCreate(UINT msg,
 }
 
 void StackTraceListView::OnDestroy() {
+  CancelResolution();
   SaveColumns();
 }
 
@@ -111,13 +126,11 @@ LRESULT StackTraceListView::OnGetDispInfo(NMHDR* pnmh) {
   int col = info->item.iSubItem;
   size_t row = info->item.iItem;
 
-  sym_util::Address address = trace_[row].address_;
+  sym_util::Address address = trace_[row];
 
   if (col == COL_ADDRESS) {
     item_text_ = StringPrintf(L"0x%08llX", address);
   } else {
-    EnsureResolution(&trace_[row]);
-
     switch (col) {
       case COL_MODULE:
         item_text_ = L"Resolving...";
@@ -148,43 +161,34 @@ LRESULT StackTraceListView::OnItemChanged(NMHDR* pnmh) {
   return 0;
 }
 
-void StackTraceListView::EnsureResolution(TraceItem* item) {
-  DCHECK(item != NULL);
-  if (item->lookup_handle_ != ISymbolLookupService::kInvalidHandle)
+void StackTraceListView::CancelResolution() {
+  if (lookup_handle_ == ISymbolLookupService::kInvalidHandle)
     return;
 
   DCHECK(lookup_service_ != NULL);
-  item->lookup_handle_ = lookup_service_->ResolveAddress(
-      pid_, time_, item->address_,
-      base::Bind(&StackTraceListView::SymbolResolved,
-                 base::Unretained(this)));
+  lookup_service_->CancelRequest(lookup_handle_);
+  lookup_handle_ = ISymbolLookupService::kInvalidHandle;
 }
 
-void StackTraceListView::CancelResolution(TraceItem* item) {
-  DCHECK(item != NULL);
-  if (item->lookup_handle_ == ISymbolLookupService::kInvalidHandle)
-    return;
+void StackTraceListView::StackResolved(sym_util::ProcessId pid,
+    base::Time time, ISymbolLookupService::Handle handle,
+    const ISymbolLookupService::ResolvedStack& symbols) {
+  // We cancel superseded requests, so this must be for the current stack.
+  DCHECK_EQ(lookup_handle_, handle);
+  // No longer pending, make sure we don't cancel it later.
+  lookup_handle_ = ISymbolLookupService::kInvalidHandle;
 
-  DCHECK(lookup_service_ != NULL);
-  lookup_service_->CancelRequest(item->lookup_handle_);
-  item->lookup_handle_ = ISymbolLookupService::kInvalidHandle;
+  SetSymbols(symbols);
 }
 
-void StackTraceListView::SymbolResolved(sym_util::ProcessId pid,
-    base::Time time, sym_util::Address address,
-    ISymbolLookupService::Handle handle, const sym_util::Symbol& symbol) {
-
-  size_t row = 0;
-  for (; row < trace_.size(); ++row) {
-    if (trace_[row].lookup_handle_ == handle)
-      break;
-  }
-
-  // We should always find our associated handle.
-  DCHECK(trace_[row].lookup_handle_ == handle);
-  // No longer pending, make sure we don't cancel it later.
-  trace_[row].lookup_handle_ = ISymbolLookupService::kInvalidHandle;
+void StackTraceListView::SetSymbols(
+    const ISymbolLookupService::ResolvedStack& symbols) {
+  DCHECK_EQ(trace_.size(), symbols.size());
+  for (size_t row = 0; row < symbols.size(); ++row)
+    SetSymbol(row, symbols[row]);
+}
 
+void StackTraceListView::SetSymbol(int row, const sym_util::Symbol& symbol) {
   for (int col = COL_MODULE; col < COL_MAX; ++col) {
     std::wstring item_text;
     switch (col) {
@@ -100,26 +100,17 @@ class StackTraceListView
   LRESULT OnGetDispInfo(NMHDR* notification);
   LRESULT OnItemChanged(NMHDR* notification);
 
-  struct TraceItem {
-    explicit TraceItem(void* address)
-        : lookup_handle_(ISymbolLookupService::kInvalidHandle),
-          address_(reinterpret_cast<sym_util::Address>(address)) {
-    }
-
-    // The lookup handle while a lookup is pending for address_.
-    ISymbolLookupService::Handle lookup_handle_;
-    sym_util::Address address_;
-  };
+  // Cancel the resolution pending for the current stack, if any.
+  void CancelResolution();
 
-  // Start resolving the address in item, unless it's already being resolved.
-  void EnsureResolution(TraceItem* item);
-  // Cancel any resolution pending for item.
-  void CancelResolution(TraceItem* item);
+  // Callback for stack resolution.
+  void StackResolved(sym_util::ProcessId pid, base::Time time,
+      ISymbolLookupService::Handle handle,
+      const ISymbolLookupService::ResolvedStack& symbols);
 
-  // Callback for symbol resolution.
-  void SymbolResolved(sym_util::ProcessId pid, base::Time time,
-      sym_util::Address address, ISymbolLookupService::Handle handle,
-      const sym_util::Symbol& symbol);
+  // Display the resolved symbols of the current stack.
+  void SetSymbols(const ISymbolLookupService::ResolvedStack& symbols);
+  void SetSymbol(int row, const sym_util::Symbol& symbol);
 
   CUpdateUIBase* update_ui_;
 
@@ -129,8 +120,10 @@ class StackTraceListView
   // The current stack trace we're displaying.
   sym_util::ProcessId pid_;
   base::Time time_;
-  typedef std::vector<TraceItem> TraceList;
-  TraceList trace_;
+  ISymbolLookupService::StackTrace trace_;
+
+  // The lookup handle while a lookup is pending for trace_.
+  ISymbolLookupService::Handle lookup_handle_;
 
   // Temporary storage for strings returned from OnGetDispInfo.
   std::wstring item_text_;
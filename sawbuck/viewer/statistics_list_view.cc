@@ -0,0 +1,263 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Statistics list view implementation.
+#include "sawbuck/viewer/statistics_list_view.h"
+
+#include <algorithm>
+#include "base/strings/stringprintf.h"
+#include "base/strings/utf_string_conversions.h"
+#include "sawbuck/viewer/const_config.h"
+
+using base::StringPrintf;
+
+const StatisticsListView::ColumnInfo StatisticsListView::kColumns[] = {
+  { 180, L"File" },
+  { 42, L"Line" },
+  { 60, L"Severity" },
+  { 60, L"Count" },
+  { 50, L"Rate/s" },
+  { 42, L"%" },
+  { 46, L"Muted" },
+};
+
+const wchar_t* StatisticsListView::kConfigKeyName =
+    config::kSettingsKey;
+const wchar_t* StatisticsListView::kColumnOrderValueName =
+    config::kStatisticsColumnOrder;
+const wchar_t* StatisticsListView::kColumnWidthValueName =
+    config::kStatisticsColumnWidths;
+
+class StatisticsListView::SiteOrder {
+ public:
+  SiteOrder(const std::vector<LogSiteTable::Site>& sites,
+            Columns column,
+            bool ascending)
+      : sites_(sites), column_(column), ascending_(ascending) {
+  }
+
+  bool operator()(int a, int b) const {
+    return ascending_ ? Less(sites_[a], sites_[b]) :
+                        Less(sites_[b], sites_[a]);
+  }
+
+ private:
+  bool Less(const LogSiteTable::Site& a, const LogSiteTable::Site& b) const {
+    switch (column_) {
+      case COL_FILE:
+        if (a.file != b.file)
+          return a.file < b.file;
+        return a.line < b.line;
+
+      case COL_LINE:
+        return a.line < b.line;
+
+      case COL_SEVERITY:
+        return a.severity < b.severity;
+
+      case COL_RATE:
+        return a.MessagesPerSecond() < b.MessagesPerSecond();
+
+      case COL_MUTED:
+        return a.muted < b.muted;
+
+      case COL_COUNT:
+      case COL_PERCENT:
+      default:
+        return a.count < b.count;
+    }
+  }
+
+  const std::vector<LogSiteTable::Site>& sites_;
+  Columns column_;
+  bool ascending_;
+};
+
+StatisticsListView::StatisticsListView()
+    : log_view_(NULL), event_cookie_(0), site_table_(NULL), num_messages_(0),
+      sort_column_(COL_COUNT), sort_ascending_(false) {
+  COMPILE_ASSERT(arraysize(kColumns) == COL_MAX,
+                 wrong_number_of_column_names);
+}
+
+StatisticsListView::~StatisticsListView() {
+}
+
+void StatisticsListView::SetLogView(ILogView* log_view) {
+  if (log_view_ == log_view)
+    return;
+
+  if (log_view_ != NULL) {
+    log_view_->Unregister(event_cookie_);
+    event_cookie_ = 0;
+  }
+
+  log_view_ = log_view;
+  if (log_view_ != NULL)
+    log_view_->Register(this, &event_cookie_);
+
+  if (IsWindow())
+    Update();
+}
+
+void StatisticsListView::SetLogSiteTable(LogSiteTable* site_table) {
+  site_table_ = site_table;
+
+  if (IsWindow())
+    Update();
+}
+
+void StatisticsListView::LogViewNewItems(int64 first_row, int64 num_rows) {
+  if (IsWindow())
+    Update();
+}
+
+void StatisticsListView::LogViewCleared() {
+  if (IsWindow())
+    Update();
+}
+
+LRESULT StatisticsListView::OnCreate(UINT msg,
+                                     WPARAM wparam,
+                                     LPARAM lparam,
+                                     BOOL& handled) {
+  // Call through to the original window class first.
+  LRESULT ret = DefWindowProc(msg, wparam, lparam);
+
+  AddColumns();
+
+  // Tweak our extended styles.
+  SetExtendedListViewStyle(LVS_EX_HEADERDRAGDROP |
+                           LVS_EX_FULLROWSELECT |
+                           LVS_EX_DOUBLEBUFFER);
+
+  Update();
+
+  return ret;
+}
+
+void StatisticsListView::OnDestroy() {
+  if (log_view_ != NULL) {
+    log_view_->Unregister(event_cookie_);
+    event_cookie_ = 0;
+  }
+  SaveColumns();
+}
+
+LRESULT StatisticsListView::OnGetDispInfo(NMHDR* pnmh) {
+  NMLVDISPINFO* info = reinterpret_cast<NMLVDISPINFO*>(pnmh);
+  size_t row = info->item.iItem;
+  if (row >= rows_.size())
+    return 0;
+
+  const LogSiteTable::Site& site = sites_[rows_[row]];
+  switch (info->item.iSubItem) {
+    case COL_FILE:
+      item_text_ = base::UTF8ToWide(site.file);
+      break;
+
+    case COL_LINE:
+      item_text_ = StringPrintf(L"%d", site.line);
+      break;
+
+    case COL_SEVERITY:
+      item_text_ = base::ASCIIToWide(
+          LogViewFormatter::GetSeverityText(site.severity));
+      break;
+
+    case COL_COUNT:
+      item_text_ = StringPrintf(L"%Iu", site.count);
+      break;
+
+    case COL_RATE:
+      item_text_ = StringPrintf(L"%.1f", site.MessagesPerSecond());
+      break;
+
+    case COL_PERCENT:
+      item_text_ = StringPrintf(L"%.1f",
+          num_messages_ == 0 ? 0.0 : 100.0 * site.count / num_messages_);
+      break;
+
+    case COL_MUTED:
+      item_text_ = site.muted ? L"Yes" : L"";
+      break;
+
+    default:
+      NOTREACHED();
+      break;
+  }
+
+  if (info->item.mask & LVIF_TEXT)
+    info->item.pszText = const_cast<LPWSTR>(item_text_.c_str());
+
+  return 0;
+}
+
+LRESULT StatisticsListView::OnColumnClick(NMHDR* pnmh) {
+  NMLISTVIEW* info = reinterpret_cast<NMLISTVIEW*>(pnmh);
+  if (info->iSubItem < 0 || info->iSubItem >= COL_MAX)
+    return 0;
+
+  // Clicking the sort column again reverses the order. Text sorts
+  // ascending by default, numbers descending.
+  Columns column = static_cast<Columns>(info->iSubItem);
+  if (column == sort_column_) {
+    sort_ascending_ = !sort_ascending_;
+  } else {
+    sort_column_ = column;
+    sort_ascending_ = (column == COL_FILE);
+  }
+
+  Update();
+  return 0;
+}
+
+LRESULT StatisticsListView::OnDoubleClick(NMHDR* pnmh) {
+  NMITEMACTIVATE* info = reinterpret_cast<NMITEMACTIVATE*>(pnmh);
+  if (info->iItem < 0 || static_cast<size_t>(info->iItem) >= rows_.size())
+    return 0;
+
+  DCHECK(site_table_ != NULL);
+  int site_id = rows_[info->iItem];
+  site_table_->SetMuted(site_id, !sites_[site_id].muted);
+
+  Update();
+
+  if (!mute_callback_.is_null())
+    mute_callback_.Run();
+
+  return 0;
+}
+
+void StatisticsListView::Update() {
+  sites_.clear();
+  if (site_table_ != NULL)
+    site_table_->GetSites(&sites_);
+
+  // Display the sites that logged since the log was last cleared, and the
+  // muted sites so that they can be unmuted.
+  num_messages_ = 0;
+  rows_.clear();
+  for (size_t i = 0; i < sites_.size(); ++i) {
+    num_messages_ += sites_[i].count;
+    if (sites_[i].count != 0 || sites_[i].muted)
+      rows_.push_back(i);
+  }
+
+  std::stable_sort(rows_.begin(), rows_.end(),
+                   SiteOrder(sites_, sort_column_, sort_ascending_));
+
+  SetItemCountEx(rows_.size(), LVSICF_NOSCROLL);
+  Invalidate();
+}
@@ -0,0 +1,135 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Statistics list view window.
+#ifndef SAWBUCK_VIEWER_STATISTICS_LIST_VIEW_H_
+#define SAWBUCK_VIEWER_STATISTICS_LIST_VIEW_H_
+
+#include <atlbase.h>
+#include <atlapp.h>
+#include <atlcrack.h>
+#include <atlctrls.h>
+#include <atlmisc.h>
+#include <string>
+#include <vector>
+#include "base/callback.h"
+#include "sawbuck/viewer/list_view_base.h"
+#include "sawbuck/viewer/log_list_view.h"
+#include "sawbuck/viewer/log_site_table.h"
+
+typedef CWinTraits<WS_CHILD | WS_VISIBLE | WS_CLIPCHILDREN | WS_CLIPSIBLINGS |
+    LVS_REPORT | LVS_OWNERDATA> StatisticsListViewTraits;
+
+// List view control subclass that keeps a live summary of the sites of a
+// log, showing how much and how fast each file/line logs. The summary is
+// read from the log site table as rows are added to the log, and can be
+// sorted on any column. Double-clicking a site mutes or unmutes it.
+class StatisticsListView
+    : public ListViewBase<StatisticsListView, StatisticsListViewTraits>,
+      public ILogViewEvents {
+ public:
+  typedef ListViewBase<StatisticsListView, StatisticsListViewTraits>
+      WindowBase;
+  DECLARE_WND_SUPERCLASS(NULL, WindowBase::GetWndClassName())
+
+  BEGIN_MSG_MAP_EX(StatisticsListView)
+    MESSAGE_HANDLER(WM_CREATE, OnCreate)
+    MSG_WM_DESTROY(OnDestroy)
+    REFLECTED_NOTIFY_CODE_HANDLER_EX(LVN_GETDISPINFO, OnGetDispInfo)
+    REFLECTED_NOTIFY_CODE_HANDLER_EX(LVN_COLUMNCLICK, OnColumnClick)
+    REFLECTED_NOTIFY_CODE_HANDLER_EX(NM_DBLCLK, OnDoubleClick)
+    DEFAULT_REFLECTION_HANDLER()
+  END_MSG_MAP()
+
+  StatisticsListView();
+  ~StatisticsListView();
+
+  // Updates the summary as rows are added to @p log_view.
+  void SetLogView(ILogView* log_view);
+
+  // Summarizes the sites of @p site_table.
+  void SetLogSiteTable(LogSiteTable* site_table);
+
+  // Sets a callback to invoke when the user mutes or unmutes a site.
+  void set_mute_callback(const base::Closure& mute_callback) {
+    mute_callback_ = mute_callback;
+  }
+
+  // ILogViewEvents implementation.
+  virtual void LogViewNewItems(int64 first_row, int64 num_rows);
+  virtual void LogViewCleared();
+
+  // Our column definitions and config data to satisfy our contract
+  // to the ListViewImpl superclass.
+  static const ColumnInfo kColumns[];
+  static const wchar_t* kConfigKeyName;
+  static const wchar_t* kColumnOrderValueName;
+  static const wchar_t* kColumnWidthValueName;
+
+ private:
+  // The columns our list view displays.
+  // @note COL_MAX must be equal to arraysize(kColumns).
+  enum Columns {
+    COL_FILE,
+    COL_LINE,
+    COL_SEVERITY,
+    COL_COUNT,
+    COL_RATE,
+    COL_PERCENT,
+    COL_MUTED,
+
+    // Must be last.
+    COL_MAX,
+  };
+
+  LRESULT OnCreate(UINT msg, WPARAM wparam, LPARAM lparam, BOOL& handled);
+  void OnDestroy();
+  LRESULT OnGetDispInfo(NMHDR* notification);
+  LRESULT OnColumnClick(NMHDR* notification);
+  LRESULT OnDoubleClick(NMHDR* notification);
+
+  // Reads the sites from the site table, sorts them and refreshes the
+  // display.
+  void Update();
+
+  // Orders site ids by the sort column of a list view.
+  class SiteOrder;
+
+  // The log view whose additions we track, and our registration cookie
+  // with it.
+  ILogView* log_view_;
+  int event_cookie_;
+
+  // The table of the sites we summarize.
+  LogSiteTable* site_table_;
+
+  // Our copy of the sites, indexed by site id.
+  std::vector<LogSiteTable::Site> sites_;
+  // The total number of messages logged from sites_.
+  size_t num_messages_;
+
+  // The ids of the sites we display, in display order.
+  std::vector<int> rows_;
+
+  // The column we sort on, and the direction.
+  Columns sort_column_;
+  bool sort_ascending_;
+
+  base::Closure mute_callback_;
+
+  // Temporary storage for strings returned from OnGetDispInfo.
+  std::wstring item_text_;
+};
+
+#endif  // SAWBUCK_VIEWER_STATISTICS_LIST_VIEW_H_
@@ -0,0 +1,82 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// String arena implementation.
+#include "sawbuck/viewer/string_arena.h"
+
+#include <algorithm>
+#include "base/logging.h"
+
+const size_t StringArena::kChunkSize;
+
+StringArena::StringArena() : next_(NULL), end_(NULL), bytes_used_(0) {
+}
+
+StringArena::~StringArena() {
+  Clear();
+}
+
+base::StringPiece StringArena::AppendString(const base::StringPiece& str) {
+  if (str.empty())
+    return base::StringPiece();
+
+  char* copy = reinterpret_cast<char*>(Allocate(str.size(), 1));
+  str.copy(copy, str.size());
+  return base::StringPiece(copy, str.size());
+}
+
+void* const* StringArena::AppendTrace(void* const* trace, size_t depth) {
+  if (depth == 0)
+    return NULL;
+
+  DCHECK(trace != NULL);
+  void** copy = reinterpret_cast<void**>(
+      Allocate(depth * sizeof(trace[0]), sizeof(trace[0])));
+  std::copy(trace, trace + depth, copy);
+  return copy;
+}
+
+void StringArena::Clear() {
+  for (size_t i = 0; i < chunks_.size(); ++i)
+    delete [] chunks_[i];
+
+  chunks_.clear();
+  next_ = NULL;
+  end_ = NULL;
+  bytes_used_ = 0;
+}
+
+void* StringArena::Allocate(size_t len, size_t alignment) {
+  DCHECK_NE(0U, len);
+  DCHECK_EQ(0U, alignment & (alignment - 1));
+
+  size_t misalignment = reinterpret_cast<uintptr_t>(next_) & (alignment - 1);
+  size_t padding = misalignment ? alignment - misalignment : 0;
+  if (next_ == NULL || static_cast<size_t>(end_ - next_) < padding + len) {
+    // Start a new chunk, large enough for oversized requests. The memory
+    // returned by new is suitably aligned for any type.
+    size_t chunk_size = std::max(kChunkSize, len);
+    char* chunk = new char[chunk_size];
+    chunks_.push_back(chunk);
+    next_ = chunk;
+    end_ = chunk + chunk_size;
+    padding = 0;
+  }
+
+  char* ret = next_ + padding;
+  next_ = ret + len;
+  bytes_used_ += len;
+
+  return ret;
+}
@@ -0,0 +1,66 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// String arena declaration.
+#ifndef SAWBUCK_VIEWER_STRING_ARENA_H_
+#define SAWBUCK_VIEWER_STRING_ARENA_H_
+
+#include <vector>
+#include "base/basictypes.h"
+#include "base/strings/string_piece.h"
+
+// An append-only store for the text and stack traces of log messages.
+// The log parsers hand out pointers into event buffers that only live for
+// the duration of a callback, so the bytes have to be copied once. The arena
+// copies them into large chunks that don't move until Clear(), so that the
+// log store can refer to them by pointer and length, and only materialize
+// strings when they're displayed.
+class StringArena {
+ public:
+  // The arena allocates chunks of at least this size.
+  static const size_t kChunkSize = 256 * 1024;
+
+  StringArena();
+  ~StringArena();
+
+  // Copies @p str into the arena.
+  // @returns a piece referring to the copy, valid until Clear().
+  base::StringPiece AppendString(const base::StringPiece& str);
+
+  // Copies the @p depth entries of @p trace into the arena.
+  // @returns a pointer to the copy, valid until Clear().
+  void* const* AppendTrace(void* const* trace, size_t depth);
+
+  // Releases all the chunks, invalidating all pieces and traces handed out.
+  void Clear();
+
+  // @returns the number of bytes stored in the arena.
+  size_t bytes_used() const { return bytes_used_; }
+
+ private:
+  // @returns @p len bytes of storage aligned to @p alignment.
+  void* Allocate(size_t len, size_t alignment);
+
+  // The chunks we own.
+  std::vector<char*> chunks_;
+  // The unused space in the last chunk.
+  char* next_;
+  char* end_;
+
+  size_t bytes_used_;
+
+  DISALLOW_COPY_AND_ASSIGN(StringArena);
+};
+
+#endif  // SAWBUCK_VIEWER_STRING_ARENA_H_
@@ -0,0 +1,81 @@
+// Copyright 2011 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// String arena unittests.
+#include "sawbuck/viewer/string_arena.h"
+
+#include <string>
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(StringArenaTest, AppendString) {
+  StringArena arena;
+
+  EXPECT_TRUE(arena.AppendString("").empty());
+  EXPECT_EQ(0U, arena.bytes_used());
+
+  std::string source("a log message");
+  base::StringPiece copy = arena.AppendString(source);
+  EXPECT_NE(source.data(), copy.data());
+  EXPECT_EQ(source, copy.as_string());
+  EXPECT_EQ(source.size(), arena.bytes_used());
+
+  // The copy is unaffected by changes to the source.
+  source[0] = 'A';
+  EXPECT_EQ("a log message", copy.as_string());
+}
+
+TEST(StringArenaTest, AppendTrace) {
+  StringArena arena;
+
+  EXPECT_TRUE(arena.AppendTrace(NULL, 0) == NULL);
+
+  // Misalign the arena.
+  arena.AppendString("x");
+
+  void* const trace[] = {
+      reinterpret_cast<void*>(0x1000),
+      reinterpret_cast<void*>(0x2000),
+      reinterpret_cast<void*>(0x3000),
+    };
+  void* const* copy = arena.AppendTrace(trace, arraysize(trace));
+  ASSERT_TRUE(copy != NULL);
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(copy) % sizeof(void*));
+  for (size_t i = 0; i < arraysize(trace); ++i)
+    EXPECT_EQ(trace[i], copy[i]);
+}
+
+TEST(StringArenaTest, PiecesOutliveNewChunks) {
+  StringArena arena;
+
+  std::string first(StringArena::kChunkSize - 1, 'a');
+  base::StringPiece first_copy = arena.AppendString(first);
+
+  // This won't fit in the first chunk, nor in a regular sized chunk.
+  std::string second(StringArena::kChunkSize + 1, 'b');
+  base::StringPiece second_copy = arena.AppendString(second);
+  base::StringPiece third_copy = arena.AppendString("third");
+
+  EXPECT_EQ(first, first_copy.as_string());
+  EXPECT_EQ(second, second_copy.as_string());
+  EXPECT_EQ("third", third_copy.as_string());
+  EXPECT_EQ(first.size() + second.size() + 5, arena.bytes_used());
+
+  arena.Clear();
+  EXPECT_EQ(0U, arena.bytes_used());
+  EXPECT_EQ("again", arena.AppendString("again").as_string());
+}
+
+}  // namespace
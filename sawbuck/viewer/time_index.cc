@@ -0,0 +1,57 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Time index implementation.
+#include "sawbuck/viewer/time_index.h"
+
+#include <algorithm>
+
+const int64 TimeIndex::kChunkRows;
+
+TimeIndex::TimeIndex() : size_(0) {
+}
+
+TimeIndex::~TimeIndex() {
+}
+
+void TimeIndex::Append(base::Time time) {
+  if (size_ % kChunkRows == 0) {
+    base::Time latest = time;
+    if (!latest_times_.empty())
+      latest = std::max(latest, latest_times_.back());
+    latest_times_.push_back(latest);
+    earliest_times_.push_back(time);
+  } else {
+    latest_times_.back() = std::max(latest_times_.back(), time);
+  }
+
+  // A late row lowers the earliest time of the chunks it's late for, which
+  // for roughly ordered rows are the last few at most.
+  std::vector<base::Time>::reverse_iterator it(earliest_times_.rbegin());
+  for (; it != earliest_times_.rend() && time < *it; ++it)
+    *it = time;
+
+  ++size_;
+}
+
+void TimeIndex::Clear() {
+  latest_times_.clear();
+  earliest_times_.clear();
+  size_ = 0;
+}
+
+int64 TimeIndex::LowerBound(const std::vector<base::Time>& times,
+                            base::Time time) {
+  return std::lower_bound(times.begin(), times.end(), time) - times.begin();
+}
@@ -0,0 +1,105 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Time index declaration.
+#ifndef SAWBUCK_VIEWER_TIME_INDEX_H_
+#define SAWBUCK_VIEWER_TIME_INDEX_H_
+
+#include <algorithm>
+#include <vector>
+#include "base/basictypes.h"
+#include "base/time/time.h"
+
+// Indexes the times of the rows of an append-only log, which are only
+// roughly in order, as events are delivered late. A plain binary search on
+// the times can't be trusted, so the rows are grouped in chunks of
+// kChunkRows, and for each chunk we keep the latest time up to its end and
+// the earliest time from its start on. Neither ever decreases from one chunk
+// to the next, so a binary search on them finds the chunk where the log
+// reaches a time, and a scan of that chunk finds the row.
+class TimeIndex {
+ public:
+  static const int64 kChunkRows = 1024;
+
+  TimeIndex();
+  ~TimeIndex();
+
+  // Indexes the next row, logged at @p time.
+  void Append(base::Time time);
+
+  void Clear();
+
+  int64 size() const { return size_; }
+
+  // @param row_times a functor that returns the time of a row, as appended.
+  // @returns the first row logged at or after @p time, or size() if there's
+  //     none. All the rows before it were logged before @p time.
+  template <class RowTimes>
+  int64 FindFirstRowAtTime(base::Time time, const RowTimes& row_times) const;
+
+  // @param row_times a functor that returns the time of a row, as appended.
+  // @returns one past the last row logged before @p time, or 0 if there's
+  //     none. All the rows from it on were logged at or after @p time.
+  template <class RowTimes>
+  int64 FindEndOfRowsBefore(base::Time time, const RowTimes& row_times) const;
+
+ private:
+  // @returns the first chunk whose entry in @p times is no earlier than
+  //     @p time, or the number of chunks if there's none.
+  static int64 LowerBound(const std::vector<base::Time>& times,
+                          base::Time time);
+
+  // The latest time of the rows up to the end of each chunk.
+  std::vector<base::Time> latest_times_;
+  // The earliest time of the rows from the start of each chunk on.
+  std::vector<base::Time> earliest_times_;
+
+  int64 size_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeIndex);
+};
+
+template <class RowTimes>
+int64 TimeIndex::FindFirstRowAtTime(base::Time time,
+                                    const RowTimes& row_times) const {
+  // The chunks before this one were all logged before time, and this one
+  // has a row logged at or after it.
+  int64 chunk = LowerBound(latest_times_, time);
+  if (chunk == static_cast<int64>(latest_times_.size()))
+    return size_;
+
+  int64 row = chunk * kChunkRows;
+  while (row_times(row) < time)
+    ++row;
+
+  return row;
+}
+
+template <class RowTimes>
+int64 TimeIndex::FindEndOfRowsBefore(base::Time time,
+                                     const RowTimes& row_times) const {
+  // The chunks from this one on were all logged at or after time, and the
+  // one before has a row logged before it.
+  int64 chunk = LowerBound(earliest_times_, time);
+  if (chunk == 0)
+    return 0;
+
+  int64 row = std::min(chunk * kChunkRows, size_);
+  while (!(row_times(row - 1) < time))
+    --row;
+
+  return row;
+}
+
+#endif  // SAWBUCK_VIEWER_TIME_INDEX_H_
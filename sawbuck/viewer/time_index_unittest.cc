@@ -0,0 +1,113 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Time index unittests.
+#include "sawbuck/viewer/time_index.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+base::Time TimeAtMs(int64 ms) {
+  return base::Time::FromInternalValue((1000000 + ms) * 1000);
+}
+
+// Reads the times of the rows we index.
+class RowTimes {
+ public:
+  explicit RowTimes(const std::vector<base::Time>& times) : times_(times) {
+  }
+
+  base::Time operator()(int64 row) const {
+    return times_[static_cast<size_t>(row)];
+  }
+
+ private:
+  const std::vector<base::Time>& times_;
+};
+
+class TimeIndexTest : public testing::Test {
+ public:
+  void Append(base::Time time) {
+    times_.push_back(time);
+    index_.Append(time);
+  }
+
+  int64 FindFirstRowAtTime(base::Time time) {
+    return index_.FindFirstRowAtTime(time, RowTimes(times_));
+  }
+
+  int64 FindEndOfRowsBefore(base::Time time) {
+    return index_.FindEndOfRowsBefore(time, RowTimes(times_));
+  }
+
+  // Checks that our index finds what a scan of all the rows does.
+  void ExpectFindsLikeScan(base::Time time) {
+    size_t first = 0;
+    while (first < times_.size() && times_[first] < time)
+      ++first;
+    EXPECT_EQ(static_cast<int64>(first), FindFirstRowAtTime(time));
+
+    size_t end = times_.size();
+    while (end > 0 && !(times_[end - 1] < time))
+      --end;
+    EXPECT_EQ(static_cast<int64>(end), FindEndOfRowsBefore(time));
+  }
+
+ protected:
+  std::vector<base::Time> times_;
+  TimeIndex index_;
+};
+
+TEST_F(TimeIndexTest, Empty) {
+  EXPECT_EQ(0, index_.size());
+  EXPECT_EQ(0, FindFirstRowAtTime(TimeAtMs(0)));
+  EXPECT_EQ(0, FindEndOfRowsBefore(TimeAtMs(0)));
+}
+
+TEST_F(TimeIndexTest, OrderedRows) {
+  // Two rows per millisecond, across several chunks.
+  const int64 kNumRows = 5 * TimeIndex::kChunkRows + 10;
+  for (int64 i = 0; i < kNumRows; ++i)
+    Append(TimeAtMs(i / 2));
+
+  ASSERT_EQ(kNumRows, index_.size());
+  EXPECT_EQ(0, FindFirstRowAtTime(TimeAtMs(-1)));
+  EXPECT_EQ(0, FindEndOfRowsBefore(TimeAtMs(-1)));
+  EXPECT_EQ(2000, FindFirstRowAtTime(TimeAtMs(1000)));
+  EXPECT_EQ(2000, FindEndOfRowsBefore(TimeAtMs(1000)));
+  EXPECT_EQ(2002, FindFirstRowAtTime(
+      TimeAtMs(1000) + base::TimeDelta::FromMicroseconds(1)));
+  EXPECT_EQ(kNumRows, FindFirstRowAtTime(TimeAtMs(kNumRows)));
+  EXPECT_EQ(kNumRows, FindEndOfRowsBefore(TimeAtMs(kNumRows)));
+
+  index_.Clear();
+  EXPECT_EQ(0, index_.size());
+}
+
+TEST_F(TimeIndexTest, LateRows) {
+  // Every 7th row is delivered late, some by more than a chunk.
+  const int64 kNumRows = 8 * TimeIndex::kChunkRows;
+  for (int64 i = 0; i < kNumRows; ++i) {
+    int64 ms = i;
+    if (i % 7 == 0)
+      ms -= (i % 3) * TimeIndex::kChunkRows / 2;
+    Append(TimeAtMs(ms));
+  }
+
+  for (int64 ms = -10; ms < kNumRows + 10; ms += 97)
+    ExpectFindsLikeScan(TimeAtMs(ms));
+}
+
+}  // namespace
@@ -0,0 +1,164 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Timeline implementation.
+#include "sawbuck/viewer/timeline.h"
+
+#include <wmistr.h>
+#include <evntrace.h>
+#include <algorithm>
+#include "base/logging.h"
+
+const size_t Timeline::kMaxBuckets;
+const int64 Timeline::kMinBucketWidthUs;
+
+Timeline::Bucket::Bucket() {
+  std::fill(counts, counts + NUM_SERIES, 0);
+}
+
+Timeline::Timeline() : width_(kMinBucketWidthUs), first_index_(0) {
+}
+
+Timeline::~Timeline() {
+}
+
+Timeline::Series Timeline::GetSeries(int severity) {
+  switch (severity) {
+    case TRACE_LEVEL_FATAL:
+    case TRACE_LEVEL_ERROR:
+      return SERIES_ERROR;
+
+    case TRACE_LEVEL_WARNING:
+      return SERIES_WARNING;
+
+    case TRACE_LEVEL_INFORMATION:
+      return SERIES_INFO;
+
+    default:
+      return SERIES_VERBOSE;
+  }
+}
+
+void Timeline::Add(base::Time time, int severity) {
+  if (time.is_null())
+    return;
+
+  int64 counts[NUM_SERIES] = {};
+  counts[GetSeries(severity)] = 1;
+  AddCounts(time.ToInternalValue(), counts);
+}
+
+void Timeline::AddRows(ILogView* log_view, int64 start, int64 end) {
+  for (int64 row = start; row < end; ++row)
+    Add(log_view->GetTime(row), log_view->GetSeverity(row));
+}
+
+void Timeline::Merge(const Timeline& other) {
+  // Our buckets then each cover whole buckets of other.
+  while (width_ < other.width_)
+    Coarsen();
+
+  for (size_t i = 0; i < other.buckets_.size(); ++i) {
+    AddCounts((other.first_index_ + static_cast<int64>(i)) * other.width_,
+              other.buckets_[i].counts);
+  }
+}
+
+void Timeline::Clear() {
+  width_ = kMinBucketWidthUs;
+  first_index_ = 0;
+  buckets_.clear();
+}
+
+base::Time Timeline::start() const {
+  return base::Time::FromInternalValue(first_index_ * width_);
+}
+
+base::Time Timeline::end() const {
+  return base::Time::FromInternalValue((GetLastIndex() + 1) * width_);
+}
+
+int64 Timeline::GetCount(size_t bucket, Series series) const {
+  DCHECK_LT(bucket, buckets_.size());
+  DCHECK_LT(series, NUM_SERIES);
+  return buckets_[bucket].counts[series];
+}
+
+int64 Timeline::GetTotal(size_t bucket) const {
+  DCHECK_LT(bucket, buckets_.size());
+  int64 total = 0;
+  for (int i = 0; i < NUM_SERIES; ++i)
+    total += buckets_[bucket].counts[i];
+
+  return total;
+}
+
+int64 Timeline::GetMaxTotal() const {
+  int64 max_total = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i)
+    max_total = std::max(max_total, GetTotal(i));
+
+  return max_total;
+}
+
+int64 Timeline::GetLastIndex() const {
+  return first_index_ + static_cast<int64>(buckets_.size()) - 1;
+}
+
+void Timeline::AddCounts(int64 time_us, const int64* counts) {
+  DCHECK_LE(0, time_us);
+
+  if (buckets_.empty()) {
+    first_index_ = time_us / width_;
+    buckets_.push_back(Bucket());
+  }
+
+  // Coarsen until the bucket of time_us fits with ours.
+  int64 index = time_us / width_;
+  while (std::max(index, GetLastIndex()) - std::min(index, first_index_) >=
+         static_cast<int64>(kMaxBuckets)) {
+    Coarsen();
+    index = time_us / width_;
+  }
+
+  while (index < first_index_) {
+    buckets_.push_front(Bucket());
+    --first_index_;
+  }
+  while (index > GetLastIndex())
+    buckets_.push_back(Bucket());
+
+  Bucket& bucket = buckets_[static_cast<size_t>(index - first_index_)];
+  for (int i = 0; i < NUM_SERIES; ++i)
+    bucket.counts[i] += counts[i];
+}
+
+void Timeline::Coarsen() {
+  width_ *= 2;
+  if (buckets_.empty())
+    return;
+
+  int64 first_index = first_index_ / 2;
+  int64 last_index = GetLastIndex() / 2;
+  std::deque<Bucket> buckets(static_cast<size_t>(last_index - first_index + 1));
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    int64 index = (first_index_ + static_cast<int64>(i)) / 2;
+    Bucket& bucket = buckets[static_cast<size_t>(index - first_index)];
+    for (int j = 0; j < NUM_SERIES; ++j)
+      bucket.counts[j] += buckets_[i].counts[j];
+  }
+
+  first_index_ = first_index;
+  buckets_.swap(buckets);
+}
@@ -0,0 +1,105 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Timeline declaration.
+#ifndef SAWBUCK_VIEWER_TIMELINE_H_
+#define SAWBUCK_VIEWER_TIMELINE_H_
+
+#include <deque>
+#include "base/basictypes.h"
+#include "base/time/time.h"
+#include "sawbuck/viewer/log_list_view.h"
+
+// Counts the rows of a log per time bucket, by severity. The buckets are
+// aligned on multiples of their width, which starts at kMinBucketWidth and
+// doubles whenever the rows span more than kMaxBuckets buckets. Adding a
+// row is thus amortized constant time, and timelines of disjoint ranges of
+// rows can be counted in parallel, then merged.
+class Timeline {
+ public:
+  // The severities we tell apart.
+  enum Series {
+    SERIES_ERROR,
+    SERIES_WARNING,
+    SERIES_INFO,
+    SERIES_VERBOSE,
+
+    // Must be last.
+    NUM_SERIES,
+  };
+
+  static const size_t kMaxBuckets = 512;
+  static const int64 kMinBucketWidthUs = 1000;
+
+  Timeline();
+  ~Timeline();
+
+  // @returns the series that counts rows of @p severity.
+  static Series GetSeries(int severity);
+
+  // Counts a row logged at @p time with @p severity. Rows with a null time
+  // are ignored.
+  void Add(base::Time time, int severity);
+
+  // Counts the rows of @p log_view from @p start up to @p end.
+  void AddRows(ILogView* log_view, int64 start, int64 end);
+
+  // Adds the counts of @p other to ours.
+  void Merge(const Timeline& other);
+
+  void Clear();
+
+  bool empty() const { return buckets_.empty(); }
+  size_t num_buckets() const { return buckets_.size(); }
+  base::TimeDelta bucket_width() const {
+    return base::TimeDelta::FromMicroseconds(width_);
+  }
+
+  // @returns the start of the first bucket.
+  base::Time start() const;
+  // @returns the end of the last bucket.
+  base::Time end() const;
+
+  // @returns the number of rows of @p series in @p bucket.
+  int64 GetCount(size_t bucket, Series series) const;
+  // @returns the number of rows in @p bucket.
+  int64 GetTotal(size_t bucket) const;
+  // @returns the largest number of rows in a bucket.
+  int64 GetMaxTotal() const;
+
+ private:
+  struct Bucket {
+    Bucket();
+
+    int64 counts[NUM_SERIES];
+  };
+
+  // @returns the index of our last bucket.
+  int64 GetLastIndex() const;
+
+  // Adds @p counts to the bucket that contains @p time_us, making room for
+  // it as need be.
+  void AddCounts(int64 time_us, const int64* counts);
+
+  // Doubles the width of our buckets, folding them pairwise.
+  void Coarsen();
+
+  // The width of a bucket, in microseconds.
+  int64 width_;
+  // The bucket buckets_[0] covers the times from first_index_ * width_.
+  int64 first_index_;
+  std::deque<Bucket> buckets_;
+};
+
+#endif  // SAWBUCK_VIEWER_TIMELINE_H_
@@ -0,0 +1,124 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Timeline unittests.
+#include "sawbuck/viewer/timeline.h"
+
+#include <wmistr.h>
+#include <evntrace.h>
+#include "gtest/gtest.h"
+
+namespace {
+
+base::Time TimeAtMs(int64 ms) {
+  // A base::Time of zero is null, so start a while after it.
+  return base::Time::FromInternalValue((1000000 + ms) * 1000);
+}
+
+// Counts all the rows of @p timeline.
+int64 CountRows(const Timeline& timeline) {
+  int64 rows = 0;
+  for (size_t i = 0; i < timeline.num_buckets(); ++i)
+    rows += timeline.GetTotal(i);
+
+  return rows;
+}
+
+TEST(TimelineTest, Empty) {
+  Timeline timeline;
+
+  EXPECT_TRUE(timeline.empty());
+  EXPECT_EQ(0U, timeline.num_buckets());
+  EXPECT_EQ(0, timeline.GetMaxTotal());
+
+  // Rows without a time are ignored.
+  timeline.Add(base::Time(), TRACE_LEVEL_ERROR);
+  EXPECT_TRUE(timeline.empty());
+}
+
+TEST(TimelineTest, CountsBySeverity) {
+  Timeline timeline;
+
+  timeline.Add(TimeAtMs(0), TRACE_LEVEL_FATAL);
+  timeline.Add(TimeAtMs(0), TRACE_LEVEL_ERROR);
+  timeline.Add(TimeAtMs(0), TRACE_LEVEL_INFORMATION);
+  timeline.Add(TimeAtMs(2), TRACE_LEVEL_WARNING);
+  timeline.Add(TimeAtMs(2), TRACE_LEVEL_VERBOSE);
+
+  ASSERT_EQ(3U, timeline.num_buckets());
+  EXPECT_EQ(TimeAtMs(0), timeline.start());
+  EXPECT_EQ(TimeAtMs(3), timeline.end());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(1), timeline.bucket_width());
+
+  EXPECT_EQ(2, timeline.GetCount(0, Timeline::SERIES_ERROR));
+  EXPECT_EQ(1, timeline.GetCount(0, Timeline::SERIES_INFO));
+  EXPECT_EQ(0, timeline.GetTotal(1));
+  EXPECT_EQ(1, timeline.GetCount(2, Timeline::SERIES_WARNING));
+  EXPECT_EQ(1, timeline.GetCount(2, Timeline::SERIES_VERBOSE));
+  EXPECT_EQ(3, timeline.GetMaxTotal());
+
+  // Earlier rows extend the timeline back.
+  timeline.Add(TimeAtMs(-1), TRACE_LEVEL_ERROR);
+  ASSERT_EQ(4U, timeline.num_buckets());
+  EXPECT_EQ(TimeAtMs(-1), timeline.start());
+  EXPECT_EQ(1, timeline.GetTotal(0));
+
+  timeline.Clear();
+  EXPECT_TRUE(timeline.empty());
+}
+
+TEST(TimelineTest, CoarsensLongSpans) {
+  Timeline timeline;
+
+  const int64 kNumRows = 10 * Timeline::kMaxBuckets;
+  for (int64 i = 0; i < kNumRows; ++i)
+    timeline.Add(TimeAtMs(i), TRACE_LEVEL_INFORMATION);
+
+  EXPECT_LE(timeline.num_buckets(), Timeline::kMaxBuckets);
+  EXPECT_LT(base::TimeDelta::FromMilliseconds(1), timeline.bucket_width());
+  EXPECT_LE(timeline.start(), TimeAtMs(0));
+  EXPECT_GT(timeline.end(), TimeAtMs(kNumRows - 1));
+  EXPECT_EQ(kNumRows, CountRows(timeline));
+}
+
+TEST(TimelineTest, MergesLikeAdding) {
+  Timeline all;
+  Timeline first;
+  Timeline second;
+
+  // The second half spans much more time than the first.
+  for (int64 i = 0; i < 1000; ++i) {
+    int severity = i % 3 == 0 ? TRACE_LEVEL_ERROR : TRACE_LEVEL_VERBOSE;
+    all.Add(TimeAtMs(i), severity);
+    first.Add(TimeAtMs(i), severity);
+  }
+  for (int64 i = 0; i < 1000; ++i) {
+    all.Add(TimeAtMs(i * 100), TRACE_LEVEL_WARNING);
+    second.Add(TimeAtMs(i * 100), TRACE_LEVEL_WARNING);
+  }
+
+  first.Merge(second);
+
+  EXPECT_EQ(all.bucket_width(), first.bucket_width());
+  EXPECT_EQ(all.start(), first.start());
+  ASSERT_EQ(all.num_buckets(), first.num_buckets());
+  for (size_t i = 0; i < all.num_buckets(); ++i) {
+    for (int series = 0; series < Timeline::NUM_SERIES; ++series) {
+      Timeline::Series s = static_cast<Timeline::Series>(series);
+      EXPECT_EQ(all.GetCount(i, s), first.GetCount(i, s));
+    }
+  }
+}
+
+}  // namespace
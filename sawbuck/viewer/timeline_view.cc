@@ -0,0 +1,207 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Timeline view window implementation.
+#include "sawbuck/viewer/timeline_view.h"
+
+#include <algorithm>
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop_proxy.h"
+#include "base/task_runner_util.h"
+
+namespace {
+
+// The colors of the series of the timeline, stacked in this order.
+const COLORREF kSeriesColors[] = {
+  RGB(0xE0, 0x30, 0x30),  // Errors.
+  RGB(0xF0, 0xA0, 0x20),  // Warnings.
+  RGB(0x40, 0x80, 0xD0),  // Info.
+  RGB(0xA0, 0xA0, 0xA0),  // Verbose.
+};
+
+}  // namespace
+
+const int64 TimelineView::kCountChunkRows;
+
+// The chunks read and count the log view concurrently, and the log view can
+// be swapped out from under them once they're done reading.
+class TimelineView::CountJob : public base::RefCountedThreadSafe<CountJob> {
+ public:
+  explicit CountJob(ILogView* log_view) : log_view_(log_view) {
+  }
+
+  // @returns the timeline of the rows from @p start up to @p end, or an
+  //     empty timeline if we're cancelled.
+  Timeline CountRows(int64 start, int64 end) {
+    Timeline timeline;
+
+    AutoReader reader(&guard_);
+    if (reader.can_read())
+      timeline.AddRows(log_view_, start, end);
+
+    return timeline;
+  }
+
+  // Waits for any chunk reading the log view. The log view may go away
+  // after this returns.
+  void Cancel() {
+    guard_.Revoke();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<CountJob>;
+  ~CountJob() {
+  }
+
+  ILogView* const log_view_;
+  // Guards the reads of |log_view_|.
+  ReaderGuard guard_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountJob);
+};
+
+TimelineView::TimelineView()
+    : log_view_(NULL), event_cookie_(0), counted_rows_(0),
+      weak_factory_(this) {
+  COMPILE_ASSERT(arraysize(kSeriesColors) == Timeline::NUM_SERIES,
+                 wrong_number_of_series_colors);
+}
+
+TimelineView::~TimelineView() {
+  if (job_.get() != NULL)
+    job_->Cancel();
+
+  if (log_view_ != NULL)
+    log_view_->Unregister(event_cookie_);
+}
+
+void TimelineView::SetLogView(ILogView* log_view) {
+  if (log_view_ == log_view)
+    return;
+
+  if (log_view_ != NULL) {
+    log_view_->Unregister(event_cookie_);
+    event_cookie_ = 0;
+  }
+
+  log_view_ = log_view;
+  if (log_view_ != NULL)
+    log_view_->Register(this, &event_cookie_);
+
+  RestartCounting();
+}
+
+void TimelineView::RestartCounting() {
+  // The chunks in flight must be done with the log view.
+  if (job_.get() != NULL)
+    job_->Cancel();
+  job_ = NULL;
+
+  timeline_.Clear();
+  counted_rows_ = 0;
+
+  if (log_view_ != NULL) {
+    job_ = new CountJob(log_view_);
+    CountRows(log_view_->GetNumRows());
+  }
+
+  if (IsWindow())
+    Invalidate();
+}
+
+void TimelineView::LogViewNewItems(int64 first_row, int64 num_rows) {
+  CountRows(first_row + num_rows);
+}
+
+void TimelineView::LogViewCleared() {
+  RestartCounting();
+}
+
+void TimelineView::OnPaint(CDCHandle /*dc*/) {
+  CPaintDC dc(m_hWnd);
+  CRect client;
+  GetClientRect(&client);
+  dc.FillRect(&client, COLOR_WINDOW);
+
+  int64 max_total = timeline_.GetMaxTotal();
+  if (max_total == 0 || client.IsRectEmpty())
+    return;
+
+  // Each bucket is a band of the strip, its series stacked left to right.
+  int64 num_buckets = timeline_.num_buckets();
+  for (int64 i = 0; i < num_buckets; ++i) {
+    int top = client.top + static_cast<int>(i * client.Height() / num_buckets);
+    int bottom = client.top +
+        static_cast<int>((i + 1) * client.Height() / num_buckets);
+    bottom = std::max(bottom, top + 1);
+
+    int left = client.left;
+    for (int series = 0; series < Timeline::NUM_SERIES; ++series) {
+      int64 count = timeline_.GetCount(static_cast<size_t>(i),
+                                       static_cast<Timeline::Series>(series));
+      if (count == 0)
+        continue;
+
+      // Show the buckets with few rows all the same.
+      int width = std::max(1,
+          static_cast<int>(count * client.Width() / max_total));
+      dc.FillSolidRect(left, top, width, bottom - top, kSeriesColors[series]);
+      left += width;
+    }
+  }
+}
+
+void TimelineView::OnLButtonDown(UINT flags, CPoint point) {
+  CRect client;
+  GetClientRect(&client);
+  if (timeline_.empty() || client.IsRectEmpty() || time_callback_.is_null())
+    return;
+
+  int64 span = (timeline_.end() - timeline_.start()).InMicroseconds();
+  int64 offset = span * (point.y - client.top) / client.Height();
+  time_callback_.Run(timeline_.start() +
+                     base::TimeDelta::FromMicroseconds(offset));
+}
+
+void TimelineView::CountRows(int64 end) {
+  if (job_.get() == NULL)
+    return;
+
+  scoped_refptr<base::TaskRunner> runner(count_runner_);
+  if (runner.get() == NULL)
+    runner = base::MessageLoopProxy::current();
+
+  // The chunks are counted in parallel, and merged in any order.
+  while (counted_rows_ < end) {
+    int64 start = counted_rows_;
+    counted_rows_ = std::min(start + kCountChunkRows, end);
+    base::PostTaskAndReplyWithResult(
+        runner.get(),
+        FROM_HERE,
+        base::Bind(&CountJob::CountRows, job_, start, counted_rows_),
+        base::Bind(&TimelineView::OnChunkCounted,
+                   weak_factory_.GetWeakPtr(), job_));
+  }
+}
+
+void TimelineView::OnChunkCounted(CountJob* job, const Timeline& timeline) {
+  // Ignore the chunks of abandoned jobs.
+  if (job != job_.get())
+    return;
+
+  timeline_.Merge(timeline);
+  if (IsWindow())
+    Invalidate();
+}
@@ -0,0 +1,117 @@
+// Copyright 2012 Google Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Timeline view window declaration.
+#ifndef SAWBUCK_VIEWER_TIMELINE_VIEW_H_
+#define SAWBUCK_VIEWER_TIMELINE_VIEW_H_
+
+#include <atlbase.h>
+#include <atlapp.h>
+#include <atlcrack.h>
+#include <atlgdi.h>
+#include <atlmisc.h>
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/task_runner.h"
+#include "sawbuck/log_lib/task_scheduler.h"
+#include "sawbuck/viewer/log_list_view.h"
+#include "sawbuck/viewer/timeline.h"
+
+typedef CWinTraits<WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS>
+    TimelineViewTraits;
+
+// A strip that shows the timeline of a log, earliest at the top, as bars of
+// the rows logged in each bucket of time, stacked by severity. The timeline
+// is counted in chunks on a task runner, as rows are added to the log.
+// Clicking the strip reports the time under the mouse.
+class TimelineView
+    : public CWindowImpl<TimelineView, CWindow, TimelineViewTraits>,
+      public ILogViewEvents {
+ public:
+  DECLARE_WND_CLASS_EX(L"SawbuckTimelineView", CS_HREDRAW | CS_VREDRAW,
+                       COLOR_WINDOW)
+
+  BEGIN_MSG_MAP_EX(TimelineView)
+    MSG_WM_PAINT(OnPaint)
+    MSG_WM_LBUTTONDOWN(OnLButtonDown)
+  END_MSG_MAP()
+
+  // The rows we count per chunk.
+  static const int64 kCountChunkRows = 64 * 1024;
+
+  TimelineView();
+  ~TimelineView();
+
+  // Counts the timeline of @p log_view, which must be safe to call from
+  // the threads of the count runner, and must outlive us or the next call.
+  void SetLogView(ILogView* log_view);
+
+  // Counts the timeline afresh, e.g. after the rows of the log view
+  // changed without it being cleared.
+  void RestartCounting();
+
+  // Counts on @p count_runner rather than on the current message loop.
+  void set_count_runner(base::TaskRunner* count_runner) {
+    count_runner_ = count_runner;
+  }
+
+  // Invoked with the time the user clicked on.
+  typedef base::Callback<void(base::Time)> TimeCallback;
+  void set_time_callback(const TimeCallback& time_callback) {
+    time_callback_ = time_callback;
+  }
+
+  const Timeline& timeline() const { return timeline_; }
+
+  // ILogViewEvents implementation.
+  virtual void LogViewNewItems(int64 first_row, int64 num_rows);
+  virtual void LogViewCleared();
+
+ protected:
+  // Counts chunks of rows of a log view, until it's cancelled.
+  class CountJob;
+
+  void OnPaint(CDCHandle dc);
+  void OnLButtonDown(UINT flags, CPoint point);
+
+  // Posts the chunks that count the rows up to @p end.
+  void CountRows(int64 end);
+
+  // Invoked with the @p timeline of a chunk counted by @p job.
+  void OnChunkCounted(CountJob* job, const Timeline& timeline);
+
+  // The log view we count, and our registration cookie with it.
+  ILogView* log_view_;
+  int event_cookie_;
+
+  // The rows counted so far.
+  Timeline timeline_;
+  // The number of rows of log_view_ posted for counting.
+  int64 counted_rows_;
+
+  // Reads log_view_ for the chunks we post.
+  scoped_refptr<CountJob> job_;
+  // Where we count our chunks, or NULL to count on the current loop.
+  scoped_refptr<base::TaskRunner> count_runner_;
+
+  TimeCallback time_callback_;
+
+  // Drops the replies of the chunks in flight when we're destroyed.
+  base::WeakPtrFactory<TimelineView> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimelineView);
+};
+
+#endif  // SAWBUCK_VIEWER_TIMELINE_VIEW_H_
@@ -73,19 +73,45 @@
         'filtered_log_view.h',
         'find_dialog.cc',
         'find_dialog.h',
+        'go_to_time_dialog.cc',
+        'go_to_time_dialog.h',
         'log_viewer.h',
         'log_viewer.cc',
         'log_list_view.h',
         'log_list_view.cc',
+        'log_site_table.cc',
+        'log_site_table.h',
+        'pattern_matcher.cc',
+        'pattern_matcher.h',
         'preferences.cc',
         'preferences.h',
+        'process_table.cc',
+        'process_table.h',
+        'process_tree.cc',
+        'process_tree.h',
         'provider_configuration.cc',
         'provider_configuration.h',
         'provider_dialog.cc',
         'provider_dialog.h',
+        'query_dialog.cc',
+        'query_dialog.h',
+        'row_index.cc',
+        'row_index.h',
         'sawbuck_guids.h',
+        'sorted_log_view.cc',
+        'sorted_log_view.h',
         'stack_trace_list_view.h',
         'stack_trace_list_view.cc',
+        'statistics_list_view.cc',
+        'statistics_list_view.h',
+        'string_arena.cc',
+        'string_arena.h',
+        'time_index.cc',
+        'time_index.h',
+        'timeline.cc',
+        'timeline.h',
+        'timeline_view.cc',
+        'timeline_view.h',
         'viewer_window.cc',
         'viewer_window.h',
       ],
@@ -149,11 +175,20 @@
       'sources': [
         'filter_unittest.cc',
         'filtered_log_view_unittest.cc',
+        'log_site_table_unittest.cc',
+        'pattern_matcher_unittest.cc',
         'preferences_unittest.cc',
+        'process_table_unittest.cc',
+        'process_tree_unittest.cc',
         'provider_configuration_unittest.cc',
         'registry_test.h',
         'registry_test.cc',
+        'row_index_unittest.cc',
         'sawbuck_guids.h',
+        'sorted_log_view_unittest.cc',
+        'string_arena_unittest.cc',
+        'time_index_unittest.cc',
+        'timeline_unittest.cc',
         'viewer_unittest_main.cc',
         'viewer_window_unittest.cc',
         'viewer.rc',
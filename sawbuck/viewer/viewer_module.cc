@@ -23,6 +23,7 @@
 #include "base/message_loop/message_loop.h"
 #include "base/message_loop/message_pump.h"
 #include "base/message_loop/message_pump_win.h"
+#include "base/strings/utf_string_conversions.h"
 #include "sawbuck/viewer/viewer_window.h"
 
 #include <initguid.h>  // NOLINT
@@ -158,7 +159,29 @@ int APIENTRY wWinMain(HINSTANCE instance,
     for (size_t i = 0; i < files.size(); ++i) {
       paths.push_back(base::FilePath(files[i]));
     }
-    window.ImportLogFiles(paths);
+
+    // Optionally restrict the import to a window of time, e.g.
+    // --start-time="Tue, 15 Nov 2011 12:45:26 GMT".
+    // Invalid times are rejected rather than importing more than asked for.
+    base::Time start_time;
+    base::Time end_time;
+    std::wstring error;
+    std::string time_string = cmd_line->GetSwitchValueASCII("start-time");
+    if (!time_string.empty() &&
+        !base::Time::FromString(time_string.c_str(), &start_time)) {
+      error = L"Invalid start time \"" + base::UTF8ToWide(time_string) + L"\".";
+    }
+    time_string = cmd_line->GetSwitchValueASCII("end-time");
+    if (error.empty() && !time_string.empty() &&
+        !base::Time::FromString(time_string.c_str(), &end_time)) {
+      error = L"Invalid end time \"" + base::UTF8ToWide(time_string) + L"\".";
+    }
+
+    if (error.empty())
+      window.ImportLogFiles(paths, start_time, end_time);
+    else
+      ::MessageBox(window.m_hWnd, error.c_str(), L"Error Importing Logs",
+                   MB_OK);
   } else if (cmd_line->HasSwitch("start-capture")) {
     window.SetCapture(true);
   }
@@ -44,6 +44,10 @@ const pcrecpp::RE kFileRe("\\[[^\\]]*\\:([^:]+)\\((\\d+)\\)\\].(.*\\w).*",
 
 const wchar_t kSessionName[] = L"Sawbuck Log Session";
 
+// New rows are published to the views at most this often, about 30 times a
+// second.
+const int kNewItemsIntervalMs = 33;
+
 bool Is64BitSystem() {
   if (sizeof(void*) == 8)  // NOLINT
     return true;
@@ -66,6 +70,21 @@ bool Is64BitSystem() {
   return is_wow_64 != FALSE;
 }
 
+// Reads the times of the rows of a list of messages for a TimeIndex.
+template <class MessageList>
+class MessageTimes {
+ public:
+  explicit MessageTimes(const MessageList& messages) : messages_(messages) {
+  }
+
+  base::Time operator()(int64 row) const {
+    return messages_[static_cast<size_t>(row)].time_stamp;
+  }
+
+ private:
+  const MessageList& messages_;
+};
+
 }  // namespace
 
 bool operator < (const GUID& a, const GUID& b) {
@@ -76,7 +95,7 @@ void ViewerWindow::CompileAsserts() {
 }
 
 ViewerWindow::ViewerWindow()
-     : symbol_lookup_worker_("Symbol Lookup Worker"),
+     : task_scheduler_(0),
        next_sink_cookie_(1),
        log_viewer_(this),
        ui_loop_(NULL),
@@ -84,6 +103,7 @@ ViewerWindow::ViewerWindow()
           base::Bind(&ViewerWindow::NotifyLogViewNewItems,
                      base::Unretained(this))),
        notify_log_view_new_items_pending_(false),
+       num_rows_notified_(0),
        update_status_task_(base::Bind(&ViewerWindow::UpdateStatus,
                                       base::Unretained(this))),
        update_status_task_pending_(false),
@@ -92,31 +112,38 @@ ViewerWindow::ViewerWindow()
   ui_loop_ = base::MessageLoop::current();
   DCHECK(ui_loop_ != NULL);
 
-  symbol_lookup_worker_.Start();
-  DCHECK(symbol_lookup_worker_.message_loop() != NULL);
+  task_scheduler_.Start();
 
   status_callback_ = base::Bind(&ViewerWindow::OnStatusUpdate,
                                 base::Unretained(this));
   symbol_lookup_service_.set_status_callback(status_callback_);
 
-  symbol_lookup_service_.set_background_thread(
-      symbol_lookup_worker_.message_loop());
+  symbol_lookup_service_.set_background_runner(
+      task_scheduler_.CreateSequencedTaskRunner(TaskScheduler::BACKGROUND));
 
   InitSymbolPath();
   symbol_lookup_service_.SetSymbolPath(symbol_path_.c_str());
 
   settings_.ReadProviders();
   settings_.ReadSettings();
+
+  process_info_service_.AddObserver(&process_table_);
 }
 
 ViewerWindow::~ViewerWindow() {
   // Last resort..
   StopCapturing();
 
-  symbol_lookup_worker_.Stop();
+  // Abandon any import, and wait out the tasks in progress.
+  if (import_token_.get() != NULL)
+    import_token_->Cancel();
+  task_scheduler_.Stop();
 
   notify_log_view_new_items_.Cancel();
   update_status_task_.Cancel();
+  import_done_.Cancel();
+
+  process_info_service_.RemoveObserver(&process_table_);
 }
 
 namespace {
@@ -129,9 +156,22 @@ class ImportLogConsumer
   ImportLogConsumer();
   ~ImportLogConsumer();
 
+  // Consumes the events logged from @p start_time through @p end_time.
+  HRESULT Consume(const base::Time& start_time, const base::Time& end_time) {
+    return ConsumeTimeWindow(trace_handles_, start_time, end_time);
+  }
+
+  // Consumption stops at the next buffer once @p token is cancelled.
+  void set_cancellation_token(CancellationToken* token) {
+    token_ = token;
+  }
+
   static void ProcessEvent(PEVENT_TRACE event);
+  static bool ProcessBuffer(PEVENT_TRACE_LOGFILE buffer);
 
  private:
+  scoped_refptr<CancellationToken> token_;
+
   static ImportLogConsumer* current_;
 };
 
@@ -150,23 +190,55 @@ ImportLogConsumer::~ImportLogConsumer() {
 void ImportLogConsumer::ProcessEvent(PEVENT_TRACE event) {
   DCHECK(current_ != NULL);
 
+  // Events without a sink are expected, so don't pay for logging them.
   if (!current_->LogParser::ProcessOneEvent(event) &&
       !current_->KernelLogParser::ProcessOneEvent(event)) {
-    LOG(INFO) << "Unknown event";
+    DVLOG(1) << "Unknown event";
   }
 }
 
+bool ImportLogConsumer::ProcessBuffer(PEVENT_TRACE_LOGFILE buffer) {
+  DCHECK(current_ != NULL);
+
+  return current_->token_.get() == NULL || !current_->token_->IsCancelled();
+}
+
+// Consumes the events of @p consumer logged from @p start_time through
+// @p end_time, then posts the outcome to @p done on @p ui_loop.
+void ConsumeLogFiles(ImportLogConsumer* consumer,
+                     const base::Time& start_time,
+                     const base::Time& end_time,
+                     base::MessageLoop* ui_loop,
+                     const base::Callback<void(HRESULT)>& done) {
+  HRESULT hr = consumer->Consume(start_time, end_time);
+  ui_loop->PostTask(FROM_HERE, base::Bind(done, hr));
+}
+
 }  // namespace
 
 void ViewerWindow::ImportLogFiles(const std::vector<base::FilePath>& paths) {
+  ImportLogFiles(paths, base::Time(), base::Time());
+}
+
+void ViewerWindow::ImportLogFiles(const std::vector<base::FilePath>& paths,
+                                  const base::Time& start_time,
+                                  const base::Time& end_time) {
+  DCHECK(import_token_.get() == NULL);
+
+  if (!start_time.is_null() && !end_time.is_null() && start_time >= end_time) {
+    ::MessageBox(m_hWnd, L"The start time must precede the end time.",
+                 L"Error Importing Logs", MB_OK);
+    return;
+  }
+
   UISetText(0, L"Importing");
   UIUpdateStatusBar();
 
-  ImportLogConsumer import_consumer;
+  scoped_ptr<ImportLogConsumer> import_consumer(new ImportLogConsumer());
 
   // Open all the log files.
   for (size_t i = 0; i < paths.size(); ++i) {
-    HRESULT hr = import_consumer.OpenFileSession(paths[i].value().c_str());
+    HRESULT hr = import_consumer->OpenFileSession(paths[i].value().c_str());
 
     if (FAILED(hr)) {
       std::wstring msg =
@@ -179,21 +251,49 @@ void ViewerWindow::ImportLogFiles(const std::vector<base::FilePath>& paths) {
     }
   }
 
-  // Attach our event sinks to the consumer.
-  import_consumer.set_event_sink(this);
-  import_consumer.set_trace_sink(this);
-  import_consumer.set_process_event_sink(&process_info_service_);
-  import_consumer.set_module_event_sink(&symbol_lookup_service_);
-
-  // Consume the files.
+  // Attach our event sinks to the consumer. They all take the events from
+  // the live consumer threads too.
+  import_consumer->set_event_sink(this);
+  import_consumer->set_trace_sink(this);
+  import_consumer->set_process_event_sink(&process_info_service_);
+  import_consumer->set_thread_event_sink(&thread_info_service_);
+  import_consumer->set_module_event_sink(&symbol_lookup_service_);
+
+  import_token_ = new CancellationToken();
+  import_consumer->set_cancellation_token(import_token_.get());
+  import_done_.Reset(base::Bind(&ViewerWindow::OnImportDone,
+                                base::Unretained(this)));
+
+  // No capturing or importing until we're done.
+  UIEnable(ID_FILE_IMPORT, false);
+  UIEnable(ID_LOG_CAPTURE, false);
+
+  // Consume the files in the background, so that the UI stays live and the
+  // rows show up as they're consumed.
   // TODO(siggi): Report progress here.
-  HRESULT hr = import_consumer.Consume();
+  task_scheduler_.PostTask(TaskScheduler::BULK,
+                           import_token_.get(),
+                           base::Bind(&ConsumeLogFiles,
+                                      base::Owned(import_consumer.release()),
+                                      start_time,
+                                      end_time,
+                                      ui_loop_,
+                                      import_done_.callback()));
+}
+
+void ViewerWindow::OnImportDone(HRESULT hr) {
+  DCHECK_EQ(ui_loop_, base::MessageLoop::current());
+  DCHECK(import_token_.get() != NULL);
+
+  import_token_ = NULL;
   if (FAILED(hr)) {
     std::wstring msg =
         base::StringPrintf(L"Import failed with error 0x%08X", hr);
     ::MessageBox(m_hWnd, msg.c_str(), L"Error Importing Logs", MB_OK);
   }
 
+  UIEnable(ID_FILE_IMPORT, true);
+  UIEnable(ID_LOG_CAPTURE, true);
   UISetText(0, L"Ready");
   UIUpdateStatusBar();
 }
@@ -364,8 +464,9 @@ bool ViewerWindow::StartCapturing() {
   p->Wnode.ClientContext = 1;
   p->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
   p->MaximumFileSize = 100;  // 100 M file size.
-  // Get image load and process events.
-  p->EnableFlags = EVENT_TRACE_FLAG_IMAGE_LOAD | EVENT_TRACE_FLAG_PROCESS;
+  // Get image load, process and thread events.
+  p->EnableFlags = EVENT_TRACE_FLAG_IMAGE_LOAD | EVENT_TRACE_FLAG_PROCESS |
+      EVENT_TRACE_FLAG_THREAD;
   p->FlushTimer = 1;  // flush every second.
   p->BufferSize = 16;  // 16 K buffers.
   hr = kernel_controller_.Start(KERNEL_LOGGER_NAME, &kernel_props);
@@ -377,6 +478,7 @@ bool ViewerWindow::StartCapturing() {
   DCHECK(NULL != kernel_consumer_.get());
   kernel_consumer_->set_module_event_sink(&symbol_lookup_service_);
   kernel_consumer_->set_process_event_sink(&process_info_service_);
+  kernel_consumer_->set_thread_event_sink(&thread_info_service_);
   kernel_consumer_->set_is_64_bit_log(Is64BitSystem());
   hr = kernel_consumer_->OpenRealtimeSession(KERNEL_LOGGER_NAME);
   if (FAILED(hr))
@@ -414,28 +516,40 @@ void ViewerWindow::OnLogMessage(const LogEvents::LogMessage& log_message) {
   // Use regular expression matching to extract the
   // file/line/message from the log string, which is of
   // format "[<stuff>:<file>(<line>)] <message><ws>".
+  // The pieces refer to the event buffer until copied to the arena below.
+  pcrecpp::StringPiece file;
+  pcrecpp::StringPiece message;
   if (!kFileRe.FullMatch(
       pcrecpp::StringPiece(log_message.message, log_message.message_len),
-                           &msg.file, &msg.line, &msg.message)) {
+                           &file, &msg.line, &message)) {
     // As fallback, just slurp the entire string.
-    msg.message.assign(log_message.message, log_message.message_len);
+    message.set(log_message.message, log_message.message_len);
   }
 
   // If the message carried file information, use that
   // in preference to the above.
   if (log_message.file_len != 0) {
-    msg.file.assign(log_message.file, log_message.file_len);
+    file.set(log_message.file, log_message.file_len);
     msg.line = log_message.line;
   }
 
-  if (log_message.trace_depth > 0) {
-    msg.trace.insert(msg.trace.begin(),
-                     &log_message.traces[0],
-                     &log_message.traces[log_message.trace_depth - 1]);
-  }
+  msg.process = process_table_.AddMessage(msg.process_id, msg.time_stamp);
 
+  // The site counts are kept under the list lock, so they agree with the
+  // messages through ClearAll.
   base::AutoLock lock(list_lock_);
+  msg.site_id = site_table_.AddMessage(
+      base::StringPiece(file.data(), file.size()), msg.line, msg.level,
+      msg.time_stamp);
+  msg.file = text_arena_.AppendString(
+      base::StringPiece(file.data(), file.size()));
+  AddMessageText(base::StringPiece(message.data(), message.size()), &msg);
+  if (log_message.trace_depth > 0) {
+    msg.trace_depth = log_message.trace_depth - 1;
+    msg.trace = text_arena_.AppendTrace(log_message.traces, msg.trace_depth);
+  }
   log_messages_.push_back(msg);
+  time_index_.Append(msg.time_stamp);
 
   ScheduleNewItemsNotification();
 }
@@ -503,45 +617,83 @@ void ViewerWindow::AddTraceEventToLog(const char* type,
   msg.time_stamp = trace_message.time;
 
   // The message will be of form "{BEGIN|END|INSTANT}(<name>, 0x<id>): <extra>"
-  msg.message = base::StringPrintf("%s(%*s, 0x%08X): %*s",
-                                   type,
-                                   trace_message.name_len,
-                                   trace_message.name,
-                                   trace_message.id,
-                                   trace_message.extra_len,
-                                   trace_message.extra);
+  std::string message = base::StringPrintf("%s(%*s, 0x%08X): %*s",
+                                           type,
+                                           trace_message.name_len,
+                                           trace_message.name,
+                                           trace_message.id,
+                                           trace_message.extra_len,
+                                           trace_message.extra);
 
-  for (size_t i = 0; i < trace_message.trace_depth; ++i)
-    msg.trace.push_back(trace_message.traces[i]);
+  msg.process = process_table_.AddMessage(msg.process_id, msg.time_stamp);
 
   base::AutoLock lock(list_lock_);
+  msg.site_id = site_table_.AddMessage(base::StringPiece(), 0, msg.level,
+                                       msg.time_stamp);
+  AddMessageText(message, &msg);
+  msg.trace_depth = trace_message.trace_depth;
+  msg.trace = text_arena_.AppendTrace(trace_message.traces,
+                                      trace_message.trace_depth);
   log_messages_.push_back(msg);
+  time_index_.Append(msg.time_stamp);
 
   ScheduleNewItemsNotification();
 }
 
+void ViewerWindow::AddMessageText(const base::StringPiece& text,
+                                  LogMessage* msg) {
+  // The list lock must be held.
+  list_lock_.AssertAcquired();
+
+  msg->template_id = template_miner_.AddMessage(text, &parameters_);
+  msg->parameters = text_arena_.AppendString(parameters_);
+}
+
 void ViewerWindow::ScheduleNewItemsNotification() {
   // The list lock must be held.
   list_lock_.AssertAcquired();
 
   if (!notify_log_view_new_items_pending_) {
     notify_log_view_new_items_pending_ = true;
-    ui_loop_->PostTask(FROM_HERE, notify_log_view_new_items_.callback());
+
+    // Wait out the rest of the interval since the last notification.
+    base::TimeDelta delay =
+        last_new_items_notification_ +
+        base::TimeDelta::FromMilliseconds(kNewItemsIntervalMs) -
+        base::TimeTicks::Now();
+    if (delay < base::TimeDelta())
+      delay = base::TimeDelta();
+
+    ui_loop_->PostDelayedTask(FROM_HERE,
+                              notify_log_view_new_items_.callback(),
+                              delay);
   }
 }
 
 void ViewerWindow::NotifyLogViewNewItems() {
   DCHECK_EQ(ui_loop_, base::MessageLoop::current());
+  int64 first_row = 0;
+  int64 num_rows = 0;
   {
     base::AutoLock lock(list_lock_);
 
     // Notification no longer pending.
     notify_log_view_new_items_pending_ = false;
+    last_new_items_notification_ = base::TimeTicks::Now();
+
+    // Publish the rows appended since the last notification.
+    first_row = num_rows_notified_;
+    num_rows = log_messages_.size() - num_rows_notified_;
+    num_rows_notified_ = log_messages_.size();
   }
 
+  // The log may have been cleared since the notification was scheduled.
+  if (num_rows == 0)
+    return;
+
   EventSinkMap::iterator it(event_sinks_.begin());
   for (; it != event_sinks_.end(); ++it) {
-    it->second->LogViewNewItems();
+    it->second->LogViewNewItems(first_row, num_rows);
   }
 }
 
@@ -658,7 +810,7 @@ int ViewerWindow::OnCreate(LPCREATESTRUCT lpCreateStruct) {
   // TODO(siggi): Make the toolbar useful.
   // CreateSimpleToolBar();
 
-  // Import is enabled, except when capturing.
+  // Import is enabled, except when capturing or importing.
   UIEnable(ID_FILE_IMPORT, true);
 
   // Edit menu is disabled by default.
@@ -680,6 +832,10 @@ int ViewerWindow::OnCreate(LPCREATESTRUCT lpCreateStruct) {
   log_viewer_.SetLogView(this);
   log_viewer_.SetSymbolLookupService(&symbol_lookup_service_);
   log_viewer_.SetProcessInfoService(&process_info_service_);
+  log_viewer_.SetThreadInfoService(&thread_info_service_);
+  log_viewer_.SetTaskRunner(
+      task_scheduler_.GetTaskRunner(TaskScheduler::INTERACTIVE));
+  log_viewer_.SetLogSiteTable(&site_table_);
 
   log_viewer_.Create(m_hWnd,
                      NULL,
@@ -737,7 +893,7 @@ void ViewerWindow::OnDestroy() {
   ::PostQuitMessage(1);
 }
 
-int ViewerWindow::GetNumRows() {
+int64 ViewerWindow::GetNumRows() {
   base::AutoLock lock(list_lock_);
   return log_messages_.size();
 }
@@ -746,48 +902,110 @@ void ViewerWindow::ClearAll() {
   {
     base::AutoLock lock(list_lock_);
     log_messages_.clear();
+    time_index_.Clear();
+    text_arena_.Clear();
+    num_rows_notified_ = 0;
+    site_table_.ResetCounts();
   }
   NotifyLogViewCleared();
 }
 
-int ViewerWindow::GetSeverity(int row) {
+const ViewerWindow::LogMessage& ViewerWindow::GetRow(int64 row) const {
+  list_lock_.AssertAcquired();
+
+  // Readers on the task scheduler may race ClearAll, and they read the rows
+  // that were cleared from under them as empty.
+  if (static_cast<uint64>(row) >= log_messages_.size())
+    return cleared_row_;
+
+  return log_messages_[static_cast<size_t>(row)];
+}
+
+int ViewerWindow::GetSeverity(int64 row) {
   base::AutoLock lock(list_lock_);
-  return log_messages_[row].level;
+  return GetRow(row).level;
 }
 
-DWORD ViewerWindow::GetProcessId(int row) {
+DWORD ViewerWindow::GetProcessId(int64 row) {
   base::AutoLock lock(list_lock_);
-  return log_messages_[row].process_id;
+  return GetRow(row).process_id;
 }
 
-DWORD ViewerWindow::GetThreadId(int row) {
+DWORD ViewerWindow::GetThreadId(int64 row) {
   base::AutoLock lock(list_lock_);
-  return log_messages_[row].thread_id;
+  return GetRow(row).thread_id;
 }
 
-base::Time ViewerWindow::GetTime(int row) {
+base::Time ViewerWindow::GetTime(int64 row) {
   base::AutoLock lock(list_lock_);
-  return log_messages_[row].time_stamp;
+  return GetRow(row).time_stamp;
 }
 
-std::string ViewerWindow::GetFileName(int row) {
+std::string ViewerWindow::GetFileName(int64 row) {
   base::AutoLock lock(list_lock_);
-  return log_messages_[row].file;
+  return GetRow(row).file.as_string();
 }
 
-int ViewerWindow::GetLine(int row) {
+int ViewerWindow::GetLine(int64 row) {
   base::AutoLock lock(list_lock_);
-  return log_messages_[row].line;
+  return GetRow(row).line;
+}
+
+std::string ViewerWindow::GetMessage(int64 row) {
+  base::AutoLock lock(list_lock_);
+  std::string message;
+  if (static_cast<uint64>(row) < log_messages_.size()) {
+    const LogMessage& msg = log_messages_[static_cast<size_t>(row)];
+    template_miner_.FormatMessage(msg.template_id, msg.parameters, &message);
+  }
+  return message;
+}
+
+void ViewerWindow::GetStackTrace(int64 row, std::vector<void*>* trace) {
+  base::AutoLock lock(list_lock_);
+  const LogMessage& msg = GetRow(row);
+  trace->assign(msg.trace, msg.trace + msg.trace_depth);
+}
+
+int ViewerWindow::GetSiteId(int64 row) {
+  base::AutoLock lock(list_lock_);
+  return GetRow(row).site_id;
+}
+
+int ViewerWindow::GetTemplateId(int64 row) {
+  base::AutoLock lock(list_lock_);
+  return GetRow(row).template_id;
+}
+
+std::string ViewerWindow::GetTemplateText(int template_id) {
+  base::AutoLock lock(list_lock_);
+  return template_miner_.GetTemplateText(template_id);
+}
+
+int ViewerWindow::GetImageId(int64 row) {
+  int process = 0;
+  {
+    base::AutoLock lock(list_lock_);
+    process = GetRow(row).process;
+  }
+
+  return process_table_.GetImageId(process);
+}
+
+std::string ViewerWindow::GetImageName(int image_id) {
+  return process_table_.GetImageName(image_id);
 }
 
-std::string ViewerWindow::GetMessage(int row) {
+int64 ViewerWindow::FindFirstRowAtTime(base::Time time) {
   base::AutoLock lock(list_lock_);
-  return log_messages_[row].message;
+  return time_index_.FindFirstRowAtTime(
+      time, MessageTimes<LogMessageList>(log_messages_));
 }
 
-void ViewerWindow::GetStackTrace(int row, std::vector<void*>* trace) {
+int64 ViewerWindow::FindEndOfRowsBefore(base::Time time) {
   base::AutoLock lock(list_lock_);
-  *trace = log_messages_[row].trace;
+  return time_index_.FindEndOfRowsBefore(
+      time, MessageTimes<LogMessageList>(log_messages_));
 }
 
 void ViewerWindow::Register(ILogViewEvents* event_sink,
@@ -24,6 +24,7 @@
 #include <atlframe.h>
 #include <atlmisc.h>
 #include <atlres.h>
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
@@ -32,14 +33,22 @@
 #include "base/memory/scoped_ptr.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/thread.h"
+#include "base/time/time.h"
 #include "base/win/event_trace_controller.h"
 #include "sawbuck/log_lib/kernel_log_consumer.h"
 #include "sawbuck/log_lib/log_consumer.h"
 #include "sawbuck/log_lib/process_info_service.h"
 #include "sawbuck/log_lib/symbol_lookup_service.h"
+#include "sawbuck/log_lib/task_scheduler.h"
+#include "sawbuck/log_lib/template_miner.h"
+#include "sawbuck/log_lib/thread_info_service.h"
+#include "sawbuck/viewer/log_site_table.h"
 #include "sawbuck/viewer/log_viewer.h"
+#include "sawbuck/viewer/process_table.h"
 #include "sawbuck/viewer/provider_configuration.h"
 #include "sawbuck/viewer/resource.h"
+#include "sawbuck/viewer/string_arena.h"
+#include "sawbuck/viewer/time_index.h"
 
 
 class ViewerWindow
@@ -73,6 +82,7 @@ class ViewerWindow
     UPDATE_ELEMENT(ID_FILE_IMPORT, UPDUI_MENUBAR)
     UPDATE_ELEMENT(ID_LOG_CAPTURE, UPDUI_MENUBAR)
     UPDATE_ELEMENT(ID_LOG_FILTER, UPDUI_MENUBAR)
+    UPDATE_ELEMENT(ID_LOG_QUERY, UPDUI_MENUBAR)
     UPDATE_ELEMENT(ID_EDIT_AUTOSIZE_COLUMNS, UPDUI_MENUBAR)
     UPDATE_ELEMENT(ID_EDIT_CUT, UPDUI_MENUBAR)
     UPDATE_ELEMENT(ID_EDIT_COPY, UPDUI_MENUBAR)
@@ -82,6 +92,7 @@ class ViewerWindow
     UPDATE_ELEMENT(ID_EDIT_SELECT_ALL, UPDUI_MENUBAR)
     UPDATE_ELEMENT(ID_EDIT_FIND, UPDUI_MENUBAR)
     UPDATE_ELEMENT(ID_EDIT_FIND_NEXT, UPDUI_MENUBAR)
+    UPDATE_ELEMENT(ID_EDIT_GO_TO_TIME, UPDUI_MENUBAR)
     UPDATE_ELEMENT(0, UPDUI_STATUSBAR)
   END_UPDATE_UI_MAP()
 
@@ -89,16 +100,23 @@ class ViewerWindow
   ~ViewerWindow();
 
   // ILogView implementation
-  virtual int GetNumRows();
+  virtual int64 GetNumRows();
   virtual void ClearAll();
-  virtual int GetSeverity(int row);
-  virtual DWORD GetProcessId(int row);
-  virtual DWORD GetThreadId(int row);
-  virtual base::Time GetTime(int row);
-  virtual std::string GetFileName(int row);
-  virtual int GetLine(int row);
-  virtual std::string GetMessage(int row);
-  virtual void GetStackTrace(int row, std::vector<void*>* stack_trace);
+  virtual int GetSeverity(int64 row);
+  virtual DWORD GetProcessId(int64 row);
+  virtual DWORD GetThreadId(int64 row);
+  virtual base::Time GetTime(int64 row);
+  virtual std::string GetFileName(int64 row);
+  virtual int GetLine(int64 row);
+  virtual std::string GetMessage(int64 row);
+  virtual void GetStackTrace(int64 row, std::vector<void*>* stack_trace);
+  virtual int GetSiteId(int64 row);
+  virtual int GetTemplateId(int64 row);
+  virtual std::string GetTemplateText(int template_id);
+  virtual int GetImageId(int64 row);
+  virtual std::string GetImageName(int image_id);
+  virtual int64 FindFirstRowAtTime(base::Time time);
+  virtual int64 FindEndOfRowsBefore(base::Time time);
 
   virtual void Register(ILogViewEvents* event_sink,
                         int* registration_cookie);
@@ -107,8 +125,15 @@ class ViewerWindow
   // Turn capturing on or off.
   virtual void SetCapture(bool capture);
 
-  // Consumes the logs in paths.
+  // Consumes the logs in paths. Imports run in the background, one at a
+  // time.
   void ImportLogFiles(const std::vector<base::FilePath>& paths);
+  // Consumes the events logged from @p start_time through @p end_time in
+  // paths. A null time leaves that end of the window open. A window whose
+  // start doesn't precede its end is rejected with a message to the user.
+  void ImportLogFiles(const std::vector<base::FilePath>& paths,
+                      const base::Time& start_time,
+                      const base::Time& end_time);
 
  private:
   LRESULT OnImport(WORD code, LPARAM lparam, HWND wnd, BOOL& handled);
@@ -141,6 +166,9 @@ class ViewerWindow
   // LogEvents implementation.
   void OnLogMessage(const LogEvents::LogMessage& log_message);
 
+  // Invoked on the UI thread when an import completes with @p hr.
+  void OnImportDone(HRESULT hr);
+
   // Invoked on the background thread by the symbol service.
   void OnStatusUpdate(const wchar_t* status);
   // Invoked on the UI thread to update our status.
@@ -155,7 +183,9 @@ class ViewerWindow
   void AddTraceEventToLog(const char* type,
                           const TraceEvents::TraceMessage& trace_message);
 
-  // Schedule a notification of new items on UI thread.
+  // Schedule a notification of new items on UI thread. The notifications
+  // are paced to a frame rate, so that the rows appended in the meantime
+  // are published in one batch.
   // Must be called under list_lock_.
   void ScheduleNewItemsNotification();
 
@@ -164,32 +194,76 @@ class ViewerWindow
   // The currently configured symbol path.
   std::wstring symbol_path_;
 
+  // The text and trace of a message refer to text_arena_, its site to
+  // site_table_, and its process instance to process_table_. The message
+  // text is stored as the parameters of its
+  // template in template_miner_.
   struct LogMessage {
-    LogMessage() : level(0), process_id(0), thread_id(0), line(0) {
+    LogMessage() : level(0), process_id(0), thread_id(0), line(0),
+        template_id(0), trace(NULL), trace_depth(0), site_id(0),
+        process(0) {
     }
 
     UCHAR level;
     DWORD process_id;
     DWORD thread_id;
     base::Time time_stamp;
-    std::string file;
+    base::StringPiece file;
     int line;
-    std::string message;
-    std::vector<void*> trace;
+    int template_id;
+    base::StringPiece parameters;
+    void* const* trace;
+    size_t trace_depth;
+    int site_id;
+    int process;
   };
 
-  // We dedicate a thread to the symbol lookup work.
-  base::Thread symbol_lookup_worker_;
+  // Mines the template of the message @p text, and stores its parameters
+  // in @p msg. Must be called under list_lock_.
+  void AddMessageText(const base::StringPiece& text, LogMessage* msg);
+
+  // @returns the message at @p row, or an empty message past the end.
+  // Must be called under list_lock_.
+  const LogMessage& GetRow(int64 row) const;
+
+  // Runs our background work: symbol lookups and imports.
+  TaskScheduler task_scheduler_;
+
+  // Non-NULL while an import is in progress.
+  scoped_refptr<CancellationToken> import_token_;
+  typedef base::CancelableCallback<void(HRESULT)> ImportDoneCallback;
+  ImportDoneCallback import_done_;
 
   base::Lock list_lock_;
-  typedef std::vector<LogMessage> LogMessageList;
+  // A deque grows in chunks, so appending never copies the messages, and
+  // long captures don't need a contiguous block of memory.
+  typedef std::deque<LogMessage> LogMessageList;
   LogMessageList log_messages_;  // Under list_lock_.
+  // What the rows past the end of log_messages_ read as.
+  const LogMessage cleared_row_;
+  StringArena text_arena_;  // Under list_lock_.
+  TemplateMiner template_miner_;  // Under list_lock_.
+  // Receives the parameters of each message from template_miner_.
+  std::string parameters_;  // Under list_lock_.
+  // Finds the messages logged at a time.
+  TimeIndex time_index_;  // Under list_lock_.
+
+  // The sites of the messages in log_messages_, counted under list_lock_.
+  LogSiteTable site_table_;
+
+  // The process instances of the messages in log_messages_, which observes
+  // process_info_service_ for their images.
+  ProcessTable process_table_;
 
   typedef base::CancelableCallback<void()> NotifyNewItemsCallback;
 
   // Keeps the task pending to notify event sinks on the UI thread.
   NotifyNewItemsCallback notify_log_view_new_items_;
   bool notify_log_view_new_items_pending_;  // Under list_lock_.
+  // When we last notified of new items.
+  base::TimeTicks last_new_items_notification_;  // Under list_lock_.
+  // The number of rows we've notified of.
+  int64 num_rows_notified_;  // Under list_lock_.
 
   // The message loop we're instantiated on, used to signal
   // back to the main thread from workers.
@@ -213,6 +287,9 @@ class ViewerWindow
   // Takes care of sinking KernelProcessEvents for us.
   ProcessInfoService process_info_service_;
 
+  // Takes care of sinking KernelThreadEvents for us.
+  ThreadInfoService thread_info_service_;
+
   // The list view control that displays log_messages_.
   LogViewer log_viewer_;
 
@@ -13,6 +13,7 @@
 // limitations under the License.
 #include "sawbuck/viewer/viewer_window.h"
 
+#include "base/run_loop.h"
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "sawbuck/viewer/mock_log_view_interfaces.h"
@@ -21,6 +22,14 @@ namespace {
 
 using testing::StrictMock;
 
+// Appends a log message to @p events.
+void AppendLogMessage(LogEvents* events, const char* text) {
+  LogEvents::LogMessage msg;
+  msg.message = text;
+  msg.message_len = strlen(text);
+  events->OnLogMessage(msg);
+}
+
 class ViewerWindowTest : public testing::Test {
  protected:
   base::MessageLoop message_loop_;
@@ -52,4 +61,39 @@ TEST_F(ViewerWindowTest, ClearAll) {
   viewer_window.ClearAll();
 }
 
+TEST_F(ViewerWindowTest, NewItemsAreBatched) {
+  ViewerWindow viewer_window;
+
+  int reg_cookie = 0;
+  StrictMock<testing::MockILogViewEvents> mock_event_sink;
+  viewer_window.Register(&mock_event_sink, &reg_cookie);
+
+  // Rows appended in a burst are published in one notification.
+  AppendLogMessage(&viewer_window, "one");
+  AppendLogMessage(&viewer_window, "two");
+  AppendLogMessage(&viewer_window, "three");
+
+  EXPECT_CALL(mock_event_sink, LogViewNewItems(0, 3)).Times(1);
+  {
+    base::RunLoop run_loop;
+    run_loop.RunUntilIdle();
+  }
+  EXPECT_EQ("two", viewer_window.GetMessage(1));
+
+  // The next batch waits out the rest of the interval.
+  AppendLogMessage(&viewer_window, "four");
+  AppendLogMessage(&viewer_window, "five");
+
+  EXPECT_CALL(mock_event_sink, LogViewNewItems(3, 2)).Times(1);
+  {
+    base::RunLoop run_loop;
+    message_loop_.PostDelayedTask(FROM_HERE,
+                                  run_loop.QuitClosure(),
+                                  base::TimeDelta::FromMilliseconds(100));
+    run_loop.Run();
+  }
+
+  viewer_window.Unregister(reg_cookie);
+}
+
 }  // namespace